@@ -1,20 +1,15 @@
 #include "BMW-I3-BATTERY.h"
 #include <Arduino.h>
+#include "../communication/can/CanCrc.h"
 #include "../communication/can/comm_can.h"
 #include "../datalayer/datalayer.h"
 #include "../datalayer/datalayer_extended.h"
-#include "../devboard/utils/common_functions.h"  //For CRC table
 #include "../devboard/utils/events.h"
 
 /* Do not change code below unless you are sure what you are doing */
 
-static uint8_t calculateCRC(CAN_frame rx_frame, uint8_t length, uint8_t initial_value) {
-  uint8_t crc = initial_value;
-  for (uint8_t j = 1; j < length; j++) {  //start at 1, since 0 is the CRC
-    crc = crc8_table_SAE_J1850_ZER0[(crc ^ static_cast<uint8_t>(rx_frame.data.u8[j])) % 256];
-  }
-  return crc;
-}
+// CRC in byte 0 over the rest of the frame, alive counter 0...14 in the low nibble of byte 1
+typedef AliveCounterCrc<Crc8J1850, 1, 0, 14> ProtectedFrame;
 
 uint8_t BmwI3Battery::increment_alive_counter(uint8_t counter) {
   counter++;
@@ -121,7 +116,7 @@ void BmwI3Battery::update_values() {  //This function maps all the values fetche
   }
 }
 
-void BmwI3Battery::handle_incoming_can_frame(CAN_frame rx_frame) {
+void BmwI3Battery::handle_incoming_can_frame(const CAN_frame& rx_frame) {
   switch (rx_frame.ID) {
     case 0x112:  //BMS [10ms] Status Of High-Voltage Battery - 2
       // Set to true unless balancing is going on and battery is supposed to go to sleep
@@ -165,7 +160,7 @@ void BmwI3Battery::handle_incoming_can_frame(CAN_frame rx_frame) {
       // Set to true unless balancing is going on and battery is supposed to go to sleep
       battery_awake = UserRequestBalancing != EXECUTING;
       if (!skipCRCCheck) {
-        if (calculateCRC(rx_frame, rx_frame.DLC, 0x15) != rx_frame.data.u8[0]) {
+        if (!ProtectedFrame::valid(rx_frame, rx_frame.DLC, 0x15)) {
           // If calculated CRC does not match transmitted CRC, increase CANerror counter
           datalayer_battery->status.CAN_error_counter++;
 
@@ -325,10 +320,7 @@ void BmwI3Battery::transmit_can(unsigned long currentMillis) {
         BMW_10B.data.u8[1] = 0x10;  // Close contactors
       }
 
-      BMW_10B.data.u8[1] = ((BMW_10B.data.u8[1] & 0xF0) + alive_counter_20ms);
-      BMW_10B.data.u8[0] = calculateCRC(BMW_10B, 3, 0x3F);
-
-      alive_counter_20ms = increment_alive_counter(alive_counter_20ms);
+      ProtectedFrame::advance(BMW_10B, alive_counter_20ms, 3, 0x3F);
 
       BMW_13E_counter++;
       BMW_13E.data.u8[4] = BMW_13E_counter;
@@ -347,10 +339,7 @@ void BmwI3Battery::transmit_can(unsigned long currentMillis) {
     if (currentMillis - previousMillis100 >= INTERVAL_100_MS) {
       previousMillis100 = currentMillis;
 
-      BMW_12F.data.u8[1] = ((BMW_12F.data.u8[1] & 0xF0) + alive_counter_100ms);
-      BMW_12F.data.u8[0] = calculateCRC(BMW_12F, 8, 0x60);
-
-      alive_counter_100ms = increment_alive_counter(alive_counter_100ms);
+      ProtectedFrame::advance(BMW_12F, alive_counter_100ms, 8, 0x60);
 
       transmit_can_frame(&BMW_12F);
     }
@@ -358,10 +347,7 @@ void BmwI3Battery::transmit_can(unsigned long currentMillis) {
     if (currentMillis - previousMillis200 >= INTERVAL_200_MS) {
       previousMillis200 = currentMillis;
 
-      BMW_19B.data.u8[1] = ((BMW_19B.data.u8[1] & 0xF0) + alive_counter_200ms);
-      BMW_19B.data.u8[0] = calculateCRC(BMW_19B, 8, 0x6C);
-
-      alive_counter_200ms = increment_alive_counter(alive_counter_200ms);
+      ProtectedFrame::advance(BMW_19B, alive_counter_200ms, 8, 0x6C);
 
       transmit_can_frame(&BMW_19B);
 
@@ -401,10 +387,7 @@ void BmwI3Battery::transmit_can(unsigned long currentMillis) {
     if (currentMillis - previousMillis500 >= INTERVAL_500_MS) {
       previousMillis500 = currentMillis;
 
-      BMW_30B.data.u8[1] = ((BMW_30B.data.u8[1] & 0xF0) + alive_counter_500ms);
-      BMW_30B.data.u8[0] = calculateCRC(BMW_30B, 8, 0xBE);
-
-      alive_counter_500ms = increment_alive_counter(alive_counter_500ms);
+      ProtectedFrame::advance(BMW_30B, alive_counter_500ms, 8, 0xBE);
 
       transmit_can_frame(&BMW_30B);
     }
@@ -436,17 +419,10 @@ void BmwI3Battery::transmit_can(unsigned long currentMillis) {
       BMW_328.data.u8[4] = (uint8_t)(BMW_328_days & 0xFF);
       BMW_328.data.u8[5] = (uint8_t)((BMW_328_days >> 8) & 0xFF);
 
-      BMW_1D0.data.u8[1] = ((BMW_1D0.data.u8[1] & 0xF0) + alive_counter_1000ms);
-      BMW_1D0.data.u8[0] = calculateCRC(BMW_1D0, 8, 0xF9);
-
-      BMW_3F9.data.u8[1] = ((BMW_3F9.data.u8[1] & 0xF0) + alive_counter_1000ms);
-      BMW_3F9.data.u8[0] = calculateCRC(BMW_3F9, 8, 0x38);
-
-      BMW_3EC.data.u8[1] = ((BMW_3EC.data.u8[1] & 0xF0) + alive_counter_1000ms);
-      BMW_3EC.data.u8[0] = calculateCRC(BMW_3EC, 8, 0x53);
-
-      BMW_3A7.data.u8[1] = ((BMW_3A7.data.u8[1] & 0xF0) + alive_counter_1000ms);
-      BMW_3A7.data.u8[0] = calculateCRC(BMW_3A7, 8, 0x05);
+      ProtectedFrame::stamp(BMW_1D0, alive_counter_1000ms, 8, 0xF9);
+      ProtectedFrame::stamp(BMW_3F9, alive_counter_1000ms, 8, 0x38);
+      ProtectedFrame::stamp(BMW_3EC, alive_counter_1000ms, 8, 0x53);
+      ProtectedFrame::stamp(BMW_3A7, alive_counter_1000ms, 8, 0x05);
 
       alive_counter_1000ms = increment_alive_counter(alive_counter_1000ms);
 
@@ -38,38 +38,6 @@ uint8_t BmwIXBattery::increment_alive_counter(uint8_t counter) {
   return counter;
 }
 
-// UDS Multi-Frame Reception Helper Functions
-void BmwIXBattery::startUDSMultiFrameReception(uint16_t totalLength, uint8_t moduleID) {
-  gUDSContext.UDS_inProgress = true;
-  gUDSContext.UDS_expectedLength = totalLength;
-  gUDSContext.UDS_bytesReceived = 0;
-  gUDSContext.UDS_sequenceNumber = 1;  // Next expected sequence is 1
-  gUDSContext.UDS_moduleID = moduleID;
-  memset(gUDSContext.UDS_buffer, 0, sizeof(gUDSContext.UDS_buffer));
-  gUDSContext.UDS_lastFrameMillis = millis();  // Track timeout
-}
-
-bool BmwIXBattery::storeUDSPayload(const uint8_t* payload, uint8_t length) {
-  if (gUDSContext.UDS_bytesReceived + length > sizeof(gUDSContext.UDS_buffer)) {
-    logging.println("UDS buffer overflow prevented");
-    gUDSContext.UDS_inProgress = false;
-    return false;
-  }
-
-  memcpy(&gUDSContext.UDS_buffer[gUDSContext.UDS_bytesReceived], payload, length);
-  gUDSContext.UDS_bytesReceived += length;
-  gUDSContext.UDS_lastFrameMillis = millis();
-
-  // If we've reached or exceeded the expected length, mark complete
-  if (gUDSContext.UDS_bytesReceived >= gUDSContext.UDS_expectedLength) {
-    gUDSContext.UDS_inProgress = false;
-  }
-  return true;
-}
-
-bool BmwIXBattery::isUDSMessageComplete() {
-  return (!gUDSContext.UDS_inProgress && gUDSContext.UDS_bytesReceived > 0);
-}
 CAN_frame BmwIXBattery::generate_433_datetime_message() {
   CAN_frame frame_433;
   frame_433.ID = 0x433;
@@ -161,18 +129,18 @@ CAN_frame BmwIXBattery::generate_442_time_counter_message() {
 
   return frame_442;
 }
-void BmwIXBattery::parseDTCResponse() {
+void BmwIXBattery::parseDTCResponse(const uint8_t* data, uint16_t length) {
   // Check for negative response
-  if (gUDSContext.UDS_buffer[0] == 0x7F) {
+  if (data[0] == 0x7F) {
     logging.print("DTC request rejected by battery. Reason code: 0x");
-    logging.print(gUDSContext.UDS_buffer[2], HEX);
+    logging.print(data[2], HEX);
     logging.println();
     datalayer_extended.bmwix.dtc_read_failed = true;
     datalayer_extended.bmwix.dtc_read_in_progress = false;
     return;
   }
 
-  if (gUDSContext.UDS_buffer[0] != 0x59 || gUDSContext.UDS_buffer[1] != 0x02) {
+  if (data[0] != 0x59 || data[1] != 0x02) {
     logging.println("Invalid DTC response header");
     datalayer_extended.bmwix.dtc_read_failed = true;
     datalayer_extended.bmwix.dtc_read_in_progress = false;
@@ -180,7 +148,7 @@ void BmwIXBattery::parseDTCResponse() {
   }
 
   int dtcStartIndex = 3;  // Skip 59 02 FF
-  int availableBytes = gUDSContext.UDS_bytesReceived - dtcStartIndex;
+  int availableBytes = length - dtcStartIndex;
   int maxDtcCount = availableBytes / 4;
 
   if (maxDtcCount > MAX_DTC_COUNT) {
@@ -198,17 +166,17 @@ void BmwIXBattery::parseDTCResponse() {
     int offset = dtcStartIndex + (i * 4);
 
     // Bounds check
-    if (offset + 3 > gUDSContext.UDS_bytesReceived) {
+    if (offset + 3 > length) {
       logging.println("DTC parsing: offset exceeds buffer, stopping");
       break;
     }
 
     // Combine 3 bytes into single uint32
-    uint32_t dtcCode = ((uint32_t)gUDSContext.UDS_buffer[offset] << 16) |
-                       ((uint32_t)gUDSContext.UDS_buffer[offset + 1] << 8) |
-                       (uint32_t)gUDSContext.UDS_buffer[offset + 2];
+    uint32_t dtcCode = ((uint32_t)data[offset] << 16) |
+                       ((uint32_t)data[offset + 1] << 8) |
+                       (uint32_t)data[offset + 2];
 
-    uint8_t dtcStatus = gUDSContext.UDS_buffer[offset + 3];
+    uint8_t dtcStatus = data[offset + 3];
 
     // Skip invalid DTCs (0x000000 or status 0x00)
     if (dtcCode == 0x000000 || dtcStatus == 0x00) {
@@ -255,164 +223,60 @@ void BmwIXBattery::parseDTCResponse() {
   datalayer_extended.bmwix.dtc_read_in_progress = false;
 }
 
-void BmwIXBattery::handleISOTPFrame(CAN_frame& rx_frame) {
-  uint8_t pciByte = rx_frame.data.u8[1];  // e.g., 0x10, 0x21, etc.
-  uint8_t pciType = pciByte >> 4;         // top nibble => 0=SF,1=FF,2=CF,3=FC
-
-  // Only process multi-frame ISO-TP messages (FF and CF)
-  // Single-frame messages are handled directly in case 0x607
-  if (pciType != 0x1 && pciType != 0x2) {
-    return;  // Not a multi-frame message we care about
+// Complete UDS response from the SME, single frame or reassembled by the ISO-TP link
+void BmwIXBattery::handle_uds_response(const uint8_t* data, uint16_t length) {
+  if (length >= 3 && data[0] == 0x7F && data[1] == 0x19) {  // Negative response to the DTC read
+    parseDTCResponse(data, length);
+    return;
+  }
+  if (length >= 2 && data[0] == 0x59 && data[1] == 0x02) {  // reportDTCByStatusMask
+    parseDTCResponse(data, length);
+    return;
+  }
+  if (length < 3 || data[0] != 0x62) {
+    return;
   }
 
-  switch (pciType) {
-    case 0x1: {
-      // First Frame (FF)
-      uint8_t pciLower = pciByte & 0x0F;
-      uint16_t totalLength = ((uint16_t)pciLower << 8) | rx_frame.data.u8[2];
-
-      uint8_t serviceResponse = rx_frame.data.u8[3];  // Service response byte (0x59, 0x62, etc.)
-      uint8_t moduleID;
-
-      // Determine which byte to use for module ID based on service response
-      if (serviceResponse == 0x59) {
-        // Standard UDS DTC response (0x19 -> 0x59)
-        // Use sub-function byte as module ID
-        moduleID = rx_frame.data.u8[4];  // 0x02 for reportDTCByStatusMask
-      } else {
-        // BMW proprietary responses (0x22 -> 0x62)
-        // Use parameter byte as module ID
-        moduleID = rx_frame.data.u8[5];  // 0x54, 0x53, etc.
+  switch ((data[1] << 8) | data[2]) {
+    case 0xE554: {  // Individual cell voltages
+      int voltage_index = 0;
+      for (int i = 3; i < length - 1; i += 2) {
+        if (voltage_index >= 108)
+          break;
+        uint16_t voltage = (data[i] << 8) | data[i + 1];
+        if (voltage < 10000) {
+          datalayer.battery.status.cell_voltages_mV[voltage_index] = voltage;
+        }
+        voltage_index++;
+      }
+    } break;
+    case 0xE5CE:  // Min/Avg/Max SOC%
+      if (length >= 9) {
+        avg_soc_state = (data[3] << 8 | data[4]);
+        min_soc_state = (data[5] << 8 | data[6]);
+        max_soc_state = (data[7] << 8 | data[8]);
       }
-
-      // logging.print("FF arrived! moduleID=0x");
-      // logging.print(moduleID, HEX);
-      // logging.print(", totalLength=");
-      // logging.println(totalLength);
-
-      // Start the multi-frame reception
-      startUDSMultiFrameReception(totalLength, moduleID);
-      gUDSContext.receivedInBatch = 0;  // Reset batch count
-
-      // Store the FF payload (starts at data[3] for extended addressing)
-      const uint8_t* ffPayload = &rx_frame.data.u8[3];
-      uint8_t ffPayloadSize = rx_frame.DLC - 3;
-      storeUDSPayload(ffPayload, ffPayloadSize);
-
-      // Request continuation
-      transmit_can_frame(&BMWiX_6F4_CONTINUE_DATA);
       break;
-    }
-
-    case 0x2: {
-      // Consecutive Frame (CF)
-      if (!gUDSContext.UDS_inProgress) {
-        logging.println("Unexpected CF - not in progress");
-        return;  // Unexpected CF, ignore
+    case 0xE4CA:  // Balancing data
+      if (length >= 4) {
+        balancing_status = data[3];  //4 = No symmetry mode active, invalid qualifier
       }
-
-      //uint8_t seq = pciByte & 0x0F;
-
-      // logging.print("CF seq=0x");
-      // logging.print(seq, HEX);
-      // logging.print(" for moduleID=0x");
-      // logging.println(gUDSContext.UDS_moduleID, HEX);
-
-      // Store CF payload (starts at byte 2)
-      storeUDSPayload(&rx_frame.data.u8[2], rx_frame.DLC - 2);
-
-      // Increment batch counter
-      gUDSContext.receivedInBatch++;
-
-      // logging.print("After CF, UDS_bytesReceived=");
-      // logging.println(gUDSContext.UDS_bytesReceived);
-
-      // Check if batch is complete (iX uses 2 frames per batch based on 0x30 0x00 0x02)
-      if (gUDSContext.receivedInBatch >= 2) {
-        //logging.println("Batch complete - requesting continue frame...");
-        transmit_can_frame(&BMWiX_6F4_CONTINUE_DATA);
-        gUDSContext.receivedInBatch = 0;
+      break;
+    case 0xE4C0:  // Uptime and vehicle time status
+      if (length >= 11) {
+        sme_uptime = (data[7] << 24) | (data[8] << 16) | (data[9] << 8) | data[10];  //Assuming 32bit
       }
       break;
-    }
-  }
-}
-
-void BmwIXBattery::processCompletedUDSResponse() {
-  uint8_t* buf = gUDSContext.UDS_buffer;
-  uint16_t len = gUDSContext.UDS_bytesReceived;
-
-  // Route based on moduleID (set during First Frame reception)
-  if (gUDSContext.UDS_moduleID == 0x02) {
-    // DTC Response (0x19 0x02 -> 0x59 0x02)
-    logging.println("=== DTC Response Received ===");
-    logging.print("Total bytes: ");
-    logging.println(len);
-    parseDTCResponse();
-
-  } else if (gUDSContext.UDS_moduleID == 0x54) {
-    // Cell Voltages (0x22 0xE5 0x54 -> 0x62 0xE5 0x54)
-    // logging.print("Parsing cell voltages - Total bytes: ");
-    // logging.println(len);
-    int voltage_index = 0;
-    for (int i = 3; i < len - 1; i += 2) {
-      if (voltage_index >= 108)
-        break;
-      uint16_t voltage = (buf[i] << 8) | buf[i + 1];
-      if (voltage < 10000) {
-        datalayer.battery.status.cell_voltages_mV[voltage_index] = voltage;
+    case 0xE545:  // SOH max min mean
+      if (length >= 11) {
+        min_soh_state = (data[5] << 8 | data[6]);
+        avg_soh_state = (data[7] << 8 | data[8]);
+        max_soh_state = (data[9] << 8 | data[10]);
       }
-      voltage_index++;
-    }
-    // logging.print("Parsed ");
-    // logging.print(voltage_index);
-    // logging.println(" cell voltages");
-
-  } else if (gUDSContext.UDS_moduleID == 0xCE) {
-    // SOC Response (0x22 0xE5 0xCE -> 0x62 0xE5 0xCE)
-    if (len >= 9) {
-      avg_soc_state = (buf[3] << 8 | buf[4]);
-      min_soc_state = (buf[5] << 8 | buf[6]);
-      max_soc_state = (buf[7] << 8 | buf[8]);
-      logging.println("SOC data updated");
-    }
-
-  } else if (gUDSContext.UDS_moduleID == 0xCA) {
-    // Balancing Data (0x22 0xE4 0xCA -> 0x62 0xE4 0xCA)
-    if (len >= 4) {
-      balancing_status = buf[3];
-      logging.println("Balancing status updated");
-    }
-
-    // REMOVE THIS BLOCK - Isolation data comes as single CAN FD frame, not ISO-TP
-    // } else if (gUDSContext.UDS_moduleID == 0x60) {
-    //   // Safety Isolation (0x22 0xA8 0x60 -> 0x62 0xA8 0x60)
-    //   if (len >= 43) {
-    //     iso_safety_positive = (buf[31] << 24) | (buf[32] << 16) | (buf[33] << 8) | buf[34];
-    //     iso_safety_negative = (buf[35] << 24) | (buf[36] << 16) | (buf[37] << 8) | buf[38];
-    //     iso_safety_parallel = (buf[39] << 24) | (buf[40] << 16) | (buf[41] << 8) | buf[42];
-    //     logging.println("ISO safety data updated");
-    //   }
-
-  } else if (gUDSContext.UDS_moduleID == 0xC0) {
-    // Uptime (0x22 0xE4 0xC0 -> 0x62 0xE4 0xC0)
-    if (len >= 11) {
-      sme_uptime = (buf[7] << 24) | (buf[8] << 16) | (buf[9] << 8) | buf[10];
-      logging.println("SME uptime updated");
-    }
-
-  } else if (gUDSContext.UDS_moduleID == 0x45) {
-    // SOH Data (0x22 0xE5 0x45 -> 0x62 0xE5 0x45)
-    if (len >= 11) {
-      min_soh_state = (buf[5] << 8 | buf[6]);
-      avg_soh_state = (buf[7] << 8 | buf[8]);
-      max_soh_state = (buf[9] << 8 | buf[10]);
-      logging.println("SOH data updated");
-    }
+      break;
+    default:
+      break;
   }
-
-  // Reset buffer after processing
-  gUDSContext.UDS_bytesReceived = 0;
 }
 
 /*
@@ -578,7 +442,7 @@ void BmwIXBattery::update_values() {  //This function maps all the values fetche
   }
 }
 
-void BmwIXBattery::handle_incoming_can_frame(CAN_frame rx_frame) {
+void BmwIXBattery::handle_incoming_can_frame(const CAN_frame& rx_frame) {
   battery_awake = true;
   switch (rx_frame.ID) {
     case 0x12B8D087:
@@ -633,8 +497,6 @@ void BmwIXBattery::handle_incoming_can_frame(CAN_frame rx_frame) {
       datalayer.battery.status.CAN_battery_still_alive = CAN_STILL_ALIVE;
       break;
     case 0x607:  //SME responds to UDS requests on 0x607
-      // Removed immediate cell voltage parsing blocks - now handled by ISO-TP multi-frame handler below
-
       if ((rx_frame.DLC == 7) && (rx_frame.data.u8[4] == 0x4D)) {  //Main Battery Voltage (Pre Contactor)
         battery_voltage = (rx_frame.data.u8[5] << 8 | rx_frame.data.u8[6]) / 10;
       }
@@ -650,32 +512,16 @@ void BmwIXBattery::handle_incoming_can_frame(CAN_frame rx_frame) {
                           0.1;
       }
 
-      if ((rx_frame.DLC == 64) && (rx_frame.data.u8[4] == 0xE4) && (rx_frame.data.u8[5] == 0xCA)) {  //Balancing Data
-        balancing_status = (rx_frame.data.u8[6]);  //4 = No symmetry mode active, invalid qualifier
-      }
       if ((rx_frame.DLC >= 6) && (rx_frame.data.u8[2] == 0x62) && (rx_frame.data.u8[3] == 0x10) &&
           (rx_frame.data.u8[4] == 0x0A)) {
         energy_saving_mode_status = rx_frame.data.u8[5];  // Store the energy saving mode status byte
       }
-      if ((rx_frame.DLC == 12) && (rx_frame.data.u8[4] == 0xE5) && (rx_frame.data.u8[5] == 0xCE)) {  //Min/Avg/Max SOC%
-        min_soc_state = (rx_frame.data.u8[8] << 8 | rx_frame.data.u8[9]);
-        avg_soc_state = (rx_frame.data.u8[6] << 8 | rx_frame.data.u8[7]);
-        max_soc_state = (rx_frame.data.u8[10] << 8 | rx_frame.data.u8[11]);
-      }
-
       if ((rx_frame.DLC == 12) && (rx_frame.data.u8[4] == 0xE5) &&
           (rx_frame.data.u8[5] == 0xC7)) {  //Current and max capacity kWh. Stored in kWh as 0.01 scale with -50  bias
         remaining_capacity = ((rx_frame.data.u8[6] << 8 | rx_frame.data.u8[7]) * 10) - 50000;
         max_capacity = ((rx_frame.data.u8[8] << 8 | rx_frame.data.u8[9]) * 10) - 50000;
       }
 
-      if ((rx_frame.DLC == 20) && (rx_frame.data.u8[4] == 0xE5) &&
-          (rx_frame.data.u8[5] == 0x45)) {  //SOH Max Min Mean Request
-        min_soh_state = ((rx_frame.data.u8[8] << 8 | rx_frame.data.u8[9]));
-        avg_soh_state = ((rx_frame.data.u8[10] << 8 | rx_frame.data.u8[11]));
-        max_soh_state = ((rx_frame.data.u8[12] << 8 | rx_frame.data.u8[13]));
-      }
-
       if ((rx_frame.DLC == 12) && (rx_frame.data.u8[4] == 0xE5) &&
           (rx_frame.data.u8[5] == 0x62)) {  //Max allowed charge and discharge current - Signed 16bit
         allowable_charge_amps = (int16_t)((rx_frame.data.u8[6] << 8 | rx_frame.data.u8[7])) / 10;
@@ -697,12 +543,6 @@ void BmwIXBattery::handle_incoming_can_frame(CAN_frame rx_frame) {
                               (rx_frame.data.u8[44] << 8) | rx_frame.data.u8[45];  //Assuming 32bit
       }
 
-      if ((rx_frame.DLC == 48) && (rx_frame.data.u8[4] == 0xE4) &&
-          (rx_frame.data.u8[5] == 0xC0)) {  // Uptime and Vehicle Time Status
-        sme_uptime = (rx_frame.data.u8[10] << 24) | (rx_frame.data.u8[11] << 16) | (rx_frame.data.u8[12] << 8) |
-                     rx_frame.data.u8[13];  //Assuming 32bit
-      }
-
       if ((rx_frame.DLC == 8) && (rx_frame.data.u8[3] == 0xAC) && (rx_frame.data.u8[4] == 0x93)) {  // Pyro Status
         pyro_status_pss1 = (rx_frame.data.u8[5]);
         pyro_status_pss4 = (rx_frame.data.u8[6]);
@@ -767,33 +607,8 @@ void BmwIXBattery::handle_incoming_can_frame(CAN_frame rx_frame) {
         battery_serial_number = strtoul(numberString, NULL, 10);
       }
 
-      // Handle single-frame DTC response (service 0x59)
-      if (rx_frame.data.u8[3] == 0x59 && rx_frame.data.u8[4] == 0x02) {
-        // Single-frame DTC response: F4 00 XX 59 02 FF [DTCs...]
-        // Copy to UDS buffer and parse
-        uint8_t sfLength = rx_frame.data.u8[2];  // Length byte
-        if (sfLength > 0 && sfLength <= (rx_frame.DLC - 3)) {
-          // Copy response data starting from byte 3 (service ID)
-          memcpy(gUDSContext.UDS_buffer, &rx_frame.data.u8[3], sfLength);
-          gUDSContext.UDS_bytesReceived = sfLength;
-          gUDSContext.UDS_moduleID = 0x02;  // DTC response
-          gUDSContext.UDS_inProgress = false;
-
-          logging.println("=== Single-Frame DTC Response Received ===");
-          logging.print("Total bytes: ");
-          logging.println(gUDSContext.UDS_bytesReceived);
-
-          parseDTCResponse();
-        }
-      }
-
-      // Handle ISO-TP multi-frame messages
-      handleISOTPFrame(rx_frame);
-
-      // Check if complete UDS response is ready to process
-      if (isUDSMessageComplete()) {
-        processCompletedUDSResponse();
-      }
+      // Multi-frame responses, and single frames handled in handle_uds_response()
+      isotp.handle_frame(rx_frame, millis());
       break;
     default:
       break;
@@ -810,14 +625,7 @@ void BmwIXBattery::transmit_can(unsigned long currentMillis) {
     datalayer.system.status.battery_allows_contactor_closing = true;
   }
 
-  // Timeout check for stuck UDS transfers
-  if (gUDSContext.UDS_inProgress) {
-    if (currentMillis - gUDSContext.UDS_lastFrameMillis > 2000) {  // 2 second timeout
-      logging.println("UDS transfer timeout - aborting");
-      gUDSContext.UDS_inProgress = false;
-      gUDSContext.UDS_bytesReceived = 0;
-    }
-  }
+  isotp.poll(currentMillis);
 
   // We can always send CAN as the iX BMS will wake up on vehicle comms
   if (currentMillis - previousMillis10 >= INTERVAL_10_MS) {
@@ -966,6 +774,12 @@ void BmwIXBattery::setup(void) {  // Performs one time setup at startup
   datalayer.battery.info.min_cell_voltage_mV = MIN_CELL_VOLTAGE_MV;
   datalayer.battery.info.max_cell_voltage_deviation_mV = MAX_CELL_DEVIATION_MV;
   datalayer.system.status.battery_allows_contactor_closing = false;  // Don't allow contactors until reset is done
+
+  isotp.set_addresses(0x07, 0xF4);
+  isotp.set_can_fd(true);
+  isotp.set_flow_control(2, 0);  // The SME sends two consecutive frames per flow control
+  isotp.set_timeout(2000);
+  isotp.on_receive([this](const uint8_t* data, uint16_t length) { handle_uds_response(data, length); });
 }
 
 void BmwIXBattery::HandleIncomingUserRequest(void) {
@@ -1,27 +1,16 @@
 #ifndef BMW_IX_BATTERY_H
 #define BMW_IX_BATTERY_H
 #include <Arduino.h>
+#include "../communication/can/IsoTp.h"
 #include "BMW-IX-HTML.h"
 #include "CanBattery.h"
 
-// UDS Multi-Frame Reception Context
-struct UDS_CONTEXT {
-  uint8_t UDS_buffer[512];            // Buffer to store multi-frame UDS data
-  uint16_t UDS_bytesReceived;         // Track number of bytes received
-  uint16_t UDS_expectedLength;        // Total expected length from first frame
-  uint8_t UDS_sequenceNumber;         // Expected sequence number for consecutive frames (for IX non-batch mode)
-  bool UDS_inProgress;                // Flag indicating if we're in the middle of receiving
-  uint8_t UDS_moduleID;               // Module ID responding (0xF4 for battery)
-  uint8_t receivedInBatch;            // Number of CFs received in current batch (for PHEV batch mode)
-  unsigned long UDS_lastFrameMillis;  // Timestamp of last frame for timeout detection
-};
-
 class BmwIXBattery : public CanBattery {
  public:
   BmwIXBattery() : renderer(*this) {}
 
   virtual void setup(void);
-  virtual void handle_incoming_can_frame(CAN_frame rx_frame);
+  virtual void handle_incoming_can_frame(const CAN_frame& rx_frame);
   virtual void update_values();
   virtual void transmit_can(unsigned long currentMillis);
   BatteryHtmlRenderer& get_status_renderer() { return renderer; }
@@ -554,12 +543,6 @@ CAN_frame BMWiX_49C = {.FD = true,
       .ID = 0x6F4,
       .data = {0x07, 0x03, 0x22, 0xE5, 0x4C}};  // Request pack voltage limits
 
-  static constexpr CAN_frame BMWiX_6F4_CONTINUE_DATA = {.FD = true,
-                                                        .ext_ID = false,
-                                                        .DLC = 4,
-                                                        .ID = 0x6F4,
-                                                        .data = {0x07, 0x30, 0x00, 0x02}};
-
   //Action Requests:
   static constexpr CAN_frame BMWiX_6F4_CELL_SOC = {.FD = true,
                                                    .ext_ID = false,
@@ -646,17 +629,8 @@ CAN_frame BMWiX_49C = {.FD = true,
   uint8_t uds_req_id_counter_slow = 0;
   uint8_t detected_number_of_cells = 0;
 
-  // UDS Multi-Frame Reception Context
-  UDS_CONTEXT gUDSContext = {
-      {},     // UDS_buffer - zero-initialized array
-      0,      // UDS_bytesReceived
-      0,      // UDS_expectedLength
-      0,      // UDS_sequenceNumber
-      false,  // UDS_inProgress
-      0,      // UDS_moduleID
-      0,      // receivedInBatch
-      0       // UDS_lastFrameMillis
-  };
+  IsoTpLink isotp{can_interface, 0x6F4, 0x607, transmit_can_frame_to_interface};
+
 
   uint16_t counter_10ms = 0;  // max 65535 --> 655.35 seconds
   uint8_t counter_100ms = 0;  // max 255 --> 25.5 seconds
@@ -665,13 +639,8 @@ CAN_frame BMWiX_49C = {.FD = true,
   uint8_t increment_uds_req_id_counter(uint8_t index);
   uint8_t increment_alive_counter(uint8_t counter);
 
-  // UDS Multi-Frame Helpers
-  void startUDSMultiFrameReception(uint16_t totalLength, uint8_t moduleID);
-  bool storeUDSPayload(const uint8_t* payload, uint8_t length);
-  bool isUDSMessageComplete();
-  void parseDTCResponse();
-  void handleISOTPFrame(CAN_frame& rx_frame);
-  void processCompletedUDSResponse();
+  void parseDTCResponse(const uint8_t* data, uint16_t length);
+  void handle_uds_response(const uint8_t* data, uint16_t length);
   CAN_frame generate_433_datetime_message();
   CAN_frame generate_442_time_counter_message();
   /**
@@ -1,10 +1,10 @@
 #include "BMW-PHEV-BATTERY.h"
 #include <Arduino.h>
 #include <cstring>  //For unit test
+#include "../communication/can/CanCrc.h"
 #include "../communication/can/comm_can.h"
 #include "../datalayer/datalayer.h"
 #include "../datalayer/datalayer_extended.h"
-#include "../devboard/utils/common_functions.h"  //For CRC table
 #include "../devboard/utils/events.h"
 #include "../devboard/utils/logging.h"
 
@@ -108,13 +108,8 @@ bool BmwPhevBattery::isStale(int16_t currentValue, uint16_t& lastValue, unsigned
   return (currentTime - lastChangeTime >= STALE_PERIOD_CONFIG);
 }
 
-static uint8_t calculateCRC(CAN_frame rx_frame, uint8_t length, uint8_t initial_value) {
-  uint8_t crc = initial_value;
-  for (uint8_t j = 1; j < length; j++) {  //start at 1, since 0 is the CRC
-    crc = crc8_table_SAE_J1850_ZER0[(crc ^ static_cast<uint8_t>(rx_frame.data.u8[j])) % 256];
-  }
-  return crc;
-}
+// CRC in byte 0 over the rest of the frame, alive counter 0...14 in the low nibble of byte 1
+typedef AliveCounterCrc<Crc8J1850, 1, 0, 14> ProtectedFrame;
 
 static uint8_t increment_uds_req_id_counter(uint8_t index, int numReqs) {
   index++;
@@ -160,13 +155,6 @@ bool BmwPhevBattery::isUDSMessageComplete() {
   return (!gUDSContext.UDS_inProgress && gUDSContext.UDS_bytesReceived > 0);
 }
 
-uint8_t BmwPhevBattery::increment_alive_counter(uint8_t counter) {
-  counter++;
-  if (counter > ALIVE_MAX_VALUE) {
-    counter = 0;
-  }
-  return counter;
-}
 void BmwPhevBattery::parseDTCResponse() {
   // Check for negative response
   if (gUDSContext.UDS_buffer[0] == 0x7F) {
@@ -396,7 +384,7 @@ void BmwPhevBattery::update_values() {  //This function maps all the values fetc
     datalayer.battery.info.min_design_voltage_dV = min_design_voltage;
   }
 }
-void BmwPhevBattery::handle_incoming_can_frame(CAN_frame rx_frame) {
+void BmwPhevBattery::handle_incoming_can_frame(const CAN_frame& rx_frame) {
 
   //battery_awake = true; //look for specific messages
   switch (rx_frame.ID) {
@@ -782,10 +770,7 @@ void BmwPhevBattery::transmit_can(unsigned long currentMillis) {
         //BMW_10B.data.u8[1] = 0xD0;  // Close contactors v2
       }
 
-      BMW_10B.data.u8[1] = ((BMW_10B.data.u8[1] & 0xF0) + alive_counter_20ms);
-      BMW_10B.data.u8[0] = calculateCRC(BMW_10B, 3, 0x3F);
-
-      alive_counter_20ms = increment_alive_counter(alive_counter_20ms);
+      ProtectedFrame::advance(BMW_10B, alive_counter_20ms, 3, 0x3F);
 
       //if (datalayer.battery.status.bms_status == FAULT) {  //ALLOW ANY TIME - TEST ONLY
       //}  //If battery is not in Fault mode, allow contactor to close by sending 10B
@@ -801,7 +786,7 @@ void BmwPhevBattery::transmit_can(unsigned long currentMillis) {
 
       // Send 0x12F Terminal Status - counter cycles 0x20->0x2E (15 values)
       BMW_12F.data.u8[1] = 0x20 + alive_counter_100ms;
-      BMW_12F.data.u8[0] = calculateCRC(BMW_12F, BMW_12F.DLC, 0x3F);
+      BMW_12F.data.u8[0] = ProtectedFrame::crc(BMW_12F, BMW_12F.DLC, 0x3F);
 
       transmit_can_frame(&BMW_12F);
 
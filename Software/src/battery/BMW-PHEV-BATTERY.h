@@ -6,7 +6,7 @@
 class BmwPhevBattery : public CanBattery {
  public:
   virtual void setup(void);
-  virtual void handle_incoming_can_frame(CAN_frame rx_frame);
+  virtual void handle_incoming_can_frame(const CAN_frame& rx_frame);
   virtual void update_values();
   virtual void transmit_can(unsigned long currentMillis);
 
@@ -44,7 +44,6 @@ class BmwPhevBattery : public CanBattery {
   void parseDTCResponse();
   void processCellVoltages();
   void wake_battery_via_canbus();
-  uint8_t increment_alive_counter(uint8_t counter);
   const char* getUDSRequestName(CAN_frame* frame);
 
   unsigned long previousMillis20 = 0;     // will store last time a 20ms CAN Message was send
@@ -58,8 +57,6 @@ class BmwPhevBattery : public CanBattery {
   unsigned long min_cell_voltage_lastchanged = 0;
   unsigned long max_cell_voltage_lastchanged = 0;
 
-  static const int ALIVE_MAX_VALUE = 14;  // BMW CAN messages contain alive counter, goes from 0...14
-
   enum CmdState { SOH, CELL_VOLTAGE_MINMAX, SOC, CELL_VOLTAGE_CELLNO, CELL_VOLTAGE_CELLNO_LAST };
 
   CmdState cmdState = SOC;
@@ -1,38 +1,16 @@
 #include "BMW-SBOX.h"
 #include <Arduino.h>
+#include "../communication/can/CanCrc.h"
 #include "../communication/can/comm_can.h"
 #include "../datalayer/datalayer.h"
 #include "../devboard/utils/logging.h"
 
-uint8_t reverse_bits(uint8_t byte) {
-  uint8_t reversed = 0;
-  for (int i = 0; i < 8; i++) {
-    reversed = (reversed << 1) | (byte & 1);
-    byte >>= 1;
-  }
-  return reversed;
-}
-
 /** CRC8, both inverted, poly 0x31 **/
 uint8_t calculateCRC(CAN_frame CAN) {
-  uint8_t crc = 0;
-  for (size_t i = 0; i < CAN.DLC; i++) {
-    uint8_t reversed_byte = reverse_bits(CAN.data.u8[i]);
-    crc ^= reversed_byte;
-    for (int j = 0; j < 8; j++) {
-      if (crc & 0x80) {
-        crc = (crc << 1) ^ 0x31;
-      } else {
-        crc <<= 1;
-      }
-      crc &= 0xFF;
-    }
-  }
-  crc = reverse_bits(crc);
-  return crc;
+  return Crc8Maxim::compute(CAN.data.u8, CAN.DLC);
 }
 
-void BmwSbox::handle_incoming_can_frame(CAN_frame rx_frame) {
+void BmwSbox::handle_incoming_can_frame(const CAN_frame& rx_frame) {
   unsigned long currentTime = millis();
   if (rx_frame.ID == 0x200) {
     ShuntLastSeen = currentTime;
@@ -152,7 +152,7 @@ void BoltAmperaBattery::update_values() {  //This function maps all the values f
   }
 }
 
-void BoltAmperaBattery::handle_incoming_can_frame(CAN_frame rx_frame) {
+void BoltAmperaBattery::handle_incoming_can_frame(const CAN_frame& rx_frame) {
   uint8_t cellbank_mux = 0;
   uint8_t cellblock_index = 0;
   switch (rx_frame.ID) {
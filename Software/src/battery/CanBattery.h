@@ -5,20 +5,21 @@
 
 #include "../../src/communication/Transmitter.h"
 #include "../../src/communication/can/CanReceiver.h"
+#include "../../src/communication/can/CanTxScheduler.h"
 #include "../../src/communication/can/comm_can.h"
 #include "../../src/devboard/utils/types.h"
 
 // Abstract base class for batteries using the CAN bus
 class CanBattery : public Battery, Transmitter, CanReceiver {
  public:
-  virtual void handle_incoming_can_frame(CAN_frame rx_frame) = 0;
+  virtual void handle_incoming_can_frame(const CAN_frame& rx_frame) = 0;
   virtual void transmit_can(unsigned long currentMillis) = 0;
 
   const char* interface_name() { return getCANInterfaceName(can_interface); }
 
   void transmit(unsigned long currentMillis) { transmit_can(currentMillis); }
 
-  void receive_can_frame(CAN_frame* frame) { handle_incoming_can_frame(*frame); }
+  void receive_can_frame(const CAN_frame* frame) { handle_incoming_can_frame(*frame); }
 
  protected:
   CAN_Interface can_interface;
@@ -31,6 +32,11 @@ class CanBattery : public Battery, Transmitter, CanReceiver {
   void reset_can_speed();
 
   void transmit_can_frame(const CAN_frame* frame) { transmit_can_frame_to_interface(frame, can_interface); }
+
+  // Let the central CAN TX scheduler send frame every period_ms (see CanTxScheduler.h)
+  void schedule_can_frame(CAN_frame* frame, uint32_t period_ms, CanTxScheduler::RefreshCallback refresh = nullptr) {
+    can_tx_scheduler.add(frame, can_interface, period_ms, refresh);
+  }
 };
 
 #endif
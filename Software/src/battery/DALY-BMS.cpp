@@ -197,28 +197,19 @@ void DalyBms::transmit_rs485(unsigned long currentMillis) {
   }
 }
 
+// Answers are A5 01 <command 90..98> 08, eight data bytes and the checksum
+static bool check_daly_frame(const uint8_t* frame, uint16_t length) {
+  return !(((length > 0) && (frame[0] != 0xA5)) || ((length > 1) && (frame[1] != 0x01)) ||
+           ((length > 2) && ((frame[2] < 0x90) || (frame[2] > 0x98))) || ((length > 3) && (frame[3] != 8)) ||
+           ((length > 12) && (frame[12] != calculate_checksum((uint8_t*)frame))));
+}
+
+static FixedLengthRs485Framer<13> rx_framer(check_daly_frame);
+
 void DalyBms::receive() {
-  static uint8_t recv_buff[13] = {0};
-  static uint8_t recv_len = 0;
-
-  while (Serial2.available()) {
-    recv_buff[recv_len] = Serial2.read();
-
-    recv_len++;
-
-    if (((recv_len > 0) && (recv_buff[0] != 0xA5)) || ((recv_len > 1) && (recv_buff[1] != 0x01)) ||
-        ((recv_len > 2) && ((recv_buff[2] < 0x90) || (recv_buff[2] > 0x98))) ||
-        ((recv_len > 3) && (recv_buff[3] != 8)) ||
-        ((recv_len > 12) && (recv_buff[12] != calculate_checksum(recv_buff)))) {
-      dump_buff("dropping partial rx: ", recv_buff, recv_len);
-      recv_len = 0;
-    }
-
-    if (recv_len > 12) {
-      dump_buff("decoding successfull rx: ", recv_buff, recv_len);
-      decode_packet(recv_buff[2], &recv_buff[4]);
-      recv_len = 0;
-      lastPacket = millis();
-    }
+  while (read_rs485_frame(rx_framer)) {
+    dump_buff("decoding successfull rx: ", rx_framer.frame(), rx_framer.length());
+    decode_packet(rx_framer.frame()[2], &rx_framer.frame()[4]);
+    lastPacket = millis();
   }
 }
@@ -1,4 +1,5 @@
 #include "ECMP-BATTERY.h"
+#include <Arduino.h>
 #include "../communication/can/comm_can.h"
 #include "../datalayer/datalayer.h"
 #include "../datalayer/datalayer_extended.h"  //For More Battery Info page
@@ -230,7 +231,15 @@ void EcmpBattery::update_values() {
   }
 }
 
-void EcmpBattery::handle_incoming_can_frame(CAN_frame rx_frame) {
+std::vector<uint32_t> EcmpBattery::accepted_can_ids() {
+  return {
+      0x125, 0x127, 0x129, 0x254, 0x2B4, 0x2D4, 0x2F4, 0x314, 0x31B, 0x353, 0x358, 0x359, 0x361, 0x362, 0x373, 0x3B4,
+      0x3F4, 0x414, 0x454, 0x474, 0x494, 0x4D4, 0x4F4, 0x554, 0x574, 0x583, 0x594, 0x694, 0x6D0, 0x6D1, 0x6D2, 0x6D3,
+      0x6D4, 0x6E0, 0x6E1, 0x6E2, 0x6E3, 0x6E4, 0x6E5, 0x6E6, 0x6E7, 0x6E8, 0x6E9, 0x6EB, 0x6EC, 0x6ED, 0x6EE, 0x6EF,
+      0x6F0, 0x6F1, 0x6F2, 0x6F3, 0x6F4, 0x6F5, 0x6F6, 0x6F7, 0x6F8, 0x6F9, 0x6FA, 0x6FB, 0x6FC, 0x6FD, 0x6FE, 0x6FF};
+}
+
+void EcmpBattery::handle_incoming_can_frame(const CAN_frame& rx_frame) {
   switch (rx_frame.ID) {
     case 0x2D4:  //MysteryVan 50/75kWh platform (TBMU 100ms periodic)
       datalayer.battery.status.CAN_battery_still_alive = CAN_STILL_ALIVE;
@@ -682,487 +691,338 @@ void EcmpBattery::handle_incoming_can_frame(CAN_frame rx_frame) {
       break;
     case 0x694:  // Poll reply
       datalayer.battery.status.CAN_battery_still_alive = CAN_STILL_ALIVE;
+      isotp.handle_frame(rx_frame, millis());
+      break;
+    default:
+      break;
+  }
+}
 
-      // Handle user requested functionality first if ongoing
-      if (datalayer_extended.stellantisECMP.UserRequestDisableIsoMonitoring) {
-        if ((rx_frame.data.u8[0] == 0x06) && (rx_frame.data.u8[1] == 0x50) && (rx_frame.data.u8[2] == 0x03)) {
-          //06,50,03,00,C8,00,14,00,
-          DisableIsoMonitoringStatemachine = 2;  //Send ECMP_ACK_MESSAGE (02 3e 00)
-        }
-        if ((rx_frame.data.u8[0] == 0x02) && (rx_frame.data.u8[1] == 0x7E) && (rx_frame.data.u8[2] == 0x00)) {
-          //Expected 02,7E,00
-          DisableIsoMonitoringStatemachine = 4;  //Send ECMP_FACTORY_MODE_ACTIVATION next loop
-        }
-        if ((rx_frame.data.u8[0] == 0x03) && (rx_frame.data.u8[1] == 0x6E) && (rx_frame.data.u8[2] == 0xD9)) {
-          //Factory mode ENTRY: 2E.D9.00.01
-          DisableIsoMonitoringStatemachine = 6;  //Send ECMP_DISABLE_ISOLATION_REQ next loop
-        }
-        if ((rx_frame.data.u8[0] == 0x03) && (rx_frame.data.u8[1] == 0x7F) && (rx_frame.data.u8[2] == 0x2E)) {
-          //Factory mode fails to enter with 7F
-          set_event(EVENT_PID_FAILED, rx_frame.data.u8[2]);
-          DisableIsoMonitoringStatemachine =
-              6;  //Send ECMP_DISABLE_ISOLATION_REQ next loop (pointless, since it will fail)
-        }
-        if ((rx_frame.data.u8[0] == 0x04) && (rx_frame.data.u8[1] == 0x31) && (rx_frame.data.u8[2] == 0x02)) {
-          //Disable isolation successful 04 31 02 df e1
-          DisableIsoMonitoringStatemachine = COMPLETED_STATE;
-          datalayer_extended.stellantisECMP.UserRequestDisableIsoMonitoring = false;
-          timeSpentDisableIsoMonitoring = COMPLETED_STATE;
-        }
-        if ((rx_frame.data.u8[0] == 0x03) && (rx_frame.data.u8[1] == 0x7F) && (rx_frame.data.u8[2] == 0x31)) {
-          //Disable Isolation fails to enter with 7F
-          set_event(EVENT_PID_FAILED, rx_frame.data.u8[2]);
-          DisableIsoMonitoringStatemachine = COMPLETED_STATE;
-          datalayer_extended.stellantisECMP.UserRequestDisableIsoMonitoring = false;
-          timeSpentDisableIsoMonitoring = COMPLETED_STATE;
-        }
-
-      } else if (datalayer_extended.stellantisECMP.UserRequestContactorReset) {
-        if ((rx_frame.data.u8[0] == 0x06) && (rx_frame.data.u8[1] == 0x50) && (rx_frame.data.u8[2] == 0x03)) {
-          //06,50,03,00,C8,00,14,00,
-          ContactorResetStatemachine = 2;  //Send ECMP_CONTACTOR_RESET_START next loop
-        }
-        if ((rx_frame.data.u8[0] == 0x05) && (rx_frame.data.u8[1] == 0x71) && (rx_frame.data.u8[2] == 0x01)) {
-          //05,71,01,DD,35,01,00,00,
-          ContactorResetStatemachine = 4;  //Send ECMP_CONTACTOR_RESET_PROGRESS next loop
-        }
-        if ((rx_frame.data.u8[0] == 0x05) && (rx_frame.data.u8[1] == 0x71) && (rx_frame.data.u8[2] == 0x03)) {
-          //05,71,03,DD,35,02,00,00,
-          ContactorResetStatemachine = COMPLETED_STATE;
-          datalayer_extended.stellantisECMP.UserRequestContactorReset = false;
-          timeSpentContactorReset = COMPLETED_STATE;
-        }
-
-      } else if (datalayer_extended.stellantisECMP.UserRequestCollisionReset) {
-        if ((rx_frame.data.u8[0] == 0x06) && (rx_frame.data.u8[1] == 0x50) && (rx_frame.data.u8[2] == 0x03)) {
-          //06,50,03,00,C8,00,14,00,
-          CollisionResetStatemachine = 2;  //Send ECMP_COLLISION_RESET_START next loop
-        }
-        if ((rx_frame.data.u8[0] == 0x05) && (rx_frame.data.u8[1] == 0x71) && (rx_frame.data.u8[2] == 0x01)) {
-          //05,71,01,DF,60,01,00,00,
-          CollisionResetStatemachine = 4;  //Send ECMP_COLLISION_RESET_PROGRESS next loop
-        }
-        if ((rx_frame.data.u8[0] == 0x05) && (rx_frame.data.u8[1] == 0x71) && (rx_frame.data.u8[2] == 0x03)) {
-          if (rx_frame.data.u8[5] == 0x01) {
-            //05,71,03,DF,60,01,00,00,
-            CollisionResetStatemachine = 4;  //Send ECMP_COLLISION_RESET_PROGRESS next loop
-          }
-          if (rx_frame.data.u8[5] == 0x02) {
-            //05,71,03,DF,60,02,00,00,
-            CollisionResetStatemachine = COMPLETED_STATE;
-            datalayer_extended.stellantisECMP.UserRequestCollisionReset = false;
-            timeSpentCollisionReset = COMPLETED_STATE;
-          }
-        }
-
-      } else if (datalayer_extended.stellantisECMP.UserRequestIsolationReset) {
-        if ((rx_frame.data.u8[0] == 0x06) && (rx_frame.data.u8[1] == 0x50) && (rx_frame.data.u8[2] == 0x03)) {
-          //06,50,03,00,C8,00,14,00,
-          IsolationResetStatemachine = 2;  //Send ECMP_ISOLATION_RESET_START next loop
-        }
-        if ((rx_frame.data.u8[0] == 0x05) && (rx_frame.data.u8[1] == 0x71) && (rx_frame.data.u8[2] == 0x01)) {
-          //05,71,01,DF,46,01,00,00,
-          IsolationResetStatemachine = 4;  //Send ECMP_ISOLATION_RESET_PROGRESS next loop
-        }
-        if ((rx_frame.data.u8[0] == 0x05) && (rx_frame.data.u8[1] == 0x71) && (rx_frame.data.u8[2] == 0x03)) {
-          if (rx_frame.data.u8[5] == 0x01) {
-            //05,71,03,DF,46,01,00,00,
-            IsolationResetStatemachine = 4;  //Send ECMP_ISOLATION_RESET_PROGRESS next loop
-          }
-          if (rx_frame.data.u8[5] == 0x02) {
-            //05,71,03,DF,46,02,00,00,
-            IsolationResetStatemachine = COMPLETED_STATE;
-            datalayer_extended.stellantisECMP.UserRequestIsolationReset = false;
-            timeSpentIsolationReset = COMPLETED_STATE;
-          }
-        }
-
-      } else {  //Normal PID polling ongoing
+// Complete UDS response on 0x694, single frame or reassembled by the ISO-TP link
+void EcmpBattery::handle_uds_response(const uint8_t* data, uint16_t length) {
+  // Handle user requested functionality first if ongoing
+  if (datalayer_extended.stellantisECMP.UserRequestDisableIsoMonitoring) {
+    if ((length == 6) && (data[0] == 0x50) && (data[1] == 0x03)) {
+      //06,50,03,00,C8,00,14,00,
+      DisableIsoMonitoringStatemachine = 2;  //Send ECMP_ACK_MESSAGE (02 3e 00)
+    }
+    if ((length == 2) && (data[0] == 0x7E) && (data[1] == 0x00)) {
+      //Expected 02,7E,00
+      DisableIsoMonitoringStatemachine = 4;  //Send ECMP_FACTORY_MODE_ACTIVATION next loop
+    }
+    if ((length == 3) && (data[0] == 0x6E) && (data[1] == 0xD9)) {
+      //Factory mode ENTRY: 2E.D9.00.01
+      DisableIsoMonitoringStatemachine = 6;  //Send ECMP_DISABLE_ISOLATION_REQ next loop
+    }
+    if ((length == 3) && (data[0] == 0x7F) && (data[1] == 0x2E)) {
+      //Factory mode fails to enter with 7F
+      set_event(EVENT_PID_FAILED, data[1]);
+      DisableIsoMonitoringStatemachine = 6;  //Send ECMP_DISABLE_ISOLATION_REQ next loop (pointless, since it will fail)
+    }
+    if ((length == 4) && (data[0] == 0x31) && (data[1] == 0x02)) {
+      //Disable isolation successful 04 31 02 df e1
+      DisableIsoMonitoringStatemachine = COMPLETED_STATE;
+      datalayer_extended.stellantisECMP.UserRequestDisableIsoMonitoring = false;
+      timeSpentDisableIsoMonitoring = COMPLETED_STATE;
+    }
+    if ((length == 3) && (data[0] == 0x7F) && (data[1] == 0x31)) {
+      //Disable Isolation fails to enter with 7F
+      set_event(EVENT_PID_FAILED, data[1]);
+      DisableIsoMonitoringStatemachine = COMPLETED_STATE;
+      datalayer_extended.stellantisECMP.UserRequestDisableIsoMonitoring = false;
+      timeSpentDisableIsoMonitoring = COMPLETED_STATE;
+    }
 
-        if (rx_frame.data.u8[0] == 0x10) {  //Multiframe response, send ACK
-          transmit_can_frame(&ECMP_ACK);
-          //Multiframe has the poll reply slightly different location
-          incoming_poll = (rx_frame.data.u8[3] << 8) | rx_frame.data.u8[4];
-        }
+  } else if (datalayer_extended.stellantisECMP.UserRequestContactorReset) {
+    if ((length == 6) && (data[0] == 0x50) && (data[1] == 0x03)) {
+      //06,50,03,00,C8,00,14,00,
+      ContactorResetStatemachine = 2;  //Send ECMP_CONTACTOR_RESET_START next loop
+    }
+    if ((length == 5) && (data[0] == 0x71) && (data[1] == 0x01)) {
+      //05,71,01,DD,35,01,00,00,
+      ContactorResetStatemachine = 4;  //Send ECMP_CONTACTOR_RESET_PROGRESS next loop
+    }
+    if ((length == 5) && (data[0] == 0x71) && (data[1] == 0x03)) {
+      //05,71,03,DD,35,02,00,00,
+      ContactorResetStatemachine = COMPLETED_STATE;
+      datalayer_extended.stellantisECMP.UserRequestContactorReset = false;
+      timeSpentContactorReset = COMPLETED_STATE;
+    }
 
-        if (rx_frame.data.u8[0] == 0x11) {  //One line response, with special handling
-          incoming_poll = (rx_frame.data.u8[3] << 8) | rx_frame.data.u8[4];
+  } else if (datalayer_extended.stellantisECMP.UserRequestCollisionReset) {
+    if ((length == 6) && (data[0] == 0x50) && (data[1] == 0x03)) {
+      //06,50,03,00,C8,00,14,00,
+      CollisionResetStatemachine = 2;  //Send ECMP_COLLISION_RESET_START next loop
+    }
+    if ((length == 5) && (data[0] == 0x71) && (data[1] == 0x01)) {
+      //05,71,01,DF,60,01,00,00,
+      CollisionResetStatemachine = 4;  //Send ECMP_COLLISION_RESET_PROGRESS next loop
+    }
+    if ((length == 5) && (data[0] == 0x71) && (data[1] == 0x03)) {
+      if (data[4] == 0x01) {
+        //05,71,03,DF,60,01,00,00,
+        CollisionResetStatemachine = 4;  //Send ECMP_COLLISION_RESET_PROGRESS next loop
+      }
+      if (data[4] == 0x02) {
+        //05,71,03,DF,60,02,00,00,
+        CollisionResetStatemachine = COMPLETED_STATE;
+        datalayer_extended.stellantisECMP.UserRequestCollisionReset = false;
+        timeSpentCollisionReset = COMPLETED_STATE;
+      }
+    }
 
-          switch (incoming_poll) {  //One line responses, special
-            case PID_HISTORY_DATA:
-              pid_history_data = ((rx_frame.data.u8[5] << 16) | (rx_frame.data.u8[6] << 8) | rx_frame.data.u8[7]);
-              break;
-            default:
-              break;
-          }
-        }
+  } else if (datalayer_extended.stellantisECMP.UserRequestIsolationReset) {
+    if ((length == 6) && (data[0] == 0x50) && (data[1] == 0x03)) {
+      //06,50,03,00,C8,00,14,00,
+      IsolationResetStatemachine = 2;  //Send ECMP_ISOLATION_RESET_START next loop
+    }
+    if ((length == 5) && (data[0] == 0x71) && (data[1] == 0x01)) {
+      //05,71,01,DF,46,01,00,00,
+      IsolationResetStatemachine = 4;  //Send ECMP_ISOLATION_RESET_PROGRESS next loop
+    }
+    if ((length == 5) && (data[0] == 0x71) && (data[1] == 0x03)) {
+      if (data[4] == 0x01) {
+        //05,71,03,DF,46,01,00,00,
+        IsolationResetStatemachine = 4;  //Send ECMP_ISOLATION_RESET_PROGRESS next loop
+      }
+      if (data[4] == 0x02) {
+        //05,71,03,DF,46,02,00,00,
+        IsolationResetStatemachine = COMPLETED_STATE;
+        datalayer_extended.stellantisECMP.UserRequestIsolationReset = false;
+        timeSpentIsolationReset = COMPLETED_STATE;
+      }
+    }
 
-        if (rx_frame.data.u8[0] < 0x10) {  //One line responses
-          incoming_poll = (rx_frame.data.u8[2] << 8) | rx_frame.data.u8[3];
+  } else {  //Normal PID polling ongoing
+    handle_pid_response(data, length);
+  }
+}
 
-          switch (incoming_poll) {  //One line responses
-            case PID_WELD_CHECK:
-              pid_welding_detection = (rx_frame.data.u8[4]);
-              break;
-            case PID_CONT_REASON_OPEN:
-              pid_reason_open = (rx_frame.data.u8[4]);
-              break;
-            case PID_CONTACTOR_STATUS:
-              pid_contactor_status = (rx_frame.data.u8[4]);
-              break;
-            case PID_NEG_CONT_CONTROL:
-              pid_negative_contactor_control = (rx_frame.data.u8[4]);
-              break;
-            case PID_NEG_CONT_STATUS:
-              pid_negative_contactor_status = (rx_frame.data.u8[4]);
-              break;
-            case PID_POS_CONT_CONTROL:
-              pid_positive_contactor_control = (rx_frame.data.u8[4]);
-              break;
-            case PID_POS_CONT_STATUS:
-              pid_positive_contactor_status = (rx_frame.data.u8[4]);
-              break;
-            case PID_CONTACTOR_NEGATIVE:
-              pid_contactor_negative = (rx_frame.data.u8[4]);
-              break;
-            case PID_CONTACTOR_POSITIVE:
-              pid_contactor_positive = (rx_frame.data.u8[4]);
-              break;
-            case PID_PRECHARGE_RELAY_CONTROL:
-              pid_precharge_relay_control = (rx_frame.data.u8[4]);
-              break;
-            case PID_PRECHARGE_RELAY_STATUS:
-              pid_precharge_relay_status = (rx_frame.data.u8[4]);
-              break;
-            case PID_RECHARGE_STATUS:
-              pid_recharge_status = (rx_frame.data.u8[4]);
-              break;
-            case PID_DELTA_TEMPERATURE:
-              pid_delta_temperature = (rx_frame.data.u8[4]);
-              break;
-            case PID_COLDEST_MODULE:
-              pid_coldest_module = (rx_frame.data.u8[4]);
-              break;
-            case PID_LOWEST_TEMPERATURE:
-              pid_lowest_temperature = (rx_frame.data.u8[4] - 40);
-              break;
-            case PID_AVERAGE_TEMPERATURE:
-              pid_average_temperature = (rx_frame.data.u8[4] - 40);
-              break;
-            case PID_HIGHEST_TEMPERATURE:
-              pid_highest_temperature = (rx_frame.data.u8[4] - 40);
-              break;
-            case PID_HOTTEST_MODULE:
-              pid_hottest_module = (rx_frame.data.u8[4]);
-              break;
-            case PID_AVG_CELL_VOLTAGE:
-              pid_avg_cell_voltage = (rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5];
-              break;
-            case PID_CURRENT:
-              pid_current = -((((rx_frame.data.u8[4] << 24) | (rx_frame.data.u8[5] << 16) | (rx_frame.data.u8[6] << 8) |
-                                rx_frame.data.u8[7]) -
-                               76800) *
-                              155) /
-                            10;
-              break;
-            case PID_INSULATION_NEG:
-              pid_insulation_res_neg = ((rx_frame.data.u8[4] << 24) | (rx_frame.data.u8[5] << 16) |
-                                        (rx_frame.data.u8[6] << 8) | rx_frame.data.u8[7]);
-              break;
-            case PID_INSULATION_POS:
-              pid_insulation_res_pos = ((rx_frame.data.u8[4] << 24) | (rx_frame.data.u8[5] << 16) |
-                                        (rx_frame.data.u8[6] << 8) | rx_frame.data.u8[7]);
-              break;
-            case PID_MAX_CURRENT_10S:
-              pid_max_current_10s = ((rx_frame.data.u8[4] << 24) | (rx_frame.data.u8[5] << 16) |
-                                     (rx_frame.data.u8[6] << 8) | rx_frame.data.u8[7]);
-              break;
-            case PID_MAX_DISCHARGE_10S:
-              pid_max_discharge_10s = ((rx_frame.data.u8[4] << 24) | (rx_frame.data.u8[5] << 16) |
-                                       (rx_frame.data.u8[6] << 8) | rx_frame.data.u8[7]);
-              break;
-            case PID_MAX_DISCHARGE_30S:
-              pid_max_discharge_30s = ((rx_frame.data.u8[4] << 24) | (rx_frame.data.u8[5] << 16) |
-                                       (rx_frame.data.u8[6] << 8) | rx_frame.data.u8[7]);
-              break;
-            case PID_MAX_CHARGE_10S:
-              pid_max_charge_10s = ((rx_frame.data.u8[4] << 24) | (rx_frame.data.u8[5] << 16) |
-                                    (rx_frame.data.u8[6] << 8) | rx_frame.data.u8[7]);
-              break;
-            case PID_MAX_CHARGE_30S:
-              pid_max_charge_30s = ((rx_frame.data.u8[4] << 24) | (rx_frame.data.u8[5] << 16) |
-                                    (rx_frame.data.u8[6] << 8) | rx_frame.data.u8[7]);
-              break;
-            case PID_ENERGY_CAPACITY:
-              pid_energy_capacity = (rx_frame.data.u8[4] << 16) | (rx_frame.data.u8[5] << 8) | (rx_frame.data.u8[6]);
-              break;
-            case PID_HIGH_CELL_NUM:
-              pid_highest_cell_voltage_num = (rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5];
-              break;
-            case PID_LOW_CELL_NUM:
-              pid_lowest_cell_voltage_num = (rx_frame.data.u8[4]);
-              break;
-            case PID_SUM_OF_CELLS:
-              pid_sum_of_cells = ((rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5]) / 2;
-              break;
-            case PID_CELL_MIN_CAPACITY:
-              pid_cell_min_capacity = (rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5];
-              break;
-            case PID_CELL_VOLTAGE_MEAS_STATUS:
-              pid_cell_voltage_measurement_status = ((rx_frame.data.u8[4] << 24) | (rx_frame.data.u8[5] << 16) |
-                                                     (rx_frame.data.u8[6] << 8) | rx_frame.data.u8[7]);
-              break;
-            case PID_INSULATION_RES:
-              pid_insulation_res = ((rx_frame.data.u8[4] << 24) | (rx_frame.data.u8[5] << 16) |
-                                    (rx_frame.data.u8[6] << 8) | rx_frame.data.u8[7]);
-              break;
-            case PID_PACK_VOLTAGE:
-              pid_pack_voltage = ((rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5]) / 2;
-              break;
-            case PID_HIGH_CELL_VOLTAGE:
-              pid_high_cell_voltage = (rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5];
-              break;
-            case PID_ALL_CELL_VOLTAGES:
-              //Multi frame, handled in other function
-              break;
-            case PID_LOW_CELL_VOLTAGE:
-              pid_low_cell_voltage = (rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5];
-              break;
-            case PID_BATTERY_ENERGY:
-              pid_battery_energy = (rx_frame.data.u8[4]);
-              break;
-            case PID_CELLBALANCE_STATUS:
-              //Multi frame?, handled in other function
-              break;
-            case PID_CELLBALANCE_HWERR_MASK:
-              //Multi frame, handled in other function
-              break;
-            case PID_CRASH_COUNTER:
-              pid_crash_counter = ((rx_frame.data.u8[4] << 24) | (rx_frame.data.u8[5] << 16) |
-                                   (rx_frame.data.u8[6] << 8) | rx_frame.data.u8[7]);
-              break;
-            case PID_WIRE_CRASH:
-              pid_wire_crash = (rx_frame.data.u8[4]);
-              break;
-            case PID_CAN_CRASH:
-              pid_CAN_crash = (rx_frame.data.u8[4]);
-              break;
-            case PID_HISTORY_DATA:
-              //handled in 0x11 handler
-              break;
-            case PID_LOWSOC_COUNTER:
-              pid_lowsoc_counter = (rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5];
-              break;
-            case PID_LAST_CAN_FAILURE_DETAIL:
-              pid_last_can_failure_detail = ((rx_frame.data.u8[4] << 24) | (rx_frame.data.u8[5] << 16) |
-                                             (rx_frame.data.u8[6] << 8) | rx_frame.data.u8[7]);
-              break;
-            case PID_HW_VERSION_NUM:
-              //pid_hw_version_num = rx_frame.data.u8[4]; Not available on all batteries
-              break;
-            case PID_SW_VERSION_NUM:
-              //pid_sw_version_num = rx_frame.data.u8[4]; Not available on all batteries
-              break;
-            case PID_FACTORY_MODE_CONTROL:
-              pid_factory_mode_control = rx_frame.data.u8[4];
-              break;
-            case PID_BATTERY_SERIAL:
-              // Multiframe, handled separately down below
-              break;
-            case PID_AUX_FUSE_STATE:
-              pid_aux_fuse_state = rx_frame.data.u8[4];
-              break;
-            case PID_BATTERY_STATE:
-              pid_battery_state = rx_frame.data.u8[4];
-              break;
-            case PID_PRECHARGE_SHORT_CIRCUIT:
-              pid_precharge_short_circuit = rx_frame.data.u8[4];
-              break;
-            case PID_ESERVICE_PLUG_STATE:
-              pid_eservice_plug_state = rx_frame.data.u8[4];
-              break;
-            case PID_MAINFUSE_STATE:
-              pid_mainfuse_state = rx_frame.data.u8[4];
-              break;
-            case PID_MOST_CRITICAL_FAULT:
-              pid_most_critical_fault = ((rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5]);
-              break;
-            case PID_CURRENT_TIME:
-              //Multiframe, handled separately down below
-              break;
-            case PID_TIME_SENT_BY_CAR:
-              pid_time_sent_by_car = ((rx_frame.data.u8[4] << 24) | (rx_frame.data.u8[5] << 16) |
-                                      (rx_frame.data.u8[6] << 8) | rx_frame.data.u8[7]);
-              break;
-            case PID_12V:
-              pid_12v = (rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5];
-              break;
-            case PID_12V_ABNORMAL:
-              pid_12v_abnormal = rx_frame.data.u8[4];
-              break;
-            case PID_HVIL_IN_VOLTAGE:
-              pid_hvil_in_voltage = (rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5];
-              break;
-            case PID_HVIL_OUT_VOLTAGE:
-              pid_hvil_out_voltage = (rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5];
-              break;
-            case PID_HVIL_STATE:
-              pid_hvil_state = rx_frame.data.u8[4];
-              break;
-            case PID_BMS_STATE:
-              pid_bms_state = rx_frame.data.u8[4];
-              break;
-            case PID_VEHICLE_SPEED:
-              pid_vehicle_speed = ((rx_frame.data.u8[4] << 24) | (rx_frame.data.u8[5] << 16) |
-                                   (rx_frame.data.u8[6] << 8) | rx_frame.data.u8[7]);
-              break;
-            case PID_TIME_SPENT_OVER_55C:
-              pid_time_spent_over_55c = ((rx_frame.data.u8[4] << 24) | (rx_frame.data.u8[5] << 16) |
-                                         (rx_frame.data.u8[6] << 8) | rx_frame.data.u8[7]);
-              break;
-            case PID_CONTACTOR_CLOSING_COUNTER:
-              pid_contactor_closing_counter = ((rx_frame.data.u8[4] << 24) | (rx_frame.data.u8[5] << 16) |
-                                               (rx_frame.data.u8[6] << 8) | rx_frame.data.u8[7]);
-              break;
-            case PID_DATE_OF_MANUFACTURE:
-              pid_date_of_manufacture =
-                  ((rx_frame.data.u8[4] << 16) | (rx_frame.data.u8[5] << 8) | (rx_frame.data.u8[6]));
-              break;
-            default:
-              break;
-          }
-        }
+// ReadDataByIdentifier response: 0x62, PID high, PID low, value...
+void EcmpBattery::handle_pid_response(const uint8_t* data, uint16_t length) {
+  if (length < 4 || data[0] != 0x62) {
+    return;
+  }
+  incoming_poll = (data[1] << 8) | data[2];
 
-        switch (incoming_poll)  //Multiframe responses
-        {
-          case PID_ALL_CELL_SOH:
-            switch (rx_frame.data.u8[0]) {
-              case 0x10:
-                pid_SOH_cell_1 = ((rx_frame.data.u8[5] << 8) | rx_frame.data.u8[6]);
-                break;
-              case 0x21:
-                break;
-              case 0x22:
-                break;
-              case 0x23:
-                break;
-              case 0x24:
-                break;
-              case 0x25:
-                break;
-              case 0x26:
-                break;
-              case 0x27:
-                break;
-              case 0x28:
-                break;
-              case 0x29:
-                break;
-              default:
-                break;
-            }
-            break;
-          case PID_ALL_CELL_VOLTAGES:
-            switch (rx_frame.data.u8[0]) {
-              case 0x10:
-                break;
-              case 0x21:
-                break;
-              case 0x22:
-                break;
-              case 0x23:
-                break;
-              case 0x24:
-                break;
-              case 0x25:
-                break;
-              case 0x26:
-                break;
-              case 0x27:
-                break;
-              case 0x28:
-                break;
-              case 0x29:
-                break;
-              default:
-                break;
-            }
-            break;
-          case PID_CELLBALANCE_STATUS:
-            switch (rx_frame.data.u8[0]) {
-              case 0x10:
-                break;
-              case 0x21:
-                break;
-              case 0x22:
-                break;
-              case 0x23:
-                break;
-              default:
-                break;
-            }
-            break;
-          case PID_CELLBALANCE_HWERR_MASK:
-            switch (rx_frame.data.u8[0]) {
-              case 0x10:
-                break;
-              case 0x21:
-                break;
-              case 0x22:
-                break;
-              case 0x23:
-                break;
-              default:
-                break;
-            }
-            break;
-          case PID_CURRENT_TIME:
-            switch (rx_frame.data.u8[0]) {
-              case 0x10:
-                pid_current_time = (pid_current_time | rx_frame.data.u8[7]);
-                break;  //Something is wrong here. TODO
-              case 0x21:
-                pid_current_time = (rx_frame.data.u8[3] << 24) | (rx_frame.data.u8[2] << 16) |
-                                   (rx_frame.data.u8[1] << 8) | pid_current_time;
-                break;
-              default:
-                break;
-            }
-            break;
-          case PID_BATTERY_SERIAL:
-            switch (rx_frame.data.u8[0]) {
-              case 0x10:  //10,11,62,D9,01,33,34,41,
-                pid_battery_serial[0] = rx_frame.data.u8[5];
-                pid_battery_serial[1] = rx_frame.data.u8[6];
-                pid_battery_serial[2] = rx_frame.data.u8[7];
-                break;
-              case 0x21:  //21,41,41,46,30,30,30,32,
-                pid_battery_serial[3] = rx_frame.data.u8[1];
-                pid_battery_serial[4] = rx_frame.data.u8[2];
-                pid_battery_serial[5] = rx_frame.data.u8[3];
-                pid_battery_serial[6] = rx_frame.data.u8[4];
-                pid_battery_serial[7] = rx_frame.data.u8[5];
-                pid_battery_serial[8] = rx_frame.data.u8[6];
-                pid_battery_serial[9] = rx_frame.data.u8[7];
-                break;
-              case 0x22:  //22,32,33,31,00,00,00,00,
-                pid_battery_serial[10] = rx_frame.data.u8[1];
-                pid_battery_serial[11] = rx_frame.data.u8[2];
-                pid_battery_serial[12] = rx_frame.data.u8[3];
-                pid_battery_serial[13] = rx_frame.data.u8[4];
-                break;
-              default:
-                break;
-            }
-            break;
-          default:
-            //Not a multiframe response, do nothing
-            break;
-        }
-        break;
-        default:
-          break;
+  switch (incoming_poll) {
+    case PID_WELD_CHECK:
+      pid_welding_detection = (data[3]);
+      break;
+    case PID_CONT_REASON_OPEN:
+      pid_reason_open = (data[3]);
+      break;
+    case PID_CONTACTOR_STATUS:
+      pid_contactor_status = (data[3]);
+      break;
+    case PID_NEG_CONT_CONTROL:
+      pid_negative_contactor_control = (data[3]);
+      break;
+    case PID_NEG_CONT_STATUS:
+      pid_negative_contactor_status = (data[3]);
+      break;
+    case PID_POS_CONT_CONTROL:
+      pid_positive_contactor_control = (data[3]);
+      break;
+    case PID_POS_CONT_STATUS:
+      pid_positive_contactor_status = (data[3]);
+      break;
+    case PID_CONTACTOR_NEGATIVE:
+      pid_contactor_negative = (data[3]);
+      break;
+    case PID_CONTACTOR_POSITIVE:
+      pid_contactor_positive = (data[3]);
+      break;
+    case PID_PRECHARGE_RELAY_CONTROL:
+      pid_precharge_relay_control = (data[3]);
+      break;
+    case PID_PRECHARGE_RELAY_STATUS:
+      pid_precharge_relay_status = (data[3]);
+      break;
+    case PID_RECHARGE_STATUS:
+      pid_recharge_status = (data[3]);
+      break;
+    case PID_DELTA_TEMPERATURE:
+      pid_delta_temperature = (data[3]);
+      break;
+    case PID_COLDEST_MODULE:
+      pid_coldest_module = (data[3]);
+      break;
+    case PID_LOWEST_TEMPERATURE:
+      pid_lowest_temperature = (data[3] - 40);
+      break;
+    case PID_AVERAGE_TEMPERATURE:
+      pid_average_temperature = (data[3] - 40);
+      break;
+    case PID_HIGHEST_TEMPERATURE:
+      pid_highest_temperature = (data[3] - 40);
+      break;
+    case PID_HOTTEST_MODULE:
+      pid_hottest_module = (data[3]);
+      break;
+    case PID_AVG_CELL_VOLTAGE:
+      pid_avg_cell_voltage = (data[3] << 8) | data[4];
+      break;
+    case PID_CURRENT:
+      pid_current = -((((data[3] << 24) | (data[4] << 16) | (data[5] << 8) | data[6]) - 76800) * 155) / 10;
+      break;
+    case PID_INSULATION_NEG:
+      pid_insulation_res_neg = ((data[3] << 24) | (data[4] << 16) | (data[5] << 8) | data[6]);
+      break;
+    case PID_INSULATION_POS:
+      pid_insulation_res_pos = ((data[3] << 24) | (data[4] << 16) | (data[5] << 8) | data[6]);
+      break;
+    case PID_MAX_CURRENT_10S:
+      pid_max_current_10s = ((data[3] << 24) | (data[4] << 16) | (data[5] << 8) | data[6]);
+      break;
+    case PID_MAX_DISCHARGE_10S:
+      pid_max_discharge_10s = ((data[3] << 24) | (data[4] << 16) | (data[5] << 8) | data[6]);
+      break;
+    case PID_MAX_DISCHARGE_30S:
+      pid_max_discharge_30s = ((data[3] << 24) | (data[4] << 16) | (data[5] << 8) | data[6]);
+      break;
+    case PID_MAX_CHARGE_10S:
+      pid_max_charge_10s = ((data[3] << 24) | (data[4] << 16) | (data[5] << 8) | data[6]);
+      break;
+    case PID_MAX_CHARGE_30S:
+      pid_max_charge_30s = ((data[3] << 24) | (data[4] << 16) | (data[5] << 8) | data[6]);
+      break;
+    case PID_ENERGY_CAPACITY:
+      pid_energy_capacity = (data[3] << 16) | (data[4] << 8) | (data[5]);
+      break;
+    case PID_HIGH_CELL_NUM:
+      pid_highest_cell_voltage_num = (data[3] << 8) | data[4];
+      break;
+    case PID_LOW_CELL_NUM:
+      pid_lowest_cell_voltage_num = (data[3]);
+      break;
+    case PID_SUM_OF_CELLS:
+      pid_sum_of_cells = ((data[3] << 8) | data[4]) / 2;
+      break;
+    case PID_CELL_MIN_CAPACITY:
+      pid_cell_min_capacity = (data[3] << 8) | data[4];
+      break;
+    case PID_CELL_VOLTAGE_MEAS_STATUS:
+      pid_cell_voltage_measurement_status = ((data[3] << 24) | (data[4] << 16) | (data[5] << 8) | data[6]);
+      break;
+    case PID_INSULATION_RES:
+      pid_insulation_res = ((data[3] << 24) | (data[4] << 16) | (data[5] << 8) | data[6]);
+      break;
+    case PID_PACK_VOLTAGE:
+      pid_pack_voltage = ((data[3] << 8) | data[4]) / 2;
+      break;
+    case PID_HIGH_CELL_VOLTAGE:
+      pid_high_cell_voltage = (data[3] << 8) | data[4];
+      break;
+    case PID_ALL_CELL_VOLTAGES:
+      //Multi frame, not decoded yet
+      break;
+    case PID_LOW_CELL_VOLTAGE:
+      pid_low_cell_voltage = (data[3] << 8) | data[4];
+      break;
+    case PID_BATTERY_ENERGY:
+      pid_battery_energy = (data[3]);
+      break;
+    case PID_CELLBALANCE_STATUS:
+      //Multi frame, not decoded yet
+      break;
+    case PID_CELLBALANCE_HWERR_MASK:
+      //Multi frame, not decoded yet
+      break;
+    case PID_CRASH_COUNTER:
+      pid_crash_counter = ((data[3] << 24) | (data[4] << 16) | (data[5] << 8) | data[6]);
+      break;
+    case PID_WIRE_CRASH:
+      pid_wire_crash = (data[3]);
+      break;
+    case PID_CAN_CRASH:
+      pid_CAN_crash = (data[3]);
+      break;
+    case PID_HISTORY_DATA:
+      pid_history_data = ((data[3] << 16) | (data[4] << 8) | data[5]);
+      break;
+    case PID_LOWSOC_COUNTER:
+      pid_lowsoc_counter = (data[3] << 8) | data[4];
+      break;
+    case PID_LAST_CAN_FAILURE_DETAIL:
+      pid_last_can_failure_detail = ((data[3] << 24) | (data[4] << 16) | (data[5] << 8) | data[6]);
+      break;
+    case PID_HW_VERSION_NUM:
+      //pid_hw_version_num = data[3]; Not available on all batteries
+      break;
+    case PID_SW_VERSION_NUM:
+      //pid_sw_version_num = data[3]; Not available on all batteries
+      break;
+    case PID_FACTORY_MODE_CONTROL:
+      pid_factory_mode_control = data[3];
+      break;
+    case PID_BATTERY_SERIAL:
+      //62,D9,01,33,34,41,41,41,46,30,30,30,32,32,33,31,00
+      if (length >= 3 + sizeof(pid_battery_serial)) {
+        memcpy(pid_battery_serial, &data[3], sizeof(pid_battery_serial));
+      }
+      break;
+    case PID_AUX_FUSE_STATE:
+      pid_aux_fuse_state = data[3];
+      break;
+    case PID_BATTERY_STATE:
+      pid_battery_state = data[3];
+      break;
+    case PID_PRECHARGE_SHORT_CIRCUIT:
+      pid_precharge_short_circuit = data[3];
+      break;
+    case PID_ESERVICE_PLUG_STATE:
+      pid_eservice_plug_state = data[3];
+      break;
+    case PID_MAINFUSE_STATE:
+      pid_mainfuse_state = data[3];
+      break;
+    case PID_MOST_CRITICAL_FAULT:
+      pid_most_critical_fault = ((data[3] << 8) | data[4]);
+      break;
+    case PID_CURRENT_TIME:
+      if (length >= 9) {
+        pid_current_time = (data[8] << 24) | (data[7] << 16) | (data[6] << 8) | data[5];
       }
+      break;
+    case PID_TIME_SENT_BY_CAR:
+      pid_time_sent_by_car = ((data[3] << 24) | (data[4] << 16) | (data[5] << 8) | data[6]);
+      break;
+    case PID_12V:
+      pid_12v = (data[3] << 8) | data[4];
+      break;
+    case PID_12V_ABNORMAL:
+      pid_12v_abnormal = data[3];
+      break;
+    case PID_HVIL_IN_VOLTAGE:
+      pid_hvil_in_voltage = (data[3] << 8) | data[4];
+      break;
+    case PID_HVIL_OUT_VOLTAGE:
+      pid_hvil_out_voltage = (data[3] << 8) | data[4];
+      break;
+    case PID_HVIL_STATE:
+      pid_hvil_state = data[3];
+      break;
+    case PID_BMS_STATE:
+      pid_bms_state = data[3];
+      break;
+    case PID_VEHICLE_SPEED:
+      pid_vehicle_speed = ((data[3] << 24) | (data[4] << 16) | (data[5] << 8) | data[6]);
+      break;
+    case PID_TIME_SPENT_OVER_55C:
+      pid_time_spent_over_55c = ((data[3] << 24) | (data[4] << 16) | (data[5] << 8) | data[6]);
+      break;
+    case PID_CONTACTOR_CLOSING_COUNTER:
+      pid_contactor_closing_counter = ((data[3] << 24) | (data[4] << 16) | (data[5] << 8) | data[6]);
+      break;
+    case PID_DATE_OF_MANUFACTURE:
+      pid_date_of_manufacture = ((data[3] << 16) | (data[4] << 8) | (data[5]));
+      break;
+    case PID_ALL_CELL_SOH:
+      pid_SOH_cell_1 = ((data[3] << 8) | data[4]);
+      break;
+    default:
+      break;
   }
 }
 
@@ -1184,6 +1044,7 @@ uint8_t checksum_calc(uint8_t counter, CAN_frame rx_frame) {
 }
 
 void EcmpBattery::transmit_can(unsigned long currentMillis) {
+  isotp.poll(currentMillis);
 
   // Send 250ms diagnostic CAN Messages
   if (currentMillis - previousMillis250 >= INTERVAL_250_MS) {
@@ -1901,4 +1762,6 @@ void EcmpBattery::setup(void) {  // Performs one time setup at startup
   datalayer.battery.info.max_design_voltage_dV = MAX_PACK_VOLTAGE_DV;
   datalayer.battery.info.min_design_voltage_dV = MIN_PACK_VOLTAGE_DV;
   datalayer.system.status.battery_allows_contactor_closing = true;
+
+  isotp.on_receive([this](const uint8_t* data, uint16_t length) { handle_uds_response(data, length); });
 }
@@ -1,5 +1,6 @@
 #ifndef STELLANTIS_ECMP_BATTERY_H
 #define STELLANTIS_ECMP_BATTERY_H
+#include "../communication/can/IsoTp.h"
 #include "CanBattery.h"
 #include "ECMP-HTML.h"
 
@@ -9,7 +10,8 @@
 class EcmpBattery : public CanBattery {
  public:
   virtual void setup(void);
-  virtual void handle_incoming_can_frame(CAN_frame rx_frame);
+  virtual void handle_incoming_can_frame(const CAN_frame& rx_frame);
+  virtual std::vector<uint32_t> accepted_can_ids();
   virtual void update_values();
   virtual void transmit_can(unsigned long currentMillis);
   static constexpr const char* Name = "Stellantis ECMP battery";
@@ -33,6 +35,10 @@ class EcmpBattery : public CanBattery {
 
  private:
   EcmpHtmlRenderer renderer;
+
+  void handle_uds_response(const uint8_t* data, uint16_t length);
+  void handle_pid_response(const uint8_t* data, uint16_t length);
+
   static const int MAX_PACK_VOLTAGE_DV = 4546;
   static const int MIN_PACK_VOLTAGE_DV = 3580;
   static const int MAX_CELL_DEVIATION_MV = 100;
@@ -139,12 +145,8 @@ class EcmpBattery : public CanBattery {
                         .ID = 0x552,  // distance in km in byte 4-6, temporal reset counter in byte 7
                         .data = {0x00, 0x02, 0x95, 0x6D, 0x00, 0xD7, 0xB5, 0xFE}};
 
+  IsoTpLink isotp{can_interface, 0x6B4, 0x694, transmit_can_frame_to_interface};
   CAN_frame ECMP_POLL = {.FD = false, .ext_ID = false, .DLC = 4, .ID = 0x6B4, .data = {0x03, 0x22, 0xD8, 0x66}};
-  static constexpr CAN_frame ECMP_ACK = {.FD = false,  //Ack frame
-                                         .ext_ID = false,
-                                         .DLC = 3,
-                                         .ID = 0x6B4,
-                                         .data = {0x30, 0x00, 0x00}};
   static constexpr CAN_frame ECMP_DIAG_START = {.FD = false,
                                                 .ext_ID = false,
                                                 .DLC = 3,
@@ -47,7 +47,7 @@ void EnnoidBms::update_values() {
   datalayer.battery.status.cell_min_voltage_mV = cellVoltageLow;
 }
 
-void EnnoidBms::handle_incoming_can_frame(CAN_frame rx_frame) {
+void EnnoidBms::handle_incoming_can_frame(const CAN_frame& rx_frame) {
 
   switch (rx_frame.ID) {
     case 0x2b0a:
@@ -70,7 +70,7 @@ void FoxessBattery::
   }
 }
 
-void FoxessBattery::handle_incoming_can_frame(CAN_frame rx_frame) {
+void FoxessBattery::handle_incoming_can_frame(const CAN_frame& rx_frame) {
   switch (rx_frame.ID) {
     case 0x1872:  //BMS_Limits
       datalayer.battery.info.max_design_voltage_dV = (uint16_t)(rx_frame.data.u8[1] << 8 | rx_frame.data.u8[0]);
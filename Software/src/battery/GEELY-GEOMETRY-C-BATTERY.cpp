@@ -1,9 +1,9 @@
 #include "GEELY-GEOMETRY-C-BATTERY.h"
 #include <cstring>  //For unit test
+#include "../communication/can/CanCrc.h"
 #include "../communication/can/comm_can.h"
 #include "../datalayer/datalayer.h"
 #include "../datalayer/datalayer_extended.h"
-#include "../devboard/utils/common_functions.h"  //For CRC table
 #include "../devboard/utils/events.h"
 
 /* TODO
@@ -126,16 +126,11 @@ void GeelyGeometryCBattery::update_values() {
   datalayer_geometryc->unknown8 = poll_unknown8;
 }
 
-bool is_message_corrupt(CAN_frame* rx_frame) {
-  uint8_t crc = 0xFF;  // Initial value
-  for (uint8_t j = 0; j < 7; j++) {
-    crc = crctable_geely_geometryC[crc ^ rx_frame->data.u8[j]];
-  }
-  crc = (crc ^ 0xFF);  // Final XOR
-  return crc != rx_frame->data.u8[7];
+bool is_message_corrupt(const CAN_frame* rx_frame) {
+  return !FrameCrc<Crc8Autosar, 7>::valid(*rx_frame);
 }
 
-void GeelyGeometryCBattery::handle_incoming_can_frame(CAN_frame rx_frame) {
+void GeelyGeometryCBattery::handle_incoming_can_frame(const CAN_frame& rx_frame) {
   switch (rx_frame.ID) {
     case 0x0B0:  //10ms
       datalayer_battery->status.CAN_battery_still_alive = CAN_STILL_ALIVE;
@@ -440,13 +435,7 @@ void GeelyGeometryCBattery::handle_incoming_can_frame(CAN_frame rx_frame) {
 }
 
 uint8_t calc_crc8_geely(CAN_frame* rx_frame) {
-  uint8_t crc = 0xFF;  // Initial value
-
-  for (uint8_t j = 0; j < 7; j++) {
-    crc = crctable_geely_geometryC[crc ^ rx_frame->data.u8[j]];
-  }
-
-  return crc ^ 0xFF;  // Final XOR
+  return FrameCrc<Crc8Autosar, 7>::crc(*rx_frame);
 }
 
 void GeelyGeometryCBattery::transmit_can(unsigned long currentMillis) {
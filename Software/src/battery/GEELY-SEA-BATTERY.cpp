@@ -89,7 +89,7 @@ void GeelySeaBattery::
   }
 }
 
-void GeelySeaBattery::handle_incoming_can_frame(CAN_frame rx_frame) {
+void GeelySeaBattery::handle_incoming_can_frame(const CAN_frame& rx_frame) {
   switch (rx_frame.ID) {
     case 0x53:  //100ms
       datalayer.battery.status.CAN_battery_still_alive = CAN_STILL_ALIVE;
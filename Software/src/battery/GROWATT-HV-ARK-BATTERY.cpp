@@ -40,7 +40,7 @@ void GrowattHvArkBattery::setup(void) {
   datalayer.system.status.battery_allows_contactor_closing = false;
 }
 
-void GrowattHvArkBattery::handle_incoming_can_frame(CAN_frame rx_frame) {
+void GrowattHvArkBattery::handle_incoming_can_frame(const CAN_frame& rx_frame) {
   switch (rx_frame.ID) {
     case 0x3110: {
       datalayer.battery.status.CAN_battery_still_alive = CAN_STILL_ALIVE;
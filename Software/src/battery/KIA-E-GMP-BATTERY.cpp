@@ -2,7 +2,6 @@
 #include <Arduino.h>
 #include "../communication/can/comm_can.h"
 #include "../datalayer/datalayer.h"
-#include "../devboard/utils/common_functions.h"  //For CRC table
 #include "../devboard/utils/events.h"
 #include "../devboard/utils/logging.h"
 #include "../system_settings.h"
@@ -71,10 +70,10 @@ uint16_t KiaEGmpBattery::selectSOC(uint16_t SOC_low, uint16_t SOC_high) {
   return (SOC_low < SOC_high) ? SOC_low : SOC_high;  // Otherwise, return the lowest value
 }
 
-void KiaEGmpBattery::set_cell_voltages(CAN_frame rx_frame, int start, int length, int startCell) {
-  for (size_t i = 0; i < length; i++) {
-    if ((rx_frame.data.u8[start + i] * 20) > 2600) {
-      datalayer.battery.status.cell_voltages_mV[startCell + i] = (rx_frame.data.u8[start + i] * 20);
+void KiaEGmpBattery::set_cell_voltages(const uint8_t* data, int length, int startCell) {
+  for (int i = 0; i < length; i++) {
+    if ((data[i] * 20) > 2600) {
+      datalayer.battery.status.cell_voltages_mV[startCell + i] = (data[i] * 20);
     }
   }
 }
@@ -105,14 +104,6 @@ void KiaEGmpBattery::set_voltage_minmax_limits() {
   }
 }
 
-uint8_t KiaEGmpBattery::calculateCRC(CAN_frame rx_frame, uint8_t length, uint8_t initial_value) {
-  uint8_t crc = initial_value;
-  for (uint8_t j = 1; j < length; j++) {  //start at 1, since 0 is the CRC
-    crc = crc8_table_SAE_J1850_ZER0[(crc ^ static_cast<uint8_t>(rx_frame.data.u8[j])) % 256];
-  }
-  return crc;
-}
-
 void KiaEGmpBattery::update_values() {
 
   if (user_selected_use_estimated_SOC) {
@@ -197,7 +188,75 @@ int KiaEGmpBattery::get_batRelay() const {
   return batteryRelay;
 }
 
-void KiaEGmpBattery::handle_incoming_can_frame(CAN_frame rx_frame) {
+// ReadDataByIdentifier response: 0x62, 0x01, PID, values...
+void KiaEGmpBattery::handle_pid_response(const uint8_t* data, uint16_t length) {
+  if (length < 3 || data[0] != 0x62) {
+    return;
+  }
+
+  switch (data[2]) {
+    case 0x01:
+      if (length >= 56) {
+        SOC_BMS = data[7] * 5;  //100% = 200 ( 200 * 5 = 1000 )
+        allowedChargePower = ((data[8] << 8) + data[9]);
+        allowedDischargePower = ((data[10] << 8) + data[11]);
+        batteryAmps = (data[13] << 8) + data[14];
+        batteryVoltage = (data[15] << 8) + data[16];
+        temperatureMax = data[17];
+        temperatureMin = data[18];
+        temperature_water_inlet = data[23];
+        CellVoltMax_mV = (data[24] * 20);  //(volts *50) *20 =mV
+        CellVmaxNo = data[27];
+        CellVoltMin_mV = (data[28] * 20);  //(volts *50) *20 =mV
+        CellVminNo = data[29];
+        // fanMod = data[30];
+        // fanSpeed = data[31];
+        leadAcidBatteryVoltage = data[32];  //12v Battery Volts
+        // cumulative charge/discharge current in data[33..40], energy charged/discharged in data[41..48],
+        // operating time in data[49..52]
+        BMS_ign = data[53];
+        inverterVoltage = (data[54] << 8) + data[55];  // BMS Capacitoir
+      }
+      break;
+    // 32 cell voltages per PID
+    case 0x02:
+    case 0x03:
+    case 0x04:
+      if (length >= 39) {
+        set_cell_voltages(&data[7], 32, (data[2] - 0x02) * 32);
+      }
+      break;
+    case 0x0A:
+    case 0x0B:
+    case 0x0C:
+      if (length >= 39) {
+        set_cell_voltages(&data[7], 32, 96 + (data[2] - 0x0A) * 32);
+      }
+      break;
+    case 0x05:
+      if (length >= 35) {
+        // ac = data[22];
+        // Vdiff = data[23];
+        // airbag = data[25];
+        heatertemp = data[26];
+        batterySOH = ((data[28] << 8) + data[29]);
+        // maxDetCell = data[30];
+        // minDet = (data[31] << 8) + data[32];
+        // minDetCell = data[33];
+        SOC_Display = data[34] * 5;
+      }
+      break;
+    case 0x06:
+      if (length >= 18) {
+        batteryManagementMode = data[17];
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+void KiaEGmpBattery::handle_incoming_can_frame(const CAN_frame& rx_frame) {
   startedUp = true;
   switch (rx_frame.ID) {
     case 0x055:
@@ -251,174 +310,8 @@ void KiaEGmpBattery::handle_incoming_can_frame(CAN_frame rx_frame) {
     case 0x3F5:
       datalayer.battery.status.CAN_battery_still_alive = CAN_STILL_ALIVE;
       break;
-    case 0x7EC:
-      switch (rx_frame.data.u8[0]) {
-        case 0x10:  //"PID Header"
-          poll_data_pid = rx_frame.data.u8[4];
-          transmit_can_frame(&EGMP_7E4_ack);  //Send ack to BMS
-          break;
-        case 0x21:  //First frame in PID group
-          if (poll_data_pid == 1) {
-            allowedChargePower = ((rx_frame.data.u8[3] << 8) + rx_frame.data.u8[4]);
-            allowedDischargePower = ((rx_frame.data.u8[5] << 8) + rx_frame.data.u8[6]);
-            SOC_BMS = rx_frame.data.u8[2] * 5;  //100% = 200 ( 200 * 5 = 1000 )
-
-          } else if (poll_data_pid == 2) {
-            // set cell voltages data, start bite, data length from start, start cell
-            set_cell_voltages(rx_frame, 2, 6, 0);
-          } else if (poll_data_pid == 3) {
-            set_cell_voltages(rx_frame, 2, 6, 32);
-          } else if (poll_data_pid == 4) {
-            set_cell_voltages(rx_frame, 2, 6, 64);
-          } else if (poll_data_pid == 0x0A) {
-            set_cell_voltages(rx_frame, 2, 6, 96);
-          } else if (poll_data_pid == 0x0B) {
-            set_cell_voltages(rx_frame, 2, 6, 128);
-          } else if (poll_data_pid == 0x0C) {
-            set_cell_voltages(rx_frame, 2, 6, 160);
-          }
-          break;
-        case 0x22:  //Second datarow in PID group
-          if (poll_data_pid == 1) {
-            batteryVoltage = (rx_frame.data.u8[3] << 8) + rx_frame.data.u8[4];
-            batteryAmps = (rx_frame.data.u8[1] << 8) + rx_frame.data.u8[2];
-            temperatureMax = rx_frame.data.u8[5];
-            temperatureMin = rx_frame.data.u8[6];
-            // temp1 = rx_frame.data.u8[7];
-          } else if (poll_data_pid == 2) {
-            set_cell_voltages(rx_frame, 1, 7, 6);
-          } else if (poll_data_pid == 3) {
-            set_cell_voltages(rx_frame, 1, 7, 38);
-          } else if (poll_data_pid == 4) {
-            set_cell_voltages(rx_frame, 1, 7, 70);
-          } else if (poll_data_pid == 0x0A) {
-            set_cell_voltages(rx_frame, 1, 7, 102);
-          } else if (poll_data_pid == 0x0B) {
-            set_cell_voltages(rx_frame, 1, 7, 134);
-          } else if (poll_data_pid == 0x0C) {
-            set_cell_voltages(rx_frame, 1, 7, 166);
-          } else if (poll_data_pid == 6) {
-            batteryManagementMode = rx_frame.data.u8[5];
-          }
-          break;
-        case 0x23:  //Third datarow in PID group
-          if (poll_data_pid == 1) {
-            temperature_water_inlet = rx_frame.data.u8[6];
-            CellVoltMax_mV = (rx_frame.data.u8[7] * 20);  //(volts *50) *20 =mV
-            // temp2 = rx_frame.data.u8[1];
-            // temp3 = rx_frame.data.u8[2];
-            // temp4 = rx_frame.data.u8[3];
-          } else if (poll_data_pid == 2) {
-            set_cell_voltages(rx_frame, 1, 7, 13);
-          } else if (poll_data_pid == 3) {
-            set_cell_voltages(rx_frame, 1, 7, 45);
-          } else if (poll_data_pid == 4) {
-            set_cell_voltages(rx_frame, 1, 7, 77);
-          } else if (poll_data_pid == 0x0A) {
-            set_cell_voltages(rx_frame, 1, 7, 109);
-          } else if (poll_data_pid == 0x0B) {
-            set_cell_voltages(rx_frame, 1, 7, 141);
-          } else if (poll_data_pid == 0x0C) {
-            set_cell_voltages(rx_frame, 1, 7, 173);
-          } else if (poll_data_pid == 5) {
-            // ac = rx_frame.data.u8[3];
-            // Vdiff = rx_frame.data.u8[4];
-
-            // airbag = rx_frame.data.u8[6];
-            heatertemp = rx_frame.data.u8[7];
-          }
-          break;
-        case 0x24:  //Fourth datarow in PID group
-          if (poll_data_pid == 1) {
-            CellVmaxNo = rx_frame.data.u8[1];
-            CellVoltMin_mV = (rx_frame.data.u8[2] * 20);  //(volts *50) *20 =mV
-            CellVminNo = rx_frame.data.u8[3];
-            // fanMod = rx_frame.data.u8[4];
-            // fanSpeed = rx_frame.data.u8[5];
-            leadAcidBatteryVoltage = rx_frame.data.u8[6];  //12v Battery Volts
-            //cumulative_charge_current[0] = rx_frame.data.u8[7];
-          } else if (poll_data_pid == 2) {
-            set_cell_voltages(rx_frame, 1, 7, 20);
-          } else if (poll_data_pid == 3) {
-            set_cell_voltages(rx_frame, 1, 7, 52);
-          } else if (poll_data_pid == 4) {
-            set_cell_voltages(rx_frame, 1, 7, 84);
-          } else if (poll_data_pid == 0x0A) {
-            set_cell_voltages(rx_frame, 1, 7, 116);
-          } else if (poll_data_pid == 0x0B) {
-            set_cell_voltages(rx_frame, 1, 7, 148);
-          } else if (poll_data_pid == 0x0C) {
-            set_cell_voltages(rx_frame, 1, 7, 180);
-          } else if (poll_data_pid == 5) {
-            batterySOH = ((rx_frame.data.u8[2] << 8) + rx_frame.data.u8[3]);
-            // maxDetCell = rx_frame.data.u8[4];
-            // minDet = (rx_frame.data.u8[5] << 8) + rx_frame.data.u8[6];
-            // minDetCell = rx_frame.data.u8[7];
-          }
-          break;
-        case 0x25:  //Fifth datarow in PID group
-          if (poll_data_pid == 1) {
-            //cumulative_charge_current[1] = rx_frame.data.u8[1];
-            //cumulative_charge_current[2] = rx_frame.data.u8[2];
-            //cumulative_charge_current[3] = rx_frame.data.u8[3];
-            //cumulative_discharge_current[0] = rx_frame.data.u8[4];
-            //cumulative_discharge_current[1] = rx_frame.data.u8[5];
-            //cumulative_discharge_current[2] = rx_frame.data.u8[6];
-            //cumulative_discharge_current[3] = rx_frame.data.u8[7];
-            //set_cumulative_charge_current();
-            //set_cumulative_discharge_current();
-          } else if (poll_data_pid == 2) {
-            set_cell_voltages(rx_frame, 1, 5, 27);
-          } else if (poll_data_pid == 3) {
-            set_cell_voltages(rx_frame, 1, 5, 59);
-          } else if (poll_data_pid == 4) {
-            set_cell_voltages(rx_frame, 1, 5, 91);
-          } else if (poll_data_pid == 0x0A) {
-            set_cell_voltages(rx_frame, 1, 5, 123);
-          } else if (poll_data_pid == 0x0B) {
-            set_cell_voltages(rx_frame, 1, 5, 155);
-          } else if (poll_data_pid == 0x0C) {
-            set_cell_voltages(rx_frame, 1, 5, 187);
-            //set_cell_count();
-          } else if (poll_data_pid == 5) {
-            // datalayer.battery.info.number_of_cells = 98;
-            SOC_Display = rx_frame.data.u8[1] * 5;
-          }
-          break;
-        case 0x26:  //Sixth datarow in PID group
-          if (poll_data_pid == 1) {
-            //cumulative_energy_charged[0] = rx_frame.data.u8[1];
-            // cumulative_energy_charged[1] = rx_frame.data.u8[2];
-            //cumulative_energy_charged[2] = rx_frame.data.u8[3];
-            //cumulative_energy_charged[3] = rx_frame.data.u8[4];
-            //cumulative_energy_discharged[0] = rx_frame.data.u8[5];
-            //cumulative_energy_discharged[1] = rx_frame.data.u8[6];
-            //cumulative_energy_discharged[2] = rx_frame.data.u8[7];
-            // set_cumulative_energy_charged();
-          }
-          break;
-        case 0x27:  //Seventh datarow in PID group
-          if (poll_data_pid == 1) {
-            //cumulative_energy_discharged[3] = rx_frame.data.u8[1];
-
-            //opTimeBytes[0] = rx_frame.data.u8[2];
-            //opTimeBytes[1] = rx_frame.data.u8[3];
-            //opTimeBytes[2] = rx_frame.data.u8[4];
-            //opTimeBytes[3] = rx_frame.data.u8[5];
-
-            BMS_ign = rx_frame.data.u8[6];
-            inverterVoltageFrameHigh = rx_frame.data.u8[7];  // BMS Capacitoir
-
-            // set_cumulative_energy_discharged();
-            // set_opTime();
-          }
-          break;
-        case 0x28:  //Eighth datarow in PID group
-          if (poll_data_pid == 1) {
-            inverterVoltage = (inverterVoltageFrameHigh << 8) + rx_frame.data.u8[1];  // BMS Capacitoir
-          }
-          break;
-      }
+    case 0x7EC:  // Answer to the PID polls
+      isotp.handle_frame(rx_frame, millis());
       break;
     default:
       break;
@@ -426,6 +319,8 @@ void KiaEGmpBattery::handle_incoming_can_frame(CAN_frame rx_frame) {
 }
 
 void KiaEGmpBattery::transmit_can(unsigned long currentMillis) {
+  isotp.poll(currentMillis);
+
   if (startedUp) {
     //Send Contactor closing message loop
     // Check if we still have messages to send
@@ -451,10 +346,9 @@ void KiaEGmpBattery::transmit_can(unsigned long currentMillis) {
     if (currentMillis - previousMillis200ms >= INTERVAL_200_MS) {
       previousMillis200ms = currentMillis;
 
-      EGMP_7E4.data.u8[3] = KIA_7E4_COUNTER;
-
       if (ok_start_polling_battery) {
-        transmit_can_frame(&EGMP_7E4);
+        const uint8_t poll_pid[] = {0x22, 0x01, KIA_7E4_COUNTER};  //Poll PID 22 01 xx
+        isotp.send(poll_pid, sizeof(poll_pid), currentMillis);
       }
 
       KIA_7E4_COUNTER++;
@@ -481,4 +375,6 @@ void KiaEGmpBattery::setup(void) {  // Performs one time setup at startup
   datalayer.battery.info.max_cell_voltage_mV = MAX_CELL_VOLTAGE_MV;
   datalayer.battery.info.min_cell_voltage_mV = MIN_CELL_VOLTAGE_MV;
   datalayer.battery.info.max_cell_voltage_deviation_mV = MAX_CELL_DEVIATION_MV;
+  isotp.set_can_fd(true);
+  isotp.on_receive([this](const uint8_t* data, uint16_t length) { handle_pid_response(data, length); });
 }
@@ -1,5 +1,6 @@
 #ifndef KIA_E_GMP_BATTERY_H
 #define KIA_E_GMP_BATTERY_H
+#include "../communication/can/IsoTp.h"
 #include "CanBattery.h"
 #include "KIA-E-GMP-HTML.h"
 
@@ -9,7 +10,7 @@ class KiaEGmpBattery : public CanBattery {
  public:
   KiaEGmpBattery() : renderer(*this) {}
   virtual void setup(void);
-  virtual void handle_incoming_can_frame(CAN_frame rx_frame);
+  virtual void handle_incoming_can_frame(const CAN_frame& rx_frame);
   virtual void update_values();
   virtual void transmit_can(unsigned long currentMillis);
   static constexpr const char* Name = "Kia/Hyundai EGMP platform";
@@ -28,8 +29,8 @@ class KiaEGmpBattery : public CanBattery {
   uint16_t estimateSOC(uint16_t packVoltage, uint16_t cellCount, int16_t currentAmps);
   uint16_t selectSOC(uint16_t SOC_low, uint16_t SOC_high);
   uint16_t estimateSOCFromCell(uint16_t cellVoltage);
-  uint8_t calculateCRC(CAN_frame rx_frame, uint8_t length, uint8_t initial_value);
-  void set_cell_voltages(CAN_frame rx_frame, int start, int length, int startCell);
+  void set_cell_voltages(const uint8_t* data, int length, int startCell);
+  void handle_pid_response(const uint8_t* data, uint16_t length);
   void set_voltage_minmax_limits();
 
   static const int MAX_PACK_VOLTAGE_DV = 8064;  //5000 = 500.0V
@@ -47,7 +48,6 @@ class KiaEGmpBattery : public CanBattery {
   unsigned long previousMillis200ms = 0;  // will store last time a 200ms CAN Message was send
   unsigned long previousMillis10s = 0;    // will store last time a 10s CAN Message was send
 
-  uint16_t inverterVoltageFrameHigh = 0;
   uint16_t inverterVoltage = 0;
   uint16_t soc_calculated = 500;
   uint16_t SOC_BMS = 500;
@@ -64,7 +64,6 @@ class KiaEGmpBattery : public CanBattery {
   int16_t temperatureMin = 20;
   int16_t allowedDischargePower = 0;
   int16_t allowedChargePower = 0;
-  int16_t poll_data_pid = 0;
   uint8_t CellVmaxNo = 0;
   uint8_t CellVminNo = 0;
   uint8_t batteryManagementMode = 0;
@@ -555,18 +554,8 @@ class KiaEGmpBattery : public CanBattery {
       &message_41, &message_42, &message_43, &message_44, &message_45, &message_46, &message_47, &message_48,
       &message_49, &message_50, &message_51, &message_52, &message_53, &message_54, &message_55, &message_56,
       &message_57, &message_58, &message_59, &message_60, &message_61, &message_62, &message_63};
-  /* PID polling messages */
-  CAN_frame EGMP_7E4 = {.FD = true,
-                        .ext_ID = false,
-                        .DLC = 8,
-                        .ID = 0x7E4,
-                        .data = {0x03, 0x22, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00}};  //Poll PID 03 22 01 01
-  static constexpr CAN_frame EGMP_7E4_ack = {
-      .FD = true,
-      .ext_ID = false,
-      .DLC = 8,
-      .ID = 0x7E4,
-      .data = {0x30, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}};  //Ack frame, correct PID is returned
+  // PIDs 0x0101-0x010D are polled on 0x7E4, the BMS answers on 0x7EC
+  IsoTpLink isotp{can_interface, 0x7E4, 0x7EC, transmit_can_frame_to_interface};
 };
 
 #endif
@@ -1,5 +1,6 @@
 #include "KIA-HYUNDAI-HYBRID-BATTERY.h"
 #include <cstring>  //For unit test
+#include "../communication/can/CanCrc.h"
 #include "../communication/can/comm_can.h"
 #include "../datalayer/datalayer.h"
 #include "../devboard/utils/events.h"
@@ -10,19 +11,7 @@
 */
 
 static uint8_t CalculateCRC8(const CAN_frame& frame) {
-  uint8_t crc = 0x00;
-
-  for (uint8_t i = 0; i < 8; i++) {
-    crc ^= frame.data.u8[i];
-    for (uint8_t b = 0; b < 8; b++) {
-      if (crc & 0x80) {
-        crc = (crc << 1) ^ 0x01;
-      } else {
-        crc <<= 1;
-      }
-    }
-  }
-  return crc;
+  return Crc8Hyundai::compute(frame.data.u8, 8);
 }
 
 void KiaHyundaiHybridBattery::
@@ -75,7 +64,7 @@ void KiaHyundaiHybridBattery::
   }
 }
 
-void KiaHyundaiHybridBattery::handle_incoming_can_frame(CAN_frame rx_frame) {
+void KiaHyundaiHybridBattery::handle_incoming_can_frame(const CAN_frame& rx_frame) {
   switch (rx_frame.ID) {
     case 0x5F1:
       break;
@@ -2,6 +2,7 @@
 #include <Arduino.h>
 #include <algorithm>  // For std::min and std::max
 #include <cstring>    //For unit test
+#include "../communication/can/CanCrc.h"
 #include "../communication/can/comm_can.h"
 #include "../communication/can/obd.h"
 #include "../datalayer/datalayer.h"
@@ -45,10 +46,12 @@ const int RX_DEFAULT = 0xE000;
  * @see https://www.autosar.org/fileadmin/user_upload/standards/classic/4-3/AUTOSAR_SWS_CRCLibrary.pdf
  * @see https://web.archive.org/web/20221105210302/https://www.autosar.org/fileadmin/user_upload/standards/classic/4-3/AUTOSAR_SWS_CRCLibrary.pdf
  */
-uint8_t vw_crc_calc(uint8_t* inputBytes, uint8_t length, uint32_t address) {
+uint8_t vw_crc_calc(const uint8_t* inputBytes, uint8_t length, uint32_t address) {
+  // A frame without bytes after the CRC position covers nothing
+  if (length < 2) {
+    return Crc8Autosar::initial_value ^ 0xFF;
+  }
 
-  const uint8_t poly = 0x2F;
-  const uint8_t xor_output = 0xFF;
   // VAG Magic Bytes
   const uint8_t MB0040[16] = {0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40,
                               0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40};
@@ -97,7 +100,6 @@ uint8_t vw_crc_calc(uint8_t* inputBytes, uint8_t length, uint32_t address) {
   const uint8_t MB16A954A6[16] = {0x79, 0xB9, 0x67, 0xAD, 0xD5, 0xF7, 0x70, 0xAA,
                                   0x44, 0x61, 0x5A, 0xDC, 0x26, 0xB4, 0xD2, 0xC3};
 
-  uint8_t crc = 0xFF;
   uint8_t magicByte = 0x00;
   uint8_t counter = inputBytes[1] & 0x0F;  // only the low byte of the couner is relevant
 
@@ -177,25 +179,12 @@ uint8_t vw_crc_calc(uint8_t* inputBytes, uint8_t length, uint32_t address) {
       break;
   }
 
-  for (uint8_t i = 1; i < length + 1; i++) {
-    // We skip the empty CRC position and start at the timer
-    // The last element is the VAG magic byte for address 0x187 depending on the counter value.
-    if (i < length)
-      crc ^= inputBytes[i];
-    else
-      crc ^= magicByte;
-
-    for (uint8_t j = 0; j < 8; j++) {
-      if (crc & 0x80)
-        crc = (crc << 1) ^ poly;
-      else
-        crc = (crc << 1);
-    }
-  }
-
-  crc ^= xor_output;
+  // We skip the empty CRC position and start at the timer
+  // The last element is the VAG magic byte for the address depending on the counter value.
+  uint8_t crc = Crc8Autosar::update(Crc8Autosar::initial_value, &inputBytes[1], length - 1);
+  crc = Crc8Autosar::update(crc, &magicByte, 1);
 
-  return crc;
+  return crc ^ 0xFF;  // XOR output
 }
 
 void MebBattery::
@@ -306,7 +295,14 @@ void MebBattery::
   datalayer_extended.meb.charging_active = charging_active;
 }
 
-void MebBattery::handle_incoming_can_frame(CAN_frame rx_frame) {
+std::vector<uint32_t> MebBattery::accepted_can_ids() {
+  return {
+      0x0CF, 0x2AF, 0x578, 0x5A2, 0x5CA, 0x12DD54D0, 0x12DD54D1, 0x12DD54D2, 0x16A954A6, 0x16A954E8, 0x16A954F8,
+      0x17F0007B, 0x17FE007B, 0x18DAF105, 0x1A555550, 0x1A555551, 0x1A5555B0, 0x1A5555B1, 0x1A5555B2, 0x1B00007B,
+      0x1C42007B, 0x1C42017B};
+}
+
+void MebBattery::handle_incoming_can_frame(const CAN_frame& rx_frame) {
   last_can_msg_timestamp = millis();
   if (first_can_msg == 0) {
     logging.printf("MEB: First CAN msg received\n");
@@ -320,8 +316,8 @@ void MebBattery::handle_incoming_can_frame(CAN_frame rx_frame) {
     case 0x5A2:
     case 0x5CA:
     case 0x16A954A6:
-      if (rx_frame.data.u8[0] !=
-          vw_crc_calc(rx_frame.data.u8, rx_frame.DLC, rx_frame.ID)) {  //If CRC does not match calc
+      if (rx_frame.DLC < 2 || rx_frame.data.u8[0] != vw_crc_calc(rx_frame.data.u8, rx_frame.DLC,
+                                                                  rx_frame.ID)) {  //If CRC does not match calc
         datalayer.battery.status.CAN_error_counter++;
         logging.printf("MEB: Msg 0x%04X CRC error\n", rx_frame.ID);
         return;
@@ -753,111 +749,8 @@ void MebBattery::handle_incoming_can_frame(CAN_frame rx_frame) {
         BMS_voltage = ((rx_frame.data.u8[7] << 4) + ((rx_frame.data.u8[6] & 0xF0) >> 4));
       }
       break;
-    case 0x1C42007B:                      // Reply from battery
-      if (rx_frame.data.u8[0] == 0x10) {  //PID header
-        transmit_can_frame(&MEB_ACK_FRAME);
-      }
-      if (rx_frame.DLC == 8) {
-        pid_reply = (rx_frame.data.u8[2] << 8) + rx_frame.data.u8[3];
-      } else {  //12 or 24bit message has reply in other location
-        pid_reply = (rx_frame.data.u8[3] << 8) + rx_frame.data.u8[4];
-      }
-
-      switch (pid_reply) {
-        case PID_SOC:
-          battery_soc_polled = rx_frame.data.u8[4] * 4;  // 135*4 = 54.0%
-          break;
-        case PID_VOLTAGE:
-          battery_voltage_polled = ((rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5]);
-          break;
-        case PID_CURRENT:  // IDLE 0A: 00 08 62 1E 3D (00 02) 49 F0 39 AA AA
-          battery_current_polled = ((rx_frame.data.u8[5] << 8) | rx_frame.data.u8[6]);  //TODO: right bits?
-          break;
-        case PID_MAX_TEMP:
-          battery_max_temp = ((rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5]);
-          break;
-        case PID_MIN_TEMP:
-          battery_min_temp = ((rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5]);
-          break;
-        // Note: PID_TEMP_POINT_1 to PID_TEMP_POINT_18 are handled in the default case.
-        case PID_MAX_CHARGE_VOLTAGE:
-          battery_max_charge_voltage = ((rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5]);
-          break;
-        case PID_MIN_DISCHARGE_VOLTAGE:
-          battery_min_discharge_voltage = ((rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5]);
-          break;
-        case PID_ENERGY_COUNTERS:
-          // int32_t ah_discharge = ((rx_frame.data.u8[5] << 24) | (rx_frame.data.u8[6] << 16) | (rx_frame.data.u8[7] << 8) |rx_frame.data.u8[8]);
-          // int32_t ah_charge = ((rx_frame.data.u8[9] << 24) | (rx_frame.data.u8[10] << 16) | (rx_frame.data.u8[11] << 8) |rx_frame.data.u8[12]);
-          kwh_charge = ((rx_frame.data.u8[13] << 24) | (rx_frame.data.u8[14] << 16) | (rx_frame.data.u8[15] << 8) |
-                        rx_frame.data.u8[16]);
-          kwh_discharge = ((rx_frame.data.u8[17] << 24) | (rx_frame.data.u8[18] << 16) | (rx_frame.data.u8[19] << 8) |
-                           rx_frame.data.u8[20]);
-          // logging.printf("ah_dis:%.3f ah_ch:%.3f kwh_dis:%.3f kwh_ch:%.3f\n", ah_discharge*0.00182044545, ah_charge*0.00182044545,
-          // kwh_discharge*0.00011650853, kwh_charge*0.00011650853);
-          datalayer.battery.status.total_discharged_battery_Wh = kwh_discharge * 0.11650853;
-          datalayer.battery.status.total_charged_battery_Wh = kwh_charge * 0.11650853;
-          break;
-        case PID_ALLOWED_CHARGE_POWER:
-          battery_allowed_charge_power = ((rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5]);
-          break;
-        case PID_ALLOWED_DISCHARGE_POWER:
-          battery_allowed_discharge_power = ((rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5]);
-          break;
-        // Note: most PID_CELLVOLTAGE_CELL_* responses are handled in the default case.
-        // Certain specific cases are handled here as they are used to establish the number of cells.
-        case PID_CELLVOLTAGE_CELL_85:
-          tempval = ((rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5]);
-          if (tempval != 0xFFE) {
-            cellvoltages_polled[84] = (tempval + 1000);
-          } else {  // Cell 85 unavailable. We have a 84S battery (48kWh)
-            datalayer.battery.info.number_of_cells = 84;
-            nof_cells_determined = true;
-            datalayer.battery.info.max_design_voltage_dV = MAX_PACK_VOLTAGE_84S_DV;
-            datalayer.battery.info.min_design_voltage_dV = MIN_PACK_VOLTAGE_84S_DV;
-          }
-          break;
-        case PID_CELLVOLTAGE_CELL_97:
-          tempval = ((rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5]);
-          if (tempval != 0xFFE) {
-            cellvoltages_polled[96] = (tempval + 1000);
-          } else {  // Cell 97 unavailable. We have a 96S battery (55kWh) (Unless already specified as 84S)
-            if (datalayer.battery.info.number_of_cells == 84) {
-              // Do nothing, we already identified it as 84S
-            } else {
-              datalayer.battery.info.number_of_cells = 96;
-              nof_cells_determined = true;
-              datalayer.battery.info.max_design_voltage_dV = MAX_PACK_VOLTAGE_96S_DV;
-              datalayer.battery.info.min_design_voltage_dV = MIN_PACK_VOLTAGE_96S_DV;
-            }
-          }
-          break;
-        case PID_CELLVOLTAGE_CELL_108:
-          tempval = ((rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5]);
-          nof_cells_determined = true;  // This is placed outside of the if, to make
-          // sure we only take the shortcuts to determine the number of cells once.
-          if (tempval != 0xFFE) {
-            cellvoltages_polled[107] = (tempval + 1000);
-            datalayer.battery.info.number_of_cells = 108;
-            datalayer.battery.info.max_design_voltage_dV = MAX_PACK_VOLTAGE_108S_DV;
-            datalayer.battery.info.min_design_voltage_dV = MIN_PACK_VOLTAGE_108S_DV;
-          }
-          break;
-        default:
-          if (pid_reply >= PID_TEMP_POINT_1 && pid_reply <= PID_TEMP_POINT_18) {
-            datalayer_extended.meb.temp_points[pid_reply - PID_TEMP_POINT_1] =
-                (((rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5]) / 8.f) - 40;
-          } else if (pid_reply >= PID_CELLVOLTAGE_CELL_1 && pid_reply <= PID_CELLVOLTAGE_CELL_108) {
-            // The general case for cell voltages (some specific cases handled above)
-            tempval = ((rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5]);
-            if (tempval != 0xFFE) {
-              cellvoltages_polled[pid_reply - PID_CELLVOLTAGE_CELL_1] = (tempval + 1000);
-            }
-          }
-
-          break;
-      }
-
+    case 0x1C42007B:  // Reply from battery
+      isotp.handle_frame(rx_frame, millis());
       break;
     case 0x18DAF105:
       handle_obd_frame(rx_frame, can_interface);
@@ -871,7 +764,112 @@ void MebBattery::handle_incoming_can_frame(CAN_frame rx_frame) {
   }
 }
 
+// ReadDataByIdentifier response: 0x62, PID high, PID low, value...
+void MebBattery::handle_pid_response(const uint8_t* data, uint16_t length) {
+  if (length < 4 || data[0] != 0x62) {
+    return;
+  }
+  uint16_t pid_reply = (data[1] << 8) | data[2];
+
+  switch (pid_reply) {
+    case PID_SOC:
+      battery_soc_polled = data[3] * 4;  // 135*4 = 54.0%
+      break;
+    case PID_VOLTAGE:
+      battery_voltage_polled = ((data[3] << 8) | data[4]);
+      break;
+    case PID_CURRENT:  // IDLE 0A: 00 08 62 1E 3D (00 02) 49 F0 39 AA AA
+      battery_current_polled = ((data[3] << 8) | data[4]);  //TODO: right bits?
+      break;
+    case PID_MAX_TEMP:
+      battery_max_temp = ((data[3] << 8) | data[4]);
+      break;
+    case PID_MIN_TEMP:
+      battery_min_temp = ((data[3] << 8) | data[4]);
+      break;
+    // Note: PID_TEMP_POINT_1 to PID_TEMP_POINT_18 are handled in the default case.
+    case PID_MAX_CHARGE_VOLTAGE:
+      battery_max_charge_voltage = ((data[3] << 8) | data[4]);
+      break;
+    case PID_MIN_DISCHARGE_VOLTAGE:
+      battery_min_discharge_voltage = ((data[3] << 8) | data[4]);
+      break;
+    case PID_ENERGY_COUNTERS:
+      // int32_t ah_discharge = ((data[3] << 24) | (data[4] << 16) | (data[5] << 8) |data[6]);
+      // int32_t ah_charge = ((data[7] << 24) | (data[8] << 16) | (data[9] << 8) |data[10]);
+      if (length < 19) {
+        break;
+      }
+      kwh_charge = ((data[11] << 24) | (data[12] << 16) | (data[13] << 8) | data[14]);
+      kwh_discharge = ((data[15] << 24) | (data[16] << 16) | (data[17] << 8) | data[18]);
+      // logging.printf("ah_dis:%.3f ah_ch:%.3f kwh_dis:%.3f kwh_ch:%.3f\n", ah_discharge*0.00182044545, ah_charge*0.00182044545,
+      // kwh_discharge*0.00011650853, kwh_charge*0.00011650853);
+      datalayer.battery.status.total_discharged_battery_Wh = kwh_discharge * 0.11650853;
+      datalayer.battery.status.total_charged_battery_Wh = kwh_charge * 0.11650853;
+      break;
+    case PID_ALLOWED_CHARGE_POWER:
+      battery_allowed_charge_power = ((data[3] << 8) | data[4]);
+      break;
+    case PID_ALLOWED_DISCHARGE_POWER:
+      battery_allowed_discharge_power = ((data[3] << 8) | data[4]);
+      break;
+    // Note: most PID_CELLVOLTAGE_CELL_* responses are handled in the default case.
+    // Certain specific cases are handled here as they are used to establish the number of cells.
+    case PID_CELLVOLTAGE_CELL_85:
+      tempval = ((data[3] << 8) | data[4]);
+      if (tempval != 0xFFE) {
+        cellvoltages_polled[84] = (tempval + 1000);
+      } else {  // Cell 85 unavailable. We have a 84S battery (48kWh)
+        datalayer.battery.info.number_of_cells = 84;
+        nof_cells_determined = true;
+        datalayer.battery.info.max_design_voltage_dV = MAX_PACK_VOLTAGE_84S_DV;
+        datalayer.battery.info.min_design_voltage_dV = MIN_PACK_VOLTAGE_84S_DV;
+      }
+      break;
+    case PID_CELLVOLTAGE_CELL_97:
+      tempval = ((data[3] << 8) | data[4]);
+      if (tempval != 0xFFE) {
+        cellvoltages_polled[96] = (tempval + 1000);
+      } else {  // Cell 97 unavailable. We have a 96S battery (55kWh) (Unless already specified as 84S)
+        if (datalayer.battery.info.number_of_cells == 84) {
+          // Do nothing, we already identified it as 84S
+        } else {
+          datalayer.battery.info.number_of_cells = 96;
+          nof_cells_determined = true;
+          datalayer.battery.info.max_design_voltage_dV = MAX_PACK_VOLTAGE_96S_DV;
+          datalayer.battery.info.min_design_voltage_dV = MIN_PACK_VOLTAGE_96S_DV;
+        }
+      }
+      break;
+    case PID_CELLVOLTAGE_CELL_108:
+      tempval = ((data[3] << 8) | data[4]);
+      nof_cells_determined = true;  // This is placed outside of the if, to make
+      // sure we only take the shortcuts to determine the number of cells once.
+      if (tempval != 0xFFE) {
+        cellvoltages_polled[107] = (tempval + 1000);
+        datalayer.battery.info.number_of_cells = 108;
+        datalayer.battery.info.max_design_voltage_dV = MAX_PACK_VOLTAGE_108S_DV;
+        datalayer.battery.info.min_design_voltage_dV = MIN_PACK_VOLTAGE_108S_DV;
+      }
+      break;
+    default:
+      if (pid_reply >= PID_TEMP_POINT_1 && pid_reply <= PID_TEMP_POINT_18) {
+        datalayer_extended.meb.temp_points[pid_reply - PID_TEMP_POINT_1] = (((data[3] << 8) | data[4]) / 8.f) - 40;
+      } else if (pid_reply >= PID_CELLVOLTAGE_CELL_1 && pid_reply <= PID_CELLVOLTAGE_CELL_108) {
+        // The general case for cell voltages (some specific cases handled above)
+        tempval = ((data[3] << 8) | data[4]);
+        if (tempval != 0xFFE) {
+          cellvoltages_polled[pid_reply - PID_CELLVOLTAGE_CELL_1] = (tempval + 1000);
+        }
+      }
+
+      break;
+  }
+}
+
 void MebBattery::transmit_can(unsigned long currentMillis) {
+  isotp.poll(currentMillis);
+
 
   if (currentMillis - last_can_msg_timestamp > 500) {
     if (first_can_msg)
@@ -1061,30 +1059,21 @@ void MebBattery::transmit_can(unsigned long currentMillis) {
     transmit_can_frame(&MEB_1B000010);
     transmit_can_frame(&MEB_1B000046);
 
+    uint16_t requested_pid = poll_pid;
     switch (poll_pid) {
       case PID_SOC:
-        MEB_POLLING_FRAME.data.u8[2] = (uint8_t)(PID_SOC >> 8);  // High byte
-        MEB_POLLING_FRAME.data.u8[3] = (uint8_t)PID_SOC;         // Low byte
         poll_pid = PID_VOLTAGE;
         break;
       case PID_VOLTAGE:
-        MEB_POLLING_FRAME.data.u8[2] = (uint8_t)(PID_VOLTAGE >> 8);
-        MEB_POLLING_FRAME.data.u8[3] = (uint8_t)PID_VOLTAGE;
         poll_pid = PID_CURRENT;
         break;
       case PID_CURRENT:
-        MEB_POLLING_FRAME.data.u8[2] = (uint8_t)(PID_CURRENT >> 8);
-        MEB_POLLING_FRAME.data.u8[3] = (uint8_t)PID_CURRENT;
         poll_pid = PID_MAX_TEMP;
         break;
       case PID_MAX_TEMP:
-        MEB_POLLING_FRAME.data.u8[2] = (uint8_t)(PID_MAX_TEMP >> 8);
-        MEB_POLLING_FRAME.data.u8[3] = (uint8_t)PID_MAX_TEMP;
         poll_pid = PID_MIN_TEMP;
         break;
       case PID_MIN_TEMP:
-        MEB_POLLING_FRAME.data.u8[2] = (uint8_t)(PID_MIN_TEMP >> 8);
-        MEB_POLLING_FRAME.data.u8[3] = (uint8_t)PID_MIN_TEMP;
         poll_pid = PID_TEMP_POINT_1;
         break;
       case PID_TEMP_POINT_1:
@@ -1104,49 +1093,32 @@ void MebBattery::transmit_can(unsigned long currentMillis) {
       case PID_TEMP_POINT_15:
       case PID_TEMP_POINT_16:
       case PID_TEMP_POINT_17:
-        MEB_POLLING_FRAME.data.u8[2] = (uint8_t)(poll_pid >> 8);
-        MEB_POLLING_FRAME.data.u8[3] = (uint8_t)poll_pid;
         poll_pid = poll_pid + 1;
         break;
       case PID_TEMP_POINT_18:
-        MEB_POLLING_FRAME.data.u8[2] = (uint8_t)(poll_pid >> 8);
-        MEB_POLLING_FRAME.data.u8[3] = (uint8_t)poll_pid;
         poll_pid = PID_MAX_CHARGE_VOLTAGE;
         break;
       case PID_MAX_CHARGE_VOLTAGE:
-        MEB_POLLING_FRAME.data.u8[2] = (uint8_t)(PID_MAX_CHARGE_VOLTAGE >> 8);
-        MEB_POLLING_FRAME.data.u8[3] = (uint8_t)PID_MAX_CHARGE_VOLTAGE;
         poll_pid = PID_MIN_DISCHARGE_VOLTAGE;
         break;
       case PID_MIN_DISCHARGE_VOLTAGE:
-        MEB_POLLING_FRAME.data.u8[2] = (uint8_t)(PID_MIN_DISCHARGE_VOLTAGE >> 8);
-        MEB_POLLING_FRAME.data.u8[3] = (uint8_t)PID_MIN_DISCHARGE_VOLTAGE;
         poll_pid = PID_ENERGY_COUNTERS;
         break;
       case PID_ENERGY_COUNTERS:
-        MEB_POLLING_FRAME.data.u8[2] = (uint8_t)(PID_ENERGY_COUNTERS >> 8);
-        MEB_POLLING_FRAME.data.u8[3] = (uint8_t)PID_ENERGY_COUNTERS;
         poll_pid = PID_ALLOWED_CHARGE_POWER;
         break;
       case PID_ALLOWED_CHARGE_POWER:
-        MEB_POLLING_FRAME.data.u8[2] = (uint8_t)(PID_ALLOWED_CHARGE_POWER >> 8);
-        MEB_POLLING_FRAME.data.u8[3] = (uint8_t)PID_ALLOWED_CHARGE_POWER;
         poll_pid = PID_ALLOWED_DISCHARGE_POWER;
         break;
       case PID_ALLOWED_DISCHARGE_POWER:
-        MEB_POLLING_FRAME.data.u8[2] = (uint8_t)(PID_ALLOWED_DISCHARGE_POWER >> 8);
-        MEB_POLLING_FRAME.data.u8[3] = (uint8_t)PID_ALLOWED_DISCHARGE_POWER;
         poll_pid = PID_CELLVOLTAGE_CELL_1;  // Start polling cell voltages
         break;
       // Cell Voltage Cases.
       // Most of these are handled in the default case.
       case PID_CELLVOLTAGE_CELL_1:
-        MEB_POLLING_FRAME.data.u8[2] = (uint8_t)(PID_CELLVOLTAGE_CELL_1 >> 8);
-        MEB_POLLING_FRAME.data.u8[3] = (uint8_t)PID_CELLVOLTAGE_CELL_1;
         poll_pid = PID_CELLVOLTAGE_CELL_2;
         break;
       case PID_CELLVOLTAGE_CELL_84:
-        MEB_POLLING_FRAME.data.u8[3] = (uint8_t)PID_CELLVOLTAGE_CELL_84;
         if (datalayer.battery.info.number_of_cells > 84) {
           if (nof_cells_determined) {
             poll_pid = PID_CELLVOLTAGE_CELL_85;
@@ -1158,20 +1130,17 @@ void MebBattery::transmit_can(unsigned long currentMillis) {
         }
         break;
       case PID_CELLVOLTAGE_CELL_96:
-        MEB_POLLING_FRAME.data.u8[3] = (uint8_t)PID_CELLVOLTAGE_CELL_96;
         if (datalayer.battery.info.number_of_cells > 96)
           poll_pid = PID_CELLVOLTAGE_CELL_97;
         else
           poll_pid = PID_SOC;
         break;
       case PID_CELLVOLTAGE_CELL_108:
-        MEB_POLLING_FRAME.data.u8[3] = (uint8_t)PID_CELLVOLTAGE_CELL_108;
         poll_pid = PID_SOC;
         break;
       default:
         if (poll_pid >= PID_CELLVOLTAGE_CELL_1 && poll_pid <= PID_CELLVOLTAGE_CELL_108) {
           // The general case for cell voltages (some specific cases handled above)
-          MEB_POLLING_FRAME.data.u8[3] = (uint8_t)poll_pid;
           // Poll the next cell next
           poll_pid = poll_pid + 1;
         } else {
@@ -1181,7 +1150,8 @@ void MebBattery::transmit_can(unsigned long currentMillis) {
         break;
     }
     if (first_can_msg > 0 && currentMillis > first_can_msg + 1000) {
-      transmit_can_frame(&MEB_POLLING_FRAME);
+      const uint8_t poll[] = {0x22, (uint8_t)(requested_pid >> 8), (uint8_t)requested_pid};
+      isotp.send(poll, sizeof(poll), currentMillis);
     }
   }
 
@@ -1273,4 +1243,7 @@ void MebBattery::setup(void) {  // Performs one time setup at startup
   datalayer.battery.info.max_cell_voltage_mV = MAX_CELL_VOLTAGE_MV;
   datalayer.battery.info.min_cell_voltage_mV = MIN_CELL_VOLTAGE_MV;
   datalayer.battery.info.max_cell_voltage_deviation_mV = MAX_CELL_DEVIATION_MV;
+  isotp.set_can_fd(true);
+  isotp.set_padding(0x55);
+  isotp.on_receive([this](const uint8_t* data, uint16_t length) { handle_pid_response(data, length); });
 }
@@ -1,5 +1,6 @@
 #ifndef MEB_BATTERY_H
 #define MEB_BATTERY_H
+#include "../communication/can/IsoTp.h"
 #include "CanBattery.h"
 #include "MEB-HTML.h"
 
@@ -19,7 +20,8 @@ class MebBattery : public CanBattery {
   }
 
   virtual void setup(void);
-  virtual void handle_incoming_can_frame(CAN_frame rx_frame);
+  virtual void handle_incoming_can_frame(const CAN_frame& rx_frame);
+  virtual std::vector<uint32_t> accepted_can_ids();
   virtual void update_values();
   virtual void transmit_can(unsigned long currentMillis);
   bool supports_real_BMS_status() { return true; }
@@ -31,6 +33,8 @@ class MebBattery : public CanBattery {
  private:
   MebHtmlRenderer renderer;
 
+  void handle_pid_response(const uint8_t* data, uint16_t length);
+
   DATALAYER_BATTERY_TYPE* datalayer_battery;
   DATALAYER_INFO_MEB* datalayer_meb;
 
@@ -203,7 +207,6 @@ class MebBattery : public CanBattery {
 
   uint32_t poll_pid = PID_CELLVOLTAGE_CELL_85;  // We start here to quickly determine the cell size of the pack.
   bool nof_cells_determined = false;
-  uint32_t pid_reply = 0;
   uint16_t battery_soc_polled = 0;
   uint16_t battery_voltage_polled = 1480;
   int16_t battery_current_polled = 0;
@@ -369,16 +372,8 @@ class MebBattery : public CanBattery {
 #define DC_FASTCHARGE_LS1 0x80
 #define DC_FASTCHARGE_LS2 0xC0
 
-  CAN_frame MEB_POLLING_FRAME = {.FD = true,
-                                 .ext_ID = true,
-                                 .DLC = 8,
-                                 .ID = 0x1C40007B,  // SOC 02 8C
-                                 .data = {0x03, 0x22, 0x02, 0x8C, 0x55, 0x55, 0x55, 0x55}};
-  static constexpr CAN_frame MEB_ACK_FRAME = {.FD = true,
-                                              .ext_ID = true,
-                                              .DLC = 8,
-                                              .ID = 0x1C40007B,  // Ack
-                                              .data = {0x30, 0x00, 0x00, 0x55, 0x55, 0x55, 0x55, 0x55}};
+  // PIDs are polled on 0x1C40007B, the BMS answers on 0x1C42007B
+  IsoTpLink isotp{can_interface, 0x1C40007B, 0x1C42007B, transmit_can_frame_to_interface};
   //Messages needed for contactor closing
   CAN_frame MEB_040 = {.FD = true,  // Airbag
                        .ext_ID = false,
@@ -166,41 +166,6 @@ void Mg5Battery::print_formatted_dtc(uint32_t dtc24, uint8_t status) {
   logging.println("]");
 }
 
-void Mg5Battery::startUDSMultiFrameReception(uint16_t totalLength, uint8_t moduleID) {
-  gUDSContext.UDS_inProgress = true;
-  gUDSContext.UDS_expectedLength = totalLength;
-  gUDSContext.UDS_bytesReceived = 0;
-  gUDSContext.UDS_moduleID = moduleID;
-  gUDSContext.receivedInBatch = 0;
-  memset(gUDSContext.UDS_buffer, 0, sizeof(gUDSContext.UDS_buffer));
-  gUDSContext.UDS_lastFrameMillis = millis();  // if you want to track timeouts
-}
-
-bool Mg5Battery::storeUDSPayload(const uint8_t* payload, uint8_t length) {
-  if (gUDSContext.UDS_bytesReceived + length > sizeof(gUDSContext.UDS_buffer)) {
-    // Overflow => abort
-    gUDSContext.UDS_inProgress = false;
-#ifdef DEBUG_LOG
-    logging.println("UDS Payload Overflow");
-#endif  // DEBUG_LOG
-    return false;
-  }
-  memcpy(&gUDSContext.UDS_buffer[gUDSContext.UDS_bytesReceived], payload, length);
-  gUDSContext.UDS_bytesReceived += length;
-  gUDSContext.UDS_lastFrameMillis = millis();
-
-  // If we’ve reached or exceeded the expected length, mark complete
-  if (gUDSContext.UDS_bytesReceived >= gUDSContext.UDS_expectedLength) {
-    gUDSContext.UDS_inProgress = false;
-    logging.println("Recived all expected UDS bytes");
-  }
-  return true;
-}
-
-bool Mg5Battery::isUDSMessageComplete() {
-  return (!gUDSContext.UDS_inProgress && gUDSContext.UDS_bytesReceived > 0);
-}
-
 void Mg5Battery::
     update_values() {  //This function maps all the values fetched via CAN to the correct parameters used for modbus
 
@@ -212,7 +177,7 @@ void Mg5Battery::
   }
 }
 
-void Mg5Battery::handle_incoming_can_frame(CAN_frame rx_frame) {
+void Mg5Battery::handle_incoming_can_frame(const CAN_frame& rx_frame) {
   //datalayer.battery.status.CAN_battery_still_alive = CAN_STILL_ALIVE;
   switch (rx_frame.ID) {
     case 0x297: {                                                          //BMS state
@@ -351,284 +316,9 @@ void Mg5Battery::handle_incoming_can_frame(CAN_frame rx_frame) {
       break;
     case 0x620:
       break;
-    case 0x789: {  // response from UDS diagnostic service (ISO-TP)
-
-      uint8_t pciByte = rx_frame.data.u8[0];  // 0x10/0x21/etc.
-      uint8_t pciType = pciByte >> 4;         // 0=SF,1=FF,2=CF,3=FC
-      uint8_t pciLower = pciByte & 0x0F;      // length nibble or sequence
-
-      switch (pciType) {
-        case 0x0: {  // Single Frame (SF)
-          uint8_t sfLength = pciLower;
-          (void)sfLength;  // if unused, silence warning
-
-          uint8_t sid = rx_frame.data.u8[1];
-
-          // Positive response to Diagnostic Session Control (0x10 -> 0x50)
-          if (sid == 0x50) {
-            uint8_t sub = rx_frame.data.u8[2];  // 0x01=Default, 0x03=Extended, etc.
-
-            if (sub == 0x03 || sub == 0x01) {
-              logging.print("entered ");
-              logging.println(sub == 0x03 ? "extended diagnostic session" : "default session");
-
-              // mark this UDS transaction done
-              uds_tx_in_flight = false;
-            }
-            break;
-          }
-
-          // Positive response to clear DTC request
-          if (sid == 0x54) {
-            //  [0] PCI
-            //  [1] SID (0x54)
-            //  [2] DTC high byte  (0x02)
-            //  [3] DTC mid byte   (0x93)
-            //  [4] DTC low byte   (0x00)
-            uint8_t b2 = rx_frame.data.u8[2];
-            uint8_t b3 = rx_frame.data.u8[3];
-            uint8_t b4 = rx_frame.data.u8[4];
-
-            bool allDtcCleared = ((b2 == 0xFF && b3 == 0xFF && b4 == 0xFF) || (b2 == 0xAA && b3 == 0xAA && b4 == 0xAA));
-
-            if (allDtcCleared) {
-              logging.println("UDS: positive response, ALL DTCs cleared");
-              userRequestClearDTC = false;  // reset the request
-            } else {
-              logging.print("UDS: positive ClearDTC response, group/DTC = ");
-              logging.print(b2, HEX);
-              logging.print(' ');
-              logging.print(b3, HEX);
-              logging.print(' ');
-              logging.print(b4, HEX);
-              logging.println();
-            }
-
-            uds_tx_in_flight = false;
-            break;
-          }
-
-          // Negative response
-          if (sid == 0x7F) {
-            uint8_t origSid = rx_frame.data.u8[2];
-            uint8_t nrc = rx_frame.data.u8[3];
-
-            logging.print("UDS negative response to 0x");
-            logging.print(origSid, HEX);
-            logging.print(": NRC=0x");
-            logging.print(nrc, HEX);
-            logging.println();
-
-            if (nrc != 0x78) {  // 0x78 = Response Pending; otherwise we’re done with this tx
-              uds_tx_in_flight = false;
-            }
-            break;
-          }
-
-          if (sid == 0x62) {  // ReadDataByIdentifier response
-            uint16_t did = (rx_frame.data.u8[2] << 8) | rx_frame.data.u8[3];
-
-            // signal that UDS transaction is complete
-            uds_tx_in_flight = false;
-
-            switch (did) {
-              case 0xB041: {
-                float v = ((rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5]);
-                (void)v;
-                //logging.print("single frame UDS ReadDataByIdentifier bus voltage: ");
-                //logging.println(v); //scaling to be checked
-
-                break;
-              }
-              case 0xB042: {
-                float v = ((rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5]) * 0.25f;
-                (void)v;
-                //logging.print("single frame UDS ReadDataByIdentifier battery voltage: ");
-                //logging.println(v);
-                break;
-              }
-              case 0xB043: {
-                float i = (((rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5])) * 1;
-                (void)i;
-                //logging.print("single frame UDS ReadDataByIdentifier battery current: ");
-                //logging.println(i); //scaling to be checked
-                break;
-              }
-              case 0xB045: {
-                float r = ((rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5]) * 1;
-                (void)r;
-                //logging.print("single frame UDS ReadDataByIdentifier battery resistance: ");
-                //logging.println(r); //scaling to be checked
-                break;
-              }
-              case 0xB046: {
-                float soc = ((rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5]) * 0.1f;
-                (void)soc;
-                //logging.print("single frame UDS ReadDataByIdentifier battery state of charge: ");
-                //logging.println(soc);
-                break;
-              }
-              case 0xB047: {
-                uint8_t e = rx_frame.data.u8[4];
-                (void)e;
-                //logging.print("single frame UDS ReadDataByIdentifier error: ");
-                //logging.println(e);
-                break;
-              }
-              case 0xB048: {
-                uint8_t s = rx_frame.data.u8[4];
-                (void)s;
-                //logging.print("single frame UDS ReadDataByIdentifier status: ");
-                //logging.println (getBMStatus(s));
-                break;
-              }
-              case 0xB049: {
-                uint8_t rB = rx_frame.data.u8[4];
-                (void)rB;
-                //logging.print("single frame UDS ReadDataByIdentifier relay B: ");
-                //logging.println (rB); //normally 1, seems to go to 0 during change of contactor state
-                break;
-              }
-              case 0xB04A: {
-                uint8_t rG = rx_frame.data.u8[4];
-                (void)rG;
-                //logging.print("single frame UDS ReadDataByIdentifier relay G: ");
-                //logging.println (rG); //normally 1, seems to go to 0 during change of contactor state
-                break;
-              }
-              case 0xB052: {
-                uint8_t rP = rx_frame.data.u8[4];
-                (void)rP;
-                //logging.print("single frame UDS ReadDataByIdentifier relay P: ");
-                //logging.println (rP); //normally 1, seems to go to 0 during change of contactor state
-                break;
-              }
-              case 0xB056: {
-                float t = rx_frame.data.u8[4] - 100;
-                (void)t;
-                //logging.print("single frame UDS ReadDataByIdentifier BATTERY TEMP: ");
-                //logging.println (t);
-                break;
-              }
-              case 0xB058: {
-                float mv = ((rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5]) * 0.001f;
-                (void)mv;
-                //logging.print("single frame UDS ReadDataByIdentifier max cell voltage: ");
-                //logging.println (mv);
-                break;
-              }
-              case 0xB059: {
-                float nv = ((rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5]) * 0.001f;
-                (void)nv;
-                //logging.print("single frame UDS ReadDataByIdentifier min cell voltage: ");
-                //logging.println (nv);
-                break;
-              }
-              case 0xB05C: {
-                float c = rx_frame.data.u8[4] - 100;
-                (void)c;
-                //logging.print("single frame UDS ReadDataByIdentifier coolant temperature: ");
-                //logging.println (c);
-                break;
-              }
-              case 0xB061: {
-                float soh = ((rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5]);
-                (void)soh;
-                //logging.print("single frame UDS ReadDataByIdentifier state of health: ");
-                //logging.println (soh*0.01f);
-                datalayer.battery.status.soh_pptt = soh;
-                break;
-              }
-              case 0xB06D: {
-                uint32_t t = (uint32_t(rx_frame.data.u8[4]) << 24) | (uint32_t(rx_frame.data.u8[5]) << 16) |
-                             (uint32_t(rx_frame.data.u8[6]) << 8) | uint32_t(rx_frame.data.u8[7]);
-                (void)t;
-                //logging.print("single frame UDS ReadDataByIdentifier BMS time: ");
-                //logging.println (t); //scaling to be checked
-
-                break;
-              } break;
-            }
-          }
-          break;
-        }
-
-        case 0x1: {  // First Frame (FF)
-          uint16_t totalLength = (uint16_t(pciLower) << 8) | rx_frame.data.u8[1];
-
-          // DTC ReadDTCInformation response (0x59 0x02) at bytes [2..3]
-          if (rx_frame.DLC >= 4 && rx_frame.data.u8[2] == 0x59 && rx_frame.data.u8[3] == 0x02) {
-            startUDSMultiFrameReception(totalLength, 0x59);
-            // FF payload for normal addressing starts at data[2]
-            uint8_t avail = (rx_frame.DLC > 2) ? (rx_frame.DLC - 2) : 0;
-            uint16_t remain = gUDSContext.UDS_expectedLength - gUDSContext.UDS_bytesReceived;
-            uint8_t toStore = uint8_t(remain < avail ? remain : avail);
-            if (toStore)
-              storeUDSPayload(&rx_frame.data.u8[2], toStore);
-
-            transmit_can_frame(&MG5_781_RQ_CONTINUE_MULTIFRAME);
-            uds_timeout_ms = UDS_TIMEOUT_AFTER_FF_MS;  // extend while MF running
-          }
-          break;
-        }
-
-        case 0x2: {  // Consecutive Frame (CF)
-          if (!gUDSContext.UDS_inProgress)
-            break;
-          uint8_t avail = (rx_frame.DLC > 1) ? (rx_frame.DLC - 1) : 0;  // CF payload at data[1]
-          uint16_t remain = gUDSContext.UDS_expectedLength - gUDSContext.UDS_bytesReceived;
-          uint8_t toStore = uint8_t(remain < avail ? remain : avail);
-          if (toStore)
-            storeUDSPayload(&rx_frame.data.u8[1], toStore);
-
-          gUDSContext.receivedInBatch++;
-          if (gUDSContext.receivedInBatch == 3) {
-            transmit_can_frame(&MG5_781_RQ_CONTINUE_MULTIFRAME);
-            gUDSContext.receivedInBatch = 0;
-          }
-
-          if (isUDSMessageComplete()) {
-            if (gUDSContext.UDS_moduleID == 0x59) {
-              const uint8_t* p = gUDSContext.UDS_buffer;
-              uint16_t len = gUDSContext.UDS_bytesReceived;
-
-              // 0: SID(0x59), 1: subfunc(0x02), 2: status availability mask
-              if (len >= 3 && p[0] == 0x59 && p[1] == 0x02) {
-                uint16_t off = 3;
-
-                logging.print("UDS DTC list (");
-                logging.print(len - off);
-                logging.println(" bytes of data)");
-
-                // entries are 3-byte DTC + 1-byte status
-                while (off + 4 <= len) {
-                  uint32_t dtc = (uint32_t(p[off]) << 16) | (uint32_t(p[off + 1]) << 8) | p[off + 2];
-                  uint8_t status = p[off + 3];
-
-                  print_formatted_dtc(dtc, status);
-                  off += 4;
-                }
-              }
-            }
-
-            // signal that UDS transaction is complete
-            uds_tx_in_flight = false;
-            userRequestReadDTC = false;
-
-            // ready for the next transaction
-            gUDSContext.UDS_inProgress = false;
-            gUDSContext.UDS_expectedLength = 0;
-            gUDSContext.UDS_bytesReceived = 0;
-          }
-          break;
-        }
-        case 0x3: {  // Flow Control from ECU (rare)
-          // optional: parse / ignore
-          break;
-        }
-      }
-    }
-
+    case 0x789:  // response from UDS diagnostic service (ISO-TP)
+      uds.handle_frame(rx_frame, millis());
+      break;
     default:
       break;
   }
@@ -680,43 +370,138 @@ void Mg5Battery::transmit_can(unsigned long currentMillis) {
     previousMillis2000 = currentMillis;
   }
 
-  if (uds_tx_in_flight == false) {     // No UDS transaction is in progress
-    if (userRequestReadDTC == true) {  // DTC requested by user
-      transmit_can_frame(&MG5_781_RQ_DTCs);
-      uds_tx_in_flight = true;                    //singal that a UDS transaction is in progress
-      uds_req_started_ms = currentMillis;         //timestamp when request was sent for timeout tracking
-      uds_timeout_ms = UDS_TIMEOUT_BEFORE_FF_MS;  //increase timeout for multi-frame response
-      logging.println("UDS DTC RQ sent");
+  uds.poll(currentMillis);
+  queue_uds_requests(currentMillis);
 
-    } else {
-      if (userRequestClearDTC == true) {  // Clear DTC requested by user
-        transmit_can_frame(&MG5_781_CLEAR_DTCs);
-        uds_tx_in_flight = true;                    //singal that a UDS transaction is in progress
-        uds_req_started_ms = currentMillis;         //timestamp when request was sent for timeout tracking
-        uds_timeout_ms = UDS_TIMEOUT_BEFORE_FF_MS;  //increase timeout for multi-frame response
-        logging.println("UDS Clear DTC RQ sent");
+#ifdef UDS_LOG
+  if (currentMillis - previousMillisUdsStats >= 60000) {
+    previousMillisUdsStats = currentMillis;
+    log_uds_poll_stats();
+  }
+#endif
+}
+
+void Mg5Battery::queue_uds_requests(unsigned long currentMillis) {
+  if (!uds.idle() || (long)(currentMillis - uds_resume_ms) < 0) {
+    return;
+  }
+
+  if (!extended_session) {
+    static const uint8_t session_control[] = {0x10, 0x03};
+    uds.request(session_control, sizeof(session_control), [this](const UdsClient::Response& response) {
+      if (response.result == UdsClient::Result::Positive) {
+        logging.println("entered extended diagnostic session");
+        extended_session = true;
+        uds_polls.restart();
       } else {
-        // Time to send next PID request, DTC has priority since it is slower
-        if (currentMillis - previousMillisPID >= UDS_PID_REFRESH_MS) {
-          previousMillisPID = currentMillis;
-          // normal single-frame poll round-robin
-          uds_slow_req_id_counter = increment_uds_req_id_counter(uds_slow_req_id_counter, numSlowUDSreqs);
-          transmit_can_frame(UDS_REQUESTS_SLOW[uds_slow_req_id_counter]);
-          uds_tx_in_flight = true;
-          uds_req_started_ms = currentMillis;
-          uds_timeout_ms = UDS_TIMEOUT_BEFORE_FF_MS;
-        }
+        log_uds_failure(response);
       }
+    });
+  } else if (userRequestReadDTC) {  // DTC requested by user, has priority over the DIDs
+    static const uint8_t read_dtcs[] = {0x19, 0x02, 0xFF};
+    uds.request(read_dtcs, sizeof(read_dtcs),
+                [this](const UdsClient::Response& response) { handle_dtc_response(response); });
+    logging.println("UDS DTC RQ sent");
+  } else if (userRequestClearDTC) {  // Clear DTC requested by user
+    static const uint8_t clear_dtcs[] = {0x14, 0xFF, 0xFF, 0xFF};
+    uds.request(clear_dtcs, sizeof(clear_dtcs), [this](const UdsClient::Response& response) {
+      if (response.result == UdsClient::Result::Positive) {
+        logging.println("UDS: positive response, ALL DTCs cleared");
+        userRequestClearDTC = false;
+      } else {
+        log_uds_failure(response);
+      }
+    });
+    logging.println("UDS Clear DTC RQ sent");
+  } else {
+    uds_polls.run(currentMillis);
+  }
+}
+
+void Mg5Battery::log_uds_failure(const UdsClient::Response& response) {
+  if (response.result == UdsClient::Result::Negative) {
+    logging.print("UDS negative response to 0x");
+    logging.print(response.service, HEX);
+    logging.print(": NRC=0x");
+    logging.print(response.nrc, HEX);
+    logging.println();
+    uds_resume_ms = millis() + UDS_RESPONSE_TIMEOUT_MS;  // Do not retry right away
+  } else if (response.result == UdsClient::Result::Timeout) {
+    // No answer, re-enter the extended session before anything else
+    uds.clear();
+    extended_session = false;
+    uds_resume_ms = millis();
+  }
+}
+
+#ifdef UDS_LOG
+// How often every polled DID really got refreshed, to tune UDS_POLLED_DIDS
+void Mg5Battery::log_uds_poll_stats() {
+  logging.printf("UDS polling, avg latency %u ms%s\n", (unsigned)uds_polls.average_latency_ms(),
+                 uds_polls.bus_busy() ? ", bus busy" : "");
+  for (uint8_t i = 0; i < uds_polls.size(); i++) {
+    const UdsPollScheduler::Stats& stats = uds_polls.stats(i);
+    logging.printf("  %04X: every %lu ms (target %u), latency %u ms, %lu ok, %u timeouts, %u NRC\n",
+                   (unsigned)stats.identifier, (unsigned long)stats.effective_period_ms,
+                   (unsigned)stats.target_period_ms, (unsigned)stats.latency_ms, (unsigned long)stats.responses,
+                   (unsigned)stats.timeouts, (unsigned)stats.negative_responses);
+  }
+}
+#endif
+
+void Mg5Battery::handle_dtc_response(const UdsClient::Response& response) {
+  if (response.result != UdsClient::Result::Positive) {
+    log_uds_failure(response);
+    if (response.result == UdsClient::Result::Negative) {
+      userRequestReadDTC = false;
+    }
+    return;
+  }
+
+  const uint8_t* p = response.data;
+  uint16_t len = response.length;
+
+  // 0: SID(0x59), 1: subfunc(0x02), 2: status availability mask
+  if (len >= 3 && p[1] == 0x02) {
+    uint16_t off = 3;
+
+    logging.print("UDS DTC list (");
+    logging.print(len - off);
+    logging.println(" bytes of data)");
+
+    // entries are 3-byte DTC + 1-byte status
+    while (off + 4 <= len) {
+      uint32_t dtc = (uint32_t(p[off]) << 16) | (uint32_t(p[off + 1]) << 8) | p[off + 2];
+      uint8_t status = p[off + 3];
+
+      print_formatted_dtc(dtc, status);
+      off += 4;
     }
-  } else {  // UDS transaction in progress
-    // Timeout / retry Session Control ------------------------------------
-    if ((currentMillis - uds_req_started_ms) > uds_timeout_ms) {
-      // re-enter Extended Session
-      transmit_can_frame(&MG5_781_ses_ctrl);
-      uds_tx_in_flight = true;
-      uds_req_started_ms = currentMillis;
-      uds_timeout_ms = UDS_TIMEOUT_BEFORE_FF_MS;
+  }
+  userRequestReadDTC = false;
+}
+
+// ReadDataByIdentifier response: 0x62, DID high, DID low, value...
+void Mg5Battery::handle_did_response(const UdsClient::Response& response) {
+  if (response.length < 4) {
+    return;
+  }
+
+  const uint8_t* value = &response.data[3];
+  uint16_t did = (response.data[1] << 8) | response.data[2];
+
+  switch (did) {
+    case 0xB061: {  // State of health, 0.01 %
+      if (response.length >= 5) {
+        datalayer.battery.status.soh_pptt = (value[0] << 8) | value[1];
+      }
+      break;
     }
+    default:
+      // Bus voltage (B041), resistance (B045), error (B047), BMS status (B048, see getBMStatus),
+      // relays B/G/P (B049/B04A/B052) and coolant temperature (B05C, -100 C offset)
+      // are read but not used yet, the scaling still needs to be checked
+      break;
   }
 }
 
@@ -730,9 +515,14 @@ void Mg5Battery::setup(void) {  // Performs one time setup at startup
   datalayer.battery.info.min_cell_voltage_mV = MIN_CELL_VOLTAGE_MV;
   datalayer.battery.info.total_capacity_Wh = TOTAL_BATTERY_CAPACITY_WH;
   datalayer.battery.info.number_of_cells = 96;
-  uds_tx_in_flight = true;                  // Make sure UDS doesn't start right away
-  uds_req_started_ms = millis();            // prevent immediate timeout
-  uds_timeout_ms = UDS_TIMEOUT_AFTER_BOOT;  // initial delay to restart UDS after boot-up
+  uds.transport().set_flow_control(3, 10);  // ECU may send 3 frames, 10 ms apart, before the next FC
+  uds.set_timeouts(UDS_RESPONSE_TIMEOUT_MS, 5000);
+  for (const PolledDid& polled : UDS_POLLED_DIDS) {
+    uds_polls.add(polled.did, polled.priority, polled.period_ms,
+                  [this](const UdsClient::Response& response) { handle_did_response(response); });
+  }
+  uds_polls.on_failure([this](uint16_t /*did*/, const UdsClient::Response& response) { log_uds_failure(response); });
+  uds_resume_ms = millis() + UDS_TIMEOUT_AFTER_BOOT;  // initial delay to start UDS after boot-up
 }
 
 #endif
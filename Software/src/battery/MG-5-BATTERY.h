@@ -1,6 +1,8 @@
 #ifndef MG_5_BATTERY_H
 #define MG_5_BATTERY_H
 
+#include "../communication/can/UdsClient.h"
+#include "../communication/can/UdsPollScheduler.h"
 #include "CanBattery.h"
 
 #ifndef SMALL_FLASH_DEVICE
@@ -8,15 +10,12 @@
 class Mg5Battery : public CanBattery {
  public:
   virtual void setup(void);
-  virtual void handle_incoming_can_frame(CAN_frame rx_frame);
+  virtual void handle_incoming_can_frame(const CAN_frame& rx_frame);
   virtual void update_values();
   virtual void update_soc(uint16_t soc_times_ten);
   virtual void transmit_can(unsigned long currentMillis);
   static constexpr const char* Name = "MG 5 battery";
-  void startUDSMultiFrameReception(uint16_t totalLength, uint8_t moduleID);
-  bool storeUDSPayload(const uint8_t* payload, uint8_t length);
   void buildMG5_8AFrame();
-  bool isUDSMessageComplete();
   virtual void print_formatted_dtc(uint32_t dtc24, uint8_t status);
   bool supports_contactor_close() { return true; }
   virtual bool supports_read_DTC() { return true; }
@@ -40,7 +39,6 @@ class Mg5Battery : public CanBattery {
   unsigned long previousMillis1000 = 0;
   unsigned long previousMillis2000 = 0;
   unsigned long previousMillisDTC = 0;
-  unsigned long previousMillisPID = 0;
 
   // For calculating charge and discharge power
   float RealVoltage;
@@ -67,185 +65,55 @@ class Mg5Battery : public CanBattery {
   const int StartDischargeTaper = 10;      // Battery percentage below which the discharge power will taper to zero
   const float DischargeTaperExponent = 1;  // Shape of discharge power taper to zero. 1 is linear. >1 red
 
-  // poll counters
-  int uds_slow_req_id_counter = -1;
-
   // rolling counter for 0x8A (0x10..0x1F pattern)
   uint8_t mg5_8a_counter = 0x10;
 
   // simple toggle to alternate 0x80/0x00 and 0x7F/0xFF (alive / redundancy style)
   bool mg5_8a_flip = false;
 
-  bool uds_tx_in_flight = false;
+  bool extended_session = false;  // Diagnostic session entered, DIDs can be read
   bool userRequestReadDTC = false;
   bool userRequestClearDTC = false;
   bool userRequestContactorClose = true;
   bool contactorClosed = false;
-  unsigned long uds_req_started_ms = 0;
-  unsigned long uds_timeout_ms = 0;
-  const unsigned long UDS_PID_REFRESH_MS = 500;         // inter-request gap
-  const unsigned long UDS_TIMEOUT_BEFORE_FF_MS = 1100;  // no reply yet
-  const unsigned long UDS_TIMEOUT_AFTER_FF_MS = 1100;   // multi-frame in progress
-  const unsigned long UDS_TIMEOUT_AFTER_BOOT = 2000;    // DELAY TO START UDS AFTER BOOT-UP
-  const unsigned long TESTER_PRESENT_PERIOD_MS = 1000;  // ~1 s
-
-  // A structure to keep track of the ongoing multi-frame UDS response
-  typedef struct {
-    bool UDS_inProgress;                // Are we currently receiving a multi-frame message?
-    uint16_t UDS_expectedLength;        // Expected total payload length
-    uint16_t UDS_bytesReceived;         // How many bytes have been stored so far
-    uint8_t UDS_moduleID;               // The "module" indicated by the first frame
-    uint8_t receivedInBatch;            // Number of CFs received in the current batch
-    uint8_t UDS_buffer[1024];           // Buffer for the reassembled data
-    unsigned long UDS_lastFrameMillis;  // Timestamp of last frame (for timeouts, if desired)
-  } UDS_RxContext;
-
-  // A single global UDS context, since only one module can respond at a time
-  UDS_RxContext gUDSContext;
-
-  //0x781 UDS diagnostic requests - Extended Session Control
-  CAN_frame MG5_781_ses_ctrl = {.FD = false,
-                                .ext_ID = false,
-                                .DLC = 8,
-                                .ID = 0x781,
-                                .data = {0x02, 0x10, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00}};
-
-  //0x781 UDS diagnostic requests - Session Response
-  CAN_frame MG5_781_ses_resp = {.FD = false,
-                                .ext_ID = false,
-                                .DLC = 8,
-                                .ID = 0x789,
-                                .data = {0x02, 0x50, 0x03, 0x00, 0x32, 0x01, 0xF4, 0x00}};
-
-  //0x781 UDS diagnostic requests - keep alive
-  CAN_frame MG5_781_keep_alive = {.FD = false,
-                                  .ext_ID = false,
-                                  .DLC = 8,
-                                  .ID = 0x781,
-                                  .data = {0x02, 0x3E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}};
-  //0x781 UDS diagnostic requests - keep alive
-  CAN_frame MG5_781_RQ_CONTINUE_MULTIFRAME = {.FD = false,
-                                              .ext_ID = false,
-                                              .DLC = 8,
-                                              .ID = 0x781,
-                                              .data = {0x30, 0x03, 0x0A, 0x00, 0x00, 0x00, 0x00, 0x00}};
-
-  //0x781 UDS diagnostic requests - request all DTC's
-  CAN_frame MG5_781_RQ_DTCs = {.FD = false,
-                               .ext_ID = false,
-                               .DLC = 8,
-                               .ID = 0x781,
-                               .data = {0x03, 0x19, 0x02, 0xFF, 0x00, 0x00, 0x00, 0x00}};
-
-  //0x781 UDS diagnostic requests - clear all DTC's
-  CAN_frame MG5_781_CLEAR_DTCs = {.FD = false,
-                                  .ext_ID = false,
-                                  .DLC = 8,
-                                  .ID = 0x781,
-                                  .data = {0x04, 0x14, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00}};
-
-  CAN_frame MG5_781_RQ_BUS_VOLTAGE = {.FD = false,
-                                      .ext_ID = false,
-                                      .DLC = 8,
-                                      .ID = 0x781,
-                                      .data = {0x03, 0x22, 0xB0, 0x41, 0x00, 0x00, 0x00, 0x00}};  //battery bus voltage
-
-  CAN_frame MG5_781_RQ_BAT_VOLTAGE = {.FD = false,
-                                      .ext_ID = false,
-                                      .DLC = 8,
-                                      .ID = 0x781,
-                                      .data = {0x03, 0x22, 0xB0, 0x42, 0x00, 0x00, 0x00, 0x00}};  //  Battery Voltage
-
-  CAN_frame MG5_781_RQ_BAT_CURRENT = {.FD = false,
-                                      .ext_ID = false,
-                                      .DLC = 8,
-                                      .ID = 0x781,
-                                      .data = {0x03, 0x22, 0xB0, 0x43, 0x00, 0x00, 0x00, 0x00}};  //  Current
-
-  CAN_frame MG5_781_RQ_BAT_RESISTANCE = {.FD = false,
-                                         .ext_ID = false,
-                                         .DLC = 8,
-                                         .ID = 0x781,
-                                         .data = {0x03, 0x22, 0xB0, 0x45, 0x00, 0x00, 0x00, 0x00}};  //  Resistance
-
-  CAN_frame MG5_781_RQ_BAT_SOC = {.FD = false,
-                                  .ext_ID = false,
-                                  .DLC = 8,
-                                  .ID = 0x781,
-                                  .data = {0x03, 0x22, 0xB0, 0x46, 0x00, 0x00, 0x00, 0x00}};  //  State of Charge
-
-  CAN_frame MG5_781_RQ_BMS_ERR = {.FD = false,
-                                  .ext_ID = false,
-                                  .DLC = 8,
-                                  .ID = 0x781,
-                                  .data = {0x03, 0x22, 0xB0, 0x47, 0x00, 0x00, 0x00, 0x00}};  //  BMS Error
+  unsigned long uds_resume_ms = 0;                      // No UDS requests before this time
+  const unsigned long UDS_RESPONSE_TIMEOUT_MS = 1100;    // no reply yet
+  const unsigned long UDS_TIMEOUT_AFTER_BOOT = 2000;     // DELAY TO START UDS AFTER BOOT-UP
 
-  CAN_frame MG5_781_RQ_BMS_STATE = {.FD = false,
-                                    .ext_ID = false,
-                                    .DLC = 8,
-                                    .ID = 0x781,
-                                    .data = {0x03, 0x22, 0xB0, 0x48, 0x00, 0x00, 0x00, 0x00}};  //  BMS Status
+  // UDS requests on 0x781, responses on 0x789
+  UdsClient uds{can_interface, 0x781, 0x789};
 
-  CAN_frame MG5_781_RQ_BAT_RELAY_B = {
-      .FD = false,
-      .ext_ID = false,
-      .DLC = 8,
-      .ID = 0x781,
-      .data = {0x03, 0x22, 0xB0, 0x49, 0x00, 0x00, 0x00, 0x00}};  //  Battery Relay Status
+  UdsPollScheduler uds_polls{uds, can_interface};
 
-  CAN_frame MG5_781_RQ_BAT_RELAY_G = {
-      .FD = false,
-      .ext_ID = false,
-      .DLC = 8,
-      .ID = 0x781,
-      .data = {0x03, 0x22, 0xB0, 0x4A, 0x00, 0x00, 0x00, 0x00}};  //  Battery Relay Status
-
-  CAN_frame MG5_781_RQ_BAT_RELAY_P = {
-      .FD = false,
-      .ext_ID = false,
-      .DLC = 8,
-      .ID = 0x781,
-      .data = {0x03, 0x22, 0xB0, 0x52, 0x00, 0x00, 0x00, 0x00}};  //  Battery Relay Status
-
-  CAN_frame MG5_781_RQ_BAT_TEMP = {
-      .FD = false,
-      .ext_ID = false,
-      .DLC = 8,
-      .ID = 0x781,
-      .data = {0x03, 0x22, 0xB0, 0x56, 0x00, 0x00, 0x00, 0x00}};  //  Battery Temperature Status
-
-  CAN_frame MG5_781_RQ_MAX_CELL = {.FD = false,
-                                   .ext_ID = false,
-                                   .DLC = 8,
-                                   .ID = 0x781,
-                                   .data = {0x03, 0x22, 0xB0, 0x58, 0x00, 0x00, 0x00, 0x00}};  //  MAX Cell Voltage
-
-  CAN_frame MG5_781_RQ_MIN_CELL = {.FD = false,
-                                   .ext_ID = false,
-                                   .DLC = 8,
-                                   .ID = 0x781,
-                                   .data = {0x03, 0x22, 0xB0, 0x59, 0x00, 0x00, 0x00, 0x00}};  //  MIN Cell Voltage
-
-  CAN_frame MG5_781_RQ_COOLANT_TEMP = {
-      .FD = false,
-      .ext_ID = false,
-      .DLC = 8,
-      .ID = 0x781,
-      .data = {0x03, 0x22, 0xB0, 0x5C, 0x00, 0x00, 0x00, 0x00}};  //  Coolant Temperature Status
+  struct PolledDid {
+    uint16_t did;
+    UdsPollScheduler::Priority priority;
+    uint16_t period_ms;
+  };
 
-  CAN_frame MG5_781_RQ_BAT_SOH = {
-      .FD = false,
-      .ext_ID = false,
-      .DLC = 8,
-      .ID = 0x781,
-      .data = {0x03, 0x22, 0xB0, 0x61, 0x00, 0x00, 0x00, 0x00}};  //  Battery State of Health
+  // ReadDataByIdentifier values polled from the BMS. Voltage, current and SoC (B042/B043/B046),
+  // max/min cell voltage (B058/B059) and battery temperature (B056) are not polled, the BMS
+  // already broadcasts them in 0x3AC, 0x173 and 0x2A2.
+  static constexpr PolledDid UDS_POLLED_DIDS[9] = {
+      {0xB047, UdsPollScheduler::Priority::Normal, 4000},  // BMS Error
+      {0xB048, UdsPollScheduler::Priority::Normal, 4000},  // BMS Status
+      {0xB041, UdsPollScheduler::Priority::Low, 10000},    // Battery bus voltage
+      {0xB045, UdsPollScheduler::Priority::Low, 10000},    // Resistance
+      {0xB049, UdsPollScheduler::Priority::Low, 10000},    // Battery Relay Status B
+      {0xB04A, UdsPollScheduler::Priority::Low, 10000},    // Battery Relay Status G
+      {0xB052, UdsPollScheduler::Priority::Low, 10000},    // Battery Relay Status P
+      {0xB05C, UdsPollScheduler::Priority::Low, 10000},    // Coolant Temperature Status
+      {0xB061, UdsPollScheduler::Priority::Low, 10000},    // Battery State of Health
+  };
 
-  CAN_frame MG5_781_RQ_BMS_TIME = {
-      .FD = false,
-      .ext_ID = false,
-      .DLC = 8,
-      .ID = 0x781,
-      .data = {0x03, 0x22, 0xB0, 0x6D, 0x00, 0x00, 0x00, 0x00}};  //  Battery Management System Time
+  void queue_uds_requests(unsigned long currentMillis);
+  void handle_did_response(const UdsClient::Response& response);
+  void handle_dtc_response(const UdsClient::Response& response);
+  void log_uds_failure(const UdsClient::Response& response);
+#ifdef UDS_LOG
+  void log_uds_poll_stats();
+  unsigned long previousMillisUdsStats = 0;
+#endif
 
   CAN_frame MG5_8A = {.FD = false,
                       .ext_ID = false,
@@ -259,32 +127,6 @@ class Mg5Battery : public CanBattery {
                        .ID = 0x1F1,
                        .data = {0x0E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}};
 
-  //Setup Fast UDS values to poll for
-  //CAN_frame* UDS_REQUESTS_FAST[0] = {};
-  //int numFastUDSreqs =
-  //    sizeof(UDS_REQUESTS_FAST) / sizeof(UDS_REQUESTS_FAST[0]);  //Store Number of elements in the array
-
-  //Setup Slow UDS values to poll for
-  CAN_frame* UDS_REQUESTS_SLOW[15] = {
-      &MG5_781_RQ_BUS_VOLTAGE, &MG5_781_RQ_BAT_VOLTAGE,  &MG5_781_RQ_BAT_CURRENT, &MG5_781_RQ_BAT_RESISTANCE,
-      &MG5_781_RQ_BAT_SOC,     &MG5_781_RQ_BMS_ERR,      &MG5_781_RQ_BMS_STATE,   &MG5_781_RQ_BAT_RELAY_B,
-      &MG5_781_RQ_BAT_RELAY_G, &MG5_781_RQ_BAT_RELAY_P,  &MG5_781_RQ_BAT_TEMP,    &MG5_781_RQ_MAX_CELL,
-      &MG5_781_RQ_MIN_CELL,    &MG5_781_RQ_COOLANT_TEMP, &MG5_781_RQ_BAT_SOH
-      //&MG5_781_RQ_DTCs
-  };
-  int numSlowUDSreqs =
-      sizeof(UDS_REQUESTS_SLOW) / sizeof(UDS_REQUESTS_SLOW[0]);  // Store Number of elements in the array
-
-  // tiny helper for cycling request indices
-  static int increment_uds_req_id_counter(int cur, int n) {
-    if (n <= 0)
-      return -1;
-    cur++;
-    if (cur >= n)
-      cur = 0;
-    return cur;
-  }
-
   //compute checksum for MG5 0x8A message
   uint8_t computeMG5_8AChecksum(const uint8_t* bytes7) const {
     uint8_t crc = 0;
@@ -2,10 +2,10 @@
 #include <cstring>  //For unit test
 #include "../charger/CHARGERS.h"
 #include "../charger/CanCharger.h"
+#include "../communication/can/CanCrc.h"
 #include "../communication/can/comm_can.h"
 #include "../datalayer/datalayer.h"
-#include "../datalayer/datalayer_extended.h"     //For "More battery info" webpage
-#include "../devboard/utils/common_functions.h"  //For CRC table
+#include "../datalayer/datalayer_extended.h"  //For "More battery info" webpage
 #include "../devboard/utils/events.h"
 #include "../devboard/utils/logging.h"
 
@@ -212,7 +212,7 @@ void NissanLeafBattery::
   }
 }
 
-void NissanLeafBattery::handle_incoming_can_frame(CAN_frame rx_frame) {
+void NissanLeafBattery::handle_incoming_can_frame(const CAN_frame& rx_frame) {
   switch (rx_frame.ID) {
     case 0x1DB:
       if (is_message_corrupt(rx_frame)) {
@@ -799,15 +799,11 @@ void NissanLeafBattery::transmit_can(unsigned long currentMillis) {
   }
 }
 
-uint8_t NissanLeafBattery::calculate_crc(CAN_frame& rx_frame) {
-  uint8_t crc = 0;
-  for (uint8_t j = 0; j < 7; j++) {
-    crc = crctable_nissan_leaf[(crc ^ static_cast<uint8_t>(rx_frame.data.u8[j])) % 256];
-  }
-  return crc;
+uint8_t NissanLeafBattery::calculate_crc(const CAN_frame& rx_frame) {
+  return FrameCrc<Crc8NissanLeaf, 7>::crc(rx_frame);
 }
 
-bool NissanLeafBattery::is_message_corrupt(CAN_frame rx_frame) {
+bool NissanLeafBattery::is_message_corrupt(const CAN_frame& rx_frame) {
   uint8_t crc = calculate_crc(rx_frame);
   return crc != rx_frame.data.u8[7];
 }
@@ -28,7 +28,7 @@ class NissanLeafBattery : public CanBattery {
   }
 
   virtual void setup(void);
-  virtual void handle_incoming_can_frame(CAN_frame rx_frame);
+  virtual void handle_incoming_can_frame(const CAN_frame& rx_frame);
   virtual void update_values();
   virtual void transmit_can(unsigned long currentMillis);
 
@@ -44,7 +44,7 @@ class NissanLeafBattery : public CanBattery {
   BatteryHtmlRenderer& get_status_renderer() { return renderer; }
   static constexpr const char* Name = "Nissan LEAF battery";
 
-  uint8_t calculate_crc(CAN_frame& frame);
+  uint8_t calculate_crc(const CAN_frame& frame);
 
  private:
   static const int MAX_PACK_VOLTAGE_DV = 4040;  //5000 = 500.0V
@@ -55,7 +55,7 @@ class NissanLeafBattery : public CanBattery {
 
   NissanLeafHtmlRenderer renderer;
 
-  bool is_message_corrupt(CAN_frame rx_frame);
+  bool is_message_corrupt(const CAN_frame& rx_frame);
   void clearSOH(void);
 
   DATALAYER_BATTERY_TYPE* datalayer_battery;
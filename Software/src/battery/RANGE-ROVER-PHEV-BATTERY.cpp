@@ -76,7 +76,7 @@ void RangeRoverPhevBattery::update_values() {
   datalayer.battery.info.min_design_voltage_dV = DischargeVoltageLimit * 10;
 }
 
-void RangeRoverPhevBattery::handle_incoming_can_frame(CAN_frame rx_frame) {
+void RangeRoverPhevBattery::handle_incoming_can_frame(const CAN_frame& rx_frame) {
   switch (rx_frame.ID) {
     case 0x080:  // 15ms
       StatusCAT5BPOChg = (rx_frame.data.u8[0] & 0x01);
@@ -1,6 +1,7 @@
 #ifndef RENAULT_ZOE_GEN1_BATTERY_H
 #define RENAULT_ZOE_GEN1_BATTERY_H
 
+#include "../communication/can/IsoTp.h"
 #include "../datalayer/datalayer.h"
 #include "../datalayer/datalayer_extended.h"
 #include "CanBattery.h"
@@ -26,7 +27,7 @@ class RenaultZoeGen1Battery : public CanBattery {
   }
 
   virtual void setup(void);
-  virtual void handle_incoming_can_frame(CAN_frame rx_frame);
+  virtual void handle_incoming_can_frame(const CAN_frame& rx_frame);
   virtual void update_values();
   virtual void transmit_can(unsigned long currentMillis);
   static constexpr const char* Name = "Renault Zoe Gen1 22/40kWh";
@@ -36,6 +37,8 @@ class RenaultZoeGen1Battery : public CanBattery {
  private:
   RenaultZoeGen1HtmlRenderer renderer;
 
+  void handle_group_response(const uint8_t* data, uint16_t length);
+
   static const int MAX_PACK_VOLTAGE_DV = 4040;  //5000 = 500.0V
   static const int MIN_PACK_VOLTAGE_DV = 3000;
   static const int MAX_CELL_DEVIATION_MV = 150;
@@ -57,16 +60,7 @@ class RenaultZoeGen1Battery : public CanBattery {
                        .DLC = 8,
                        .ID = 0x423,
                        .data = {0x07, 0x1d, 0x00, 0x02, 0x5d, 0x80, 0x5d, 0xc8}};
-  CAN_frame ZOE_POLL_79B = {.FD = false,
-                            .ext_ID = false,
-                            .DLC = 8,
-                            .ID = 0x79B,
-                            .data = {0x02, 0x21, 0x41, 0x00, 0x00, 0x00, 0x00, 0x00}};
-  CAN_frame ZOE_ACK_79B = {.FD = false,
-                           .ext_ID = false,
-                           .DLC = 8,
-                           .ID = 0x79B,
-                           .data = {0x30, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}};
+  IsoTpLink isotp{can_interface, 0x79B, 0x7BB, transmit_can_frame_to_interface};
 
 #define GROUP1_CELLVOLTAGES_1_POLL 0x41
 #define GROUP2_CELLVOLTAGES_2_POLL 0x42
@@ -98,29 +92,14 @@ class RenaultZoeGen1Battery : public CanBattery {
   uint8_t LB_HVBOT = 0;
   uint8_t LB_HVBOV = 0;
   uint8_t LB_COV = 0;
-  uint8_t frame0 = 0;
   uint8_t current_poll = 0;
-  uint8_t requested_poll = 0;
   uint8_t group = 0;
   uint16_t cellvoltages[96];
   uint32_t calculated_total_pack_voltage_mV = 370000;
-  uint8_t highbyte_cell_next_frame = 0;
   uint16_t SOC_polled = 5000;
-  int16_t cell_1_temperature_polled = 0;
-  int16_t cell_2_temperature_polled = 0;
-  int16_t cell_3_temperature_polled = 0;
-  int16_t cell_4_temperature_polled = 0;
-  int16_t cell_5_temperature_polled = 0;
-  int16_t cell_6_temperature_polled = 0;
-  int16_t cell_7_temperature_polled = 0;
-  int16_t cell_8_temperature_polled = 0;
-  int16_t cell_9_temperature_polled = 0;
-  int16_t cell_10_temperature_polled = 0;
-  int16_t cell_11_temperature_polled = 0;
-  int16_t cell_12_temperature_polled = 0;
+  int16_t cell_temperatures_polled[12] = {0};
   uint16_t battery_mileage_in_km = 0;
   uint16_t kWh_from_beginning_of_battery_life = 0;
-  bool looping_over_20 = false;
 };
 
 #endif
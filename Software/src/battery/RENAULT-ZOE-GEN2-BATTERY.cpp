@@ -1,9 +1,9 @@
 #include "RENAULT-ZOE-GEN2-BATTERY.h"
 #include <Arduino.h>
+#include "../communication/can/CanCrc.h"
 #include "../communication/can/comm_can.h"
 #include "../datalayer/datalayer.h"
-#include "../datalayer/datalayer_extended.h"     //For "More battery info" webpage
-#include "../devboard/utils/common_functions.h"  //For CRC table
+#include "../datalayer/datalayer_extended.h"  //For "More battery info" webpage
 #include "../devboard/utils/events.h"
 
 /* TODO
@@ -23,15 +23,11 @@ https://github.com/ljames28/Renault-Zoe-PH2-ZE50-Canbus-LBC-Information?tab=read
 https://github.com/fesch/CanZE/tree/master/app/src/main/assets/ZOE_Ph2
 */
 
-uint8_t RenaultZoeGen2Battery::calculate_crc_zoe(CAN_frame& rx_frame, uint8_t crc_xor) {
-  uint8_t crc = 0;  //init value 0x00
-  for (uint8_t j = 0; j < 7; j++) {
-    crc = crc8_table_SAE_J1850_ZER0[(crc ^ static_cast<uint8_t>(rx_frame.data.u8[j])) & 0xFF];
-  }
-  return crc ^ crc_xor;
+uint8_t RenaultZoeGen2Battery::calculate_crc_zoe(const CAN_frame& rx_frame, uint8_t crc_xor) {
+  return FrameCrc<Crc8J1850, 7>::crc(rx_frame) ^ crc_xor;
 }
 
-bool RenaultZoeGen2Battery::is_message_corrupt(CAN_frame rx_frame, uint8_t crc_xor) {
+bool RenaultZoeGen2Battery::is_message_corrupt(const CAN_frame& rx_frame, uint8_t crc_xor) {
   uint8_t crc = calculate_crc_zoe(rx_frame, crc_xor);
   return crc != rx_frame.data.u8[7];
 }
@@ -135,7 +131,7 @@ void RenaultZoeGen2Battery::update_values() {
   datalayer_extended.zoePH2.battery_soc_max = battery_soc_max;
 }
 
-void RenaultZoeGen2Battery::handle_incoming_can_frame(CAN_frame rx_frame) {
+void RenaultZoeGen2Battery::handle_incoming_can_frame(const CAN_frame& rx_frame) {
   switch (rx_frame.ID) {
     case 0x0F8:
       datalayer_battery->status.CAN_battery_still_alive = CAN_STILL_ALIVE;
@@ -208,193 +204,182 @@ void RenaultZoeGen2Battery::handle_incoming_can_frame(CAN_frame rx_frame) {
 
     case 0x18DAF1DB:  // LBC Reply from active polling
       datalayer_battery->status.CAN_battery_still_alive = CAN_STILL_ALIVE;
+      isotp.handle_frame(rx_frame, millis());
+      break;
+    default:
+      break;
+  }
+}
 
-      if (rx_frame.data.u8[0] == 0x10) {  //First frame of a group
-        transmit_can_frame(&ZOE_POLL_FLOW_CONTROL);
-        //frame 2 & 3 contains which PID is sent
-        reply_poll = (rx_frame.data.u8[3] << 8) | rx_frame.data.u8[4];
-      }
+// ReadDataByIdentifier response: 0x62, DID high, DID low, value...
+void RenaultZoeGen2Battery::handle_poll_response(const uint8_t* data, uint16_t length) {
+  if (length < 4 || data[0] != 0x62) {
+    return;
+  }
+  const uint8_t* value = &data[3];
+  uint16_t reply_poll = (data[1] << 8) | data[2];
 
-      if (rx_frame.data.u8[0] < 0x10) {  //One line responses
-        reply_poll = (rx_frame.data.u8[2] << 8) | rx_frame.data.u8[3];
+  switch (reply_poll) {
+    case POLL_SOC:
+      battery_soc = (value[0] << 8) | value[1];
+      break;
+    case POLL_USABLE_SOC:
+      battery_usable_soc = (value[0] << 8) | value[1];
+      break;
+    case POLL_SOH:
+      battery_soh = (value[0] << 8) | value[1];
+      break;
+    case POLL_PACK_VOLTAGE:
+      battery_pack_voltage_polled_dV = (value[0] << 8) | value[1];
+      break;
+    case POLL_MAX_CELL_VOLTAGE:
+      temporary_variable = (value[0] << 8) | value[1];
+      if (temporary_variable > 500) {  //Disregard messages with value unavailable
+        battery_max_cell_voltage_polled = (value[0] << 8) | value[1];
       }
-
-      switch (reply_poll) {
-        case POLL_SOC:
-          battery_soc = (rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5];
-          break;
-        case POLL_USABLE_SOC:
-          battery_usable_soc = (rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5];
-          break;
-        case POLL_SOH:
-          battery_soh = (rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5];
-          break;
-        case POLL_PACK_VOLTAGE:
-          battery_pack_voltage_polled_dV = (rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5];
-          break;
-        case POLL_MAX_CELL_VOLTAGE:
-          temporary_variable = (rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5];
-          if (temporary_variable > 500) {  //Disregard messages with value unavailable
-            battery_max_cell_voltage_polled = (rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5];
-          }
-          break;
-        case POLL_MIN_CELL_VOLTAGE:
-          temporary_variable = (rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5];
-          if (temporary_variable > 500) {  //Disregard messages with value unavailable
-            battery_min_cell_voltage_polled = (rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5];
-          }
-          break;
-        case POLL_12V:
-          battery_12v = ((rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5]) + 350;  //350, calibration from testing
-          break;
-        case POLL_AVG_TEMP:
-          battery_avg_temp = (rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5];
-          break;
-        case POLL_MIN_TEMP:
-          battery_min_temp = (rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5];
-          break;
-        case POLL_MAX_TEMP:
-          battery_max_temp = (rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5];
-          break;
-        case POLL_MAX_POWER:
-          battery_max_power = (rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5];
-          break;
-        case POLL_INTERLOCK:
-          battery_interlock_polled = (rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5];
-          break;
-        case POLL_KWH:
-          battery_kwh = (rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5];
-          break;
-        case POLL_CURRENT:
-          battery_current = (rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5];
-          break;
-        case POLL_CURRENT_OFFSET:
-          battery_current_offset = (rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5];
-          break;
-        case POLL_MAX_GENERATED:
-          battery_max_generated = (rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5];
-          break;
-        case POLL_MAX_AVAILABLE:
-          battery_max_available = (rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5];
-          break;
-        case POLL_CURRENT_VOLTAGE:
-          battery_current_voltage = (rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5];
-          break;
-        case POLL_CHARGING_STATUS:
-          battery_charging_status = (rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5];
-          break;
-        case POLL_REMAINING_CHARGE:
-          battery_remaining_charge = (rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5];
-          break;
-        case POLL_BALANCE_CAPACITY_TOTAL:
-          battery_balance_capacity_total = (rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5];
-          break;
-        case POLL_BALANCE_TIME_TOTAL:
-          battery_balance_time_total = (rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5];
-          break;
-        case POLL_BALANCE_CAPACITY_SLEEP:
-          battery_balance_capacity_sleep = (rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5];
-          break;
-        case POLL_BALANCE_TIME_SLEEP:
-          battery_balance_time_sleep = (rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5];
-          break;
-        case POLL_BALANCE_CAPACITY_WAKE:
-          battery_balance_capacity_wake = (rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5];
-          break;
-        case POLL_BALANCE_TIME_WAKE:
-          battery_balance_time_wake = (rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5];
-          break;
-        case POLL_BMS_STATE:
-          battery_bms_state = (rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5];
-          break;
-        case POLL_BALANCE_SWITCHES:
-          if (rx_frame.data.u8[0] == 0x23) {
-            for (int i = 0; i < 32; i++) {
-              datalayer_battery->status.cell_balancing_status[i] =
-                  (rx_frame.data.u8[4 + (i / 8)] >> (7 - (i % 8))) & 0x01;
-            }
-          }
-          if (rx_frame.data.u8[0] == 0x24) {
-            for (int i = 0; i < 56; i++) {
-              datalayer_battery->status.cell_balancing_status[32 + i] =
-                  (rx_frame.data.u8[1 + (i / 8)] >> (7 - (i % 8))) & 0x01;
-            }
-          }
-          if (rx_frame.data.u8[0] == 0x25) {
-            for (int i = 0; i < 8; i++) {
-              datalayer_battery->status.cell_balancing_status[88 + i] =
-                  (rx_frame.data.u8[1 + (i / 8)] >> (7 - (i % 8))) & 0x01;
-            }
-          }
-          break;
-        case POLL_ENERGY_COMPLETE:
-          battery_energy_complete = (rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5];
-          break;
-        case POLL_ENERGY_PARTIAL:
-          battery_energy_partial = (rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5];
-          break;
-        case POLL_SLAVE_FAILURES:
-          battery_slave_failures = ((rx_frame.data.u8[4] << 24) | (rx_frame.data.u8[5] << 16) |
-                                    (rx_frame.data.u8[6] << 8) | rx_frame.data.u8[7]);
-          break;
-        case POLL_MILEAGE:
-          battery_mileage = (rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5];
-          break;
-        case POLL_FAN_SPEED:
-          battery_fan_speed = (rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5];
-          break;
-        case POLL_FAN_PERIOD:
-          battery_fan_period = (rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5];
-          break;
-        case POLL_FAN_CONTROL:
-          battery_fan_control = (rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5];
-          break;
-        case POLL_FAN_DUTY:
-          battery_fan_duty = (rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5];
-          break;
-        case POLL_TEMPORISATION:
-          battery_temporisation = rx_frame.data.u8[4] >> 7;
-          break;
-        case POLL_TIME:
-          battery_time = (rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5];
-          break;
-        case POLL_PACK_TIME:
-          battery_pack_time = (rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5];
-          break;
-        case POLL_SOC_MIN:
-          battery_soc_min = (rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5];
-          break;
-        case POLL_SOC_MAX:
-          battery_soc_max = (rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5];
-          break;
-        default:
-          // Handle cell voltages
-          if (reply_poll >= POLL_CELL_0 && reply_poll <= POLL_CELL_95) {
-            int cell_index = reply_poll - POLL_CELL_0;
-
-            // Three offsets are skipped in the polling sequence, account for that.
-            if (reply_poll > POLL_CELL_30) {
-              cell_index -= 1;  // Account for missing 0x9040
-            }
-            if (reply_poll > POLL_CELL_61) {
-              cell_index -= 1;  // Account for missing 0x9060
-            }
-            if (reply_poll > POLL_CELL_92) {
-              cell_index -= 1;  // Account for missing 0x9080
-            }
-
-            datalayer_battery->status.cell_voltages_mV[cell_index] =
-                (uint16_t)(((rx_frame.data.u8[4] << 8) | rx_frame.data.u8[5]) * 0.976563);
-          }
-          break;
+      break;
+    case POLL_MIN_CELL_VOLTAGE:
+      temporary_variable = (value[0] << 8) | value[1];
+      if (temporary_variable > 500) {  //Disregard messages with value unavailable
+        battery_min_cell_voltage_polled = (value[0] << 8) | value[1];
       }
       break;
+    case POLL_12V:
+      battery_12v = ((value[0] << 8) | value[1]) + 350;  //350, calibration from testing
+      break;
+    case POLL_AVG_TEMP:
+      battery_avg_temp = (value[0] << 8) | value[1];
+      break;
+    case POLL_MIN_TEMP:
+      battery_min_temp = (value[0] << 8) | value[1];
+      break;
+    case POLL_MAX_TEMP:
+      battery_max_temp = (value[0] << 8) | value[1];
+      break;
+    case POLL_MAX_POWER:
+      battery_max_power = (value[0] << 8) | value[1];
+      break;
+    case POLL_INTERLOCK:
+      battery_interlock_polled = (value[0] << 8) | value[1];
+      break;
+    case POLL_KWH:
+      battery_kwh = (value[0] << 8) | value[1];
+      break;
+    case POLL_CURRENT:
+      battery_current = (value[0] << 8) | value[1];
+      break;
+    case POLL_CURRENT_OFFSET:
+      battery_current_offset = (value[0] << 8) | value[1];
+      break;
+    case POLL_MAX_GENERATED:
+      battery_max_generated = (value[0] << 8) | value[1];
+      break;
+    case POLL_MAX_AVAILABLE:
+      battery_max_available = (value[0] << 8) | value[1];
+      break;
+    case POLL_CURRENT_VOLTAGE:
+      battery_current_voltage = (value[0] << 8) | value[1];
+      break;
+    case POLL_CHARGING_STATUS:
+      battery_charging_status = (value[0] << 8) | value[1];
+      break;
+    case POLL_REMAINING_CHARGE:
+      battery_remaining_charge = (value[0] << 8) | value[1];
+      break;
+    case POLL_BALANCE_CAPACITY_TOTAL:
+      battery_balance_capacity_total = (value[0] << 8) | value[1];
+      break;
+    case POLL_BALANCE_TIME_TOTAL:
+      battery_balance_time_total = (value[0] << 8) | value[1];
+      break;
+    case POLL_BALANCE_CAPACITY_SLEEP:
+      battery_balance_capacity_sleep = (value[0] << 8) | value[1];
+      break;
+    case POLL_BALANCE_TIME_SLEEP:
+      battery_balance_time_sleep = (value[0] << 8) | value[1];
+      break;
+    case POLL_BALANCE_CAPACITY_WAKE:
+      battery_balance_capacity_wake = (value[0] << 8) | value[1];
+      break;
+    case POLL_BALANCE_TIME_WAKE:
+      battery_balance_time_wake = (value[0] << 8) | value[1];
+      break;
+    case POLL_BMS_STATE:
+      battery_bms_state = (value[0] << 8) | value[1];
+      break;
+    case POLL_BALANCE_SWITCHES:
+      if (length >= 35) {
+        for (int i = 0; i < 96; i++) {
+          datalayer_battery->status.cell_balancing_status[i] = (value[20 + (i / 8)] >> (7 - (i % 8))) & 0x01;
+        }
+      }
+      break;
+    case POLL_ENERGY_COMPLETE:
+      battery_energy_complete = (value[0] << 8) | value[1];
+      break;
+    case POLL_ENERGY_PARTIAL:
+      battery_energy_partial = (value[0] << 8) | value[1];
+      break;
+    case POLL_SLAVE_FAILURES:
+      if (length >= 7) {
+        battery_slave_failures = ((value[0] << 24) | (value[1] << 16) | (value[2] << 8) | value[3]);
+      }
+      break;
+    case POLL_MILEAGE:
+      battery_mileage = (value[0] << 8) | value[1];
+      break;
+    case POLL_FAN_SPEED:
+      battery_fan_speed = (value[0] << 8) | value[1];
+      break;
+    case POLL_FAN_PERIOD:
+      battery_fan_period = (value[0] << 8) | value[1];
+      break;
+    case POLL_FAN_CONTROL:
+      battery_fan_control = (value[0] << 8) | value[1];
+      break;
+    case POLL_FAN_DUTY:
+      battery_fan_duty = (value[0] << 8) | value[1];
+      break;
+    case POLL_TEMPORISATION:
+      battery_temporisation = value[0] >> 7;
+      break;
+    case POLL_TIME:
+      battery_time = (value[0] << 8) | value[1];
+      break;
+    case POLL_PACK_TIME:
+      battery_pack_time = (value[0] << 8) | value[1];
+      break;
+    case POLL_SOC_MIN:
+      battery_soc_min = (value[0] << 8) | value[1];
+      break;
+    case POLL_SOC_MAX:
+      battery_soc_max = (value[0] << 8) | value[1];
+      break;
     default:
+      // Handle cell voltages
+      if (reply_poll >= POLL_CELL_0 && reply_poll <= POLL_CELL_95) {
+        int cell_index = reply_poll - POLL_CELL_0;
+
+        // Three offsets are skipped in the polling sequence, account for that.
+        if (reply_poll > POLL_CELL_30) {
+          cell_index -= 1;  // Account for missing 0x9040
+        }
+        if (reply_poll > POLL_CELL_61) {
+          cell_index -= 1;  // Account for missing 0x9060
+        }
+        if (reply_poll > POLL_CELL_92) {
+          cell_index -= 1;  // Account for missing 0x9080
+        }
+
+        datalayer_battery->status.cell_voltages_mV[cell_index] = (uint16_t)(((value[0] << 8) | value[1]) * 0.976563);
+      }
       break;
   }
 }
 
 void RenaultZoeGen2Battery::transmit_can(unsigned long currentMillis) {
+  isotp.poll(currentMillis);
+
   if (datalayer_extended.zoePH2.UserRequestNVROLReset) {
     // Send NVROL reset frames
     transmit_reset_nvrol_frames();
@@ -436,14 +421,9 @@ void RenaultZoeGen2Battery::transmit_can(unsigned long currentMillis) {
   if ((currentMillis - previousMillis200 >= INTERVAL_200_MS) && !datalayer_extended.zoePH2.UserRequestNVROLReset) {
     previousMillis200 = currentMillis;
 
-    // Update current poll from the array
-    currentpoll = poll_commands[poll_index];
+    const uint8_t poll[] = {0x22, (uint8_t)(poll_commands[poll_index] >> 8), (uint8_t)poll_commands[poll_index]};
+    isotp.send(poll, sizeof(poll), currentMillis);
     poll_index = (poll_index + 1) % 163;
-
-    ZOE_POLL_18DADBF1.data.u8[2] = (uint8_t)((currentpoll & 0xFF00) >> 8);
-    ZOE_POLL_18DADBF1.data.u8[3] = (uint8_t)(currentpoll & 0x00FF);
-
-    transmit_can_frame(&ZOE_POLL_18DADBF1);
   }
 
   if (currentMillis - previousMillis1000 >= INTERVAL_1_S) {
@@ -468,6 +448,7 @@ void RenaultZoeGen2Battery::setup(void) {  // Performs one time setup at startup
   datalayer_battery->info.max_cell_voltage_mV = MAX_CELL_VOLTAGE_MV;
   datalayer_battery->info.min_cell_voltage_mV = MIN_CELL_VOLTAGE_MV;
   datalayer_battery->info.max_cell_voltage_deviation_mV = MAX_CELL_DEVIATION_MV;
+  isotp.on_receive([this](const uint8_t* data, uint16_t length) { handle_poll_response(data, length); });
 }
 
 void RenaultZoeGen2Battery::transmit_can_frame_376(void) {
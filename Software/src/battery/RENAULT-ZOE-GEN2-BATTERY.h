@@ -1,6 +1,7 @@
 #ifndef RENAULT_ZOE_GEN2_BATTERY_H
 #define RENAULT_ZOE_GEN2_BATTERY_H
 
+#include "../communication/can/IsoTp.h"
 #include "CanBattery.h"
 #include "RENAULT-ZOE-GEN2-HTML.h"
 
@@ -24,7 +25,7 @@ class RenaultZoeGen2Battery : public CanBattery {
     datalayer_zoePH2 = &datalayer_extended.zoePH2;
   }
   virtual void setup(void);
-  virtual void handle_incoming_can_frame(CAN_frame rx_frame);
+  virtual void handle_incoming_can_frame(const CAN_frame& rx_frame);
   virtual void update_values();
   virtual void transmit_can(unsigned long currentMillis);
   static constexpr const char* Name = "Renault Zoe Gen2 50kWh";
@@ -35,7 +36,7 @@ class RenaultZoeGen2Battery : public CanBattery {
 
   BatteryHtmlRenderer& get_status_renderer() { return renderer; }
 
-  uint8_t calculate_crc_zoe(CAN_frame& frame, uint8_t crc_xor);
+  uint8_t calculate_crc_zoe(const CAN_frame& frame, uint8_t crc_xor);
 
  private:
   RenaultZoeGen2HtmlRenderer renderer;
@@ -46,7 +47,8 @@ class RenaultZoeGen2Battery : public CanBattery {
   // If not null, this battery decides when the contactor can be closed and writes the value here.
   bool* allows_contactor_closing;
 
-  bool is_message_corrupt(CAN_frame rx_frame, uint8_t crc_xor);
+  bool is_message_corrupt(const CAN_frame& rx_frame, uint8_t crc_xor);
+  void handle_poll_response(const uint8_t* data, uint16_t length);
 
   static const int MAX_PACK_VOLTAGE_DV = 4100;  //5000 = 500.0V
   static const int MIN_PACK_VOLTAGE_DV = 3000;
@@ -287,11 +289,8 @@ class RenaultZoeGen2Battery : public CanBattery {
                                  .DLC = 8,
                                  .ID = 0x18DADBF1,
                                  .data = {0x03, 0x22, 0x90, 0x00, 0x00, 0x00, 0x00, 0x00}};
-  CAN_frame ZOE_POLL_FLOW_CONTROL = {.FD = false,
-                                     .ext_ID = true,
-                                     .DLC = 8,
-                                     .ID = 0x18DADBF1,
-                                     .data = {0x30, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}};
+  // One DID from poll_commands every 200 ms, the LBC answers on 0x18DAF1DB
+  IsoTpLink isotp{can_interface, 0x18DADBF1, 0x18DAF1DB, transmit_can_frame_to_interface};
   //NVROL Reset
   CAN_frame ZOE_NVROL_1_18DADBF1 = {.FD = false,
                                     .ext_ID = true,
@@ -480,8 +479,6 @@ class RenaultZoeGen2Battery : public CanBattery {
                                        POLL_CELL_95};
   uint8_t counter_373 = 0;
   uint8_t poll_index = 0;
-  uint16_t currentpoll = POLL_SOC;
-  uint16_t reply_poll = 0;
   uint8_t counter_10ms = 0;
   unsigned long previousMillis10 = 0;    // will store last time a 10ms CAN Message was sent
   unsigned long previousMillis100 = 0;   // will store last time a 100ms CAN Message was sent
@@ -1,10 +1,10 @@
 #include "RIVIAN-BATTERY.h"
 
 #include "../battery/BATTERIES.h"
+#include "../communication/can/CanCrc.h"
 #include "../communication/can/comm_can.h"
 #include "../datalayer/datalayer.h"
-#include "../datalayer/datalayer_extended.h"     //For Advanced Battery Insights webpage
-#include "../devboard/utils/common_functions.h"  //For CRC table
+#include "../datalayer/datalayer_extended.h"  //For Advanced Battery Insights webpage
 #include "../devboard/utils/events.h"
 
 /*
@@ -15,14 +15,8 @@ The battery has 3x CAN channels
 - Battery CAN (500kbps) lots of content, not required for operation 
 */
 
-uint8_t RivianBattery::calculateCRC(CAN_frame rx_frame, uint8_t length, uint8_t initial_value) {
-  uint8_t crc = initial_value;
-  for (uint8_t j = 1; j < length; j++) {  //start at 1, since 0 is the CRC
-    crc = crc8_table_SAE_J1850_ZER0[(crc ^ static_cast<uint8_t>(rx_frame.data.u8[j])) % 256];
-  }
-  crc ^= 0xFF;
-  return crc;
-}
+// SAE J1850 CRC in byte 0 over the rest of the frame, start value per message
+typedef FrameCrc<Crc8<0x1D, 0x00, 0xFF>, 0> ProtectedFrame;
 
 void RivianBattery::update_values() {
 
@@ -75,7 +69,7 @@ void RivianBattery::update_values() {
   datalayer_extended.rivian.operation_limit_violation_warning = operation_limit_violation_warning;
 }
 
-void RivianBattery::handle_incoming_can_frame(CAN_frame rx_frame) {
+void RivianBattery::handle_incoming_can_frame(const CAN_frame& rx_frame) {
   switch (rx_frame.ID) {
     case 0x00A:  //DCDC status [Platform CAN]+ 20ms
       datalayer.battery.status.CAN_battery_still_alive = CAN_STILL_ALIVE;
@@ -103,7 +97,7 @@ void RivianBattery::handle_incoming_can_frame(CAN_frame rx_frame) {
       break;
     case 0x1E3:  //HMI [Platform CAN]+
       datalayer.battery.status.CAN_battery_still_alive = CAN_STILL_ALIVE;
-      if (rx_frame.data.u8[0] != calculateCRC(rx_frame, 3, 0xEC)) {
+      if (!ProtectedFrame::valid(rx_frame, 3, 0xEC)) {
         datalayer.battery.status.CAN_error_counter++;
         break;
       }
@@ -131,7 +125,7 @@ void RivianBattery::handle_incoming_can_frame(CAN_frame rx_frame) {
       break;
     case 0x154:  //Status flags [Platform CAN]+
       datalayer.battery.status.CAN_battery_still_alive = CAN_STILL_ALIVE;
-      if (rx_frame.data.u8[0] != calculateCRC(rx_frame, 8, 0xFD)) {
+      if (!ProtectedFrame::valid(rx_frame, 8, 0xFD)) {
         datalayer.battery.status.CAN_error_counter++;
         break;
       }
@@ -37,7 +37,7 @@ void SimpBmsBattery::update_values() {
   datalayer.battery.info.number_of_cells = cells_in_series;
 }
 
-void SimpBmsBattery::handle_incoming_can_frame(CAN_frame rx_frame) {
+void SimpBmsBattery::handle_incoming_can_frame(const CAN_frame& rx_frame) {
   switch (rx_frame.ID) {
     case 0x355:
       datalayer.battery.status.CAN_battery_still_alive = CAN_STILL_ALIVE;
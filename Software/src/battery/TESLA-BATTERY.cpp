@@ -1,5 +1,7 @@
 #include "TESLA-BATTERY.h"
 #include <cstring>  //For unit test
+#include "../communication/can/CanCrc.h"
+#include "../communication/can/CanSignal.h"
 #include "../communication/can/comm_can.h"
 #include "../datalayer/datalayer.h"
 #include "../datalayer/datalayer_extended.h"  //For Advanced Battery Insights webpage
@@ -143,187 +145,40 @@ inline int getDataLen(uint8_t dlc) {
   return std::min<int>(dlc, 8);
 }
 
-// Fast bit‐field writer: writes 'bitLen' bits of 'value' starting at 'startBit'
-inline void setBitField(uint8_t* data, int bytes, int startBit, int bitLen, uint64_t value) {
-  int bit = startBit;
-  for (int i = 0; i < bitLen && bit < bytes * 8; ++i, ++bit) {
-    uint8_t* p = data + (bit >> 3);
-    uint8_t m = uint8_t(1u << (bit & 7));
-    *p = (*p & ~m) | (uint8_t((value >> i) & 1) << (bit & 7));
-  }
-}
-
-/// Increment a counter field and recompute an 8‑bit checksum as part of a mux
-void generateMuxFrameCounterChecksum(CAN_frame& f,
-                                     uint8_t frameCounter,  // counter value
-                                     int ctrStartBit,       // bit index of counter LSB
-                                     int ctrBitLength,      // width of counter in bits
-                                     int csumStartBit,      // bit index of checksum LSB
-                                     int csumBitLength      // width of checksum in bits
-) {
-  int bytes = getDataLen(f.DLC);
-  auto data = f.data.u8;
-
-  // Pack payload into a 64‑bit word
-  uint64_t w = 0;
-  for (uint8_t i = 0; i < bytes; ++i) {
-    w |= uint64_t(data[i]) << (8 * i);
-  }
-
-  // Increment the counter
-  {
-    uint64_t mask = (uint64_t(1) << ctrBitLength) - 1;
-    uint64_t ctr = frameCounter & mask;  // External counter 0-15
-    w = (w & ~(mask << ctrStartBit)) | (ctr << ctrStartBit);
-  }
-
-  // Unpack back into the frame bytes
-  for (uint8_t i = 0; i < bytes; ++i) {
-    data[i] = uint8_t((w >> (8 * i)) & 0xFF);
-  }
+// Checksum of Tesla frames: low byte of the ID, plus its most significant hex digit, plus all
+// data bytes with the checksum field itself counted as zero
+template <uint16_t CsumStartBit, uint8_t CsumBitLength>
+void writeFrameChecksum(CAN_frame& f) {
+  typedef CanSignal<CsumStartBit, CsumBitLength> Checksum;
+  Checksum::encode(f, 0);
 
-  // Build a small buffer and zero out the checksum bits
-  uint8_t buf[8];
-  for (uint8_t i = 0; i < bytes; ++i) {
-    buf[i] = data[i];
-  }
-  for (int bit = csumStartBit; bit < csumStartBit + csumBitLength; ++bit) {
-    int b = bit >> 3;
-    if (b >= bytes)
-      break;
-    buf[b] &= uint8_t(~(1u << (bit & 7)));
-  }
-
-  // Compute checksum offset from most significant hex digit of CAN ID
-  uint8_t checksum_offset = uint8_t((f.ID >> 8) & 0xF);  // high nibble of top byte
-
-  // Sum the low byte of ID + buf[]
-  uint8_t sum = uint8_t(f.ID & 0xFF);
-  for (int i = 0; i < bytes; ++i) {
-    sum = uint8_t(sum + buf[i]);
-  }
-  uint8_t checksum = uint8_t(sum + checksum_offset);
+  uint8_t sum = Checksum8::compute(f.data.u8, getDataLen(f.DLC), uint8_t((f.ID & 0xFF) + ((f.ID >> 8) & 0xF)));
+  Checksum::encode(f, sum & Checksum::mask);
+}
 
-  // Write the checksum back into the frame
-  setBitField(data, bytes, csumStartBit, csumBitLength, checksum);
+/// Set a counter field and recompute an 8‑bit checksum as part of a mux
+template <uint16_t CtrStartBit,   // bit index of counter LSB
+          uint8_t CtrBitLength,   // width of counter in bits
+          uint16_t CsumStartBit,  // bit index of checksum LSB
+          uint8_t CsumBitLength   // width of checksum in bits
+          >
+void generateMuxFrameCounterChecksum(CAN_frame& f, uint8_t frameCounter) {
+  typedef CanSignal<CtrStartBit, CtrBitLength> Counter;
+  Counter::encode(f, frameCounter & Counter::mask);  // External counter 0-15
+  writeFrameChecksum<CsumStartBit, CsumBitLength>(f);
 }
 
 // Increment a counter field and recompute an 8‑bit checksum
-void generateFrameCounterChecksum(CAN_frame& f,
-                                  int ctrStartBit,   // bit index of counter LSB
-                                  int ctrBitLength,  // width of counter in bits
-                                  int csumStartBit,  // bit index of checksum LSB
-                                  int csumBitLength  // width of checksum in bits
-) {
-  int bytes = getDataLen(f.DLC);
-  auto data = f.data.u8;
-
-  // Pack payload into a 64‑bit word
-  uint64_t w = 0;
-  for (int i = 0; i < bytes; ++i) {
-    w |= uint64_t(data[i]) << (8 * i);
-  }
-
+template <uint16_t CtrStartBit,   // bit index of counter LSB
+          uint8_t CtrBitLength,   // width of counter in bits
+          uint16_t CsumStartBit,  // bit index of checksum LSB
+          uint8_t CsumBitLength   // width of checksum in bits
+          >
+void generateFrameCounterChecksum(CAN_frame& f) {
+  typedef CanSignal<CtrStartBit, CtrBitLength> Counter;
   // Increment the counter by +1 modulo its width
-  {
-    uint64_t mask = (uint64_t(1) << ctrBitLength) - 1;
-    uint64_t ctr = ((w >> ctrStartBit) & mask) + 1;
-    ctr &= mask;
-    w = (w & ~(mask << ctrStartBit)) | (ctr << ctrStartBit);
-  }
-
-  // Unpack back into the frame bytes
-  for (int i = 0; i < bytes; ++i) {
-    data[i] = uint8_t((w >> (8 * i)) & 0xFF);
-  }
-
-  // Build a small buffer and zero out the checksum bits
-  uint8_t buf[8];
-  for (int i = 0; i < bytes; ++i) {
-    buf[i] = data[i];
-  }
-  for (int bit = csumStartBit; bit < csumStartBit + csumBitLength; ++bit) {
-    int b = bit >> 3;
-    if (b >= bytes)
-      break;
-    buf[b] &= uint8_t(~(1u << (bit & 7)));
-  }
-
-  // Compute checksum offset from most significant hex digit of CAN ID
-  uint8_t checksum_offset = uint8_t((f.ID >> 8) & 0xF);  // high nibble of top byte
-
-  // Sum the low byte of ID + buf[]
-  uint8_t sum = uint8_t(f.ID & 0xFF);
-  for (int i = 0; i < bytes; ++i) {
-    sum = uint8_t(sum + buf[i]);
-  }
-  uint8_t checksum = uint8_t(sum + checksum_offset);
-
-  // Write the checksum back into the frame
-  setBitField(data, bytes, csumStartBit, csumBitLength, checksum);
-}
-
-// Function to extract raw bits/values from a given CAN frame signal
-inline uint64_t extract_signal_value(const uint8_t* data, uint32_t start_bit, uint32_t bit_length) {
-  //
-  // Usage: uint8_t bms_state = static_cast<uint8_t>(extract_signal_value(rx_frame.data.u8, 31, 4));
-  //
-  // Calculate the starting byte and bit offset
-  uint32_t byte_index = start_bit / 8;
-  uint32_t bit_offset = start_bit % 8;
-
-  // Read up to 8 bytes starting from byte_index (need enough to cover bit_length + bit_offset)
-  uint64_t raw = 0;
-  for (int i = 0; i < 8 && (byte_index + i) < 64; ++i) {
-    raw |= (uint64_t)data[byte_index + i] << (8 * i);
-  }
-
-  // Shift and mask
-  raw >>= bit_offset;
-  if (bit_length == 64)
-    return raw;
-  return raw & ((1ULL << bit_length) - 1);
-}
-
-// Function to write a value to a given CAN frame signal
-void write_signal_value(CAN_frame* frame, uint16_t start_bit, uint8_t bit_length, int64_t value, bool is_signed) {
-  if (bit_length == 0 || bit_length > 64 || frame == nullptr)
-    return;
-
-  uint64_t uvalue;
-
-  if (is_signed) {
-    int64_t min_val = -(1LL << (bit_length - 1));
-    int64_t max_val = (1LL << (bit_length - 1)) - 1;
-
-    // Clamp to valid range
-    if (value < min_val)
-      value = min_val;
-    if (value > max_val)
-      value = max_val;
-
-    // Two's complement encoding
-    uvalue = static_cast<uint64_t>(value) & ((1ULL << bit_length) - 1);
-  } else {
-    uvalue = static_cast<uint64_t>(value) & ((1ULL << bit_length) - 1);
-  }
-
-  // Write value into frame->data.u8 using little-endian bit layout
-  for (uint8_t i = 0; i < bit_length; ++i) {
-    uint8_t bit_val = (uvalue >> i) & 1;
-    uint16_t bit_pos = start_bit + i;
-
-    uint8_t byte_index = bit_pos / 8;
-    uint8_t bit_index = bit_pos % 8;
-
-    if (byte_index >= frame->DLC)
-      continue;  // Prevent overrun
-
-    if (bit_val)
-      frame->data.u8[byte_index] |= (1 << bit_index);
-    else
-      frame->data.u8[byte_index] &= ~(1 << bit_index);
-  }
+  Counter::encode(f, (Counter::decode(f) + 1) & Counter::mask);
+  writeFrameChecksum<CsumStartBit, CsumBitLength>(f);
 }
 
 void generateTESLA_229(CAN_frame& f) {
@@ -334,36 +189,15 @@ void generateTESLA_229(CAN_frame& f) {
   if (f.ID != 0x229)
     return;
 
-  const int ctrStartBit = 8;
-  const int ctrBitLength = 4;
-  const int csumStartBit = 0;
-  const int csumBitLength = 8;
-
-  int bytes = getDataLen(f.DLC);
-  auto data = f.data.u8;
-
-  // Pack the first few bytes into a word
-  uint64_t w = 0;
-  for (int i = 0; i < bytes; ++i) {
-    w |= uint64_t(data[i]) << (8 * i);
-  }
-
-  // Extract current counter
-  uint64_t mask = (uint64_t(1) << ctrBitLength) - 1;
-  uint8_t ctr = (w >> ctrStartBit) & mask;
+  typedef CanSignal<8, 4> Counter;
+  typedef CanSignal<0, 8> Checksum;
 
   // Increment counter mod 16
-  ctr = (ctr + 1) & 0xF;
-
-  // Write updated counter back
-  w = (w & ~(mask << ctrStartBit)) | (uint64_t(ctr) << ctrStartBit);
-  for (int i = 0; i < bytes; ++i) {
-    data[i] = uint8_t((w >> (8 * i)) & 0xFF);
-  }
+  uint8_t ctr = (Counter::decode(f) + 1) & 0xF;
+  Counter::encode(f, ctr);
 
   // Look up and insert checksum
-  uint8_t checksum = checksumLookup[ctr];
-  setBitField(data, bytes, csumStartBit, csumBitLength, checksum);
+  Checksum::encode(f, checksumLookup[ctr]);
 }
 
 void generateTESLA_213(CAN_frame& f) {
@@ -609,7 +443,7 @@ void TeslaBattery::
 
   //Update 0x333 UI_chargeTerminationPct (bit 16, width 10) value to SOC max value - expose via UI?
   //One firmware version this was seen at bit 17 width 11
-  write_signal_value(&TESLA_333, 16, 10, static_cast<int64_t>(datalayer.battery.settings.max_percentage / 10), false);
+  CanSignal<16, 10>::encode(TESLA_333, datalayer.battery.settings.max_percentage / 10);
 
   // Update webserver datalayer
   //datalayer_extended.tesla.BMS_hvilFault = BMS_a036_SW_HvpHvilFault;
@@ -885,7 +719,13 @@ void TeslaBattery::
                  (battery_dcdcLvBusVolt * 0.0390625), (battery_dcdcLvOutputCurrent * 0.1));
 }
 
-void TeslaBattery::handle_incoming_can_frame(CAN_frame rx_frame) {
+std::vector<uint32_t> TeslaBattery::accepted_can_ids() {
+  return {
+      0x132, 0x20A, 0x212, 0x224, 0x252, 0x292, 0x2A4, 0x2B4, 0x2C4, 0x2D2, 0x300, 0x310, 0x312, 0x320, 0x332, 0x352,
+      0x392, 0x3AA, 0x3C4, 0x3D2, 0x401, 0x612, 0x72A, 0x7AA};
+}
+
+void TeslaBattery::handle_incoming_can_frame(const CAN_frame& rx_frame) {
   static uint8_t mux = 0;
   static uint16_t temp = 0;
   static bool mux0_read = false;
@@ -993,7 +833,7 @@ void TeslaBattery::handle_incoming_can_frame(CAN_frame rx_frame) {
       //BMS_state = // Original code from older DBCs
       //((rx_frame.data.u8[1] >> 3) &
       //(0x0FU));  //0 "STANDBY" 1 "DRIVE" 2 "SUPPORT" 3 "CHARGE" 4 "FEIM" 5 "CLEAR_FAULT" 6 "FAULT" 7 "WELD" 8 "TEST" 9 "SNA" ;
-      BMS_state = static_cast<uint8_t>(extract_signal_value(rx_frame.data.u8, 31, 4));
+      BMS_state = static_cast<uint8_t>(CanSignal<31, 4>::decode(rx_frame));
       //0 "STANDBY" 1 "DRIVE" 2 "SUPPORT" 3 "CHARGE" 4 "FEIM" 5 "CLEAR_FAULT" 6 "FAULT" 7 "WELD" 8 "TEST" 9 "SNA" 10 "BMS_DIAG";
       BMS_hvState = (rx_frame.data.u8[2] & (0x07U));
       //0 "DOWN" 1 "COMING_UP" 2 "GOING_DOWN" 3 "UP_FOR_DRIVE" 4 "UP_FOR_CHARGE" 5 "UP_FOR_DC_CHARGE" 6 "UP" ;
@@ -1001,9 +841,9 @@ void TeslaBattery::handle_incoming_can_frame(CAN_frame rx_frame) {
           ((rx_frame.data.u8[3] & (0x1FU)) << 5) |
           ((rx_frame.data.u8[2] >> 3) & (0x1FU));  //19|10@1+ (10,0) [0|0] "kOhm"/to datalayer_extended
       //BMS_chargeRequest = ((rx_frame.data.u8[3] >> 5) & (0x01U));
-      BMS_chargeRequest = static_cast<bool>(extract_signal_value(rx_frame.data.u8, 29, 1));
+      BMS_chargeRequest = static_cast<bool>(CanSignal<29, 1>::decode(rx_frame));
       BMS_keepWarmRequest = ((rx_frame.data.u8[3] >> 6) & (0x01U));
-      BMS_uiChargeStatus = static_cast<uint8_t>(extract_signal_value(rx_frame.data.u8, 32, 3));
+      BMS_uiChargeStatus = static_cast<uint8_t>(CanSignal<32, 3>::decode(rx_frame));
       //BMS_uiChargeStatus =
       //(rx_frame.data.u8[4] &
       //(0x07U));
@@ -1624,32 +1464,32 @@ void TeslaBattery::handle_incoming_can_frame(CAN_frame rx_frame) {
       //Display internal BMS info and other build/version data
       if (rx_frame.data.u8[0] == 0x0A) {  // Mux 10: BUILD_HWID_COMPONENTID
         if (BMS_info_buildConfigId == 0) {
-          BMS_info_buildConfigId = static_cast<uint16_t>(extract_signal_value(rx_frame.data.u8, 16, 16));
+          BMS_info_buildConfigId = static_cast<uint16_t>(CanSignal<16, 16>::decode(rx_frame));
         }
         if (BMS_info_hardwareId == 0) {
-          BMS_info_hardwareId = static_cast<uint16_t>(extract_signal_value(rx_frame.data.u8, 32, 16));
+          BMS_info_hardwareId = static_cast<uint16_t>(CanSignal<32, 16>::decode(rx_frame));
         }
         if (BMS_info_componentId == 0) {
-          BMS_info_componentId = static_cast<uint16_t>(extract_signal_value(rx_frame.data.u8, 48, 16));
+          BMS_info_componentId = static_cast<uint16_t>(CanSignal<48, 16>::decode(rx_frame));
         }
       }
       /*
       if (rx_frame.data.u8[0] == 0x0B) { // Mux 11: PCBAID_ASSYID_USAGEID
-        if (BMS_info_pcbaId == 0) {BMS_info_pcbaId = static_cast<uint8_t>(extract_signal_value(rx_frame.data.u8, 16, 8));}
-        if (BMS_info_assemblyId == 0) {BMS_info_assemblyId = static_cast<uint8_t>(extract_signal_value(rx_frame.data.u8, 24, 8));}
-        if (BMS_info_usageId == 0) {BMS_info_usageId = static_cast<uint16_t>(extract_signal_value(rx_frame.data.u8, 32, 16));}
-        if (BMS_info_subUsageId == 0) {BMS_info_subUsageId = static_cast<uint16_t>(extract_signal_value(rx_frame.data.u8, 48, 16));}
+        if (BMS_info_pcbaId == 0) {BMS_info_pcbaId = static_cast<uint8_t>(CanSignal<16, 8>::decode(rx_frame));}
+        if (BMS_info_assemblyId == 0) {BMS_info_assemblyId = static_cast<uint8_t>(CanSignal<24, 8>::decode(rx_frame));}
+        if (BMS_info_usageId == 0) {BMS_info_usageId = static_cast<uint16_t>(CanSignal<32, 16>::decode(rx_frame));}
+        if (BMS_info_subUsageId == 0) {BMS_info_subUsageId = static_cast<uint16_t>(CanSignal<48, 16>::decode(rx_frame));}
       }
       if (rx_frame.data.u8[0] == 0x0D) { // Mux 13: APP_CRC
-        if (BMS_info_platformType == 0) {BMS_info_platformType = static_cast<uint8_t>(extract_signal_value(rx_frame.data.u8, 8, 8));}
-        if (BMS_info_appCrc == 0) {BMS_info_appCrc = static_cast<uint32_t>(extract_signal_value(rx_frame.data.u8, 32, 32));}
+        if (BMS_info_platformType == 0) {BMS_info_platformType = static_cast<uint8_t>(CanSignal<8, 8>::decode(rx_frame));}
+        if (BMS_info_appCrc == 0) {BMS_info_appCrc = static_cast<uint32_t>(CanSignal<32, 32>::decode(rx_frame));}
       }
       if (rx_frame.data.u8[0] == 0x12) { // Mux 18: BOOTLOADER_GITHASH
-        if (BMS_info_bootGitHash == 0) {BMS_info_bootGitHash = static_cast<uint64_t>(extract_signal_value(rx_frame.data.u8, 10, 54));}
+        if (BMS_info_bootGitHash == 0) {BMS_info_bootGitHash = static_cast<uint64_t>(CanSignal<10, 54>::decode(rx_frame));}
       }
       if (rx_frame.data.u8[0] == 0x14) { // Mux 20: UDS_PROTOCOL_BOOTCRC
-        if (BMS_info_bootUdsProtoVersion == 0) {BMS_info_bootUdsProtoVersion = static_cast<uint8_t>(extract_signal_value(rx_frame.data.u8, 8, 8));}
-        if (BMS_info_bootCrc == 0) {BMS_info_bootCrc = static_cast<uint32_t>(extract_signal_value(rx_frame.data.u8, 32, 32));}
+        if (BMS_info_bootUdsProtoVersion == 0) {BMS_info_bootUdsProtoVersion = static_cast<uint8_t>(CanSignal<8, 8>::decode(rx_frame));}
+        if (BMS_info_bootCrc == 0) {BMS_info_bootCrc = static_cast<uint32_t>(CanSignal<32, 32>::decode(rx_frame));}
       }
       */
       break;
@@ -1658,35 +1498,35 @@ void TeslaBattery::handle_incoming_can_frame(CAN_frame rx_frame) {
       //Display internal PCS info and other build/version data
       if (rx_frame.data.u8[0] == 0x0A) {  // Mux 10: BUILD_HWID_COMPONENTID
         if (PCS_info_buildConfigId == 0) {
-          PCS_info_buildConfigId = static_cast<uint16_t>(extract_signal_value(rx_frame.data.u8, 16, 16));
+          PCS_info_buildConfigId = static_cast<uint16_t>(CanSignal<16, 16>::decode(rx_frame));
         }
         if (PCS_info_hardwareId == 0) {
-          PCS_info_hardwareId = static_cast<uint16_t>(extract_signal_value(rx_frame.data.u8, 32, 16));
+          PCS_info_hardwareId = static_cast<uint16_t>(CanSignal<32, 16>::decode(rx_frame));
         }
         if (PCS_info_componentId == 0) {
-          PCS_info_componentId = static_cast<uint16_t>(extract_signal_value(rx_frame.data.u8, 48, 16));
+          PCS_info_componentId = static_cast<uint16_t>(CanSignal<48, 16>::decode(rx_frame));
         }
       }
       /*
       if (rx_frame.data.u8[0] == 0x0B) { // Mux 11: PCBAID_ASSYID_USAGEID
-        if (PCS_info_pcbaId == 0) {PCS_info_pcbaId = static_cast<uint8_t>(extract_signal_value(rx_frame.data.u8, 16, 8));}
-        if (PCS_info_assemblyId == 0) {PCS_info_assemblyId = static_cast<uint8_t>(extract_signal_value(rx_frame.data.u8, 24, 8));}
-        if (PCS_info_usageId == 0) {PCS_info_usageId = static_cast<uint16_t>(extract_signal_value(rx_frame.data.u8, 32, 16));}
-        if (PCS_info_subUsageId == 0) {PCS_info_subUsageId = static_cast<uint16_t>(extract_signal_value(rx_frame.data.u8, 48, 16));}
+        if (PCS_info_pcbaId == 0) {PCS_info_pcbaId = static_cast<uint8_t>(CanSignal<16, 8>::decode(rx_frame));}
+        if (PCS_info_assemblyId == 0) {PCS_info_assemblyId = static_cast<uint8_t>(CanSignal<24, 8>::decode(rx_frame));}
+        if (PCS_info_usageId == 0) {PCS_info_usageId = static_cast<uint16_t>(CanSignal<32, 16>::decode(rx_frame));}
+        if (PCS_info_subUsageId == 0) {PCS_info_subUsageId = static_cast<uint16_t>(CanSignal<48, 16>::decode(rx_frame));}
       }
       if (rx_frame.data.u8[0] == 0x0D) { // Mux 13: APP_CRC
-        PCS_info_platformType = static_cast<uint8_t>(extract_signal_value(rx_frame.data.u8, 8, 8));
-        PCS_info_appCrc = static_cast<uint32_t>(extract_signal_value(rx_frame.data.u8, 32, 32));
+        PCS_info_platformType = static_cast<uint8_t>(CanSignal<8, 8>::decode(rx_frame));
+        PCS_info_appCrc = static_cast<uint32_t>(CanSignal<32, 32>::decode(rx_frame));
       }
       if (rx_frame.data.u8[0] == 0x10) { // Mux 16: SUBCOMPONENT
-        PCS_info_cpu2AppCrc = static_cast<uint32_t>(extract_signal_value(rx_frame.data.u8, 32, 32));
+        PCS_info_cpu2AppCrc = static_cast<uint32_t>(CanSignal<32, 32>::decode(rx_frame));
       }
       if (rx_frame.data.u8[0] == 0x12) { // Mux 18: BOOTLOADER_GITHASH
-        PCS_info_bootGitHash = static_cast<uint64_t>(extract_signal_value(rx_frame.data.u8, 10, 54));
+        PCS_info_bootGitHash = static_cast<uint64_t>(CanSignal<10, 54>::decode(rx_frame));
       }
       if (rx_frame.data.u8[0] == 0x14) { // Mux 20: UDS_PROTOCOL_BOOTCRC
-        PCS_info_bootUdsProtoVersion = static_cast<uint8_t>(extract_signal_value(rx_frame.data.u8, 8, 8));
-        PCS_info_bootCrc = static_cast<uint32_t>(extract_signal_value(rx_frame.data.u8, 32, 32));
+        PCS_info_bootUdsProtoVersion = static_cast<uint8_t>(CanSignal<8, 8>::decode(rx_frame));
+        PCS_info_bootCrc = static_cast<uint32_t>(CanSignal<32, 32>::decode(rx_frame));
       }
       */
       //PCS Part Number in ASCII
@@ -1716,32 +1556,32 @@ void TeslaBattery::handle_incoming_can_frame(CAN_frame rx_frame) {
       //Display internal HVP info and other build/version data
       if (rx_frame.data.u8[0] == 0x0A) {  // Mux 10: BUILD_HWID_COMPONENTID
         if (HVP_info_buildConfigId == 0) {
-          HVP_info_buildConfigId = static_cast<uint16_t>(extract_signal_value(rx_frame.data.u8, 16, 16));
+          HVP_info_buildConfigId = static_cast<uint16_t>(CanSignal<16, 16>::decode(rx_frame));
         }
         if (HVP_info_hardwareId == 0) {
-          HVP_info_hardwareId = static_cast<uint16_t>(extract_signal_value(rx_frame.data.u8, 32, 16));
+          HVP_info_hardwareId = static_cast<uint16_t>(CanSignal<32, 16>::decode(rx_frame));
         }
         if (HVP_info_componentId == 0) {
-          HVP_info_componentId = static_cast<uint16_t>(extract_signal_value(rx_frame.data.u8, 48, 16));
+          HVP_info_componentId = static_cast<uint16_t>(CanSignal<48, 16>::decode(rx_frame));
         }
       }
       /*
       if (rx_frame.data.u8[0] == 0x0B) { // Mux 11: PCBAID_ASSYID_USAGEID
-        if (HVP_info_pcbaId == 0) {HVP_info_pcbaId = static_cast<uint8_t>(extract_signal_value(rx_frame.data.u8, 16, 8));}
-        if (HVP_info_assemblyId == 0) {HVP_info_assemblyId = static_cast<uint8_t>(extract_signal_value(rx_frame.data.u8, 24, 8));}
-        if (HVP_info_usageId == 0) {HVP_info_usageId = static_cast<uint16_t>(extract_signal_value(rx_frame.data.u8, 32, 16));}
-        if (HVP_info_subUsageId == 0) {HVP_info_subUsageId = static_cast<uint16_t>(extract_signal_value(rx_frame.data.u8, 48, 16));}
+        if (HVP_info_pcbaId == 0) {HVP_info_pcbaId = static_cast<uint8_t>(CanSignal<16, 8>::decode(rx_frame));}
+        if (HVP_info_assemblyId == 0) {HVP_info_assemblyId = static_cast<uint8_t>(CanSignal<24, 8>::decode(rx_frame));}
+        if (HVP_info_usageId == 0) {HVP_info_usageId = static_cast<uint16_t>(CanSignal<32, 16>::decode(rx_frame));}
+        if (HVP_info_subUsageId == 0) {HVP_info_subUsageId = static_cast<uint16_t>(CanSignal<48, 16>::decode(rx_frame));}
       }
       if (rx_frame.data.u8[0] == 0x0D) { // Mux 13: APP_CRC
-        HVP_info_platformType = static_cast<uint8_t>(extract_signal_value(rx_frame.data.u8, 8, 8));
-        HVP_info_appCrc = static_cast<uint32_t>(extract_signal_value(rx_frame.data.u8, 32, 32));
+        HVP_info_platformType = static_cast<uint8_t>(CanSignal<8, 8>::decode(rx_frame));
+        HVP_info_appCrc = static_cast<uint32_t>(CanSignal<32, 32>::decode(rx_frame));
       }
       if (rx_frame.data.u8[0] == 0x12) { // Mux 18: BOOTLOADER_GITHASH
-        HVP_info_bootGitHash = static_cast<uint64_t>(extract_signal_value(rx_frame.data.u8, 10, 54));
+        HVP_info_bootGitHash = static_cast<uint64_t>(CanSignal<10, 54>::decode(rx_frame));
       }
       if (rx_frame.data.u8[0] == 0x14) { // Mux 20: UDS_PROTOCOL_BOOTCRC
-        HVP_info_bootUdsProtoVersion = static_cast<uint8_t>(extract_signal_value(rx_frame.data.u8, 8, 8));
-        HVP_info_bootCrc = static_cast<uint32_t>(extract_signal_value(rx_frame.data.u8, 32, 32));
+        HVP_info_bootUdsProtoVersion = static_cast<uint8_t>(CanSignal<8, 8>::decode(rx_frame));
+        HVP_info_bootCrc = static_cast<uint32_t>(CanSignal<32, 32>::decode(rx_frame));
       }
       */
       break;
@@ -1894,7 +1734,7 @@ void TeslaBattery::transmit_can(unsigned long currentMillis) {
     }
     muxNumber_TESLA_2E1 = (muxNumber_TESLA_2E1 + 1) % 6;  //Cycle betweeen 0-1-2-3-4-5-0...
     //Generate next frames
-    generateFrameCounterChecksum(TESLA_118, 8, 4, 0, 8);
+    generateFrameCounterChecksum<8, 4, 0, 8>(TESLA_118);
   }
 
   //Send 50ms messages
@@ -1904,34 +1744,34 @@ void TeslaBattery::transmit_can(unsigned long currentMillis) {
     //0x221 VCFRONT_LVPowerState
     if (vehicleState == CAR_DRIVE) {
       if (alternateMux) {
-        generateMuxFrameCounterChecksum(TESLA_221_DRIVE_Mux0, frameCounter_TESLA_221, 52, 4, 56, 8);
+        generateMuxFrameCounterChecksum<52, 4, 56, 8>(TESLA_221_DRIVE_Mux0, frameCounter_TESLA_221);
         transmit_can_frame(&TESLA_221_DRIVE_Mux0);
       } else {
-        generateMuxFrameCounterChecksum(TESLA_221_DRIVE_Mux1, frameCounter_TESLA_221, 52, 4, 56, 8);
+        generateMuxFrameCounterChecksum<52, 4, 56, 8>(TESLA_221_DRIVE_Mux1, frameCounter_TESLA_221);
         transmit_can_frame(&TESLA_221_DRIVE_Mux1);
       }
     } else if (vehicleState == ACCESSORY) {
       if (alternateMux) {
-        generateMuxFrameCounterChecksum(TESLA_221_ACCESSORY_Mux0, frameCounter_TESLA_221, 52, 4, 56, 8);
+        generateMuxFrameCounterChecksum<52, 4, 56, 8>(TESLA_221_ACCESSORY_Mux0, frameCounter_TESLA_221);
         transmit_can_frame(&TESLA_221_ACCESSORY_Mux0);
       } else {
-        generateMuxFrameCounterChecksum(TESLA_221_ACCESSORY_Mux1, frameCounter_TESLA_221, 52, 4, 56, 8);
+        generateMuxFrameCounterChecksum<52, 4, 56, 8>(TESLA_221_ACCESSORY_Mux1, frameCounter_TESLA_221);
         transmit_can_frame(&TESLA_221_ACCESSORY_Mux1);
       }
     } else if (vehicleState == GOING_DOWN) {
       if (alternateMux) {
-        generateMuxFrameCounterChecksum(TESLA_221_GOING_DOWN_Mux0, frameCounter_TESLA_221, 52, 4, 56, 8);
+        generateMuxFrameCounterChecksum<52, 4, 56, 8>(TESLA_221_GOING_DOWN_Mux0, frameCounter_TESLA_221);
         transmit_can_frame(&TESLA_221_GOING_DOWN_Mux0);
       } else {
-        generateMuxFrameCounterChecksum(TESLA_221_GOING_DOWN_Mux1, frameCounter_TESLA_221, 52, 4, 56, 8);
+        generateMuxFrameCounterChecksum<52, 4, 56, 8>(TESLA_221_GOING_DOWN_Mux1, frameCounter_TESLA_221);
         transmit_can_frame(&TESLA_221_GOING_DOWN_Mux1);
       }
     } else if (vehicleState == CAR_OFF) {
       if (alternateMux) {
-        generateMuxFrameCounterChecksum(TESLA_221_OFF_Mux0, frameCounter_TESLA_221, 52, 4, 56, 8);
+        generateMuxFrameCounterChecksum<52, 4, 56, 8>(TESLA_221_OFF_Mux0, frameCounter_TESLA_221);
         transmit_can_frame(&TESLA_221_OFF_Mux0);
       } else {
-        generateMuxFrameCounterChecksum(TESLA_221_OFF_Mux1, frameCounter_TESLA_221, 52, 4, 56, 8);
+        generateMuxFrameCounterChecksum<52, 4, 56, 8>(TESLA_221_OFF_Mux1, frameCounter_TESLA_221);
         transmit_can_frame(&TESLA_221_OFF_Mux1);
       }
     }
@@ -1974,7 +1814,7 @@ void TeslaBattery::transmit_can(unsigned long currentMillis) {
     }
 
     //Generate next frame
-    generateFrameCounterChecksum(TESLA_39D, 8, 4, 0, 8);
+    generateFrameCounterChecksum<8, 4, 0, 8>(TESLA_39D);
   }
 
   //Send 100ms messages
@@ -2018,8 +1858,8 @@ void TeslaBattery::transmit_can(unsigned long currentMillis) {
     muxNumber_TESLA_7FF = (muxNumber_TESLA_7FF + 1) % 5;  //Cycle betweeen 0-1-2-3-4-0...
     //Generate next frames
     generateTESLA_229(TESLA_229);
-    generateFrameCounterChecksum(TESLA_2A8, 52, 4, 56, 8);
-    generateFrameCounterChecksum(TESLA_2E8, 52, 4, 56, 8);
+    generateFrameCounterChecksum<52, 4, 56, 8>(TESLA_2A8);
+    generateFrameCounterChecksum<52, 4, 56, 8>(TESLA_2E8);
 
     if (stateMachineClearIsolationFault != 0xFF) {
       //This implementation should be rewritten to actually reply to the UDS responses sent by the BMS
@@ -2211,9 +2051,9 @@ void TeslaBattery::transmit_can(unsigned long currentMillis) {
 
     //Generate next frames
     generateTESLA_213(TESLA_213);
-    generateFrameCounterChecksum(TESLA_293, 52, 4, 56, 8);
-    generateFrameCounterChecksum(TESLA_313, 52, 4, 56, 8);
-    generateFrameCounterChecksum(TESLA_334, 52, 4, 56, 8);
+    generateFrameCounterChecksum<52, 4, 56, 8>(TESLA_293);
+    generateFrameCounterChecksum<52, 4, 56, 8>(TESLA_313);
+    generateFrameCounterChecksum<52, 4, 56, 8>(TESLA_334);
   }
 
   //Send 1000ms messages
@@ -2224,7 +2064,7 @@ void TeslaBattery::transmit_can(unsigned long currentMillis) {
     transmit_can_frame(&TESLA_321);
 
     //Generate next frames
-    generateFrameCounterChecksum(TESLA_321, 52, 4, 56, 8);
+    generateFrameCounterChecksum<52, 4, 56, 8>(TESLA_321);
   }
 }
 
@@ -2410,12 +2250,12 @@ void TeslaModel3YBattery::setup(void) {  // Performs one time setup at startup
 
   //0x7FF GTW CAN frame values
   //Mux1
-  write_signal_value(&TESLA_7FF_Mux1, 16, 16, user_selected_tesla_GTW_country, false);
-  write_signal_value(&TESLA_7FF_Mux1, 11, 1, user_selected_tesla_GTW_rightHandDrive, false);
+  CanSignal<16, 16>::encode(TESLA_7FF_Mux1, user_selected_tesla_GTW_country);
+  CanSignal<11, 1>::encode(TESLA_7FF_Mux1, user_selected_tesla_GTW_rightHandDrive);
   //Mux3
-  write_signal_value(&TESLA_7FF_Mux3, 8, 4, user_selected_tesla_GTW_mapRegion, false);
-  write_signal_value(&TESLA_7FF_Mux3, 18, 3, user_selected_tesla_GTW_chassisType, false);
-  write_signal_value(&TESLA_7FF_Mux3, 32, 5, user_selected_tesla_GTW_packEnergy, false);
+  CanSignal<8, 4>::encode(TESLA_7FF_Mux3, user_selected_tesla_GTW_mapRegion);
+  CanSignal<18, 3>::encode(TESLA_7FF_Mux3, user_selected_tesla_GTW_chassisType);
+  CanSignal<32, 5>::encode(TESLA_7FF_Mux3, user_selected_tesla_GTW_packEnergy);
 
   strncpy(datalayer.system.info.battery_protocol, Name, 63);
   datalayer.system.info.battery_protocol[63] = '\0';
@@ -38,7 +38,7 @@ void TestFakeBattery::
   datalayer_battery->status.CAN_battery_still_alive = CAN_STILL_ALIVE;
 }
 
-void TestFakeBattery::handle_incoming_can_frame(CAN_frame rx_frame) {
+void TestFakeBattery::handle_incoming_can_frame(const CAN_frame& rx_frame) {
   datalayer_battery->status.CAN_battery_still_alive = CAN_STILL_ALIVE;
 }
 
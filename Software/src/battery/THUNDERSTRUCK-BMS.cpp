@@ -31,7 +31,7 @@ void ThunderstruckBMS::
   datalayer.battery.status.temperature_max_dC = highest_cell_temperature * 10;
 }
 
-void ThunderstruckBMS::handle_incoming_can_frame(CAN_frame rx_frame) {
+void ThunderstruckBMS::handle_incoming_can_frame(const CAN_frame& rx_frame) {
   switch (rx_frame.ID) {
     case 0x14ffcfd0:  // Temperatures
     case 0x14ffced0:
@@ -72,7 +72,7 @@ void VolvoSpaHybridBattery::
   }
 }
 
-void VolvoSpaHybridBattery::handle_incoming_can_frame(CAN_frame rx_frame) {
+void VolvoSpaHybridBattery::handle_incoming_can_frame(const CAN_frame& rx_frame) {
   switch (rx_frame.ID) {
     case 0x3A:
       datalayer.battery.status.CAN_battery_still_alive = CAN_STILL_ALIVE;
@@ -14,7 +14,7 @@ class ChevyVoltCharger : public CanCharger {
   const char* name() { return Name; }
   static constexpr const char* Name = "Chevy Volt Gen1 Charger";
 
-  void map_can_frame_to_variable(CAN_frame rx_frame);
+  void map_can_frame_to_variable(const CAN_frame& rx_frame);
   void transmit_can(unsigned long currentMillis);
 
   float outputPowerDC() {
@@ -1,7 +1,7 @@
 #include "NISSAN-LEAF-CHARGER.h"
+#include "../communication/can/CanCrc.h"
 #include "../communication/can/comm_can.h"
 #include "../datalayer/datalayer.h"
-#include "../devboard/utils/common_functions.h"  //For CRC table
 #include "CHARGERS.h"
 
 /* This implements Nissan LEAF PDM charger support. 2013-2024 Gen2/3 PDMs are supported
@@ -22,11 +22,7 @@
 */
 
 static uint8_t calculate_CRC_Nissan(CAN_frame* frame) {
-  uint8_t crc = 0;
-  for (uint8_t j = 0; j < 7; j++) {
-    crc = crctable_nissan_leaf[(crc ^ static_cast<uint8_t>(frame->data.u8[j])) % 256];
-  }
-  return crc;
+  return FrameCrc<Crc8NissanLeaf, 7>::crc(*frame);
 }
 
 static uint8_t calculate_checksum_nibble(CAN_frame* frame) {
@@ -39,7 +35,7 @@ static uint8_t calculate_checksum_nibble(CAN_frame* frame) {
   return sum;
 }
 
-void NissanLeafCharger::map_can_frame_to_variable(CAN_frame rx_frame) {
+void NissanLeafCharger::map_can_frame_to_variable(const CAN_frame& rx_frame) {
 
   switch (rx_frame.ID) {
     case 0x5BC:
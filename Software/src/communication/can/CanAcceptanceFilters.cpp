@@ -0,0 +1,135 @@
+#include "CanAcceptanceFilters.h"
+#include <algorithm>
+
+static uint8_t count_bits(uint32_t value) {
+  uint8_t count = 0;
+  while (value) {
+    value &= value - 1;
+    count++;
+  }
+  return count;
+}
+
+uint64_t can_filter_accepted_count(uint32_t mask, uint32_t id_mask) {
+  return 1ULL << count_bits(id_mask & ~mask);
+}
+
+static CanFilterGroup merge_groups(const CanFilterGroup& a, const CanFilterGroup& b) {
+  CanFilterGroup merged;
+  merged.mask = a.mask & b.mask & ~(a.code ^ b.code);
+  merged.code = a.code & merged.mask;
+  return merged;
+}
+
+std::vector<CanFilterGroup> compute_can_filter_groups(const std::vector<uint32_t>& ids, uint32_t id_mask,
+                                                      size_t max_groups) {
+  std::vector<uint32_t> unique_ids;
+  for (uint32_t id : ids) {
+    unique_ids.push_back(id & id_mask);
+  }
+  std::sort(unique_ids.begin(), unique_ids.end());
+  unique_ids.erase(std::unique(unique_ids.begin(), unique_ids.end()), unique_ids.end());
+
+  std::vector<CanFilterGroup> groups;
+  for (uint32_t id : unique_ids) {
+    groups.push_back({id, id_mask});
+  }
+
+  if (max_groups == 0) {
+    groups.clear();
+    return groups;
+  }
+
+  // Greedily merge the pair of groups whose union accepts the fewest extra IDs
+  while (groups.size() > max_groups) {
+    size_t best_a = 0;
+    size_t best_b = 1;
+    int64_t best_cost = INT64_MAX;
+
+    for (size_t a = 0; a < groups.size(); a++) {
+      for (size_t b = a + 1; b < groups.size(); b++) {
+        CanFilterGroup merged = merge_groups(groups[a], groups[b]);
+        int64_t cost = (int64_t)can_filter_accepted_count(merged.mask, id_mask) -
+                       (int64_t)can_filter_accepted_count(groups[a].mask, id_mask) -
+                       (int64_t)can_filter_accepted_count(groups[b].mask, id_mask);
+        if (cost < best_cost) {
+          best_cost = cost;
+          best_a = a;
+          best_b = b;
+        }
+      }
+    }
+
+    groups[best_a] = merge_groups(groups[best_a], groups[best_b]);
+    groups.erase(groups.begin() + best_b);
+  }
+
+  return groups;
+}
+
+uint32_t shared_can_filter_mask(const std::vector<CanFilterGroup>& groups, uint32_t id_mask) {
+  uint32_t mask = id_mask;
+  for (const CanFilterGroup& group : groups) {
+    mask &= group.mask;
+  }
+  return mask;
+}
+
+static uint64_t shared_mask_cost(const std::vector<CanFilterGroup>& groups, uint32_t id_mask) {
+  if (groups.empty()) {
+    return 0;
+  }
+  return groups.size() * can_filter_accepted_count(shared_can_filter_mask(groups, id_mask), id_mask);
+}
+
+static void apply_shared_mask(std::vector<CanFilterGroup>& groups, uint32_t id_mask) {
+  uint32_t mask = shared_can_filter_mask(groups, id_mask);
+  for (CanFilterGroup& group : groups) {
+    group.mask = mask;
+    group.code &= mask;
+  }
+}
+
+bool split_can_filter_groups(const std::vector<CanFilterGroup>& groups, size_t slots_a, size_t slots_b,
+                             uint32_t id_mask, std::vector<CanFilterGroup>& a, std::vector<CanFilterGroup>& b) {
+  a.clear();
+  b.clear();
+  if (groups.size() > slots_a + slots_b || groups.size() > 16) {
+    return false;
+  }
+
+  uint64_t best_cost = UINT64_MAX;
+  uint32_t best_selection = 0;
+
+  // Each bit in selection puts the corresponding group on side a
+  for (uint32_t selection = 0; selection < (1UL << groups.size()); selection++) {
+    std::vector<CanFilterGroup> side_a;
+    std::vector<CanFilterGroup> side_b;
+    for (size_t i = 0; i < groups.size(); i++) {
+      if (selection & (1UL << i)) {
+        side_a.push_back(groups[i]);
+      } else {
+        side_b.push_back(groups[i]);
+      }
+    }
+    if (side_a.size() > slots_a || side_b.size() > slots_b) {
+      continue;
+    }
+    uint64_t cost = shared_mask_cost(side_a, id_mask) + shared_mask_cost(side_b, id_mask);
+    if (cost < best_cost) {
+      best_cost = cost;
+      best_selection = selection;
+    }
+  }
+
+  for (size_t i = 0; i < groups.size(); i++) {
+    if (best_selection & (1UL << i)) {
+      a.push_back(groups[i]);
+    } else {
+      b.push_back(groups[i]);
+    }
+  }
+  apply_shared_mask(a, id_mask);
+  apply_shared_mask(b, id_mask);
+  return true;
+}
@@ -0,0 +1,35 @@
+#ifndef _CANACCEPTANCEFILTERS_H
+#define _CANACCEPTANCEFILTERS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#define CAN_STANDARD_ID_MASK 0x7FFUL
+#define CAN_EXTENDED_ID_MASK 0x1FFFFFFFUL
+
+// One hardware acceptance filter. A frame passes when (ID & mask) == code.
+struct CanFilterGroup {
+  uint32_t code;
+  uint32_t mask;
+};
+
+// Number of IDs accepted by a filter with the given mask, within id_mask (CAN_STANDARD_ID_MASK or CAN_EXTENDED_ID_MASK)
+uint64_t can_filter_accepted_count(uint32_t mask, uint32_t id_mask);
+
+// Groups the IDs into at most max_groups filters, merging the groups that cost the fewest
+// extra accepted IDs first. With max_groups >= number of unique IDs every filter is an exact match.
+std::vector<CanFilterGroup> compute_can_filter_groups(const std::vector<uint32_t>& ids, uint32_t id_mask,
+                                                      size_t max_groups);
+
+// Widens the groups to a single mask, for filters that share one mask register (MCP2515).
+// The returned mask accepts every ID the groups accepted, codes must be ANDed with it.
+uint32_t shared_can_filter_mask(const std::vector<CanFilterGroup>& groups, uint32_t id_mask);
+
+// Splits the groups between two mask registers with slots_a and slots_b filters each, choosing the split that
+// accepts the fewest IDs once each side shares one mask. Codes in a and b are already ANDed with the shared mask.
+// Returns false if the groups don't fit in the available slots.
+bool split_can_filter_groups(const std::vector<CanFilterGroup>& groups, size_t slots_a, size_t slots_b,
+                             uint32_t id_mask, std::vector<CanFilterGroup>& a, std::vector<CanFilterGroup>& b);
+
+#endif
@@ -0,0 +1,152 @@
+#ifndef _CAN_CRC_H_
+#define _CAN_CRC_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../../devboard/utils/types.h"
+
+// CRC-8 with the lookup tables generated by the compiler from the polynomial.
+//
+//   Poly       Generator polynomial, without the x^8 term, as in the CRC catalogues
+//   Init       Register value before the first byte, compute() also takes it at runtime
+//              since several vehicles use a different start value per message
+//   XorOut     XORed into the result
+//   Reflected  Bytes and result are bit reversed (refin = refout = true)
+//
+// update() goes one table lookup per byte. Payloads of 16 bytes and more, the
+// CAN-FD frames, go four bytes per step through slice-by-4 tables: the four
+// lookups do not depend on each other, so the chain of dependent loads is a
+// quarter as long.
+template <uint8_t Poly, uint8_t Init = 0x00, uint8_t XorOut = 0x00, bool Reflected = false>
+class Crc8 {
+  struct Tables {
+    uint8_t t[4][256];
+  };
+
+  static constexpr uint8_t reflect(uint8_t byte) {
+    uint8_t reflected = 0;
+    for (int i = 0; i < 8; i++) {
+      reflected |= ((byte >> i) & 1) << (7 - i);
+    }
+    return reflected;
+  }
+
+  static constexpr Tables generate() {
+    Tables tables = {};
+    for (int i = 0; i < 256; i++) {
+      uint8_t crc = i;
+      for (int bit = 0; bit < 8; bit++) {
+        if (Reflected) {
+          crc = (crc & 0x01) ? (crc >> 1) ^ reflect(Poly) : crc >> 1;
+        } else {
+          crc = (crc & 0x80) ? (crc << 1) ^ Poly : crc << 1;
+        }
+      }
+      tables.t[0][i] = crc;
+    }
+    // t[k][i] is the register after byte i followed by k zero bytes
+    for (int k = 1; k < 4; k++) {
+      for (int i = 0; i < 256; i++) {
+        tables.t[k][i] = tables.t[0][tables.t[k - 1][i]];
+      }
+    }
+    return tables;
+  }
+
+  static constexpr Tables tables = generate();
+
+ public:
+  static constexpr uint8_t initial_value = Init;
+  static constexpr const uint8_t (&table)[256] = tables.t[0];
+
+  // Feed bytes into a running register, without the final XOR
+  static constexpr uint8_t update(uint8_t crc, const uint8_t* data, size_t length) {
+    if (length >= 16) {
+      for (; length >= 4; length -= 4, data += 4) {
+        crc = tables.t[3][crc ^ data[0]] ^ tables.t[2][data[1]] ^ tables.t[1][data[2]] ^ tables.t[0][data[3]];
+      }
+    }
+    for (; length > 0; length--) {
+      crc = tables.t[0][crc ^ *data++];
+    }
+    return crc;
+  }
+
+  static constexpr uint8_t compute(const uint8_t* data, size_t length, uint8_t init = Init) {
+    return update(init, data, length) ^ XorOut;
+  }
+};
+
+// The polynomials used by the integrations
+typedef Crc8<0x1D> Crc8J1850;                    // SAE J1850, start value and final XOR per message
+typedef Crc8<0x2F, 0xFF, 0xFF> Crc8Autosar;      // AUTOSAR CRC8H2F, used by VW and Geely
+typedef Crc8<0x85> Crc8NissanLeaf;               // Nissan LEAF
+typedef Crc8<0x31, 0x00, 0x00, true> Crc8Maxim;  // Dallas/Maxim, the BMW S-Box
+typedef Crc8<0x01> Crc8Hyundai;                  // Hyundai/Kia hybrid and PHEV packs
+
+// 8 bit additive checksum, the sum of a start value and the bytes, modulo 256
+struct Checksum8 {
+  static constexpr uint8_t compute(const uint8_t* data, size_t length, uint8_t init = 0) {
+    uint8_t sum = init;
+    for (size_t i = 0; i < length; i++) {
+      sum = uint8_t(sum + data[i]);
+    }
+    return sum;
+  }
+};
+
+// CRC stored in data[CrcByte] of a frame. It covers the bytes after it when it
+// is the first byte of the frame, otherwise the bytes before it.
+template <typename Crc, uint8_t CrcByte>
+struct FrameCrc {
+  // CRC of the first length bytes of the frame, skipping the CRC byte. A frame too short
+  // to hold the CRC byte, like a DLC 0 frame, covers nothing and gives init.
+  static constexpr uint8_t crc(const CAN_frame& frame, uint8_t length = 8, uint8_t init = Crc::initial_value) {
+    if (length <= CrcByte) {
+      return init;
+    }
+    if (CrcByte == 0) {
+      return Crc::compute(&frame.data.u8[1], length - 1, init);
+    }
+    return Crc::compute(frame.data.u8, CrcByte, init);
+  }
+
+  static constexpr bool valid(const CAN_frame& frame, uint8_t length = 8, uint8_t init = Crc::initial_value) {
+    return length > CrcByte && frame.data.u8[CrcByte] == crc(frame, length, init);
+  }
+
+  static constexpr void write(CAN_frame& frame, uint8_t length = 8, uint8_t init = Crc::initial_value) {
+    frame.data.u8[CrcByte] = crc(frame, length, init);
+  }
+};
+
+// Outgoing frame protected by a CRC and a 4 bit alive counter in the low nibble
+// of data[CounterByte], counting 0...CounterMax.
+//
+//   typedef AliveCounterCrc<Crc8J1850, 1, 0, 14> ProtectedFrame;
+//   ProtectedFrame::advance(BMW_12F, alive_counter_100ms, 8, 0x60);
+//
+// replaces setting the nibble, recomputing the CRC and stepping the counter by hand.
+template <typename Crc, uint8_t CounterByte, uint8_t CrcByte, uint8_t CounterMax = 0x0F>
+struct AliveCounterCrc : FrameCrc<Crc, CrcByte> {
+  static_assert(CounterMax <= 0x0F, "the alive counter is a 4 bit field");
+  static_assert(CounterByte != CrcByte, "counter and CRC share a byte");
+
+  // Write counter and CRC into the frame
+  static constexpr void stamp(CAN_frame& frame, uint8_t counter, uint8_t length = 8,
+                              uint8_t init = Crc::initial_value) {
+    frame.data.u8[CounterByte] = (frame.data.u8[CounterByte] & 0xF0) | (counter & 0x0F);
+    FrameCrc<Crc, CrcByte>::write(frame, length, init);
+  }
+
+  static constexpr uint8_t next(uint8_t counter) { return (counter >= CounterMax) ? 0 : counter + 1; }
+
+  // stamp(), then step counter to the value for the next frame
+  static constexpr void advance(CAN_frame& frame, uint8_t& counter, uint8_t length = 8,
+                                uint8_t init = Crc::initial_value) {
+    stamp(frame, counter, length, init);
+    counter = next(counter);
+  }
+};
+
+#endif
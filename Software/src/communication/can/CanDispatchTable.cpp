@@ -0,0 +1,93 @@
+#include "CanDispatchTable.h"
+#include "CanAcceptanceFilters.h"
+
+// Key of an ID in the tables. Extended IDs carry CAN_EXTENDED_ID_FLAG, so a standard and an extended frame
+// with the same ID value go to different receivers.
+static uint32_t id_key(uint32_t id, bool extended) {
+  id &= ~CAN_EXTENDED_ID_FLAG;
+  return (extended || id > CAN_STANDARD_ID_MASK) ? (id | CAN_EXTENDED_ID_FLAG) : id;
+}
+
+void CanDispatchTable::add(CanReceiver* receiver, CAN_Interface interface) {
+  if (interface >= NO_CAN_INTERFACE) {
+    return;
+  }
+
+  InterfaceTable& table = tables[interface];
+  std::vector<uint32_t> ids = receiver->accepted_can_ids();
+
+  if (ids.empty()) {
+    table.any_id.push_back(receiver);
+    return;
+  }
+
+  for (uint32_t id : ids) {
+    std::vector<CanReceiver*>& receivers = table.by_id[id_key(id, id & CAN_EXTENDED_ID_FLAG)];
+    // Guard against IDs listed twice by the same receiver
+    if (receivers.empty() || receivers.back() != receiver) {
+      receivers.push_back(receiver);
+    }
+  }
+}
+
+void CanDispatchTable::clear() {
+  for (auto& table : tables) {
+    table.any_id.clear();
+    table.by_id.clear();
+  }
+}
+
+bool CanDispatchTable::dispatch(const CAN_frame* rx_frame, CAN_Interface interface) const {
+  if (interface >= NO_CAN_INTERFACE) {
+    return false;
+  }
+
+  const InterfaceTable& table = tables[interface];
+  bool delivered = false;
+
+  for (CanReceiver* receiver : table.any_id) {
+    receiver->receive_can_frame(rx_frame);
+    delivered = true;
+  }
+
+  if (!table.by_id.empty()) {
+    auto it = table.by_id.find(id_key(rx_frame->ID, rx_frame->ext_ID));
+    if (it != table.by_id.end()) {
+      for (CanReceiver* receiver : it->second) {
+        receiver->receive_can_frame(rx_frame);
+      }
+      delivered = true;
+    }
+  }
+
+  return delivered;
+}
+
+bool CanDispatchTable::wants(uint32_t id, CAN_Interface interface) const {
+  if (interface >= NO_CAN_INTERFACE) {
+    return false;
+  }
+
+  const InterfaceTable& table = tables[interface];
+  return !table.any_id.empty() || table.by_id.count(id_key(id, id & CAN_EXTENDED_ID_FLAG)) > 0;
+}
+
+bool CanDispatchTable::accepts_all(CAN_Interface interface) const {
+  if (interface >= NO_CAN_INTERFACE) {
+    return false;
+  }
+
+  return !tables[interface].any_id.empty();
+}
+
+std::vector<uint32_t> CanDispatchTable::subscribed_ids(CAN_Interface interface) const {
+  std::vector<uint32_t> ids;
+  if (interface >= NO_CAN_INTERFACE) {
+    return ids;
+  }
+
+  for (auto& entry : tables[interface].by_id) {
+    ids.push_back(entry.first);
+  }
+  return ids;
+}
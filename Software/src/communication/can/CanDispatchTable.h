@@ -0,0 +1,42 @@
+#ifndef _CANDISPATCHTABLE_H
+#define _CANDISPATCHTABLE_H
+
+#include <unordered_map>
+#include <vector>
+#include "../../devboard/utils/types.h"
+#include "CanReceiver.h"
+
+// Routes received CAN frames to the receivers that subscribed to their interface and ID.
+// Built once at init time, lookups in the receive path are constant time and allocation free.
+class CanDispatchTable {
+ public:
+  // Add a receiver for an interface. The receiver's accepted_can_ids() decide which frames it gets.
+  void add(CanReceiver* receiver, CAN_Interface interface);
+
+  // Remove all receivers
+  void clear();
+
+  // Pass the frame to every receiver interested in it. Returns false if nobody wanted the frame.
+  bool dispatch(const CAN_frame* rx_frame, CAN_Interface interface) const;
+
+  // True if any receiver on the interface wants frames with this ID, in the format given as in accepted_can_ids()
+  bool wants(uint32_t id, CAN_Interface interface) const;
+
+  // True if the interface has a receiver that wants every frame
+  bool accepts_all(CAN_Interface interface) const;
+
+  // All IDs subscribed to on the interface, used to program hardware acceptance filters.
+  // Extended IDs carry CAN_EXTENDED_ID_FLAG.
+  std::vector<uint32_t> subscribed_ids(CAN_Interface interface) const;
+
+ private:
+  struct InterfaceTable {
+    // Receivers that did not declare any IDs, they get every frame
+    std::vector<CanReceiver*> any_id;
+    std::unordered_map<uint32_t, std::vector<CanReceiver*>> by_id;
+  };
+
+  InterfaceTable tables[NO_CAN_INTERFACE];
+};
+
+#endif
@@ -1,11 +1,21 @@
 #ifndef _CANRECEIVER_H
 #define _CANRECEIVER_H
 
+#include <vector>
 #include "../../devboard/utils/types.h"
 
+// Marks an ID in accepted_can_ids() as an extended (29 bit) ID. IDs above 0x7FF can only be extended, so this
+// is only needed for extended IDs in the standard range.
+#define CAN_EXTENDED_ID_FLAG 0x80000000UL
+
 class CanReceiver {
  public:
-  virtual void receive_can_frame(CAN_frame* rx_frame) = 0;
+  virtual void receive_can_frame(const CAN_frame* rx_frame) = 0;
+
+  // CAN IDs this receiver handles. An empty list (the default) means every frame on the interface is wanted.
+  // Frames only match an ID in the same format, see CAN_EXTENDED_ID_FLAG.
+  // Queried once when the dispatch table is built in init_CAN(), so it may allocate.
+  virtual std::vector<uint32_t> accepted_can_ids() { return {}; }
 };
 
 #endif
@@ -0,0 +1,126 @@
+#ifndef _CAN_SIGNAL_H_
+#define _CAN_SIGNAL_H_
+
+#include <stdint.h>
+#include <type_traits>
+#include "../../devboard/utils/types.h"
+
+// Bit numbering as in a DBC file
+enum class ByteOrder : uint8_t {
+  LittleEndian,  // Intel, "@1": StartBit is the least significant bit
+  BigEndian,     // Motorola, "@0": StartBit is the most significant bit, bit 7 of a byte is its MSB
+};
+
+// A signal in a CAN frame, described like a DBC signal:
+//
+//   SG_ BMS_state : 31|4@1+ (1,0)         ->  CanSignal<31, 4>
+//   SG_ BMS_packTemp : 16|10@1- (0.5,-40) ->  CanSignal<16, 10, ByteOrder::LittleEndian, true, 0.5f, -40.0f>
+//
+// Everything about the signal is a template parameter, so decode() and encode()
+// compile down to a fixed list of byte loads, shifts and masks without any loop
+// over bits. The signal must fit in the 64 byte CAN-FD payload, the frame DLC is
+// not checked.
+template <uint16_t StartBit, uint8_t Length, ByteOrder Order = ByteOrder::LittleEndian, bool Signed = false,
+          float Scale = 1.0f, float Offset = 0.0f>
+class CanSignal {
+  static_assert(Length >= 1 && Length <= 64, "CAN signals are 1 to 64 bits long");
+
+  // Position of the signal counted from the MSB of byte 0, for big endian signals
+  static constexpr int msb_position = (StartBit / 8) * 8 + (7 - StartBit % 8);
+  static constexpr int first_byte = (Order == ByteOrder::LittleEndian) ? StartBit / 8 : msb_position / 8;
+  static constexpr int last_byte =
+      (Order == ByteOrder::LittleEndian) ? (StartBit + Length - 1) / 8 : (msb_position + Length - 1) / 8;
+  static_assert(last_byte < 64, "CAN signal does not fit in a CAN frame");
+
+  // Where bit 0 of data[byte] ends up in the raw value, negative means it is below the signal
+  static constexpr int shift_of(int byte) {
+    return (Order == ByteOrder::LittleEndian) ? 8 * (byte - first_byte) - StartBit % 8
+                                              : 8 * (last_byte - byte) - (7 - (msb_position + Length - 1) % 8);
+  }
+
+  template <int Byte>
+  static constexpr uint64_t gather(const uint8_t* data) {
+    constexpr int shift = shift_of(Byte);
+    uint64_t bits = 0;
+    if constexpr (shift >= 0) {
+      bits = (uint64_t)data[Byte] << shift;
+    } else {
+      bits = (uint64_t)data[Byte] >> -shift;
+    }
+    if constexpr (Byte < last_byte) {
+      bits |= gather<Byte + 1>(data);
+    }
+    return bits;
+  }
+
+  template <int Byte>
+  static constexpr void scatter(uint8_t* data, uint64_t bits) {
+    constexpr int shift = shift_of(Byte);
+    uint8_t byte_mask = 0;
+    uint8_t byte_bits = 0;
+    if constexpr (shift >= 0) {
+      byte_mask = (uint8_t)(mask >> shift);
+      byte_bits = (uint8_t)(bits >> shift);
+    } else {
+      byte_mask = (uint8_t)(mask << -shift);
+      byte_bits = (uint8_t)(bits << -shift);
+    }
+    data[Byte] = (data[Byte] & ~byte_mask) | (byte_bits & byte_mask);
+    if constexpr (Byte < last_byte) {
+      scatter<Byte + 1>(data, bits);
+    }
+  }
+
+ public:
+  typedef typename std::conditional<Signed, int64_t, uint64_t>::type raw_type;
+
+  static constexpr uint64_t mask = (Length == 64) ? ~0ULL : (1ULL << Length) - 1;
+  static constexpr raw_type min_raw = Signed ? (raw_type)(-(int64_t)(mask >> 1) - 1) : 0;
+  static constexpr raw_type max_raw = Signed ? (raw_type)(mask >> 1) : (raw_type)mask;
+
+  // Raw value, sign extended for signed signals
+  static constexpr raw_type decode(const uint8_t* data) {
+    uint64_t bits = gather<first_byte>(data) & mask;
+    if constexpr (Signed && Length < 64) {
+      return (int64_t)(bits << (64 - Length)) >> (64 - Length);
+    } else {
+      return (raw_type)bits;
+    }
+  }
+  static constexpr raw_type decode(const CAN_frame& frame) { return decode(frame.data.u8); }
+
+  // Value with scale and offset applied
+  static constexpr float decode_value(const uint8_t* data) { return decode(data) * Scale + Offset; }
+  static constexpr float decode_value(const CAN_frame& frame) { return decode_value(frame.data.u8); }
+
+  // Raw values outside the range of the signal are clamped to it
+  static constexpr void encode(uint8_t* data, raw_type raw) {
+    if constexpr (Length < 64) {
+      if (raw > max_raw) {
+        raw = max_raw;
+      }
+      if constexpr (Signed) {
+        if (raw < min_raw) {
+          raw = min_raw;
+        }
+      }
+    }
+    scatter<first_byte>(data, (uint64_t)raw & mask);
+  }
+  static constexpr void encode(CAN_frame& frame, raw_type raw) { encode(frame.data.u8, raw); }
+
+  // Rounded to the nearest raw value
+  static constexpr void encode_value(uint8_t* data, float value) {
+    float raw = (value - Offset) / Scale;
+    if (raw >= (float)max_raw) {
+      encode(data, max_raw);
+    } else if (raw <= (float)min_raw) {
+      encode(data, min_raw);
+    } else {
+      encode(data, (raw_type)(raw < 0 ? raw - 0.5f : raw + 0.5f));
+    }
+  }
+  static constexpr void encode_value(CAN_frame& frame, float value) { encode_value(frame.data.u8, value); }
+};
+
+#endif
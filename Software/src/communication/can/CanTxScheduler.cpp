@@ -0,0 +1,94 @@
+#include "CanTxScheduler.h"
+#include <algorithm>
+#include <numeric>
+#include "comm_can.h"
+
+// Only the first part of long periods is searched for a free phase, which keeps
+// registration cheap and still gives every frame its own millisecond.
+#define MAX_PHASE_CANDIDATES 100
+
+CanTxScheduler can_tx_scheduler(transmit_can_frame_to_interface);
+
+CanTxScheduler::CanTxScheduler(SendFunction send) : send(send) {}
+
+uint32_t CanTxScheduler::add(CAN_frame* frame, CAN_Interface interface, uint32_t period_ms, RefreshCallback refresh,
+                             int32_t phase_ms) {
+  if (period_ms == 0) {
+    period_ms = 1;
+  }
+  uint32_t phase = (phase_ms == AUTO_PHASE) ? least_loaded_phase(interface, period_ms) : (uint32_t)phase_ms % period_ms;
+  // The deadline is set on the next run(), when the current time is known
+  entries.push_back({frame, interface, period_ms, phase, 0, refresh});
+  return phase;
+}
+
+void CanTxScheduler::clear() {
+  entries.clear();
+  heap.clear();
+}
+
+// Two frames with periods p1, p2 and phases f1, f2 are sent in the same millisecond
+// sooner or later exactly when f1 and f2 are equal modulo gcd(p1, p2).
+uint32_t CanTxScheduler::least_loaded_phase(CAN_Interface interface, uint32_t period_ms) const {
+  uint32_t candidates = std::min<uint32_t>(period_ms, MAX_PHASE_CANDIDATES);
+  uint32_t best_phase = 0;
+  uint32_t best_collisions = UINT32_MAX;
+
+  for (uint32_t phase = 0; phase < candidates && best_collisions > 0; phase++) {
+    uint32_t collisions = 0;
+    for (const Entry& entry : entries) {
+      if (entry.interface != interface) {
+        continue;
+      }
+      uint32_t divisor = std::gcd(period_ms, entry.period_ms);
+      if (phase % divisor == entry.phase_ms % divisor) {
+        collisions++;
+      }
+    }
+    if (collisions < best_collisions) {
+      best_collisions = collisions;
+      best_phase = phase;
+    }
+  }
+  return best_phase;
+}
+
+bool CanTxScheduler::later(uint16_t a, uint16_t b) const {
+  return (long)(entries[a].due_ms - entries[b].due_ms) > 0;
+}
+
+// Set the deadline to the first time at or after after_ms that matches the phase of the entry
+void CanTxScheduler::schedule(uint16_t index, unsigned long after_ms) {
+  Entry& entry = entries[index];
+  unsigned long due = after_ms - (after_ms % entry.period_ms) + entry.phase_ms;
+  if ((long)(due - after_ms) < 0) {
+    due += entry.period_ms;
+  }
+  entry.due_ms = due;
+}
+
+void CanTxScheduler::run(unsigned long currentMillis) {
+  auto comparator = [this](uint16_t a, uint16_t b) { return later(a, b); };
+
+  // Frames added since the last run
+  while (heap.size() < entries.size()) {
+    uint16_t index = heap.size();
+    schedule(index, currentMillis);
+    heap.push_back(index);
+    std::push_heap(heap.begin(), heap.end(), comparator);
+  }
+
+  while (!heap.empty() && (long)(currentMillis - entries[heap.front()].due_ms) >= 0) {
+    std::pop_heap(heap.begin(), heap.end(), comparator);
+    uint16_t index = heap.back();
+    Entry& entry = entries[index];
+
+    if (!entry.refresh || entry.refresh(entry.frame)) {
+      send(entry.frame, entry.interface);
+    }
+
+    // Deadlines missed while the core task was held up are skipped, not sent in a burst
+    schedule(index, currentMillis + 1);
+    std::push_heap(heap.begin(), heap.end(), comparator);
+  }
+}
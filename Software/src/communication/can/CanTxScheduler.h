@@ -0,0 +1,61 @@
+#ifndef _CAN_TX_SCHEDULER_H_
+#define _CAN_TX_SCHEDULER_H_
+
+#include <stdint.h>
+#include <functional>
+#include <vector>
+#include "../../devboard/utils/types.h"
+
+// Central scheduler for periodic CAN frames.
+//
+// Protocols register their cyclic frames once, with a period and optionally a
+// phase offset, instead of checking a set of previousMillisXX counters on every
+// transmit() call. The scheduler keeps the frames in a min-heap ordered by their
+// next deadline, so each core_loop tick only looks at the frames that are due.
+// When no phase is given, the frame gets the phase in its period that collides
+// with the fewest frames already scheduled on the same interface, which spreads
+// bursts out instead of queueing them all in the same millisecond.
+class CanTxScheduler {
+ public:
+  // Called right before the frame is sent, to refresh its payload.
+  // Return false to skip this transmission (e.g. while the other side is not awake).
+  typedef std::function<bool(CAN_frame* frame)> RefreshCallback;
+  typedef void (*SendFunction)(const CAN_frame* frame, CAN_Interface interface);
+
+  static const int32_t AUTO_PHASE = -1;
+
+  explicit CanTxScheduler(SendFunction send);
+
+  // Send frame on interface every period_ms. The frame must outlive the scheduler entry.
+  // Returns the phase (0..period_ms-1) the frame was given.
+  uint32_t add(CAN_frame* frame, CAN_Interface interface, uint32_t period_ms, RefreshCallback refresh = nullptr,
+               int32_t phase_ms = AUTO_PHASE);
+
+  // Send all frames that are due. Called from the core task every millisecond.
+  void run(unsigned long currentMillis);
+
+  void clear();
+  size_t size() const { return entries.size(); }
+
+ private:
+  struct Entry {
+    CAN_frame* frame;
+    CAN_Interface interface;
+    uint32_t period_ms;
+    uint32_t phase_ms;
+    unsigned long due_ms;
+    RefreshCallback refresh;
+  };
+
+  uint32_t least_loaded_phase(CAN_Interface interface, uint32_t period_ms) const;
+  bool later(uint16_t a, uint16_t b) const;
+  void schedule(uint16_t index, unsigned long after_ms);
+
+  SendFunction send;
+  std::vector<Entry> entries;
+  std::vector<uint16_t> heap;  // Indexes into entries, earliest deadline first
+};
+
+extern CanTxScheduler can_tx_scheduler;
+
+#endif
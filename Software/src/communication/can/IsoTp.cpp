@@ -0,0 +1,315 @@
+#include "IsoTp.h"
+#include <string.h>
+#include <algorithm>
+
+#define PCI_SINGLE_FRAME 0x0
+#define PCI_FIRST_FRAME 0x1
+#define PCI_CONSECUTIVE_FRAME 0x2
+#define PCI_FLOW_CONTROL 0x3
+
+#define FLOW_CONTINUE 0x0
+#define FLOW_WAIT 0x1
+#define FLOW_OVERFLOW 0x2
+
+IsoTpBufferPool isotp_buffer_pool;
+
+uint8_t* IsoTpBufferPool::acquire() {
+  for (int i = 0; i < ISOTP_RX_POOL_SIZE; i++) {
+    if (!used[i]) {
+      used[i] = true;
+      return buffers[i];
+    }
+  }
+  return nullptr;
+}
+
+void IsoTpBufferPool::release(uint8_t* buffer) {
+  for (int i = 0; i < ISOTP_RX_POOL_SIZE; i++) {
+    if (buffers[i] == buffer) {
+      used[i] = false;
+    }
+  }
+}
+
+uint8_t IsoTpBufferPool::available() const {
+  uint8_t count = 0;
+  for (int i = 0; i < ISOTP_RX_POOL_SIZE; i++) {
+    if (!used[i]) {
+      count++;
+    }
+  }
+  return count;
+}
+
+// CAN-FD frames can only have some lengths above 8 bytes
+static uint8_t fd_frame_length(uint8_t length) {
+  static const uint8_t lengths[] = {8, 12, 16, 20, 24, 32, 48, 64};
+  for (uint8_t valid : lengths) {
+    if (length <= valid) {
+      return valid;
+    }
+  }
+  return 64;
+}
+
+// STmin as sent in a flow control frame. Sub-millisecond values are rounded up
+// to one core_loop tick, reserved values mean the maximum of 127 ms.
+static uint8_t decode_separation_time(uint8_t st_min) {
+  if (st_min <= 0x7F) {
+    return st_min;
+  }
+  if (st_min >= 0xF1 && st_min <= 0xF9) {
+    return 1;
+  }
+  return 0x7F;
+}
+
+IsoTpLink::IsoTpLink(CAN_Interface interface, uint32_t tx_id, uint32_t rx_id, SendFunction send)
+    : interface(interface), tx_id(tx_id), rx_id(rx_id), send_function(send) {}
+
+void IsoTpLink::set_flow_control(uint8_t block_size, uint8_t separation_time_ms) {
+  this->block_size = block_size;
+  this->separation_time_ms = std::min<uint8_t>(separation_time_ms, 0x7F);
+}
+
+void IsoTpLink::set_addresses(int16_t tx_address, int16_t rx_address) {
+  this->tx_address = tx_address;
+  this->rx_address = rx_address;
+}
+
+uint8_t IsoTpLink::frame_payload_size() const {
+  return (can_fd ? 64 : 8) - (tx_address == NO_ADDRESS ? 0 : 1);
+}
+
+void IsoTpLink::send_frame(const uint8_t* payload, uint8_t length) {
+  CAN_frame frame;
+  frame.FD = can_fd;
+  frame.ext_ID = tx_id > 0x7FF;
+  frame.ID = tx_id;
+
+  uint8_t offset = 0;
+  if (tx_address != NO_ADDRESS) {
+    frame.data.u8[offset++] = (uint8_t)tx_address;
+  }
+  memcpy(&frame.data.u8[offset], payload, length);
+  uint8_t used = offset + length;
+  frame.DLC = can_fd ? fd_frame_length(used) : 8;
+  memset(&frame.data.u8[used], padding, frame.DLC - used);
+
+  send_function(&frame, interface);
+}
+
+void IsoTpLink::send_flow_control(uint8_t status) {
+  uint8_t payload[3] = {(uint8_t)((PCI_FLOW_CONTROL << 4) | status), block_size, separation_time_ms};
+  send_frame(payload, sizeof(payload));
+}
+
+bool IsoTpLink::send(const uint8_t* data, uint16_t length, unsigned long currentMillis) {
+  if (tx_state != TxState::Idle || length == 0 || length > ISOTP_TX_BUFFER_SIZE) {
+    return false;
+  }
+
+  uint8_t payload[64];
+  uint8_t frame_size = frame_payload_size();
+
+  if (length <= frame_size - 1 && length <= 7) {
+    payload[0] = (PCI_SINGLE_FRAME << 4) | length;
+    memcpy(&payload[1], data, length);
+    send_frame(payload, length + 1);
+    return true;
+  }
+  if (can_fd && length <= frame_size - 2) {
+    // CAN-FD single frame with escaped length
+    payload[0] = PCI_SINGLE_FRAME << 4;
+    payload[1] = length;
+    memcpy(&payload[2], data, length);
+    send_frame(payload, length + 2);
+    return true;
+  }
+
+  memcpy(tx_data, data, length);
+  tx_length = length;
+  tx_offset = frame_size - 2;
+  tx_sequence = 1;
+  payload[0] = (PCI_FIRST_FRAME << 4) | ((length >> 8) & 0x0F);
+  payload[1] = length & 0xFF;
+  memcpy(&payload[2], data, tx_offset);
+  send_frame(payload, frame_size);
+
+  tx_state = TxState::WaitFlowControl;
+  tx_last_ms = currentMillis;
+  return true;
+}
+
+void IsoTpLink::send_consecutive_frames(unsigned long currentMillis) {
+  uint8_t payload[64];
+  uint8_t frame_size = frame_payload_size();
+
+  for (int sent = 0; sent < ISOTP_MAX_FRAMES_PER_POLL; sent++) {
+    if (sent > 0 && tx_separation_ms > 0) {
+      break;  // One frame per separation time
+    }
+    if (tx_separation_ms > 0 && currentMillis - tx_last_ms < tx_separation_ms) {
+      break;
+    }
+
+    uint8_t chunk = std::min<uint16_t>(frame_size - 1, tx_length - tx_offset);
+    payload[0] = (PCI_CONSECUTIVE_FRAME << 4) | tx_sequence;
+    memcpy(&payload[1], &tx_data[tx_offset], chunk);
+    send_frame(payload, chunk + 1);
+    tx_offset += chunk;
+    tx_sequence = (tx_sequence + 1) & 0x0F;
+    tx_last_ms = currentMillis;
+
+    if (tx_offset >= tx_length) {
+      tx_state = TxState::Idle;
+      return;
+    }
+    if (tx_block_limited && --tx_block_remaining == 0) {
+      tx_state = TxState::WaitFlowControl;
+      return;
+    }
+  }
+}
+
+void IsoTpLink::abort_reception() {
+  if (rx_buffer != nullptr) {
+    isotp_buffer_pool.release(rx_buffer);
+    rx_buffer = nullptr;
+  }
+}
+
+void IsoTpLink::deliver(const uint8_t* data, uint16_t length) {
+  if (receive_callback) {
+    receive_callback(data, length);
+  }
+}
+
+bool IsoTpLink::handle_frame(const CAN_frame& frame, unsigned long currentMillis) {
+  if (frame.ID != rx_id) {
+    return false;
+  }
+  uint8_t offset = 0;
+  if (rx_address != NO_ADDRESS) {
+    if (frame.DLC < 1 || frame.data.u8[0] != (uint8_t)rx_address) {
+      return false;  // Same ID, but meant for another address
+    }
+    offset = 1;
+  }
+  if (frame.DLC <= offset) {
+    return true;
+  }
+
+  const uint8_t* data = &frame.data.u8[offset];
+  uint8_t length = std::min<uint8_t>(frame.DLC, 64) - offset;
+  uint8_t pci = data[0];
+
+  switch (pci >> 4) {
+    case PCI_SINGLE_FRAME: {
+      uint8_t size = pci & 0x0F;
+      uint8_t start = 1;
+      if (size == 0 && length > 8) {
+        size = data[1];
+        start = 2;
+      }
+      if (size == 0 || size > length - start) {
+        break;
+      }
+      abort_reception();  // A new message replaces one that was still being received
+      deliver(&data[start], size);
+    } break;
+
+    case PCI_FIRST_FRAME: {
+      if (length < 2) {
+        break;
+      }
+      uint32_t size = ((pci & 0x0F) << 8) | data[1];
+      uint8_t start = 2;
+      if (size == 0 && length >= 6) {
+        size = ((uint32_t)data[2] << 24) | ((uint32_t)data[3] << 16) | ((uint32_t)data[4] << 8) | data[5];
+        start = 6;
+      }
+      abort_reception();
+      if (size > ISOTP_RX_BUFFER_SIZE || (rx_buffer = isotp_buffer_pool.acquire()) == nullptr) {
+        error_count++;
+        send_flow_control(FLOW_OVERFLOW);
+        break;
+      }
+      rx_expected = size;
+      rx_received = std::min<uint16_t>(length - start, rx_expected);
+      memcpy(rx_buffer, &data[start], rx_received);
+      rx_sequence = 1;
+      rx_block_count = 0;
+      rx_last_ms = currentMillis;
+      send_flow_control(FLOW_CONTINUE);
+    } break;
+
+    case PCI_CONSECUTIVE_FRAME: {
+      if (rx_buffer == nullptr) {
+        break;
+      }
+      if ((pci & 0x0F) != rx_sequence) {
+        error_count++;
+        abort_reception();
+        break;
+      }
+      uint16_t chunk = std::min<uint16_t>(length - 1, rx_expected - rx_received);
+      memcpy(&rx_buffer[rx_received], &data[1], chunk);
+      rx_received += chunk;
+      rx_sequence = (rx_sequence + 1) & 0x0F;
+      rx_last_ms = currentMillis;
+
+      if (rx_received >= rx_expected) {
+        uint8_t* complete = rx_buffer;
+        rx_buffer = nullptr;
+        deliver(complete, rx_expected);
+        isotp_buffer_pool.release(complete);
+      } else if (block_size > 0 && ++rx_block_count >= block_size) {
+        rx_block_count = 0;
+        send_flow_control(FLOW_CONTINUE);
+      }
+    } break;
+
+    case PCI_FLOW_CONTROL: {
+      if (tx_state != TxState::WaitFlowControl) {
+        break;
+      }
+      uint8_t status = pci & 0x0F;
+      tx_last_ms = currentMillis;
+      if (status == FLOW_CONTINUE && length >= 3) {
+        tx_block_remaining = data[1];
+        tx_block_limited = data[1] > 0;
+        tx_separation_ms = decode_separation_time(data[2]);
+        tx_state = TxState::SendConsecutive;
+        tx_last_ms = currentMillis - tx_separation_ms;  // The first frame may go right away
+        send_consecutive_frames(currentMillis);
+      } else if (status != FLOW_WAIT) {
+        error_count++;
+        tx_state = TxState::Idle;
+      }
+    } break;
+
+    default:
+      break;
+  }
+  return true;
+}
+
+void IsoTpLink::poll(unsigned long currentMillis) {
+  if (rx_buffer != nullptr && currentMillis - rx_last_ms > timeout_ms) {
+    error_count++;
+    abort_reception();
+  }
+
+  if (tx_state == TxState::WaitFlowControl && currentMillis - tx_last_ms > timeout_ms) {
+    error_count++;
+    tx_state = TxState::Idle;
+  } else if (tx_state == TxState::SendConsecutive) {
+    send_consecutive_frames(currentMillis);
+  }
+}
+
+void IsoTpLink::reset() {
+  abort_reception();
+  tx_state = TxState::Idle;
+}
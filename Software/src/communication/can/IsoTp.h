@@ -0,0 +1,134 @@
+#ifndef _ISOTP_H_
+#define _ISOTP_H_
+
+#include <stdint.h>
+#include <functional>
+#include "../../devboard/utils/types.h"
+
+// Largest message that can be received, e.g. a full cell voltage dump
+#ifndef ISOTP_RX_BUFFER_SIZE
+#define ISOTP_RX_BUFFER_SIZE 1024
+#endif
+
+// Number of multi-frame messages that can be reassembled at the same time, over all links
+#ifndef ISOTP_RX_POOL_SIZE
+#define ISOTP_RX_POOL_SIZE 4
+#endif
+
+// Largest message that can be sent (requests are short)
+#ifndef ISOTP_TX_BUFFER_SIZE
+#define ISOTP_TX_BUFFER_SIZE 64
+#endif
+
+// Consecutive frames sent back-to-back per poll() when the receiver asks for no separation time
+#ifndef ISOTP_MAX_FRAMES_PER_POLL
+#define ISOTP_MAX_FRAMES_PER_POLL 8
+#endif
+
+// Fixed set of reassembly buffers shared by all ISO-TP links. A buffer is only
+// taken while a multi-frame message is being received, so a handful is enough
+// for all batteries and no memory is allocated per response.
+class IsoTpBufferPool {
+ public:
+  uint8_t* acquire();
+  void release(uint8_t* buffer);
+  uint8_t available() const;
+
+ private:
+  uint8_t buffers[ISOTP_RX_POOL_SIZE][ISOTP_RX_BUFFER_SIZE];
+  bool used[ISOTP_RX_POOL_SIZE] = {false};
+};
+
+extern IsoTpBufferPool isotp_buffer_pool;
+
+// ISO 15765-2 transport between us (tx_id) and one ECU (rx_id).
+//
+// Received single frames are handed over directly, multi-frame messages are
+// reassembled in a pool buffer. Flow control frames are answered with the
+// block size and separation time set with set_flow_control(), and when sending
+// the block size and separation time requested by the ECU are respected.
+// handle_frame() is called for received frames and poll() every core_loop tick,
+// which sends pending consecutive frames and drops transfers that timed out.
+class IsoTpLink {
+ public:
+  typedef void (*SendFunction)(const CAN_frame* frame, CAN_Interface interface);
+  // Called with a complete message. The data is only valid during the call.
+  typedef std::function<void(const uint8_t* data, uint16_t length)> ReceiveCallback;
+
+  static const int16_t NO_ADDRESS = -1;
+
+  IsoTpLink(CAN_Interface interface, uint32_t tx_id, uint32_t rx_id, SendFunction send);
+
+  void on_receive(ReceiveCallback callback) { receive_callback = callback; }
+
+  // Block size and separation time (ms) we ask the ECU for when it sends to us
+  void set_flow_control(uint8_t block_size, uint8_t separation_time_ms);
+  // Extended addressing: every frame starts with the target address byte
+  void set_addresses(int16_t tx_address, int16_t rx_address);
+  void set_can_fd(bool fd) { can_fd = fd; }
+  void set_padding(uint8_t value) { padding = value; }
+  // N_Bs / N_Cr: how long to wait for the next flow control or consecutive frame
+  void set_timeout(uint16_t timeout_ms) { this->timeout_ms = timeout_ms; }
+
+  // Start sending a message. Returns false if a message is still being sent or it is too long.
+  bool send(const uint8_t* data, uint16_t length, unsigned long currentMillis);
+
+  // Returns true if the frame belongs to this link
+  bool handle_frame(const CAN_frame& frame, unsigned long currentMillis);
+
+  void poll(unsigned long currentMillis);
+
+  // Abort any transfer in progress
+  void reset();
+
+  bool sending() const { return tx_state != TxState::Idle; }
+  bool receiving() const { return rx_buffer != nullptr; }
+  // Transfers aborted because of sequence errors, timeouts or a full pool
+  uint16_t errors() const { return error_count; }
+
+ private:
+  enum class TxState : uint8_t { Idle, WaitFlowControl, SendConsecutive };
+
+  uint8_t frame_payload_size() const;
+  void send_frame(const uint8_t* payload, uint8_t length);
+  void send_flow_control(uint8_t status);
+  void send_consecutive_frames(unsigned long currentMillis);
+  void abort_reception();
+  void deliver(const uint8_t* data, uint16_t length);
+
+  CAN_Interface interface;
+  uint32_t tx_id;
+  uint32_t rx_id;
+  SendFunction send_function;
+  ReceiveCallback receive_callback;
+
+  int16_t tx_address = NO_ADDRESS;
+  int16_t rx_address = NO_ADDRESS;
+  bool can_fd = false;
+  uint8_t padding = 0x00;
+  uint8_t block_size = 0;
+  uint8_t separation_time_ms = 0;
+  uint16_t timeout_ms = 1000;
+  uint16_t error_count = 0;
+
+  // Reception
+  uint8_t* rx_buffer = nullptr;
+  uint16_t rx_expected = 0;
+  uint16_t rx_received = 0;
+  uint8_t rx_sequence = 0;
+  uint8_t rx_block_count = 0;
+  unsigned long rx_last_ms = 0;
+
+  // Transmission
+  TxState tx_state = TxState::Idle;
+  uint8_t tx_data[ISOTP_TX_BUFFER_SIZE];
+  uint16_t tx_length = 0;
+  uint16_t tx_offset = 0;
+  uint8_t tx_sequence = 0;
+  uint8_t tx_block_remaining = 0;
+  bool tx_block_limited = false;
+  uint8_t tx_separation_ms = 0;
+  unsigned long tx_last_ms = 0;
+};
+
+#endif
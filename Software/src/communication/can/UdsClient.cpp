@@ -0,0 +1,113 @@
+#include "UdsClient.h"
+#include <string.h>
+
+UdsClient::UdsClient(CAN_Interface interface, uint32_t tx_id, uint32_t rx_id, IsoTpLink::SendFunction send)
+    : link(interface, tx_id, rx_id, send) {
+  link.on_receive([this](const uint8_t* data, uint16_t length) { on_message(data, length); });
+}
+
+void UdsClient::set_timeouts(uint16_t response_ms, uint16_t pending_ms) {
+  response_timeout_ms = response_ms;
+  pending_timeout_ms = pending_ms;
+}
+
+bool UdsClient::request(const uint8_t* data, uint8_t length, ResponseCallback callback, uint16_t timeout_ms) {
+  if (count >= UDS_MAX_QUEUED_REQUESTS || length == 0 || length > UDS_MAX_REQUEST_SIZE) {
+    return false;
+  }
+  Request& request = requests[(head + count) % UDS_MAX_QUEUED_REQUESTS];
+  memcpy(request.data, data, length);
+  request.length = length;
+  request.timeout_ms = timeout_ms;
+  request.callback = callback;
+  count++;
+  return true;
+}
+
+bool UdsClient::read_data_by_identifier(uint16_t identifier, ResponseCallback callback, uint16_t timeout_ms) {
+  uint8_t data[3] = {UDS_READ_DATA_BY_IDENTIFIER, (uint8_t)(identifier >> 8), (uint8_t)(identifier & 0xFF)};
+  return request(data, sizeof(data), callback, timeout_ms);
+}
+
+bool UdsClient::handle_frame(const CAN_frame& frame, unsigned long currentMillis) {
+  now_ms = currentMillis;
+  return link.handle_frame(frame, currentMillis);
+}
+
+void UdsClient::poll(unsigned long currentMillis) {
+  now_ms = currentMillis;
+  link.poll(currentMillis);
+
+  if (in_flight && (long)(currentMillis - deadline_ms) > 0) {
+    timeout_count++;
+    link.reset();
+    finish({Result::Timeout, requests[head].data[0], 0, nullptr, 0});
+  }
+
+  if (!in_flight && count > 0 && !link.sending()) {
+    Request& request = requests[head];
+    if (link.send(request.data, request.length, currentMillis)) {
+      in_flight = true;
+      deadline_ms = currentMillis + (request.timeout_ms > 0 ? request.timeout_ms : response_timeout_ms);
+    }
+  }
+}
+
+// Positive responses echo the data identifier or sub-function of the request,
+// which tells them apart from a late answer to an earlier request for the same service.
+static bool is_response_to(const uint8_t* request, uint8_t request_length, const uint8_t* data, uint16_t length) {
+  if (data[0] != (uint8_t)(request[0] + 0x40)) {
+    return false;
+  }
+  switch (request[0]) {
+    case UDS_READ_DATA_BY_IDENTIFIER:
+      return request_length < 3 || (length >= 3 && data[1] == request[1] && data[2] == request[2]);
+    case 0x10:  // DiagnosticSessionControl
+    case 0x11:  // ECUReset
+    case 0x19:  // ReadDTCInformation
+    case 0x31:  // RoutineControl
+      return request_length < 2 || (length >= 2 && data[1] == (request[1] & 0x7F));
+    default:
+      return true;
+  }
+}
+
+void UdsClient::on_message(const uint8_t* data, uint16_t length) {
+  if (!in_flight || length == 0) {
+    return;  // Nothing asked, or the answer to a request that already timed out
+  }
+  uint8_t service = requests[head].data[0];
+
+  if (data[0] == UDS_NEGATIVE_RESPONSE && length >= 3 && data[1] == service) {
+    if (data[2] == UDS_NRC_RESPONSE_PENDING) {
+      deadline_ms = now_ms + pending_timeout_ms;
+      return;
+    }
+    finish({Result::Negative, service, data[2], data, length});
+  } else if (is_response_to(requests[head].data, requests[head].length, data, length)) {
+    finish({Result::Positive, service, 0, data, length});
+  }
+}
+
+void UdsClient::finish(const Response& response) {
+  // Take the request off the queue first, the callback may queue the next one
+  ResponseCallback callback = std::move(requests[head].callback);
+  requests[head].callback = nullptr;
+  head = (head + 1) % UDS_MAX_QUEUED_REQUESTS;
+  count--;
+  in_flight = false;
+
+  if (callback) {
+    callback(response);
+  }
+}
+
+void UdsClient::clear() {
+  for (Request& request : requests) {
+    request.callback = nullptr;
+  }
+  head = 0;
+  count = 0;
+  in_flight = false;
+  link.reset();
+}
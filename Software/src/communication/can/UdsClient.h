@@ -0,0 +1,95 @@
+#ifndef _UDS_CLIENT_H_
+#define _UDS_CLIENT_H_
+
+#include <stdint.h>
+#include <functional>
+#include "IsoTp.h"
+#include "comm_can.h"
+
+#ifndef UDS_MAX_QUEUED_REQUESTS
+#define UDS_MAX_QUEUED_REQUESTS 16
+#endif
+
+#ifndef UDS_MAX_REQUEST_SIZE
+#define UDS_MAX_REQUEST_SIZE 16
+#endif
+
+#define UDS_READ_DATA_BY_IDENTIFIER 0x22
+#define UDS_NEGATIVE_RESPONSE 0x7F
+#define UDS_NRC_RESPONSE_PENDING 0x78
+
+// UDS (ISO 14229) requests to one ECU over an IsoTpLink.
+//
+// Batteries queue requests with a callback instead of keeping their own PID
+// state machine. The next request goes out as soon as the previous one was
+// answered, a request that gets no answer times out on its own and the queue
+// moves on. "Response pending" (NRC 0x78) extends the timeout. Answers that
+// arrive after their request timed out are recognised and dropped instead of
+// being taken for the answer to the next request.
+//
+// Call handle_frame() for frames received from the ECU and poll() from transmit_can().
+class UdsClient {
+ public:
+  enum class Result : uint8_t { Positive, Negative, Timeout };
+
+  struct Response {
+    Result result;
+    uint8_t service;  // Service ID of the request
+    uint8_t nrc;      // Negative response code, when result is Negative
+    // Positive response including the response service ID (service + 0x40). Only valid during the callback.
+    const uint8_t* data;
+    uint16_t length;
+  };
+
+  typedef std::function<void(const Response& response)> ResponseCallback;
+
+  UdsClient(CAN_Interface interface, uint32_t tx_id, uint32_t rx_id,
+            IsoTpLink::SendFunction send = transmit_can_frame_to_interface);
+  UdsClient(const UdsClient&) = delete;
+  UdsClient& operator=(const UdsClient&) = delete;
+
+  // Queue a request, returns false if the queue is full or the request too long.
+  // timeout_ms overrides the response timeout set with set_timeouts() for this request.
+  bool request(const uint8_t* data, uint8_t length, ResponseCallback callback, uint16_t timeout_ms = 0);
+  bool read_data_by_identifier(uint16_t identifier, ResponseCallback callback, uint16_t timeout_ms = 0);
+
+  bool handle_frame(const CAN_frame& frame, unsigned long currentMillis);
+  void poll(unsigned long currentMillis);
+
+  // Drop all queued requests without calling their callbacks
+  void clear();
+
+  // True when nothing is queued or waiting for an answer
+  bool idle() const { return count == 0; }
+  uint8_t queued() const { return count; }
+  uint16_t timeouts() const { return timeout_count; }
+
+  // P2 and P2* of the ECU: time to the first answer, and after a "response pending"
+  void set_timeouts(uint16_t response_ms, uint16_t pending_ms);
+
+  IsoTpLink& transport() { return link; }
+
+ private:
+  struct Request {
+    uint8_t data[UDS_MAX_REQUEST_SIZE];
+    uint8_t length;
+    uint16_t timeout_ms;
+    ResponseCallback callback;
+  };
+
+  void on_message(const uint8_t* data, uint16_t length);
+  void finish(const Response& response);
+
+  IsoTpLink link;
+  Request requests[UDS_MAX_QUEUED_REQUESTS];
+  uint8_t head = 0;   // Oldest request, the one in flight
+  uint8_t count = 0;  // Queued requests including the one in flight
+  bool in_flight = false;
+  unsigned long deadline_ms = 0;
+  unsigned long now_ms = 0;
+  uint16_t response_timeout_ms = 1000;
+  uint16_t pending_timeout_ms = 5000;
+  uint16_t timeout_count = 0;
+};
+
+#endif
@@ -0,0 +1,176 @@
+#include "UdsPollScheduler.h"
+#include <Arduino.h>
+#include <algorithm>
+#include "../../datalayer/datalayer.h"
+
+#define BUS_LOAD_WINDOW_MS 1000
+
+// Moving averages follow a change by a quarter per sample
+static uint32_t average(uint32_t current, uint32_t sample) {
+  return current - current / 4 + sample / 4;
+}
+
+UdsPollScheduler::UdsPollScheduler(UdsClient& client, CAN_Interface interface) : client(client), interface(interface) {}
+
+uint8_t UdsPollScheduler::add(uint16_t identifier, Priority priority, uint16_t period_ms, ValueCallback callback,
+                              uint16_t timeout_ms, uint8_t retries) {
+  Entry entry = {};
+  entry.stats.identifier = identifier;
+  entry.stats.target_period_ms = std::max<uint16_t>(period_ms, 1);
+  entry.priority = priority;
+  entry.timeout_ms = timeout_ms;
+  entry.retries = retries;
+  entry.callback = callback;
+  entries.push_back(entry);
+  return entries.size() - 1;
+}
+
+void UdsPollScheduler::set_request_rate(uint8_t requests_per_second) {
+  min_gap_ms = 1000 / std::max<uint8_t>(requests_per_second, 1);
+}
+
+void UdsPollScheduler::restart() {
+  started = false;
+}
+
+void UdsPollScheduler::clear() {
+  entries.clear();
+  started = false;
+}
+
+void UdsPollScheduler::update_bus_load(unsigned long currentMillis) {
+  uint32_t frames = datalayer.system.status.can_rx_stats[interface].frames_received;
+  unsigned long elapsed = currentMillis - load_window_ms;
+  if (elapsed < BUS_LOAD_WINDOW_MS) {
+    return;
+  }
+  busy = (uint64_t)(frames - load_frames) * 1000 / elapsed > UDS_POLL_BUSY_FRAMES_PER_SECOND;
+  load_frames = frames;
+  load_window_ms = currentMillis;
+}
+
+// Every period an identifier is overdue counts as one priority level higher
+int UdsPollScheduler::next_due(unsigned long currentMillis) const {
+  int best = -1;
+  int best_level = 0;
+  unsigned long best_due = 0;
+
+  for (size_t i = 0; i < entries.size(); i++) {
+    const Entry& entry = entries[i];
+    long overdue = (long)(currentMillis - entry.due_ms);
+    if (overdue < 0) {
+      continue;
+    }
+    int level = (int)entry.priority - (int)(overdue / entry.stats.target_period_ms);
+    if (busy && level >= (int)Priority::Low) {
+      continue;
+    }
+    if (best < 0 || level < best_level || (level == best_level && (long)(entry.due_ms - best_due) < 0)) {
+      best = i;
+      best_level = level;
+      best_due = entry.due_ms;
+    }
+  }
+  return best;
+}
+
+void UdsPollScheduler::run(unsigned long currentMillis) {
+  if (!started) {
+    // Everything is due now, the priorities decide the order of the first round
+    for (Entry& entry : entries) {
+      entry.due_ms = currentMillis;
+      entry.attempt = 0;
+    }
+    load_frames = datalayer.system.status.can_rx_stats[interface].frames_received;
+    load_window_ms = currentMillis;
+    last_request_ms = currentMillis - min_gap_ms;
+    last_answer_ms = currentMillis - latency_ms;
+    started = true;
+  }
+  update_bus_load(currentMillis);
+
+  if (!client.idle()) {
+    return;
+  }
+  uint16_t gap_ms = busy ? min_gap_ms * 2 : min_gap_ms;
+  if (currentMillis - last_request_ms < gap_ms || currentMillis - last_answer_ms < latency_ms) {
+    return;
+  }
+
+  int index = next_due(currentMillis);
+  if (index < 0) {
+    return;
+  }
+  Entry& entry = entries[index];
+  // The index fits the small buffer of std::function, queueing a request allocates nothing
+  uint8_t entry_index = index;
+  if (!client.read_data_by_identifier(
+          entry.stats.identifier,
+          [this, entry_index](const UdsClient::Response& response) { on_response(entry_index, response); },
+          entry.timeout_ms)) {
+    return;
+  }
+  entry.requested_ms = currentMillis;
+  // Anchored to the previous deadline, so the period does not drift by the time spent waiting for a slot
+  unsigned long next = entry.due_ms + entry.stats.target_period_ms;
+  entry.due_ms = ((long)(next - currentMillis) > 0) ? next : currentMillis + entry.stats.target_period_ms;
+  last_request_ms = currentMillis;
+}
+
+void UdsPollScheduler::on_response(uint8_t index, const UdsClient::Response& response) {
+  if (index >= entries.size()) {
+    return;  // Answer to a request queued before clear()
+  }
+  Entry& entry = entries[index];
+  Stats& stats = entry.stats;
+  unsigned long now = millis();
+
+  if (response.result == UdsClient::Result::Timeout) {
+    stats.timeouts++;
+    if (entry.attempt < entry.retries) {
+      entry.attempt++;
+      entry.due_ms = now;  // Retry at the next free slot
+      return;
+    }
+    reschedule_after_failure(entry, response);
+    return;
+  }
+
+  last_answer_ms = now;
+  uint16_t latency = std::min<unsigned long>(now - entry.requested_ms, UINT16_MAX);
+  latency_ms = (latency_ms == 0) ? latency : average(latency_ms, latency);
+
+  if (response.result == UdsClient::Result::Negative) {
+    stats.negative_responses++;
+    reschedule_after_failure(entry, response);
+    return;
+  }
+
+  stats.latency_ms = (stats.responses == 0) ? latency : average(stats.latency_ms, latency);
+  if (stats.responses > 0) {
+    uint32_t interval = now - entry.answered_ms;
+    stats.effective_period_ms = (stats.effective_period_ms == 0) ? interval : average(stats.effective_period_ms, interval);
+  }
+  stats.responses++;
+  entry.answered_ms = now;
+  entry.attempt = 0;
+  if (entry.backoff_shift > 0) {
+    // Back to the target rate
+    entry.backoff_shift = 0;
+    entry.due_ms = entry.requested_ms + stats.target_period_ms;
+  }
+
+  if (entry.callback) {
+    entry.callback(response);
+  }
+}
+
+void UdsPollScheduler::reschedule_after_failure(Entry& entry, const UdsClient::Response& response) {
+  entry.attempt = 0;
+  entry.backoff_shift = std::min<uint8_t>(entry.backoff_shift + 1, UDS_POLL_MAX_BACKOFF_SHIFT);
+  entry.due_ms = millis() + ((uint32_t)entry.stats.target_period_ms << entry.backoff_shift);
+
+  if (failure_callback) {
+    failure_callback(entry.stats.identifier, response);
+  }
+}
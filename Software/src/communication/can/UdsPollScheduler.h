@@ -0,0 +1,121 @@
+#ifndef _UDS_POLL_SCHEDULER_H_
+#define _UDS_POLL_SCHEDULER_H_
+
+#include <stdint.h>
+#include <functional>
+#include <vector>
+#include "UdsClient.h"
+
+// Diagnostic requests per second the scheduler sends at most, on top of that the
+// ECU always gets at least its average response time of rest between requests
+#ifndef UDS_POLL_REQUESTS_PER_SECOND
+#define UDS_POLL_REQUESTS_PER_SECOND 10
+#endif
+
+// Received frames per second above which the bus counts as busy: polling slows
+// down to half the rate and low priority identifiers wait. 2000 frames is about
+// half of a 500 kbit/s bus.
+#ifndef UDS_POLL_BUSY_FRAMES_PER_SECOND
+#define UDS_POLL_BUSY_FRAMES_PER_SECOND 2000
+#endif
+
+// An identifier that keeps failing is polled at most 2^N times less often than its target
+#ifndef UDS_POLL_MAX_BACKOFF_SHIFT
+#define UDS_POLL_MAX_BACKOFF_SHIFT 3
+#endif
+
+// Polls ReadDataByIdentifier values from one ECU through a UdsClient.
+//
+// Batteries register each identifier once with a priority, the refresh period
+// they would like, and optionally a response timeout and number of retries,
+// instead of stepping through a fixed round-robin. Whenever the client is idle
+// the most urgent due identifier is requested: the highest priority first, and
+// within a priority the one that is overdue the longest. An identifier that is
+// overdue by a whole period moves up one priority, so low priority values slow
+// down under load but are never starved.
+//
+// The request rate adapts to the ECU and the bus: there is at least the average
+// response time between an answer and the next request, and on a busy bus the
+// rate is halved. Identifiers that time out are retried, and when the retries or
+// a negative response say the value is not available right now, it is polled
+// less often until it answers again. stats() tells how often every value really
+// got refreshed.
+//
+// Call run() from transmit_can() after UdsClient::poll(). Other requests can
+// be queued on the same client in between, polling waits until they are done.
+class UdsPollScheduler {
+ public:
+  enum class Priority : uint8_t { High, Normal, Low };
+
+  // Called with the positive response of a polled identifier
+  typedef UdsClient::ResponseCallback ValueCallback;
+  // Called when an identifier failed after all its retries, or got a negative response
+  typedef std::function<void(uint16_t identifier, const UdsClient::Response& response)> FailureCallback;
+
+  struct Stats {
+    uint16_t identifier;
+    uint16_t target_period_ms;
+    uint32_t effective_period_ms;  // Average time between two answers, 0 until the second answer
+    uint16_t latency_ms;           // Average time from request to answer
+    uint32_t responses;
+    uint16_t timeouts;
+    uint16_t negative_responses;
+  };
+
+  UdsPollScheduler(UdsClient& client, CAN_Interface interface);
+
+  // Returns the index of the identifier for stats()
+  uint8_t add(uint16_t identifier, Priority priority, uint16_t period_ms, ValueCallback callback,
+              uint16_t timeout_ms = 0, uint8_t retries = 1);
+
+  void on_failure(FailureCallback callback) { failure_callback = callback; }
+  void set_request_rate(uint8_t requests_per_second);
+
+  // Request the next identifier if it is time to
+  void run(unsigned long currentMillis);
+
+  // Poll every identifier again from now on, e.g. after a new diagnostic session was entered
+  void restart();
+  void clear();
+
+  uint8_t size() const { return entries.size(); }
+  const Stats& stats(uint8_t index) const { return entries[index].stats; }
+  uint16_t average_latency_ms() const { return latency_ms; }
+  bool bus_busy() const { return busy; }
+
+ private:
+  struct Entry {
+    Stats stats;
+    Priority priority;
+    uint16_t timeout_ms;
+    uint8_t retries;
+    uint8_t attempt;
+    uint8_t backoff_shift;
+    unsigned long due_ms;
+    unsigned long requested_ms;
+    unsigned long answered_ms;
+    ValueCallback callback;
+  };
+
+  void update_bus_load(unsigned long currentMillis);
+  int next_due(unsigned long currentMillis) const;
+  void on_response(uint8_t index, const UdsClient::Response& response);
+  void reschedule_after_failure(Entry& entry, const UdsClient::Response& response);
+
+  UdsClient& client;
+  CAN_Interface interface;
+  std::vector<Entry> entries;
+  FailureCallback failure_callback;
+
+  uint16_t min_gap_ms = 1000 / UDS_POLL_REQUESTS_PER_SECOND;
+  uint16_t latency_ms = 0;
+  bool started = false;
+  unsigned long last_request_ms = 0;
+  unsigned long last_answer_ms = 0;
+
+  bool busy = false;
+  uint32_t load_frames = 0;
+  unsigned long load_window_ms = 0;
+};
+
+#endif
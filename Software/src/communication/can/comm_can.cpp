@@ -2,16 +2,20 @@
 #include "../../lib/pierremolinaro-ACAN2517FD/ACAN2517FD.h"
 #include "../../lib/pierremolinaro-acan-esp32/ACAN_ESP32.h"
 #include "../../lib/pierremolinaro-acan2515/ACAN2515.h"
+#include "CanAcceptanceFilters.h"
+#include "CanDispatchTable.h"
 #include "CanReceiver.h"
 #include "comm_can.h"
 #include "src/datalayer/datalayer.h"
 #include "src/devboard/safety/safety.h"
 #include "src/devboard/sdcard/sdcard.h"
 #include "src/devboard/utils/logging.h"
+#include "src/devboard/utils/spsc_queue.h"
 
 #include <esp_private/periph_ctrl.h>
 
 #include <algorithm>
+#include <atomic>
 #include <map>
 
 // The spare ESP32 SPI buses are called HSPI and VSPI, whereas on a ESP32S3
@@ -37,12 +41,32 @@ struct CanReceiverRegistration {
 };
 
 static std::multimap<CAN_Interface, CanReceiverRegistration> can_receivers;
+// Built from can_receivers in init_CAN(), when all receivers are fully constructed
+static CanDispatchTable can_dispatch;
+
+// Frames for the webserver CAN logger, queued by the core task and formatted on the connectivity core
+struct LoggedCanFrame {
+  CAN_frame frame;
+  CAN_Interface interface;
+  frameDirection direction;
+  unsigned long timestamp_ms;
+};
+// The core task and the CAN replay task both log frames. Each task claims a queue of its own on its first
+// frame, so every queue keeps a single producer and pushing never takes a lock.
+static SpscQueue<LoggedCanFrame, CAN_LOG_QUEUE_SIZE> logged_can_frames[CAN_LOG_PRODUCERS];
+static std::atomic<TaskHandle_t> logged_can_frames_owner[CAN_LOG_PRODUCERS];
+// Frames from tasks that found every queue claimed
+static std::atomic<uint32_t> logged_can_frames_unowned{0};
+// Guards logged_can_messages between the connectivity task that formats into it and the webserver that reads it
+static portMUX_TYPE logged_can_messages_lock = portMUX_INITIALIZER_UNLOCKED;
 
 volatile bool send_ok_native = 0;
 volatile bool send_ok_2515 = 0;
 volatile bool send_ok_2518 = 0;
 
-void map_can_frame_to_variable(CAN_frame* rx_frame, CAN_Interface interface);
+void map_can_frame_to_variable(const CAN_frame* rx_frame, CAN_Interface interface);
+static void update_can_rx_stats(CAN_Interface interface, uint16_t frames, uint16_t queue_level, uint16_t queue_size,
+                                bool overflowed);
 
 void register_can_receiver(CanReceiver* receiver, CAN_Interface interface, CAN_Speed speed) {
   can_receivers.insert({interface, {receiver, speed}});
@@ -50,8 +74,18 @@ void register_can_receiver(CanReceiver* receiver, CAN_Interface interface, CAN_S
 }
 
 uint32_t init_native_can(CAN_Speed speed, gpio_num_t tx_pin, gpio_num_t rx_pin);
+static void compute_acceptance_filters();
+static uint16_t begin_can2515();
+static uint32_t begin_canfd();
+static ACAN_ESP32_Filter native_filter();
+static bool can_logger_active();
 
 ACAN_ESP32_Settings* settingsespcan = nullptr;
+// Hardware acceptance filter of the native CAN, kept for restarts and speed changes
+static bool native_can_filtered = false;
+static ACAN_ESP32_Filter native_can_filter = ACAN_ESP32_Filter::acceptAll();
+// True while a CAN logger runs, the interfaces then accept every frame
+static bool acceptance_filters_open = false;
 
 static uint32_t QUARTZ_FREQUENCY;
 SPIClass SPI2515(SPI2515_BUS);
@@ -61,12 +95,17 @@ ACAN2515* can2515;
 ACAN2515Settings* settings2515;
 
 static ACAN2515_Buffer16 gBuffer;
+// MCP2515 acceptance masks (RXM0, RXM1) and filters (RXF0-1 use RXM0, RXF2-5 use RXM1)
+static bool can2515_filtered = false;
+static ACAN2515Mask can2515_masks[2];
+static ACAN2515Mask can2515_filters[6];
 
 static ACAN2517FDSettings::Oscillator quartz_fd_frequency;
 SPIClass SPI2517(SPI2517_BUS);
 uint8_t user_selected_canfd_addon_crystal_frequency_mhz = 0;
 ACAN2517FD* canfd;
 ACAN2517FDSettings* settings2517;
+static ACAN2517FDFilters* canfd_filters = nullptr;
 bool use_canfd_as_can = false;
 bool native_can_initialized = false;
 //CAN logging filter settings
@@ -74,6 +113,15 @@ uint16_t user_selected_CAN_ID_cutoff_filter = 0;  //Messages below this ID will
 
 bool init_CAN() {
 
+  can_dispatch.clear();
+  for (auto& registration : can_receivers) {
+    can_dispatch.add(registration.second.receiver, registration.first);
+  }
+
+  // Logging should show all bus traffic, so the filters are only applied while no CAN logger is running
+  compute_acceptance_filters();
+  acceptance_filters_open = can_logger_active();
+
   if (user_selected_can_addon_crystal_frequency_mhz > 0) {
     QUARTZ_FREQUENCY = user_selected_can_addon_crystal_frequency_mhz * 1000000UL;
   } else {
@@ -170,7 +218,7 @@ bool init_CAN() {
 
     settings2515 = new ACAN2515Settings(QUARTZ_FREQUENCY, bitRate);
     settings2515->mRequestedMode = ACAN2515Settings::NormalMode;
-    const uint16_t errorCode2515 = can2515->begin(*settings2515, [] { can2515->isr(); });
+    const uint16_t errorCode2515 = begin_can2515();
     if (errorCode2515 == 0) {
       logging.println("Can ok");
     } else {
@@ -209,7 +257,7 @@ bool init_CAN() {
     // ListenOnly / Normal20B / NormalFDs
     settings2517->mRequestedMode = use_canfd_as_can ? ACAN2517FDSettings::Normal20B : ACAN2517FDSettings::NormalFD;
 
-    const uint32_t errorCode2517 = canfd->begin(*settings2517, [] { canfd->isr(); });
+    const uint32_t errorCode2517 = begin_canfd();
     canfd->poll();
     if (errorCode2517 == 0) {
       logging.print("Bit Rate prescaler: ");
@@ -246,7 +294,7 @@ void transmit_can_frame_to_interface(const CAN_frame* tx_frame, CAN_Interface in
   print_can_frame(*tx_frame, interface, frameDirection(MSG_TX));
 
   if (datalayer.system.info.CAN_SD_logging_active) {
-    add_can_frame_to_buffer(*tx_frame, frameDirection(MSG_TX));
+    add_can_frame_to_buffer(*tx_frame, interface, frameDirection(MSG_TX));
   }
 
   switch (interface) {
@@ -255,10 +303,8 @@ void transmit_can_frame_to_interface(const CAN_frame* tx_frame, CAN_Interface in
       CANMessage frame;
       frame.id = tx_frame->ID;
       frame.ext = tx_frame->ext_ID;
-      frame.len = tx_frame->DLC;
-      for (uint8_t i = 0; i < frame.len; i++) {
-        frame.data[i] = tx_frame->data.u8[i];
-      }
+      frame.len = std::min(tx_frame->DLC, (uint8_t)8);
+      memcpy(frame.data, tx_frame->data.u8, frame.len);
       send_ok_native = ACAN_ESP32::can.tryToSend(frame);
 
       if (!send_ok_native) {
@@ -270,11 +316,9 @@ void transmit_can_frame_to_interface(const CAN_frame* tx_frame, CAN_Interface in
       CANMessage MCP2515Frame;
       MCP2515Frame.id = tx_frame->ID;
       MCP2515Frame.ext = tx_frame->ext_ID;
-      MCP2515Frame.len = tx_frame->DLC;
+      MCP2515Frame.len = std::min(tx_frame->DLC, (uint8_t)8);
       MCP2515Frame.rtr = false;
-      for (uint8_t i = 0; i < MCP2515Frame.len; i++) {
-        MCP2515Frame.data[i] = tx_frame->data.u8[i];
-      }
+      memcpy(MCP2515Frame.data, tx_frame->data.u8, MCP2515Frame.len);
 
       send_ok_2515 = can2515->tryToSend(MCP2515Frame);
       if (!send_ok_2515) {
@@ -291,10 +335,8 @@ void transmit_can_frame_to_interface(const CAN_frame* tx_frame, CAN_Interface in
       }
       MCP2518Frame.id = tx_frame->ID;
       MCP2518Frame.ext = tx_frame->ext_ID;
-      MCP2518Frame.len = tx_frame->DLC;
-      for (uint8_t i = 0; i < MCP2518Frame.len; i++) {
-        MCP2518Frame.data[i] = tx_frame->data.u8[i];
-      }
+      MCP2518Frame.len = std::min(tx_frame->DLC, (uint8_t)64);
+      memcpy(MCP2518Frame.data, tx_frame->data.u8, MCP2518Frame.len);
       send_ok_2518 = canfd->tryToSend(MCP2518Frame);
       if (!send_ok_2518) {
         datalayer.system.info.can_2518_send_fail = true;
@@ -307,7 +349,32 @@ void transmit_can_frame_to_interface(const CAN_frame* tx_frame, CAN_Interface in
 }
 
 // Receive functions
+// The web CAN logger is started and stopped at runtime, SD and USB logging from the settings
+static bool can_logger_active() {
+  return datalayer.system.info.CAN_SD_logging_active || datalayer.system.info.CAN_usb_logging_active ||
+         datalayer.system.info.can_logging_active;
+}
+
+// Restarts the filtered interfaces when a CAN logger starts or stops, so the logger sees all bus traffic.
+// Frames arriving during the restart are lost.
+static void update_acceptance_filters() {
+  if (can_logger_active() == acceptance_filters_open) {
+    return;
+  }
+  acceptance_filters_open = !acceptance_filters_open;
+
+  // While CAN is paused by the safety checks, the new filters are applied when it is restarted
+  if ((native_can_filtered || can2515_filtered || canfd_filters != nullptr) && allowed_to_send_CAN) {
+    logging.println(acceptance_filters_open ? "CAN logger started, opening hardware filters"
+                                            : "CAN logger stopped, restoring hardware filters");
+    stop_can();
+    restart_can();
+  }
+}
+
 void receive_can() {
+  update_acceptance_filters();
+
   if (native_can_initialized) {
     receive_frame_can_native();  // Receive CAN messages from native CAN port
   }
@@ -321,64 +388,111 @@ void receive_can() {
   }
 }
 
-void receive_frame_can_native() {  // This section checks if we have a complete CAN message incoming on native CAN port
+void receive_frame_can_native() {  // This section drains complete CAN messages incoming on native CAN port
   CANMessage frame;
+  uint16_t count = 0;
 
-  if (ACAN_ESP32::can.available()) {
-    if (ACAN_ESP32::can.receive(frame)) {
+  while (count < CAN_RX_BUDGET_PER_TICK && ACAN_ESP32::can.available()) {
+    if (!ACAN_ESP32::can.receive(frame)) {
+      break;
+    }
+    count++;
 
-      CAN_frame rx_frame;
-      rx_frame.ID = frame.id;
-      rx_frame.ext_ID = frame.ext;
-      rx_frame.DLC = frame.len;
-      for (uint8_t i = 0; i < frame.len && i < 8; i++) {
-        rx_frame.data.u8[i] = frame.data[i];
-      }
+    CAN_frame rx_frame;
+    rx_frame.FD = false;
+    rx_frame.ID = frame.id;
+    rx_frame.ext_ID = frame.ext;
+    rx_frame.DLC = std::min(frame.len, (uint8_t)8);
+    memcpy(rx_frame.data.u8, frame.data, rx_frame.DLC);
 
-      //message incoming, pass it on to the handler
-      map_can_frame_to_variable(&rx_frame, CAN_NATIVE);
-    }
+    //message incoming, pass it on to the handler
+    map_can_frame_to_variable(&rx_frame, CAN_NATIVE);
   }
+
+  // The driver marks an overflow by pushing the peak count above the queue size. The peak
+  // is reset every tick, so it is the fullest the queue got since the previous one.
+  const uint16_t size = ACAN_ESP32::can.driverReceiveBufferSize();
+  const uint16_t peak = ACAN_ESP32::can.driverReceiveBufferPeakCount();
+  update_can_rx_stats(CAN_NATIVE, count, std::min(peak, size), size, peak > size);
+  ACAN_ESP32::can.resetDriverReceiveBufferPeakCount();
 }
 
-void receive_frame_can_addon() {  // This section checks if we have a complete CAN message incoming on add-on CAN port
+void receive_frame_can_addon() {  // This section drains complete CAN messages incoming on add-on CAN port
   CAN_frame rx_frame;             // Struct with our CAN format
   CANMessage MCP2515frame;        // Struct with ACAN2515 library format, needed to use the MCP2515 library
+  uint16_t count = 0;
+
+  // The ACAN2515 buffer silently drops frames when full, so a full queue at the start of the tick counts as overflow
+  const uint16_t size = can2515->receiveBufferSize();
+  const uint16_t pending = can2515->receiveBufferCount();
 
-  if (can2515->available()) {
+  while (count < CAN_RX_BUDGET_PER_TICK && can2515->available()) {
     can2515->receive(MCP2515frame);
+    count++;
 
+    rx_frame.FD = false;
     rx_frame.ID = MCP2515frame.id;
     rx_frame.ext_ID = MCP2515frame.ext;
-    rx_frame.DLC = MCP2515frame.len;
-    for (uint8_t i = 0; i < MCP2515frame.len && i < 8; i++) {
-      rx_frame.data.u8[i] = MCP2515frame.data[i];
-    }
+    rx_frame.DLC = std::min(MCP2515frame.len, (uint8_t)8);
+    memcpy(rx_frame.data.u8, MCP2515frame.data, rx_frame.DLC);
 
     //message incoming, pass it on to the handler
     map_can_frame_to_variable(&rx_frame, CAN_ADDON_MCP2515);
   }
+
+  update_can_rx_stats(CAN_ADDON_MCP2515, count, pending, size, pending >= size);
 }
 
-void receive_frame_canfd_addon() {  // This section checks if we have a complete CAN-FD message incoming
+void receive_frame_canfd_addon() {  // This section drains complete CAN-FD messages incoming
   CANFDMessage MCP2518frame;
-  int count = 0;
-  while (canfd->available() && count++ < 16) {
+  uint16_t count = 0;
+
+  while (count < CAN_RX_BUDGET_PER_TICK && canfd->available()) {
     canfd->receive(MCP2518frame);
+    count++;
 
     CAN_frame rx_frame;
+    rx_frame.FD = (MCP2518frame.type == CANFDMessage::CANFD_WITH_BIT_RATE_SWITCH ||
+                   MCP2518frame.type == CANFDMessage::CANFD_NO_BIT_RATE_SWITCH);
     rx_frame.ID = MCP2518frame.id;
     rx_frame.ext_ID = MCP2518frame.ext;
-    rx_frame.DLC = MCP2518frame.len;
-    memcpy(rx_frame.data.u8, MCP2518frame.data, std::min(rx_frame.DLC, (uint8_t)64));
+    rx_frame.DLC = std::min(MCP2518frame.len, (uint8_t)64);
+    memcpy(rx_frame.data.u8, MCP2518frame.data, rx_frame.DLC);
     //message incoming, pass it on to the handler
     map_can_frame_to_variable(&rx_frame, CANFD_ADDON_MCP2518);
     map_can_frame_to_variable(&rx_frame, CANFD_NATIVE);
   }
+
+  // The driver stops taking frames from the chip while its queue is full, so lost frames show up as hardware FIFO
+  // overflows. A driver queue overflow pushes its peak count above the queue size, but that peak cannot be reset,
+  // so it is counted once. The driver has no count of waiting frames either, the frames drained this tick stand in.
+  static bool driver_overflow_counted = false;
+  const uint16_t size = settings2517->mDriverReceiveFIFOSize;
+  const bool driver_overflow = !driver_overflow_counted && canfd->driverReceiveBufferPeakCount() > size;
+  driver_overflow_counted |= driver_overflow;
+  const uint8_t hw_overflows = canfd->hardwareReceiveBufferOverflowCount();
+  if (hw_overflows > 0) {
+    canfd->resetHardwareReceiveBufferOverflowCount();
+    datalayer.system.status.can_rx_stats[CANFD_ADDON_MCP2518].rx_overflows += hw_overflows;
+  }
+  update_can_rx_stats(CANFD_ADDON_MCP2518, count, std::min(count, size), size, driver_overflow);
+}
+
+static void update_can_rx_stats(CAN_Interface interface, uint16_t frames, uint16_t queue_level, uint16_t queue_size,
+                                bool overflowed) {
+  DATALAYER_CAN_RX_STATS_TYPE& stats = datalayer.system.status.can_rx_stats[interface];
+  stats.frames_received += frames;
+  stats.queue_size = queue_size;
+  if (queue_level > stats.queue_high_water) {
+    stats.queue_high_water = queue_level;
+  }
+  if (overflowed) {
+    stats.rx_overflows++;
+  }
 }
 
 // Support functions
-void print_can_frame(CAN_frame frame, CAN_Interface interface, frameDirection msgDir) {
+void print_can_frame(const CAN_frame& frame, CAN_Interface interface, frameDirection msgDir) {
 
   if (datalayer.system.info.CAN_usb_logging_active) {
     uint8_t i = 0;
@@ -412,7 +526,7 @@ void print_can_frame(CAN_frame frame, CAN_Interface interface, frameDirection ms
   }
 }
 
-void map_can_frame_to_variable(CAN_frame* rx_frame, CAN_Interface interface) {
+void map_can_frame_to_variable(const CAN_frame* rx_frame, CAN_Interface interface) {
   if (interface !=
       CANFD_NATIVE) {  //Avoid printing twice due to receive_frame_canfd_addon sending to both FD interfaces
     //TODO: This check can be removed later when refactored to use inline functions for logging
@@ -423,52 +537,108 @@ void map_can_frame_to_variable(CAN_frame* rx_frame, CAN_Interface interface) {
     if (interface !=
         CANFD_NATIVE) {  //Avoid printing twice due to receive_frame_canfd_addon sending to both FD interfaces
       //TODO: This check can be removed later when refactored to use inline functions for logging
-      add_can_frame_to_buffer(*rx_frame, frameDirection(MSG_RX));
+      add_can_frame_to_buffer(*rx_frame, interface, frameDirection(MSG_RX));
     }
   }
 
-  // Send the frame to all the receivers registered for this interface.
-  auto receivers = can_receivers.equal_range(interface);
+  // Send the frame to the receivers on this interface that subscribed to its ID.
+  can_dispatch.dispatch(rx_frame, interface);
+}
 
-  for (auto it = receivers.first; it != receivers.second; ++it) {
-    auto& receiver = it->second;
-    receiver.receiver->receive_can_frame(rx_frame);
+void dump_can_frame(const CAN_frame& frame, CAN_Interface interface, frameDirection msgDir) {
+  // Only queue the raw frame here, the text is produced by format_logged_can_frames() on the connectivity core
+  TaskHandle_t task = xTaskGetCurrentTaskHandle();
+  for (int i = 0; i < CAN_LOG_PRODUCERS; i++) {
+    TaskHandle_t owner = logged_can_frames_owner[i].load(std::memory_order_acquire);
+    if (owner == nullptr && logged_can_frames_owner[i].compare_exchange_strong(owner, task)) {
+      owner = task;
+    }
+    if (owner == task) {
+      logged_can_frames[i].push({frame, interface, msgDir, millis()});
+      return;
+    }
   }
+  logged_can_frames_unowned.fetch_add(1, std::memory_order_relaxed);
 }
 
-void dump_can_frame(CAN_frame& frame, CAN_Interface interface, frameDirection msgDir) {
-  char* message_string = datalayer.system.info.logged_can_messages;
-  int offset = datalayer.system.info.logged_can_messages_offset;  // Keeps track of the current position in the buffer
-  size_t message_string_size = sizeof(datalayer.system.info.logged_can_messages);
-
-  if (offset + 128 > sizeof(datalayer.system.info.logged_can_messages)) {
-    // Not enough space, reset and start from the beginning
-    offset = 0;
+uint32_t logged_can_frames_dropped() {
+  uint32_t dropped = logged_can_frames_unowned.load(std::memory_order_relaxed);
+  for (int i = 0; i < CAN_LOG_PRODUCERS; i++) {
+    dropped += logged_can_frames[i].dropped_count();
   }
-  unsigned long currentTime = millis();
+  return dropped;
+}
+
+// Format one logged frame into line, the way SavvyCAN imports it. Returns the length of the line.
+static int format_logged_can_frame(const LoggedCanFrame& logged, char* line, size_t line_size) {
+  const CAN_frame& frame = logged.frame;
+
   // Add timestamp
-  offset += snprintf(message_string + offset, message_string_size - offset, "(%lu.%03lu) ", currentTime / 1000,
-                     currentTime % 1000);
+  int length = snprintf(line, line_size, "(%lu.%03lu) ", logged.timestamp_ms / 1000, logged.timestamp_ms % 1000);
 
   // Add direction. Multiplying the interface by two ensures that SavvyCAN puts TX and RX in a different bus.
-  offset += snprintf(message_string + offset, message_string_size - offset, "%s%d ", (msgDir == MSG_RX) ? "RX" : "TX",
-                     (int)(interface * 2) + (msgDir == MSG_RX ? 0 : 1));
+  length += snprintf(line + length, line_size - length, "%s%d ", (logged.direction == MSG_RX) ? "RX" : "TX",
+                     (int)(logged.interface * 2) + (logged.direction == MSG_RX ? 0 : 1));
 
   // Add ID and DLC
-  offset += snprintf(message_string + offset, message_string_size - offset, "%lX [%u] ", frame.ID, frame.DLC);
+  length += snprintf(line + length, line_size - length, "%lX [%u] ", frame.ID, frame.DLC);
 
   // Add data bytes
   for (uint8_t i = 0; i < frame.DLC; i++) {
     if (i < frame.DLC - 1) {
-      offset += snprintf(message_string + offset, message_string_size - offset, "%02X ", frame.data.u8[i]);
+      length += snprintf(line + length, line_size - length, "%02X ", frame.data.u8[i]);
     } else {
-      offset += snprintf(message_string + offset, message_string_size - offset, "%02X", frame.data.u8[i]);
+      length += snprintf(line + length, line_size - length, "%02X", frame.data.u8[i]);
     }
   }
   // Add linebreak
-  offset += snprintf(message_string + offset, message_string_size - offset, "\n");
+  length += snprintf(line + length, line_size - length, "\n");
+  return std::min(length, (int)line_size - 1);
+}
+
+void format_logged_can_frames() {
+  char* message_string = datalayer.system.info.logged_can_messages;
+  size_t message_string_size = sizeof(datalayer.system.info.logged_can_messages);
+  // Room for a CAN FD frame with 64 data bytes
+  char line[256];
+  LoggedCanFrame logged;
+
+  for (int queue = 0; queue < CAN_LOG_PRODUCERS; queue++) {
+    while (logged_can_frames[queue].pop(logged)) {
+      // Format outside the lock, so the webserver only waits for the copy
+      int length = format_logged_can_frame(logged, line, sizeof(line));
+
+      portENTER_CRITICAL(&logged_can_messages_lock);
+      size_t offset = datalayer.system.info.logged_can_messages_offset;  // Current position in the buffer
+      if (offset + length + 1 > message_string_size) {
+        // Not enough space, reset and start from the beginning
+        offset = 0;
+      }
+      memcpy(message_string + offset, line, length + 1);
+      datalayer.system.info.logged_can_messages_offset = offset + length;  // Update offset in buffer
+      portEXIT_CRITICAL(&logged_can_messages_lock);
+    }
+  }
+}
 
-  datalayer.system.info.logged_can_messages_offset = offset;  // Update offset in buffer
+String copy_logged_can_messages() {
+  String logs;
+  // Reserve before taking the lock, the copy itself must not allocate
+  if (!logs.reserve(sizeof(datalayer.system.info.logged_can_messages))) {
+    return logs;
+  }
+  portENTER_CRITICAL(&logged_can_messages_lock);
+  logs.concat(datalayer.system.info.logged_can_messages,
+              strnlen(datalayer.system.info.logged_can_messages, sizeof(datalayer.system.info.logged_can_messages)));
+  portEXIT_CRITICAL(&logged_can_messages_lock);
+  return logs;
+}
+
+void clear_logged_can_messages() {
+  portENTER_CRITICAL(&logged_can_messages_lock);
+  datalayer.system.info.logged_can_messages_offset = 0;
+  datalayer.system.info.logged_can_messages[0] = '\0';
+  portEXIT_CRITICAL(&logged_can_messages_lock);
 }
 
 void stop_can() {
@@ -489,17 +659,17 @@ void stop_can() {
 
 void restart_can() {
   if (can_receivers.find(CAN_NATIVE) != can_receivers.end()) {
-    ACAN_ESP32::can.begin(*settingsespcan);
+    ACAN_ESP32::can.begin(*settingsespcan, native_filter());
   }
 
   if (can2515) {
     SPI2515.begin();
-    can2515->begin(*settings2515, [] { can2515->isr(); });
+    begin_can2515();
   }
 
   if (canfd) {
     SPI2517.begin();
-    canfd->begin(*settings2517, [] { canfd->isr(); });
+    begin_canfd();
   }
 }
 
@@ -523,7 +693,11 @@ uint32_t init_native_can(CAN_Speed speed, gpio_num_t tx_pin, gpio_num_t rx_pin)
   settingsespcan->mRxPin = rx_pin;
 
   // (Re)start the CAN interface
-  return ACAN_ESP32::can.begin(*settingsespcan);
+  return ACAN_ESP32::can.begin(*settingsespcan, native_filter());
+}
+
+static ACAN_ESP32_Filter native_filter() {
+  return (native_can_filtered && !acceptance_filters_open) ? native_can_filter : ACAN_ESP32_Filter::acceptAll();
 }
 
 // Change the speed of the given CAN interface. Returns true if successful.
@@ -541,3 +715,170 @@ bool change_can_speed(CAN_Interface interface, CAN_Speed speed) {
 
   return false;
 }
+
+// Split subscribed IDs by frame format, the dispatch table marks extended IDs with CAN_EXTENDED_ID_FLAG
+static void split_can_ids(const std::vector<uint32_t>& ids, std::vector<uint32_t>& standard,
+                          std::vector<uint32_t>& extended) {
+  for (uint32_t id : ids) {
+    if (id & CAN_EXTENDED_ID_FLAG) {
+      extended.push_back(id & ~CAN_EXTENDED_ID_FLAG);
+    } else {
+      standard.push_back(id);
+    }
+  }
+}
+
+// The TWAI controller has two standard filters or one extended filter, but can't match both formats at once.
+static void compute_native_can_filter(const std::vector<uint32_t>& ids) {
+  std::vector<uint32_t> standard;
+  std::vector<uint32_t> extended;
+  split_can_ids(ids, standard, extended);
+
+  if (!standard.empty() && extended.empty()) {
+    auto groups = compute_can_filter_groups(standard, CAN_STANDARD_ID_MASK, 2);
+    const CanFilterGroup& first = groups.front();
+    const CanFilterGroup& second = groups.back();
+    native_can_filter = ACAN_ESP32_Filter::dualStandardFilter(
+        ACAN_ESP32_Filter::data, first.code, ~first.mask & CAN_STANDARD_ID_MASK, ACAN_ESP32_Filter::data, second.code,
+        ~second.mask & CAN_STANDARD_ID_MASK);
+    native_can_filtered = true;
+    logging.printf("Native CAN: hardware filter for %d standard IDs\n", (int)standard.size());
+  } else if (standard.empty() && !extended.empty()) {
+    auto groups = compute_can_filter_groups(extended, CAN_EXTENDED_ID_MASK, 1);
+    native_can_filter = ACAN_ESP32_Filter::singleExtendedFilter(ACAN_ESP32_Filter::data, groups[0].code,
+                                                                ~groups[0].mask & CAN_EXTENDED_ID_MASK);
+    native_can_filtered = true;
+    logging.printf("Native CAN: hardware filter for %d extended IDs\n", (int)extended.size());
+  }
+}
+
+static ACAN2515Mask mask_2515(const CanFilterGroup& group, bool extended) {
+  return extended ? extended2515Mask(group.mask) : standard2515Mask(group.mask, 0, 0);
+}
+
+static ACAN2515Mask filter_2515(const CanFilterGroup& group, bool extended) {
+  return extended ? extended2515Filter(group.code) : standard2515Filter(group.code, 0, 0);
+}
+
+// The MCP2515 has two filters sharing RXM0 and four filters sharing RXM1. When both frame formats are
+// subscribed, each mask gets one format, the format with most IDs gets the four filters.
+static void compute_can2515_filters(const std::vector<uint32_t>& ids) {
+  std::vector<uint32_t> standard;
+  std::vector<uint32_t> extended;
+  split_can_ids(ids, standard, extended);
+
+  std::vector<CanFilterGroup> rxb0;
+  std::vector<CanFilterGroup> rxb1;
+  bool rxb0_extended;
+  bool rxb1_extended;
+
+  if (standard.empty() || extended.empty()) {
+    rxb0_extended = rxb1_extended = standard.empty();
+    const uint32_t id_mask = rxb0_extended ? CAN_EXTENDED_ID_MASK : CAN_STANDARD_ID_MASK;
+    auto groups = compute_can_filter_groups(rxb0_extended ? extended : standard, id_mask, 6);
+    split_can_filter_groups(groups, 2, 4, id_mask, rxb0, rxb1);
+  } else {
+    rxb0_extended = standard.size() > extended.size();
+    rxb1_extended = !rxb0_extended;
+    const uint32_t rxb0_id_mask = rxb0_extended ? CAN_EXTENDED_ID_MASK : CAN_STANDARD_ID_MASK;
+    const uint32_t rxb1_id_mask = rxb1_extended ? CAN_EXTENDED_ID_MASK : CAN_STANDARD_ID_MASK;
+    std::vector<CanFilterGroup> unused;
+    split_can_filter_groups(compute_can_filter_groups(rxb0_extended ? extended : standard, rxb0_id_mask, 2), 2, 0,
+                            rxb0_id_mask, rxb0, unused);
+    split_can_filter_groups(compute_can_filter_groups(rxb1_extended ? extended : standard, rxb1_id_mask, 4), 0, 4,
+                            rxb1_id_mask, unused, rxb1);
+  }
+
+  // Every filter register must be written, unused ones repeat a filter that is already in use
+  if (rxb0.empty()) {
+    rxb0.push_back(rxb1.front());
+    rxb0_extended = rxb1_extended;
+  }
+  if (rxb1.empty()) {
+    rxb1.push_back(rxb0.front());
+    rxb1_extended = rxb0_extended;
+  }
+
+  can2515_masks[0] = mask_2515(rxb0.front(), rxb0_extended);
+  can2515_masks[1] = mask_2515(rxb1.front(), rxb1_extended);
+  for (size_t i = 0; i < 2; i++) {
+    can2515_filters[i] = filter_2515(rxb0[std::min(i, rxb0.size() - 1)], rxb0_extended);
+  }
+  for (size_t i = 0; i < 4; i++) {
+    can2515_filters[2 + i] = filter_2515(rxb1[std::min(i, rxb1.size() - 1)], rxb1_extended);
+  }
+  can2515_filtered = true;
+  logging.printf("MCP2515: hardware filters for %d IDs\n", (int)ids.size());
+}
+
+// The MCP2518FD has 32 filters with a mask each, shared between the two frame formats
+static void compute_canfd_filters(const std::vector<uint32_t>& ids) {
+  const size_t filter_count = 32;
+  std::vector<uint32_t> standard;
+  std::vector<uint32_t> extended;
+  split_can_ids(ids, standard, extended);
+
+  size_t standard_slots = standard.size();
+  if (standard.size() + extended.size() > filter_count) {
+    standard_slots = (filter_count * standard.size()) / ids.size();
+    standard_slots = std::max(standard_slots, standard.empty() ? (size_t)0 : (size_t)1);
+    standard_slots = std::min(standard_slots, extended.empty() ? filter_count : filter_count - 1);
+  }
+
+  canfd_filters = new ACAN2517FDFilters();
+  for (const CanFilterGroup& group : compute_can_filter_groups(standard, CAN_STANDARD_ID_MASK, standard_slots)) {
+    canfd_filters->appendFilter(kStandard, group.mask, group.code, NULL);
+  }
+  for (const CanFilterGroup& group :
+       compute_can_filter_groups(extended, CAN_EXTENDED_ID_MASK, filter_count - standard_slots)) {
+    canfd_filters->appendFilter(kExtended, group.mask, group.code, NULL);
+  }
+
+  if (canfd_filters->filterStatus() != ACAN2517FDFilters::kFiltersOk) {
+    logging.println("MCP2518FD: invalid hardware filters, accepting all frames");
+    delete canfd_filters;
+    canfd_filters = nullptr;
+  } else {
+    logging.printf("MCP2518FD: %d hardware filters for %d IDs\n", canfd_filters->filterCount(), (int)ids.size());
+  }
+}
+
+static void compute_acceptance_filters() {
+  if (can_receivers.find(CAN_NATIVE) != can_receivers.end() && !can_dispatch.accepts_all(CAN_NATIVE)) {
+    compute_native_can_filter(can_dispatch.subscribed_ids(CAN_NATIVE));
+  }
+
+  if (can_receivers.find(CAN_ADDON_MCP2515) != can_receivers.end() && !can_dispatch.accepts_all(CAN_ADDON_MCP2515)) {
+    compute_can2515_filters(can_dispatch.subscribed_ids(CAN_ADDON_MCP2515));
+  }
+
+  // Frames from the MCP2518 are delivered to both CAN-FD interfaces
+  if (!can_dispatch.accepts_all(CANFD_NATIVE) && !can_dispatch.accepts_all(CANFD_ADDON_MCP2518)) {
+    std::vector<uint32_t> ids = can_dispatch.subscribed_ids(CANFD_NATIVE);
+    std::vector<uint32_t> addon_ids = can_dispatch.subscribed_ids(CANFD_ADDON_MCP2518);
+    ids.insert(ids.end(), addon_ids.begin(), addon_ids.end());
+    if (!ids.empty()) {
+      compute_canfd_filters(ids);
+    }
+  }
+}
+
+static uint16_t begin_can2515() {
+  if (!can2515_filtered || acceptance_filters_open) {
+    return can2515->begin(*settings2515, [] { can2515->isr(); });
+  }
+
+  const ACAN2515AcceptanceFilter filters[] = {
+      {can2515_filters[0], NULL}, {can2515_filters[1], NULL}, {can2515_filters[2], NULL},
+      {can2515_filters[3], NULL}, {can2515_filters[4], NULL}, {can2515_filters[5], NULL},
+  };
+  return can2515->begin(*settings2515, [] { can2515->isr(); }, can2515_masks[0], can2515_masks[1], filters, 6);
+}
+
+static uint32_t begin_canfd() {
+  if (canfd_filters == nullptr || acceptance_filters_open) {
+    return canfd->begin(*settings2517, [] { canfd->isr(); });
+  }
+
+  return canfd->begin(*settings2517, [] { canfd->isr(); }, *canfd_filters);
+}
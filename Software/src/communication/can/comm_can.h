@@ -8,13 +8,39 @@ extern uint8_t user_selected_can_addon_crystal_frequency_mhz;
 extern uint8_t user_selected_canfd_addon_crystal_frequency_mhz;
 extern uint16_t user_selected_CAN_ID_cutoff_filter;
 
-void dump_can_frame(CAN_frame& frame, CAN_Interface interface, frameDirection msgDir);
+class String;
+
+void dump_can_frame(const CAN_frame& frame, CAN_Interface interface, frameDirection msgDir);
+// Format the frames queued by dump_can_frame into the webserver CAN log. Must only be called from one task.
+void format_logged_can_frames();
+// Frames the webserver CAN logger dropped because formatting could not keep up
+uint32_t logged_can_frames_dropped();
+// Copy of the webserver CAN log, taken while format_logged_can_frames() can't write to it
+String copy_logged_can_messages();
+// Empty the webserver CAN log
+void clear_logged_can_messages();
 void transmit_can_frame_to_interface(const CAN_frame* tx_frame, CAN_Interface interface);
 
 //These defines are not used if user updates values via Settings page
 #define CRYSTAL_FREQUENCY_MHZ 8
 #define CANFD_ADDON_CRYSTAL_FREQUENCY_MHZ ACAN2517FDSettings::OSC_40MHz
 
+// Maximum amount of frames drained from each CAN interface per core_loop tick.
+// Can be overridden with a build flag, e.g. -D CAN_RX_BUDGET_PER_TICK=32
+#ifndef CAN_RX_BUDGET_PER_TICK
+#define CAN_RX_BUDGET_PER_TICK 16
+#endif
+
+// Amount of frames that can wait for the webserver CAN logger (power of two).
+#ifndef CAN_LOG_QUEUE_SIZE
+#define CAN_LOG_QUEUE_SIZE 64
+#endif
+
+// Tasks that can log frames to the webserver CAN logger, each gets its own queue.
+#ifndef CAN_LOG_PRODUCERS
+#define CAN_LOG_PRODUCERS 2
+#endif
+
 class CanReceiver;
 
 typedef struct {
@@ -55,6 +81,7 @@ bool init_CAN();
 
 /**
  * @brief Receive CAN messages from all interfaces. Respective CanReceivers are called.
+ * Each interface is drained of up to CAN_RX_BUDGET_PER_TICK frames per call.
  *
  * @param[in] void
  *
@@ -96,7 +123,7 @@ void receive_frame_canfd_addon();
  *
  * @return void
  */
-void print_can_frame(CAN_frame frame, CAN_Interface interface, frameDirection msgDir);
+void print_can_frame(const CAN_frame& frame, CAN_Interface interface, frameDirection msgDir);
 
 // Stop/pause CAN communication for all interfaces
 void stop_can();
@@ -0,0 +1,139 @@
+#ifndef _RS485_FRAMER_H_
+#define _RS485_FRAMER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Splits the byte stream of an RS485 UART into the frames of one protocol.
+// Bytes are pushed one at a time, and push() returns true on the byte that
+// completes a frame. The frame is then in frame()/length() until the next push().
+//
+// Each framer keeps its frame in a fixed buffer inside the object, so framing
+// never allocates. A frame that would not fit is dropped and counted.
+class Rs485Framer {
+ public:
+  virtual ~Rs485Framer() = default;
+
+  virtual bool push(uint8_t byte) = 0;
+
+  uint8_t* frame() { return buffer; }
+  uint16_t length() const { return completed ? received : 0; }
+
+  // Bytes thrown away because they did not belong to a valid frame
+  uint32_t dropped() const { return dropped_bytes; }
+
+  void reset() {
+    received = 0;
+    completed = false;
+  }
+
+ protected:
+  Rs485Framer(uint8_t* buffer, uint16_t capacity) : buffer(buffer), capacity(capacity) {}
+
+  // Starts over with the next byte, if the previous call completed a frame
+  void begin_byte() {
+    if (completed) {
+      reset();
+    }
+  }
+
+  bool full() const { return received == capacity; }
+
+  void append(uint8_t byte) { buffer[received++] = byte; }
+
+  void drop() {
+    dropped_bytes += received;
+    received = 0;
+  }
+
+  bool complete() {
+    completed = true;
+    return true;
+  }
+
+  uint8_t* const buffer;
+  const uint16_t capacity;
+  uint16_t received = 0;
+  bool completed = false;
+  uint32_t dropped_bytes = 0;
+};
+
+// Frames that end with a delimiter byte, which is part of the frame. Used for
+// the zero-stuffed Kostal frames, where 0x00 only appears at the end.
+template <uint16_t N>
+class DelimitedRs485Framer : public Rs485Framer {
+ public:
+  explicit DelimitedRs485Framer(uint8_t delimiter) : Rs485Framer(storage, N), delimiter(delimiter) {}
+
+  bool push(uint8_t byte) override {
+    begin_byte();
+    if (full()) {
+      drop();
+    }
+    append(byte);
+    return byte == delimiter ? complete() : false;
+  }
+
+ private:
+  const uint8_t delimiter;
+  uint8_t storage[N];
+};
+
+// ASCII frames from a start character to an end character, both included, like
+// the "~...\r" frames of the Pylontech RS485 protocol. Bytes outside a frame are
+// dropped, and a start character in the middle of a frame starts it over.
+template <uint16_t N>
+class AsciiRs485Framer : public Rs485Framer {
+ public:
+  AsciiRs485Framer(char start, char end) : Rs485Framer(storage, N), start(start), end(end) {}
+
+  bool push(uint8_t byte) override {
+    begin_byte();
+    if (byte == (uint8_t)start) {
+      drop();
+      append(byte);
+      return false;
+    }
+    if (received == 0 || full()) {
+      drop();
+      dropped_bytes++;
+      return false;
+    }
+    append(byte);
+    return byte == (uint8_t)end ? complete() : false;
+  }
+
+ private:
+  const char start;
+  const char end;
+  uint8_t storage[N];
+};
+
+// Frames of a fixed length, like the 13 byte Daly BMS packets. The check is run
+// on the partial frame after every byte, so a wrong header byte or checksum
+// drops the frame as soon as it is seen.
+template <uint16_t N>
+class FixedLengthRs485Framer : public Rs485Framer {
+ public:
+  // Returns false if the first length bytes of frame cannot start a valid frame.
+  // With length == N it is the whole frame, and the checksum can be checked.
+  typedef bool (*Check)(const uint8_t* frame, uint16_t length);
+
+  explicit FixedLengthRs485Framer(Check check) : Rs485Framer(storage, N), check(check) {}
+
+  bool push(uint8_t byte) override {
+    begin_byte();
+    append(byte);
+    if (!check(buffer, received)) {
+      drop();
+      return false;
+    }
+    return received == N ? complete() : false;
+  }
+
+ private:
+  const Check check;
+  uint8_t storage[N];
+};
+
+#endif
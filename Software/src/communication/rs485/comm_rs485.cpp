@@ -47,3 +47,12 @@ void receive_rs485() {
 void register_receiver(Rs485Receiver* receiver) {
   receivers.push_back(receiver);
 }
+
+bool read_rs485_frame(Rs485Framer& framer) {
+  while (Serial2.available()) {
+    if (framer.push(Serial2.read())) {
+      return true;
+    }
+  }
+  return false;
+}
@@ -1,6 +1,8 @@
 #ifndef _COMM_RS485_H_
 #define _COMM_RS485_H_
 
+#include "Rs485Framer.h"
+
 /**
  * @brief Initialization of RS485
  *
@@ -23,4 +25,10 @@ void receive_rs485();
 // Registers the given object as a receiver.
 void register_receiver(Rs485Receiver* receiver);
 
+// Feeds the bytes Serial2 has buffered to framer until one completes a frame.
+// Returns false once the UART buffer is empty, so a receiver handles every frame
+// that arrived since the last tick with
+//   while (read_rs485_frame(framer)) { ... framer.frame(), framer.length() ... }
+bool read_rs485_frame(Rs485Framer& framer);
+
 #endif
@@ -0,0 +1,410 @@
+#include "core_loop.h"
+#include <Arduino.h>
+#include <list>
+#include "../battery/BATTERIES.h"
+#include "../charger/CHARGERS.h"
+#include "../communication/Transmitter.h"
+#include "../communication/can/CanTxScheduler.h"
+#include "../communication/can/comm_can.h"
+#include "../communication/contactorcontrol/comm_contactorcontrol.h"
+#include "../communication/equipmentstopbutton/comm_equipmentstopbutton.h"
+#include "../communication/precharge_control/precharge_control.h"
+#include "../communication/rs485/comm_rs485.h"
+#include "../datalayer/datalayer.h"
+#include "../datalayer/datalayer_snapshot.h"
+#include "../devboard/hal/hal.h"
+#include "../devboard/safety/safety.h"
+#include "../devboard/utils/events.h"
+#include "../devboard/utils/led_handler.h"
+#include "../devboard/utils/logging.h"
+#include "../devboard/utils/time_meas.h"
+#include "../devboard/utils/timer.h"
+#include "../devboard/utils/types.h"
+#include "../devboard/utils/value_mapping.h"
+#include "../inverter/INVERTERS.h"
+#include "parallel_safety.h"
+
+// Interval timers
+volatile unsigned long currentMillis = 0;
+unsigned long previousMillis10ms = 0;
+unsigned long previousMillisUpdateVal = 0;
+// Task time measurement for debugging
+MyTimer core_task_timer_10s(INTERVAL_10_S);
+uint64_t start_time_10ms = 0;
+uint64_t start_time_values = 0;
+uint64_t start_time_cantx = 0;
+// Per-stage latency distributions of the core task, summarized into the datalayer every 10 s
+LatencyHistogram comm_histogram;
+LatencyHistogram histogram_10ms;
+LatencyHistogram values_histogram;
+LatencyHistogram cantx_histogram;
+LatencyHistogram core_task_histogram;
+LatencyHistogram wakeup_jitter_histogram;
+int64_t previous_wakeup_us = 0;
+
+static std::list<Transmitter*> transmitters;
+void register_transmitter(Transmitter* transmitter) {
+  transmitters.push_back(transmitter);
+  DEBUG_PRINTF("transmitter registered, total: %d\n", transmitters.size());
+}
+
+// Once per update of the battery, so the webserver, MQTT and live data all see the same numbers
+static void update_cell_statistics(DATALAYER_BATTERY_TYPE& battery) {
+  uint16_t cells = std::min<uint16_t>(battery.info.number_of_cells, MAX_AMOUNT_CELLS);
+  compute_cell_statistics(battery.status.cell_voltages_mV, battery.status.cell_balancing_status, cells,
+                          battery.status.cell_statistics);
+}
+
+void update_calculated_values(unsigned long currentMillis) {
+  /* Update CPU temperature*/
+  union {
+    float temp;
+    uint32_t hex;
+  } temp = {.temp = temperatureRead()};
+  if (temp.hex != 0x42555555) {
+    // Ignoring erroneous temperature value that ESP32 sometimes returns
+    datalayer.system.info.CPU_temperature = temp.temp;
+  }
+
+  /*Update free heap*/
+  datalayer.system.info.CPU_free_heap = ESP.getFreeHeap();
+
+  /* Check is remote set limits have timed out */
+  if (currentMillis > datalayer.battery.settings.remote_set_timestamp + datalayer.battery.settings.remote_set_timeout) {
+    datalayer.battery.settings.remote_settings_limit_charge = false;
+    datalayer.battery.settings.remote_settings_limit_discharge = false;
+    datalayer.battery.settings.max_remote_set_charge_dA = 0;
+    datalayer.battery.settings.max_remote_set_discharge_dA = 0;
+  }
+
+  /* Calculate allowed charge/discharge currents*/
+  if (datalayer.battery.status.voltage_dV > 10) {
+    // Only update value when we have voltage available to avoid div0. TODO: This should be based on nominal voltage
+    datalayer.battery.status.max_charge_current_dA =
+        ((datalayer.battery.status.max_charge_power_W * 100) / datalayer.battery.status.voltage_dV);
+    datalayer.battery.status.max_discharge_current_dA =
+        ((datalayer.battery.status.max_discharge_power_W * 100) / datalayer.battery.status.voltage_dV);
+  }
+
+  /* Apply remote restrictions if set*/
+  if (datalayer.battery.settings.remote_settings_limit_charge) {
+    if (datalayer.battery.status.max_charge_current_dA > datalayer.battery.settings.max_remote_set_charge_dA) {
+      datalayer.battery.status.max_charge_current_dA = datalayer.battery.settings.max_remote_set_charge_dA;
+    }
+  } else {
+    /* Restrict values from user settings if needed*/
+    if (datalayer.battery.status.max_charge_current_dA > datalayer.battery.settings.max_user_set_charge_dA) {
+      datalayer.battery.status.max_charge_current_dA = datalayer.battery.settings.max_user_set_charge_dA;
+      datalayer.battery.settings.user_settings_limit_charge = true;
+    } else {
+      datalayer.battery.settings.user_settings_limit_charge = false;
+    }
+  }
+
+  /* Apply remote restrictions if set*/
+  if (datalayer.battery.settings.remote_settings_limit_discharge) {
+    if (datalayer.battery.status.max_discharge_current_dA > datalayer.battery.settings.max_remote_set_charge_dA) {
+      datalayer.battery.status.max_discharge_current_dA = datalayer.battery.settings.max_remote_set_discharge_dA;
+    }
+  } else {
+    /* Restrict values from user settings if needed*/
+    if (datalayer.battery.status.max_discharge_current_dA > datalayer.battery.settings.max_user_set_discharge_dA) {
+      datalayer.battery.status.max_discharge_current_dA = datalayer.battery.settings.max_user_set_discharge_dA;
+      datalayer.battery.settings.user_settings_limit_discharge = true;
+    } else {
+      datalayer.battery.settings.user_settings_limit_discharge = false;
+    }
+  }
+
+  /* Calculate sum of all currents from all batteries. 0 if they are not used*/
+  datalayer.battery.status.reported_current_dA =
+      (datalayer.battery.status.current_dA + datalayer.battery2.status.current_dA +
+       datalayer.battery3.status.current_dA);
+
+  /* Calculate if battery or inverter is limiting factor*/
+  if (datalayer.battery.status.current_dA == 0) {  //Battery idle
+    if (datalayer.battery.status.max_discharge_current_dA > 0) {
+      //We allow discharge, but inverter does nothing. Inverter is limiting
+      datalayer.battery.settings.inverter_limits_discharge = true;
+    } else {
+      datalayer.battery.settings.inverter_limits_discharge = false;
+    }
+    if (datalayer.battery.status.max_charge_current_dA > 0) {
+      //We allow charge, but inverter does nothing. Inverter is limiting
+      datalayer.battery.settings.inverter_limits_charge = true;
+    } else {
+      datalayer.battery.settings.inverter_limits_charge = false;
+    }
+  } else if (datalayer.battery.status.current_dA < 0) {  //Battery discharging
+    if (-datalayer.battery.status.current_dA < datalayer.battery.status.max_discharge_current_dA) {
+      datalayer.battery.settings.inverter_limits_discharge = true;
+    } else {
+      datalayer.battery.settings.inverter_limits_discharge = false;
+    }
+  } else {  // > 0 Battery charging
+    //If actual current is smaller than max we allow, inverter is limiting factor
+    if (datalayer.battery.status.current_dA < datalayer.battery.status.max_charge_current_dA) {
+      datalayer.battery.settings.inverter_limits_charge = true;
+    } else {
+      datalayer.battery.settings.inverter_limits_charge = false;
+    }
+  }
+
+  /* Calculate active power based on voltage and current*/
+  datalayer.battery.status.active_power_W =
+      (datalayer.battery.status.current_dA * (datalayer.battery.status.voltage_dV / 100));
+  if (battery2) {
+    /* Calculate active power based on voltage and current for battery 2*/
+    datalayer.battery2.status.active_power_W =
+        (datalayer.battery2.status.current_dA * (datalayer.battery2.status.voltage_dV / 100));
+  }
+  if (battery3) {
+    /* Calculate active power based on voltage and current for battery 2*/
+    datalayer.battery3.status.active_power_W =
+        (datalayer.battery3.status.current_dA * (datalayer.battery3.status.voltage_dV / 100));
+  }
+
+  if (datalayer.battery.settings.soc_scaling_active) {
+    /** SOC Scaling
+   * A static version of a stochastic oscillator. The scaled SoC is calculated as:
+   *
+   *     10000 * (real_soc - min_percentage)
+   * ---------------------------------------
+   *     (max_percentage - min_percentage)
+   *
+   * And scaled capacity is:
+   *
+   *     reported_total_capacity_Wh = total_capacity_Wh * (max - min) / 10000
+   *     reported_remaining_capacity_Wh = reported_total_capacity_Wh * scaled_soc / 10000
+   */
+    // Compute delta_pct and clamped_soc
+    int32_t delta_pct = datalayer.battery.settings.max_percentage - datalayer.battery.settings.min_percentage;
+    int32_t clamped_soc = CONSTRAIN(datalayer.battery.status.real_soc, datalayer.battery.settings.min_percentage,
+                                    datalayer.battery.settings.max_percentage);
+    int32_t scaled_soc = 0;
+    int32_t scaled_total_capacity = 0;
+    if (delta_pct != 0) {  //Safeguard against division by 0
+      scaled_soc = 10000 * (clamped_soc - datalayer.battery.settings.min_percentage) / delta_pct;
+    }
+
+    datalayer.battery.status.reported_soc = scaled_soc;
+
+    // If battery info is valid
+    if (datalayer.battery.info.total_capacity_Wh > 0 && datalayer.battery.status.real_soc > 0) {
+      // Scale total usable capacity
+      scaled_total_capacity = (datalayer.battery.info.total_capacity_Wh * delta_pct) / 10000;
+      datalayer.battery.info.reported_total_capacity_Wh = scaled_total_capacity;
+
+      // Scale remaining capacity based on scaled SOC
+      datalayer.battery.status.reported_remaining_capacity_Wh = (scaled_total_capacity * scaled_soc) / 10000;
+
+    } else {
+      // Fallback if scaling cannot be performed
+      datalayer.battery.info.reported_total_capacity_Wh = datalayer.battery.info.total_capacity_Wh;
+      datalayer.battery.status.reported_remaining_capacity_Wh = datalayer.battery.status.remaining_capacity_Wh;
+    }
+
+    if (battery2) {
+      // If battery info is valid
+      if (datalayer.battery2.info.total_capacity_Wh > 0 && datalayer.battery.status.real_soc > 0) {
+
+        datalayer.battery2.info.reported_total_capacity_Wh = scaled_total_capacity;
+        // Scale remaining capacity based on scaled SOC
+        datalayer.battery2.status.reported_remaining_capacity_Wh = (scaled_total_capacity * scaled_soc) / 10000;
+
+      } else {
+        // Fallback if scaling cannot be performed
+        datalayer.battery2.info.reported_total_capacity_Wh = datalayer.battery2.info.total_capacity_Wh;
+        datalayer.battery2.status.reported_remaining_capacity_Wh = datalayer.battery2.status.remaining_capacity_Wh;
+      }
+
+      //Since we are running double battery, the scaled value of battery1 becomes the sum of battery1+battery2
+      //This way the inverter connected to the system sees both batteries as one large battery
+      datalayer.battery.info.reported_total_capacity_Wh += datalayer.battery2.info.reported_total_capacity_Wh;
+      datalayer.battery.status.reported_remaining_capacity_Wh +=
+          datalayer.battery2.status.reported_remaining_capacity_Wh;
+    }
+
+  } else {  // soc_scaling_active == false. No SOC window wanted. Set scaled SOC & capacity to same as real.
+    datalayer.battery.status.reported_soc = datalayer.battery.status.real_soc;
+    datalayer.battery.status.reported_remaining_capacity_Wh = datalayer.battery.status.remaining_capacity_Wh +
+                                                              datalayer.battery2.status.remaining_capacity_Wh +
+                                                              datalayer.battery3.status.remaining_capacity_Wh;
+    datalayer.battery.info.reported_total_capacity_Wh = datalayer.battery.info.total_capacity_Wh +
+                                                        datalayer.battery2.info.total_capacity_Wh +
+                                                        datalayer.battery3.info.total_capacity_Wh;
+  }
+
+  //Check each extra battery, and if they are at the extremes, report the SOC from these batteries instead
+  if (battery2 && datalayer.system.status.battery2_allowed_contactor_closing) {  //Battery2 is in the mix
+    if ((datalayer.battery2.status.real_soc < 100) || (datalayer.battery2.status.real_soc > 9900)) {
+      datalayer.battery.status.reported_soc = datalayer.battery2.status.real_soc;
+    }
+  }
+  if (battery3 && datalayer.system.status.battery3_allowed_contactor_closing) {  //Battery3 is in the mix
+    if ((datalayer.battery3.status.real_soc < 100) || (datalayer.battery3.status.real_soc > 9900)) {
+      datalayer.battery.status.reported_soc = datalayer.battery3.status.real_soc;
+    }
+  }
+}
+
+void setup_core() {
+  init_contactors();
+
+  init_precharge_control();
+
+  setup_charger();
+  setup_inverter();
+  setup_battery();
+  setup_shunt();
+
+  // Init CAN only after any CAN receivers have had a chance to register.
+  init_CAN();
+
+  init_rs485();
+
+  init_equipment_stop_button();
+}
+
+void core_loop_tick() {
+  START_TIME_MEASUREMENT(all);
+  START_TIME_MEASUREMENT(comm);
+
+  if (datalayer.system.info.performance_measurement_active) {
+    // Deviation of the actual wakeup interval from the 1 ms period requested from vTaskDelayUntil
+    if (previous_wakeup_us != 0) {
+      int64_t interval_us = start_time_all - previous_wakeup_us;
+      wakeup_jitter_histogram.record(interval_us > 1000 ? interval_us - 1000 : 1000 - interval_us);
+    }
+    previous_wakeup_us = start_time_all;
+  }
+
+  // Input, Runs as fast as possible
+  receive_can();    // Receive CAN messages
+  receive_rs485();  // Process serial2 RS485 interface
+
+  if (datalayer.system.info.performance_measurement_active) {
+    END_TIME_MEASUREMENT_HISTOGRAM(comm, datalayer.system.status.time_comm_us, comm_histogram);
+  } else {
+    END_TIME_MEASUREMENT_MAX(comm, datalayer.system.status.time_comm_us);
+  }
+
+  // Process
+  currentMillis = millis();
+  if (currentMillis - previousMillis10ms >= INTERVAL_10_MS) {
+    if ((currentMillis - previousMillis10ms >= INTERVAL_10_MS_DELAYED) &&
+        (milliseconds(currentMillis) > esp32hal->BOOTUP_TIME())) {
+      set_event(EVENT_TASK_OVERRUN, (currentMillis - previousMillis10ms));
+    }
+    previousMillis10ms = currentMillis;
+    if (datalayer.system.info.performance_measurement_active) {
+      START_TIME_MEASUREMENT(10ms);
+      monitor_equipment_stop_button();
+      led_exe();
+      handle_contactors();  // Take care of startup precharge/contactor closing
+      if (precharge_control_enabled) {
+        handle_precharge_control(currentMillis);  //Drive the hia4v1 via PWM
+      }
+      END_TIME_MEASUREMENT_HISTOGRAM(10ms, datalayer.system.status.time_10ms_us, histogram_10ms);
+    } else {  //Run 10ms tasks without timing it
+      monitor_equipment_stop_button();
+      led_exe();
+      handle_contactors();  // Take care of startup precharge/contactor closing
+      if (precharge_control_enabled) {
+        handle_precharge_control(currentMillis);  //Drive the hia4v1 via PWM
+      }
+    }
+  }
+
+  if (currentMillis - previousMillisUpdateVal >= INTERVAL_1_S) {
+    previousMillisUpdateVal = currentMillis;  // Order matters on the update_loop!
+    START_TIME_MEASUREMENT(values);
+    update_pause_state();  // Check if we are OK to send CAN or need to pause
+
+    // Fetch battery values
+    if (battery) {
+      battery->update_values();
+      update_cell_statistics(datalayer.battery);
+    }
+
+    if (battery2) {
+      battery2->update_values();
+      update_cell_statistics(datalayer.battery2);
+      check_parallel_battery_safety(2);
+    }
+    if (battery3) {
+      battery3->update_values();
+      update_cell_statistics(datalayer.battery3);
+      check_parallel_battery_safety(3);
+    }
+    update_calculated_values(currentMillis);
+    update_machineryprotection();  // Check safeties
+
+    // Update values heading towards inverter
+    if (inverter) {
+      inverter->update_values();
+    }
+
+    // Hand the updated values to the connectivity core in one piece
+    publish_datalayer_snapshot();
+
+    if (datalayer.system.info.performance_measurement_active) {
+      END_TIME_MEASUREMENT_HISTOGRAM(values, datalayer.system.status.time_values_us, values_histogram);
+    }
+  }
+  if (datalayer.system.info.performance_measurement_active) {
+    START_TIME_MEASUREMENT(cantx);
+
+    for (auto& transmitter : transmitters) {
+      transmitter->transmit(currentMillis);
+    }
+    can_tx_scheduler.run(currentMillis);
+
+    END_TIME_MEASUREMENT_HISTOGRAM(cantx, datalayer.system.status.time_cantx_us, cantx_histogram);
+  } else {
+    for (auto& transmitter : transmitters) {
+      transmitter->transmit(currentMillis);
+    }
+    can_tx_scheduler.run(currentMillis);
+  }
+
+  if (datalayer.system.info.performance_measurement_active) {
+    END_TIME_MEASUREMENT_HISTOGRAM(all, datalayer.system.status.core_task_10s_max_us, core_task_histogram);
+    if (datalayer.system.status.core_task_10s_max_us > datalayer.system.status.core_task_max_us) {
+      // Update worst case total time
+      datalayer.system.status.core_task_max_us = datalayer.system.status.core_task_10s_max_us;
+      // Record snapshots of task times
+      datalayer.system.status.time_snap_comm_us = datalayer.system.status.time_comm_us;
+      datalayer.system.status.time_snap_10ms_us = datalayer.system.status.time_10ms_us;
+      datalayer.system.status.time_snap_values_us = datalayer.system.status.time_values_us;
+      datalayer.system.status.time_snap_cantx_us = datalayer.system.status.time_cantx_us;
+    }
+
+    datalayer.system.status.core_task_max_us =
+        MAX(datalayer.system.status.core_task_10s_max_us, datalayer.system.status.core_task_max_us);
+    if (core_task_timer_10s.elapsed()) {
+      datalayer.system.status.latency_comm = comm_histogram.summary();
+      datalayer.system.status.latency_10ms = histogram_10ms.summary();
+      datalayer.system.status.latency_values = values_histogram.summary();
+      datalayer.system.status.latency_cantx = cantx_histogram.summary();
+      datalayer.system.status.latency_core_task = core_task_histogram.summary();
+      datalayer.system.status.wakeup_jitter = wakeup_jitter_histogram.summary();
+      comm_histogram.reset();
+      histogram_10ms.reset();
+      values_histogram.reset();
+      cantx_histogram.reset();
+      core_task_histogram.reset();
+      wakeup_jitter_histogram.reset();
+      datalayer.system.status.time_comm_us = 0;
+      datalayer.system.status.time_10ms_us = 0;
+      datalayer.system.status.time_values_us = 0;
+      datalayer.system.status.time_cantx_us = 0;
+      datalayer.system.status.core_task_10s_max_us = 0;
+      datalayer.system.status.wifi_task_10s_max_us = 0;
+      datalayer.system.status.mqtt_task_10s_max_us = 0;
+      for (int i = 0; i < NO_CAN_INTERFACE; i++) {
+        datalayer.system.status.can_rx_stats[i].queue_high_water = 0;
+      }
+    }
+  }
+}
@@ -0,0 +1,25 @@
+#ifndef CORE_LOOP_H
+#define CORE_LOOP_H
+
+/**
+ * @brief Set up everything the core task works with: contactors, precharge, the
+ * charger, inverter, battery and shunt integrations, CAN, RS485 and the stop button.
+ *
+ * Called once from setup(), after the settings were read from NVM.
+ */
+void setup_core();
+
+/**
+ * @brief One pass of the core task: receive, run the 10 ms and 1 s work that is
+ * due on millis(), then transmit.
+ *
+ * core_loop() calls this every millisecond on CORE_FUNCTION_CORE(). It does not
+ * block and knows nothing of FreeRTOS, so a host build can drive it from its own
+ * clock (see test/sim).
+ */
+void core_loop_tick();
+
+// millis() when core_loop_tick() last updated the battery and inverter values
+extern unsigned long previousMillisUpdateVal;
+
+#endif
@@ -1,6 +1,8 @@
 #ifndef _DATALAYER_H_
 #define _DATALAYER_H_
 
+#include "../devboard/utils/cell_statistics.h"
+#include "../devboard/utils/latency_histogram.h"
 #include "../devboard/utils/types.h"
 #include "../system_settings.h"
 
@@ -111,6 +113,9 @@ struct DATALAYER_BATTERY_STATUS_TYPE {
   /** Balancing status */
   balancing_status_enum balancing_status = BALANCING_STATUS_UNKNOWN;
 
+  /** Min, max, mean, spread and outliers of cell_voltages_mV, updated after each update_values() */
+  CellStatistics cell_statistics;
+
   /** All cell voltages currently measured in the pack, in mV.
    * Use with battery.info.number_of_cells to get valid data.
    */
@@ -258,6 +263,17 @@ struct DATALAYER_SHUNT_TYPE {
   bool available = false;
 };
 
+struct DATALAYER_CAN_RX_STATS_TYPE {
+  /** Total amount of frames received on this interface since boot */
+  uint32_t frames_received = 0;
+  /** Amount of times the receive queue was found full/overflowing, frames were lost */
+  uint32_t rx_overflows = 0;
+  /** Highest amount of frames found waiting in the receive queue at once, over the last 10 s */
+  uint16_t queue_high_water = 0;
+  /** Size of the driver receive queue */
+  uint16_t queue_size = 0;
+};
+
 struct DATALAYER_SYSTEM_INFO_TYPE {
   /** array with incoming CAN messages, for displaying on webserver */
   char logged_can_messages[15000] = {0};
@@ -303,6 +319,8 @@ struct DATALAYER_SYSTEM_INFO_TYPE {
   bool start_precharging = false;      //Is precharge ongoing?
 };
 
+/** The measurements up to and including CAN_inverter_still_alive are not compared by
+ * publish_datalayer_snapshot(), keep them at the start */
 struct DATALAYER_SYSTEM_STATUS_TYPE {
   /** Core task measurement variable */
   int64_t core_task_max_us = 0;
@@ -337,6 +355,18 @@ struct DATALAYER_SYSTEM_STATUS_TYPE {
    */
   int64_t time_snap_cantx_us = 0;
 
+  /** Percentiles of the core task stages over the last 10 seconds */
+  LatencySummary latency_comm;
+  LatencySummary latency_10ms;
+  LatencySummary latency_values;
+  LatencySummary latency_cantx;
+  LatencySummary latency_core_task;
+  /** How late the core task woke up compared to its 1 ms period, last 10 seconds */
+  LatencySummary wakeup_jitter;
+
+  /** CAN receive statistics, indexed by CAN_Interface */
+  DATALAYER_CAN_RX_STATS_TYPE can_rx_stats[NO_CAN_INTERFACE];
+
   /** uint8_t */
   /** A counter set each time a new message comes from inverter.
    * This value then gets decremented every second. Incase we reach 0
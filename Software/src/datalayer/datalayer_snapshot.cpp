@@ -0,0 +1,102 @@
+#include "datalayer_snapshot.h"
+#include <stddef.h>
+#include <string.h>
+#include "../devboard/utils/seqlock.h"
+
+static Seqlock<DataLayerSnapshot> latest;
+
+template <typename T>
+static bool same(const T& published, const T& current) {
+  return memcmp((const void*)&published, (const void*)&current, sizeof(T)) == 0;
+}
+
+// Same, leaving out the bytes from `skip_from` up to `skip_to`
+template <typename T>
+static bool same_except(const T& published, const T& current, size_t skip_from, size_t skip_to) {
+  const uint8_t* a = (const uint8_t*)&published;
+  const uint8_t* b = (const uint8_t*)&current;
+  return memcmp(a, b, skip_from) == 0 && memcmp(a + skip_to, b + skip_to, sizeof(T) - skip_to) == 0;
+}
+
+// The task timings, the CAN receive statistics and the still-alive counters move on nearly
+// every pass of the core task. They are published along with everything else, but on their
+// own they would make every update a new version.
+#define SKIP_FIELD(type, field) offsetof(type, field), offsetof(type, field) + sizeof(((type*)0)->field)
+
+static_assert(offsetof(DATALAYER_SYSTEM_STATUS_TYPE, core_task_max_us) == 0 &&
+                  offsetof(DATALAYER_SYSTEM_STATUS_TYPE, can_rx_stats) <
+                      offsetof(DATALAYER_SYSTEM_STATUS_TYPE, CAN_inverter_still_alive),
+              "The system status compare skips everything up to CAN_inverter_still_alive");
+
+static bool same_battery(const DATALAYER_BATTERY_TYPE& published, const DATALAYER_BATTERY_TYPE& current) {
+  return same_except(published, current, SKIP_FIELD(DATALAYER_BATTERY_TYPE, status.CAN_battery_still_alive));
+}
+
+static bool same_charger(const DATALAYER_CHARGER_TYPE& published, const DATALAYER_CHARGER_TYPE& current) {
+  return same_except(published, current, SKIP_FIELD(DATALAYER_CHARGER_TYPE, CAN_charger_still_alive));
+}
+
+static bool same_system_status(const DATALAYER_SYSTEM_STATUS_TYPE& published,
+                               const DATALAYER_SYSTEM_STATUS_TYPE& current) {
+  return same_except(published, current, 0,
+                     offsetof(DATALAYER_SYSTEM_STATUS_TYPE, CAN_inverter_still_alive) +
+                         sizeof(current.CAN_inverter_still_alive));
+}
+
+// The CPU temperature and free heap change with every update, like the task timings
+static bool same_system_info(const DataLayerSystemInfo& published, const DataLayerSystemInfo& current) {
+  return published.emulator_status == current.emulator_status &&
+         published.equipment_stop_active == current.equipment_stop_active;
+}
+
+static DataLayerSystemInfo current_system_info() {
+  DataLayerSystemInfo info;
+  info.emulator_status = get_emulator_status();
+  info.equipment_stop_active = datalayer.system.info.equipment_stop_active;
+  info.CPU_temperature = datalayer.system.info.CPU_temperature;
+  info.CPU_free_heap = datalayer.system.info.CPU_free_heap;
+  return info;
+}
+
+template <typename T>
+static void copy(T& published, const T& current) {
+  memcpy((void*)&published, (const void*)&current, sizeof(T));
+}
+
+void publish_datalayer_snapshot() {
+  const DataLayerSnapshot& published = latest.written();
+  DataLayerSystemInfo system_info = current_system_info();
+  if (latest.version() != 0 && same_battery(published.battery, datalayer.battery) &&
+      same_battery(published.battery2, datalayer.battery2) && same_battery(published.battery3, datalayer.battery3) &&
+      same(published.shunt, datalayer.shunt) && same_charger(published.charger, datalayer.charger) &&
+      same_system_status(published.system_status, datalayer.system.status) &&
+      same_system_info(published.system_info, system_info)) {
+    return;
+  }
+
+  DataLayerSnapshot& next = latest.begin_write();
+  copy(next.battery, datalayer.battery);
+  copy(next.battery2, datalayer.battery2);
+  copy(next.battery3, datalayer.battery3);
+  copy(next.shunt, datalayer.shunt);
+  copy(next.charger, datalayer.charger);
+  copy(next.system_status, datalayer.system.status);
+  next.system_info = system_info;
+  latest.end_write();
+}
+
+uint32_t read_datalayer_snapshot(DataLayerSnapshot& snapshot) {
+  return latest.read(snapshot);
+}
+
+uint32_t read_datalayer_snapshot_battery(uint8_t number, DATALAYER_BATTERY_TYPE& battery) {
+  return latest.read_part([number, &battery](const DataLayerSnapshot& snapshot) {
+    const DATALAYER_BATTERY_TYPE& source =
+        number == 3 ? snapshot.battery3 : (number == 2 ? snapshot.battery2 : snapshot.battery);
+    memcpy((void*)&battery, (const void*)&source, sizeof(battery));
+  });
+}
+
+bool datalayer_changed_since(uint32_t version) {
+  return latest.version() != version;
+}
@@ -0,0 +1,50 @@
+#ifndef _DATALAYER_SNAPSHOT_H_
+#define _DATALAYER_SNAPSHOT_H_
+
+#include <stdint.h>
+#include "../devboard/utils/events.h"
+#include "datalayer.h"
+
+// A copy of the datalayer values that the core task updates together, for the
+// tasks on the other core. The webserver, MQTT and the display read the datalayer
+// while the core task writes it, so a plain read can mix the voltage of one update
+// with the current of the next, or half of a cell voltage array with the other half.
+// The core task publishes a snapshot after every value update instead, and readers
+// get a consistent copy of it without ever blocking the core task.
+//
+// Only a few values of the system info are copied, the rest of it holds the 15 kB web CAN log.
+struct DataLayerSystemInfo {
+  EMULATOR_STATUS emulator_status = STATUS_OK;
+  bool equipment_stop_active = false;
+  float CPU_temperature = 0;
+  uint32_t CPU_free_heap = 0;
+};
+
+struct DataLayerSnapshot {
+  DATALAYER_BATTERY_TYPE battery;
+  DATALAYER_BATTERY_TYPE battery2;
+  DATALAYER_BATTERY_TYPE battery3;
+  DATALAYER_SHUNT_TYPE shunt;
+  DATALAYER_CHARGER_TYPE charger;
+  DATALAYER_SYSTEM_STATUS_TYPE system_status;
+  DataLayerSystemInfo system_info;
+};
+
+// Called by the core task when the values are updated. Publishes a new version
+// if anything changed since the last one. The task timings, CAN receive statistics,
+// still-alive counters, CPU temperature and free heap do not count as a change, so
+// they are only as fresh as the last version that something else changed in.
+void publish_datalayer_snapshot();
+
+// Copies the latest snapshot and returns its version, 0 before the first publish
+uint32_t read_datalayer_snapshot(DataLayerSnapshot& snapshot);
+
+// Copies battery 1, 2 or 3 of the latest snapshot and returns its version, for readers
+// that show one battery at a time
+uint32_t read_datalayer_snapshot_battery(uint8_t number, DATALAYER_BATTERY_TYPE& battery);
+
+// True if a version newer than `version` was published. Lets a reader skip its
+// work, and the copy, when nothing changed since it last looked.
+bool datalayer_changed_since(uint32_t version);
+
+#endif
@@ -3,6 +3,7 @@
 
 #include "../../battery/BATTERIES.h"
 #include "../../datalayer/datalayer.h"
+#include "../../datalayer/datalayer_snapshot.h"
 #include "../hal/hal.h"
 #include "../utils/events.h"
 #include "../utils/logging.h"
@@ -445,14 +446,10 @@ void update_display() {
   int battery_index = current_phase % num_batteries;
   int page = (current_phase / num_batteries) % NUM_PAGES;
 
-  // Print the battery status for current battery
-  if (battery_index == 0) {
-    print_battery_status(0, datalayer.battery.status, 1, page);
-  } else if (battery_index == 1) {
-    print_battery_status(0, datalayer.battery2.status, 2, page);
-  } else {
-    print_battery_status(0, datalayer.battery3.status, 3, page);
-  }
+  // Print the battery status for current battery, from one consistent copy of its values
+  static DATALAYER_BATTERY_TYPE pack;
+  read_datalayer_snapshot_battery(battery_index + 1, pack);
+  print_battery_status(0, pack.status, battery_index + 1, page);
 
   write_text(0, 2, "---------------------", false);
 
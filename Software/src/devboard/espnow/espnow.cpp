@@ -6,6 +6,7 @@
 #include <esp_now.h>
 #include "../../battery/BATTERIES.h"
 #include "../../datalayer/datalayer.h"
+#include "../../datalayer/datalayer_snapshot.h"
 #include "../hal/hal.h"
 #include "../utils/events.h"
 #include "../utils/logging.h"
@@ -178,24 +179,19 @@ void update_espnow() {
     return;
   }
 
-  // Send status for all configured batteries
+  // Send status for all configured batteries, each from one consistent copy of its values
+  static DATALAYER_BATTERY_TYPE pack;
   for (int battery_index = 0; battery_index < b_num_batteries; battery_index++) {
-    if (battery_index == 0 && battery != nullptr) {
-      send_battery_info(datalayer.battery.info, battery_index);
-      send_battery_status(datalayer.battery.status, battery_index);
-      send_battery_cell_status(datalayer.battery.info, datalayer.battery.status, battery_index);
-      send_battery_balancing(datalayer.battery.info, datalayer.battery.status, battery_index);
-    } else if (battery_index == 1) {
-      send_battery_info(datalayer.battery2.info, battery_index);
-      send_battery_status(datalayer.battery2.status, battery_index);
-      send_battery_cell_status(datalayer.battery2.info, datalayer.battery2.status, battery_index);
-      send_battery_balancing(datalayer.battery2.info, datalayer.battery2.status, battery_index);
-    } else {
-      send_battery_info(datalayer.battery3.info, battery_index);
-      send_battery_status(datalayer.battery3.status, battery_index);
-      send_battery_cell_status(datalayer.battery3.info, datalayer.battery3.status, battery_index);
-      send_battery_balancing(datalayer.battery3.info, datalayer.battery3.status, battery_index);
+    if (battery_index == 0 && battery == nullptr) {
+      continue;
     }
+    if (read_datalayer_snapshot_battery(battery_index + 1, pack) == 0) {
+      return;  // The core task has not published any values yet
+    }
+    send_battery_info(pack.info, battery_index);
+    send_battery_status(pack.status, battery_index);
+    send_battery_cell_status(pack.info, pack.status, battery_index);
+    send_battery_balancing(pack.info, pack.status, battery_index);
   }
 
   b_lastUpdateMillis = currentMillis;
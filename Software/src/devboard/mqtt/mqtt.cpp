@@ -7,6 +7,7 @@
 #include "../../battery/BATTERIES.h"
 #include "../../communication/contactorcontrol/comm_contactorcontrol.h"
 #include "../../datalayer/datalayer.h"
+#include "../../datalayer/datalayer_snapshot.h"
 #include "../../devboard/hal/hal.h"
 #include "../../devboard/safety/safety.h"
 #include "../../lib/bblanchon-ArduinoJson/ArduinoJson.h"
@@ -15,6 +16,7 @@
 #include "../webserver/webserver.h"
 #include "mqtt.h"
 #include "mqtt_client.h"
+#include "mqtt_payload.h"
 
 std::string mqtt_user;
 std::string mqtt_password;
@@ -64,11 +66,15 @@ static bool publish_common_info(void);
 static bool publish_cell_voltages(void);
 static bool publish_cell_balancing(void);
 static bool publish_events(void);
+static bool publish_performance(void);
+
+// The values of one round of messages, copied once so the messages agree with each other
+static DataLayerSnapshot snapshot;
 
 /** Publish global values and call callbacks for specific modules */
 static void publish_values(void) {
 
-  if (mqtt_publish((topic_name + "/status").c_str(), "online", false) == false) {
+  if (mqtt_publish(lwt_topic.c_str(), "online", false) == false) {
     return;
   }
 
@@ -76,6 +82,10 @@ static void publish_values(void) {
     return;
   }
 
+  if (read_datalayer_snapshot(snapshot) == 0) {
+    return;  // The core task has not published any values yet
+  }
+
   if (publish_common_info() == false) {
     return;
   }
@@ -91,6 +101,12 @@ static void publish_values(void) {
       return;
     }
   }
+
+  if (datalayer.system.info.performance_measurement_active) {
+    if (publish_performance() == false) {
+      return;
+    }
+  }
 }
 
 static bool ha_common_info_published = false;
@@ -126,6 +142,9 @@ SensorConfig batterySensorConfigTemplate[] = {
     {"cell_max_voltage", "Cell Max Voltage", "", "V", "voltage", always},
     {"cell_min_voltage", "Cell Min Voltage", "", "V", "voltage", always},
     {"cell_voltage_delta", "Cell Voltage Delta", "", "mV", "voltage", always},
+    {"cell_voltage_mean", "Cell Voltage Mean", "", "V", "voltage", always},
+    {"cell_voltage_stddev", "Cell Voltage Std Deviation", "", "mV", "voltage", always},
+    {"cell_outliers", "Cell Outliers", "", "", "", always},
     {"battery_voltage", "Battery Voltage", "", "V", "voltage", always},
     {"total_capacity", "Battery Total Capacity", "", "Wh", "energy", always},
     {"remaining_capacity", "Battery Remaining Capacity (scaled)", "", "Wh", "energy", always},
@@ -233,51 +252,45 @@ static const char* get_balancing_status_text(balancing_status_enum status) {
   }
 }
 
-void set_battery_attributes(JsonDocument& doc, const DATALAYER_BATTERY_TYPE& battery, const String& suffix,
+void add_battery_attributes(MqttPayload& payload, const DATALAYER_BATTERY_TYPE& battery, const char* suffix,
                             bool supports_charged) {
-  doc["SOC" + suffix] = ((float)battery.status.reported_soc) / 100.0f;
-  doc["SOC_real" + suffix] = ((float)battery.status.real_soc) / 100.0f;
-  doc["state_of_health" + suffix] = ((float)battery.status.soh_pptt) / 100.0f;
-  doc["temperature_min" + suffix] = ((float)((int16_t)battery.status.temperature_min_dC)) / 10.0f;
-  doc["temperature_max" + suffix] = ((float)((int16_t)battery.status.temperature_max_dC)) / 10.0f;
-  doc["stat_batt_power" + suffix] = ((float)((int32_t)battery.status.active_power_W));
-  doc["battery_current" + suffix] = ((float)((int16_t)battery.status.current_dA)) / 10.0f;
-  doc["battery_voltage" + suffix] = ((float)battery.status.voltage_dV) / 10.0f;
+  payload.add("SOC", suffix, battery.status.reported_soc, 2);
+  payload.add("SOC_real", suffix, battery.status.real_soc, 2);
+  payload.add("state_of_health", suffix, battery.status.soh_pptt, 2);
+  payload.add("temperature_min", suffix, battery.status.temperature_min_dC, 1);
+  payload.add("temperature_max", suffix, battery.status.temperature_max_dC, 1);
+  payload.add("stat_batt_power", suffix, battery.status.active_power_W, 0, MQTT_POWER_DEADBAND_W);
+  payload.add("battery_current", suffix, battery.status.current_dA, 1);
+  payload.add("battery_voltage", suffix, battery.status.voltage_dV, 1);
   if (battery.info.number_of_cells != 0u && battery.status.cell_voltages_mV[battery.info.number_of_cells - 1] != 0u) {
-    doc["cell_max_voltage" + suffix] = ((float)battery.status.cell_max_voltage_mV) / 1000.0f;
-    doc["cell_min_voltage" + suffix] = ((float)battery.status.cell_min_voltage_mV) / 1000.0f;
-    doc["cell_voltage_delta" + suffix] =
-        ((float)battery.status.cell_max_voltage_mV) - ((float)battery.status.cell_min_voltage_mV);
+    payload.add("cell_max_voltage", suffix, battery.status.cell_max_voltage_mV, 3, MQTT_CELL_VOLTAGE_DEADBAND_mV);
+    payload.add("cell_min_voltage", suffix, battery.status.cell_min_voltage_mV, 3, MQTT_CELL_VOLTAGE_DEADBAND_mV);
+    payload.add("cell_voltage_delta", suffix, battery.status.cell_max_voltage_mV - battery.status.cell_min_voltage_mV,
+                0, MQTT_CELL_VOLTAGE_DEADBAND_mV);
   }
-  doc["total_capacity" + suffix] = ((float)battery.info.total_capacity_Wh);
-  doc["remaining_capacity_real" + suffix] = ((float)battery.status.remaining_capacity_Wh);
-  doc["remaining_capacity" + suffix] = ((float)battery.status.reported_remaining_capacity_Wh);
-  doc["max_discharge_power" + suffix] = ((float)battery.status.max_discharge_power_W);
-  doc["max_charge_power" + suffix] = ((float)battery.status.max_charge_power_W);
+  if (battery.status.cell_statistics.cells != 0u) {
+    payload.add("cell_voltage_mean", suffix, battery.status.cell_statistics.mean_mV, 3, MQTT_CELL_VOLTAGE_DEADBAND_mV);
+    payload.add("cell_voltage_stddev", suffix, battery.status.cell_statistics.stddev_uV / 100, 1);
+    payload.add("cell_outliers", suffix, battery.status.cell_statistics.outliers);
+  }
+  payload.add("total_capacity", suffix, battery.info.total_capacity_Wh);
+  payload.add("remaining_capacity_real", suffix, battery.status.remaining_capacity_Wh);
+  payload.add("remaining_capacity", suffix, battery.status.reported_remaining_capacity_Wh);
+  payload.add("max_discharge_power", suffix, battery.status.max_discharge_power_W, 0, MQTT_POWER_DEADBAND_W);
+  payload.add("max_charge_power", suffix, battery.status.max_charge_power_W, 0, MQTT_POWER_DEADBAND_W);
 
   if (supports_charged) {
-    if (datalayer.battery.status.total_charged_battery_Wh != 0 &&
-        datalayer.battery.status.total_discharged_battery_Wh != 0) {
-      doc["charged_energy" + suffix] = ((float)datalayer.battery.status.total_charged_battery_Wh);
-      doc["discharged_energy" + suffix] = ((float)datalayer.battery.status.total_discharged_battery_Wh);
+    if (battery.status.total_charged_battery_Wh != 0 && battery.status.total_discharged_battery_Wh != 0) {
+      payload.add("charged_energy", suffix, battery.status.total_charged_battery_Wh);
+      payload.add("discharged_energy", suffix, battery.status.total_discharged_battery_Wh);
     }
   }
 
   // Add balancing data
-  uint16_t active_cells = 0;
-  if (battery.info.number_of_cells != 0u) {
-    for (size_t i = 0; i < battery.info.number_of_cells; ++i) {
-      if (battery.status.cell_balancing_status[i]) {
-        active_cells++;
-      }
-    }
-  }
-  doc["balancing_active_cells" + suffix] = active_cells;
-  doc["balancing_status" + suffix] = get_balancing_status_text(battery.status.balancing_status);
+  payload.add("balancing_active_cells", suffix, battery.status.cell_statistics.balancing);
+  payload.add("balancing_status", suffix, get_balancing_status_text(battery.status.balancing_status));
 }
 
-static std::vector<EventData> order_events;
-
 static bool publish_common_info(void) {
   static JsonDocument doc;
   static String state_topic = topic_name + "/info";
@@ -313,32 +326,65 @@ static bool publish_common_info(void) {
     }
 
   } else {
-    doc["bms_status"] = getBMSStatus(datalayer.battery.status.bms_status);
-    doc["pause_status"] = get_emulator_pause_status();
+    static MqttPublishedState published_state;
+    MqttPayload payload(mqtt_msg, sizeof(mqtt_msg), published_state);
+    payload.add("bms_status", "", getBMSStatus(snapshot.battery.status.bms_status).c_str());
+    payload.add("pause_status", "", get_emulator_pause_status().c_str());
 
     //only publish these values if BMS is active and we are comunication  with the battery (can send CAN messages to the battery)
+    // The still-alive counters are read live, a snapshot is not published when only they change
     if (datalayer.battery.status.CAN_battery_still_alive && allowed_to_send_CAN && esp32hal->system_booted_up()) {
-      set_battery_attributes(doc, datalayer.battery, "", battery->supports_charged_energy());
+      add_battery_attributes(payload, snapshot.battery, "", battery->supports_charged_energy());
     }
 
     if (battery2) {
       //only publish these values if BMS is active and we are comunication  with the battery (can send CAN messages to the battery)
       if (datalayer.battery2.status.CAN_battery_still_alive && allowed_to_send_CAN && esp32hal->system_booted_up()) {
-        set_battery_attributes(doc, datalayer.battery2, "_2", battery2->supports_charged_energy());
+        add_battery_attributes(payload, snapshot.battery2, "_2", battery2->supports_charged_energy());
       }
     }
 
-    doc["event_level"] = get_event_level_string(get_event_level());
-    doc["emulator_status"] = get_emulator_status_string(get_emulator_status());
-    doc["cpu_temp"] = (int)(datalayer.system.info.CPU_temperature + 0.5);
-    doc["emulator_uptime"] = millis64() / 1000;
+    payload.add("event_level", "", get_event_level_string(get_event_level()));
+    payload.add("emulator_status", "", get_emulator_status_string(snapshot.system_info.emulator_status));
+    payload.add("cpu_temp", "", (int)(snapshot.system_info.CPU_temperature + 0.5));
+    // Goes out with the rest, but is no reason to publish by itself
+    payload.add("emulator_uptime", "", (int32_t)(millis64() / 1000), 0, MQTT_UNTRACKED);
 
-    serializeJson(doc, mqtt_msg);
-    if (mqtt_publish(state_topic.c_str(), mqtt_msg, false) == false) {
-      logging.println("Common info MQTT msg could not be sent");
+    if (payload.finish()) {
+      if (mqtt_publish(state_topic.c_str(), mqtt_msg, false) == false) {
+        logging.println("Common info MQTT msg could not be sent");
+        return false;
+      }
+      payload.published();
+    } else if (payload.overflow()) {
+      logging.println("Common info MQTT msg too large");
+    }
+  }
+  return true;
+}
+
+static bool publish_cell_voltages(const DATALAYER_BATTERY_TYPE& battery, const String& state_topic,
+                                  MqttPublishedState& published_state) {
+  // If cell voltages have been populated...
+  if (battery.info.number_of_cells == 0u || battery.status.cell_voltages_mV[battery.info.number_of_cells - 1] == 0u) {
+    return true;
+  }
+
+  MqttPayload payload(mqtt_msg, sizeof(mqtt_msg), published_state);
+  payload.begin_array("cell_voltages");
+  for (size_t i = 0; i < battery.info.number_of_cells; ++i) {
+    payload.add_to_array(battery.status.cell_voltages_mV[i], 3, MQTT_CELL_VOLTAGE_DEADBAND_mV);
+  }
+  payload.end_array();
+
+  if (payload.finish()) {
+    if (!mqtt_publish(state_topic.c_str(), mqtt_msg, false)) {
+      logging.println("Cell voltage MQTT msg could not be sent");
       return false;
     }
-    doc.clear();
+    payload.published();
+  } else if (payload.overflow()) {
+    logging.println("Cell voltage MQTT msg too large");
   }
   return true;
 }
@@ -353,9 +399,9 @@ static bool publish_cell_voltages(void) {
     if (ha_cell_voltages_published == false) {
 
       // If the cell voltage number isn't initialized...
-      if (datalayer.battery.info.number_of_cells != 0u) {
+      if (snapshot.battery.info.number_of_cells != 0u) {
 
-        for (int i = 0; i < datalayer.battery.info.number_of_cells; i++) {
+        for (int i = 0; i < snapshot.battery.info.number_of_cells; i++) {
           int cellNumber = i + 1;
           set_battery_voltage_attributes(doc, i, cellNumber, state_topic, object_id_prefix, "");
           set_common_discovery_attributes(doc);
@@ -373,9 +419,9 @@ static bool publish_cell_voltages(void) {
         successfully_published = false;
         // TODO: Combine this identical block with the previous one.
         // If the cell voltage number isn't initialized...
-        if (datalayer.battery2.info.number_of_cells != 0u) {
+        if (snapshot.battery2.info.number_of_cells != 0u) {
 
-          for (int i = 0; i < datalayer.battery2.info.number_of_cells; i++) {
+          for (int i = 0; i < snapshot.battery2.info.number_of_cells; i++) {
             int cellNumber = i + 1;
             set_battery_voltage_attributes(doc, i, cellNumber, state_topic_2, object_id_prefix + "2_", " 2");
             set_common_discovery_attributes(doc);
@@ -395,84 +441,100 @@ static bool publish_cell_voltages(void) {
     }
   }
 
-  // If cell voltages have been populated...
-  if (datalayer.battery.info.number_of_cells != 0u &&
-      datalayer.battery.status.cell_voltages_mV[datalayer.battery.info.number_of_cells - 1] != 0u) {
+  static MqttPublishedState published_state;
+  static MqttPublishedState published_state_2;
 
-    JsonArray cell_voltages = doc["cell_voltages"].to<JsonArray>();
-    for (size_t i = 0; i < datalayer.battery.info.number_of_cells; ++i) {
-      cell_voltages.add(((float)datalayer.battery.status.cell_voltages_mV[i]) / 1000.0f);
-    }
-
-    serializeJson(doc, mqtt_msg, sizeof(mqtt_msg));
-
-    if (!mqtt_publish(state_topic.c_str(), mqtt_msg, false)) {
-      logging.println("Cell voltage MQTT msg could not be sent");
+  if (!publish_cell_voltages(snapshot.battery, state_topic, published_state)) {
+    return false;
+  }
+  if (battery2) {
+    if (!publish_cell_voltages(snapshot.battery2, state_topic_2, published_state_2)) {
       return false;
     }
-    doc.clear();
   }
+  return true;
+}
 
-  if (battery2) {
-    // If cell voltages have been populated...
-    if (datalayer.battery2.info.number_of_cells != 0u &&
-        datalayer.battery2.status.cell_voltages_mV[datalayer.battery2.info.number_of_cells - 1] != 0u) {
-
-      JsonArray cell_voltages = doc["cell_voltages"].to<JsonArray>();
-      for (size_t i = 0; i < datalayer.battery2.info.number_of_cells; ++i) {
-        cell_voltages.add(((float)datalayer.battery2.status.cell_voltages_mV[i]) / 1000.0f);
-      }
+static bool publish_cell_balancing(const DATALAYER_BATTERY_TYPE& battery, const String& state_topic,
+                                   MqttPublishedState& published_state) {
+  // If cell balancing data is available...
+  if (battery.info.number_of_cells == 0u) {
+    return true;
+  }
 
-      serializeJson(doc, mqtt_msg, sizeof(mqtt_msg));
+  MqttPayload payload(mqtt_msg, sizeof(mqtt_msg), published_state);
+  payload.begin_array("cell_balancing");
+  for (size_t i = 0; i < battery.info.number_of_cells; ++i) {
+    payload.add_to_array(battery.status.cell_balancing_status[i]);
+  }
+  payload.end_array();
 
-      if (!mqtt_publish(state_topic_2.c_str(), mqtt_msg, false)) {
-        logging.println("Cell voltage MQTT msg could not be sent");
-        return false;
-      }
-      doc.clear();
+  if (payload.finish()) {
+    if (!mqtt_publish(state_topic.c_str(), mqtt_msg, false)) {
+      logging.println("Cell balancing MQTT msg could not be sent");
+      return false;
     }
+    payload.published();
+  } else if (payload.overflow()) {
+    logging.println("Cell balancing MQTT msg too large");
   }
   return true;
 }
 
 static bool publish_cell_balancing(void) {
-  static JsonDocument doc;
   static String state_topic = topic_name + "/balancing_data";
   static String state_topic_2 = topic_name + "/balancing_data_2";
+  static MqttPublishedState published_state;
+  static MqttPublishedState published_state_2;
 
-  // If cell balancing data is available...
-  if (datalayer.battery.info.number_of_cells != 0u) {
-
-    JsonArray cell_balancing = doc["cell_balancing"].to<JsonArray>();
-    for (size_t i = 0; i < datalayer.battery.info.number_of_cells; ++i) {
-      cell_balancing.add(datalayer.battery.status.cell_balancing_status[i]);
-    }
-
-    serializeJson(doc, mqtt_msg, sizeof(mqtt_msg));
-
-    if (!mqtt_publish(state_topic.c_str(), mqtt_msg, false)) {
-      logging.println("Cell balancing MQTT msg could not be sent");
+  if (!publish_cell_balancing(snapshot.battery, state_topic, published_state)) {
+    return false;
+  }
+  // Handle second battery if available
+  if (battery2) {
+    if (!publish_cell_balancing(snapshot.battery2, state_topic_2, published_state_2)) {
       return false;
     }
-    doc.clear();
   }
+  return true;
+}
 
-  // Handle second battery if available
-  if (battery2) {
-    if (datalayer.battery2.info.number_of_cells != 0u) {
+static bool publish_event(JsonDocument& doc, const String& state_topic, EVENTS_ENUM_TYPE event, uint8_t data,
+                          uint64_t timestamp) {
+  doc["event_type"] = String(get_event_enum_string(event));
+  doc["severity"] = String(get_event_level_string(event));
+  doc["count"] = String(get_event_pointer(event)->occurences);
+  doc["data"] = String(data);
+  doc["message"] = get_event_message_string(event);
+  doc["millis"] = String(timestamp);
+
+  serializeJson(doc, mqtt_msg);
+  doc.clear();
+  if (!mqtt_publish(state_topic.c_str(), mqtt_msg, false)) {
+    logging.println("Common info MQTT msg could not be sent");
+    return false;
+  }
+  set_event_MQTTpublished(event);
+  return true;
+}
 
-      JsonArray cell_balancing = doc["cell_balancing"].to<JsonArray>();
-      for (size_t i = 0; i < datalayer.battery2.info.number_of_cells; ++i) {
-        cell_balancing.add(datalayer.battery2.status.cell_balancing_status[i]);
-      }
+static std::vector<EventData> order_events;
 
-      serializeJson(doc, mqtt_msg, sizeof(mqtt_msg));
+// Publishes the events that are set but not published yet, oldest first
+static bool publish_unpublished_events(JsonDocument& doc, const String& state_topic) {
+  order_events.clear();
+  for (int i = 0; i < EVENT_NOF_EVENTS; i++) {
+    const EVENTS_STRUCT_TYPE* event_pointer = get_event_pointer((EVENTS_ENUM_TYPE)i);
+    if (event_pointer->occurences > 0 && !event_pointer->MQTTpublished) {
+      order_events.push_back({static_cast<EVENTS_ENUM_TYPE>(i), event_pointer});
+    }
+  }
+  std::sort(order_events.begin(), order_events.end(), compareEventsByTimestampAsc);
 
-      if (!mqtt_publish(state_topic_2.c_str(), mqtt_msg, false)) {
-        logging.println("Cell balancing MQTT msg could not be sent");
-        return false;
-      }
-      doc.clear();
+  for (const auto& event : order_events) {
+    if (!publish_event(doc, state_topic, event.event_handle, event.event_pointer->data,
+                       event.event_pointer->timestamp)) {
+      return false;
     }
   }
   return true;
@@ -502,47 +564,62 @@ bool publish_events() {
 
     doc.clear();
   } else {
-    const EVENTS_STRUCT_TYPE* event_pointer;
-
-    //clear the vector
-    order_events.clear();
-    // Collect all events
-    for (int i = 0; i < EVENT_NOF_EVENTS; i++) {
-      event_pointer = get_event_pointer((EVENTS_ENUM_TYPE)i);
-      if (event_pointer->occurences > 0 && !event_pointer->MQTTpublished) {
-        order_events.push_back({static_cast<EVENTS_ENUM_TYPE>(i), event_pointer});
+    // The journal holds the events in the order they were set, so each one goes out once
+    static uint32_t published_sequence = 0;
+    EVENT_JOURNAL_ENTRY_TYPE entry;
+
+    uint32_t latest = get_event_journal_sequence();
+    if (latest - published_sequence > EVENT_JOURNAL_SIZE) {
+      // More transitions came in since the last publish than the journal holds, and the oldest
+      // were overwritten. The events they set are still marked as not published in the table.
+      if (!publish_unpublished_events(doc, state_topic)) {
+        return false;
       }
+      published_sequence = latest;
     }
-    // Sort events by timestamp
-    std::sort(order_events.begin(), order_events.end(), compareEventsByTimestampAsc);
-
-    for (const auto& event : order_events) {
-
-      EVENTS_ENUM_TYPE event_handle = event.event_handle;
-      event_pointer = event.event_pointer;
-
-      doc["event_type"] = String(get_event_enum_string(event_handle));
-      doc["severity"] = String(get_event_level_string(event_handle));
-      doc["count"] = String(event_pointer->occurences);
-      doc["data"] = String(event_pointer->data);
-      doc["message"] = get_event_message_string(event_handle);
-      doc["millis"] = String(event_pointer->timestamp);
 
-      serializeJson(doc, mqtt_msg);
-      if (!mqtt_publish(state_topic.c_str(), mqtt_msg, false)) {
-        logging.println("Common info MQTT msg could not be sent");
+    while (read_event_journal(published_sequence, &entry, 1) == 1) {
+      if (entry.active && !publish_event(doc, state_topic, entry.event, entry.data, entry.timestamp)) {
         return false;
-      } else {
-        set_event_MQTTpublished(event_handle);
       }
-      doc.clear();
-      //clear the vector
-      order_events.clear();
+      published_sequence = entry.sequence;
     }
   }
   return true;
 }
 
+static void set_latency_attributes(JsonDocument& doc, const char* stage, const LatencySummary& summary) {
+  JsonObject object = doc[stage].to<JsonObject>();
+  object["p50_us"] = summary.p50_us;
+  object["p95_us"] = summary.p95_us;
+  object["p99_us"] = summary.p99_us;
+  object["max_us"] = summary.max_us;
+  object["samples"] = summary.samples;
+}
+
+/** Core task timing percentiles of the last 10 s, only sent when performance measurement is enabled */
+static bool publish_performance(void) {
+  static JsonDocument doc;
+  static String state_topic = topic_name + "/performance";
+
+  set_latency_attributes(doc, "core_task", datalayer.system.status.latency_core_task);
+  set_latency_attributes(doc, "comm", datalayer.system.status.latency_comm);
+  set_latency_attributes(doc, "10ms", datalayer.system.status.latency_10ms);
+  set_latency_attributes(doc, "values", datalayer.system.status.latency_values);
+  set_latency_attributes(doc, "cantx", datalayer.system.status.latency_cantx);
+  set_latency_attributes(doc, "wakeup_jitter", datalayer.system.status.wakeup_jitter);
+  doc["mqtt_task_10s_max_us"] = datalayer.system.status.mqtt_task_10s_max_us;
+  doc["wifi_task_10s_max_us"] = datalayer.system.status.wifi_task_10s_max_us;
+
+  serializeJson(doc, mqtt_msg, sizeof(mqtt_msg));
+  if (!mqtt_publish(state_topic.c_str(), mqtt_msg, false)) {
+    logging.println("Performance MQTT msg could not be sent");
+    return false;
+  }
+  doc.clear();
+  return true;
+}
+
 static bool publish_buttons_discovery(void) {
   if (ha_autodiscovery_enabled) {
     if (ha_buttons_published == false) {
@@ -5,7 +5,8 @@
  * 
  * Subscription - Add topics to MQTT_SUBSCRIPTIONS in USER_SETTINGS.h and handle the messages in mqtt.cpp:callback()
  * 
- * Publishing - See example in mqtt.cpp:publish_values() for constructing the payload
+ * Publishing - See example in mqtt.cpp:publish_values() for constructing the payload. State topics are
+ * only published when a value changed, see MqttPayload, and in full every MQTT_FULL_PUBLISH_CYCLES
  * 
  * Home assistant - See below for an example, and the official documentation is quite good (https://www.home-assistant.io/integrations/sensor.mqtt/)
  * in configuration.yaml:
@@ -38,7 +39,17 @@
 #include <string>
 #include <vector>
 
-#define MQTT_MSG_BUFFER_SIZE (1024)
+// Fits the cell voltages of a 192 cell pack, "4.123," each
+#define MQTT_MSG_BUFFER_SIZE (1280)
+
+// Changes smaller than or equal to these do not cause a state topic to be published by themselves,
+// the value goes out with the next publish of the topic, at the latest after MQTT_FULL_PUBLISH_CYCLES
+#ifndef MQTT_POWER_DEADBAND_W
+#define MQTT_POWER_DEADBAND_W 20
+#endif
+#ifndef MQTT_CELL_VOLTAGE_DEADBAND_mV
+#define MQTT_CELL_VOLTAGE_DEADBAND_mV 2
+#endif
 
 extern const char* version_number;  // The current software version, used for mqtt
 
@@ -0,0 +1,131 @@
+#include "mqtt_payload.h"
+#include <stdio.h>
+#include <string.h>
+
+MqttPayload::MqttPayload(char* buffer, size_t size, MqttPublishedState& state)
+    : buffer(buffer), size(size), state(state) {
+  state.pending.clear();
+  append("{");
+}
+
+void MqttPayload::append(const char* text, size_t length) {
+  if (used + length >= size) {  // Room for the terminator is kept
+    overflowed = true;
+    return;
+  }
+  memcpy(buffer + used, text, length);
+  used += length;
+  buffer[used] = '\0';
+}
+
+void MqttPayload::append(const char* text) {
+  append(text, strlen(text));
+}
+
+void MqttPayload::write_key(const char* key, const char* suffix) {
+  append(first_member ? "\"" : ",\"");
+  first_member = false;
+  append(key);
+  append(suffix);
+  append("\":");
+}
+
+void MqttPayload::write_number(int32_t value, uint8_t decimals) {
+  uint32_t divisor = 1;
+  for (uint8_t i = 0; i < decimals; i++) {
+    divisor *= 10;
+  }
+  uint32_t magnitude = (value < 0) ? (uint32_t)(-(int64_t)value) : (uint32_t)value;
+  uint32_t fraction = magnitude % divisor;
+
+  char text[16];
+  int length = snprintf(text, sizeof(text), "%s%lu", (value < 0) ? "-" : "", (unsigned long)(magnitude / divisor));
+  if (fraction != 0) {
+    // Leading zeros of the fraction are kept, trailing ones dropped: 3700 mV is 3.7 V
+    length += snprintf(text + length, sizeof(text) - length, ".%0*lu", decimals, (unsigned long)fraction);
+    while (text[length - 1] == '0') {
+      length--;
+    }
+  }
+  append(text, length);
+}
+
+void MqttPayload::track(int32_t value, int32_t deadband) {
+  size_t index = state.pending.size();
+  state.pending.push_back(value);
+  if (!state.published || index >= state.values.size()) {
+    changed = true;
+    return;
+  }
+  int64_t difference = (int64_t)value - state.values[index];
+  if (difference > deadband || -difference > deadband) {
+    changed = true;
+  }
+}
+
+void MqttPayload::add(const char* key, const char* suffix, int32_t value, uint8_t decimals, int32_t deadband) {
+  write_key(key, suffix);
+  write_number(value, decimals);
+  track(value, deadband);
+}
+
+void MqttPayload::add(const char* key, const char* suffix, const char* text) {
+  write_key(key, suffix);
+  append("\"");
+  append(text);
+  append("\"");
+
+  // Texts are compared by a hash of them, FNV-1a
+  uint32_t hash = 2166136261u;
+  for (const char* c = text; *c; c++) {
+    hash = (hash ^ (uint8_t)*c) * 16777619u;
+  }
+  track((int32_t)hash, 0);
+}
+
+void MqttPayload::begin_array(const char* key) {
+  write_key(key, "");
+  append("[");
+  first_member = true;
+}
+
+void MqttPayload::add_to_array(int32_t value, uint8_t decimals, int32_t deadband) {
+  if (!first_member) {
+    append(",");
+  }
+  first_member = false;
+  write_number(value, decimals);
+  track(value, deadband);
+}
+
+void MqttPayload::add_to_array(bool value) {
+  if (!first_member) {
+    append(",");
+  }
+  first_member = false;
+  append(value ? "true" : "false");
+  track(value, 0);
+}
+
+void MqttPayload::end_array() {
+  append("]");
+  first_member = false;
+}
+
+bool MqttPayload::finish() {
+  append("}");
+  if (overflowed) {
+    return false;
+  }
+  if (state.pending.size() != state.values.size()) {
+    changed = true;  // A value came or went
+  }
+  state.cycles_since_publish++;
+  return changed || state.cycles_since_publish >= MQTT_FULL_PUBLISH_CYCLES;
+}
+
+void MqttPayload::published() {
+  state.values.swap(state.pending);
+  state.cycles_since_publish = 0;
+  state.published = true;
+}
@@ -0,0 +1,74 @@
+#ifndef _MQTT_PAYLOAD_H_
+#define _MQTT_PAYLOAD_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// A state topic is published in full at least every this many publish intervals, even if nothing changed
+#ifndef MQTT_FULL_PUBLISH_CYCLES
+#define MQTT_FULL_PUBLISH_CYCLES 12
+#endif
+
+// Deadband for values that never cause a publish by themselves, such as the uptime
+#define MQTT_UNTRACKED INT32_MAX
+
+// What a state topic was last published with
+struct MqttPublishedState {
+  std::vector<int32_t> values;
+  std::vector<int32_t> pending;  // Of the payload being written, kept here so its room is reused
+  uint16_t cycles_since_publish = 0;
+  bool published = false;
+};
+
+// Writes a JSON object straight into a buffer, and meanwhile compares each value with
+// the one last published on the topic. Numbers are integers in the units of the
+// datalayer, printed with a given number of decimals, so 3701 mV with 3 decimals
+// becomes 3.701. A value counts as changed when it moved more than its deadband.
+//
+//   MqttPayload payload(mqtt_msg, sizeof(mqtt_msg), info_state);
+//   payload.add("battery_voltage", "", voltage_dV, 1);
+//   if (payload.finish() && mqtt_publish(topic, mqtt_msg, false)) {
+//     payload.published();
+//   }
+class MqttPayload {
+ public:
+  MqttPayload(char* buffer, size_t size, MqttPublishedState& state);
+
+  // `key` and `suffix` are written one after the other, suffix tells battery 2 apart
+  void add(const char* key, const char* suffix, int32_t value, uint8_t decimals = 0, int32_t deadband = 0);
+  void add(const char* key, const char* suffix, const char* text);
+
+  void begin_array(const char* key);
+  void add_to_array(int32_t value, uint8_t decimals = 0, int32_t deadband = 0);
+  void add_to_array(bool value);
+  void end_array();
+
+  // Closes the object. True if it is worth publishing: something changed, this is the
+  // first time, or the topic was quiet for MQTT_FULL_PUBLISH_CYCLES. False if the
+  // buffer was too small.
+  bool finish();
+
+  // To be called once the payload went out, it is what the next one is compared to
+  void published();
+
+  bool overflow() const { return overflowed; }
+
+ private:
+  void append(const char* text);
+  void append(const char* text, size_t length);
+  void write_key(const char* key, const char* suffix);
+  void write_number(int32_t value, uint8_t decimals);
+  void track(int32_t value, int32_t deadband);
+
+  char* buffer;
+  size_t size;
+  size_t used = 0;
+  bool overflowed = false;
+  bool first_member = true;
+
+  MqttPublishedState& state;
+  bool changed = false;
+};
+
+#endif
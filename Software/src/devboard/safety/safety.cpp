@@ -11,6 +11,34 @@ static uint8_t discharge_limit_failures = 0;
 static bool battery_full_event_fired = false;
 static bool battery_empty_event_fired = false;
 
+// The highest and lowest cell of a pack. When the cell statistics have voltage readings they are combined
+// with the values the BMS reports, so a cell out of range in either one is caught.
+static uint16_t highest_cell_mV(const DATALAYER_BATTERY_TYPE& battery) {
+  const CellStatistics& cells = battery.status.cell_statistics;
+  if (cells.cells == 0) {
+    return battery.status.cell_max_voltage_mV;
+  }
+  return std::max(battery.status.cell_max_voltage_mV, cells.max_mV);
+}
+
+static uint16_t lowest_cell_mV(const DATALAYER_BATTERY_TYPE& battery) {
+  const CellStatistics& cells = battery.status.cell_statistics;
+  if (cells.cells == 0) {
+    return battery.status.cell_min_voltage_mV;
+  }
+  return std::min(battery.status.cell_min_voltage_mV, cells.min_mV);
+}
+
+// Check diff between highest and lowest cell
+static void check_cell_deviation(const DATALAYER_BATTERY_TYPE& battery) {
+  cell_deviation_mV = std::abs(highest_cell_mV(battery) - lowest_cell_mV(battery));
+  if (cell_deviation_mV > battery.info.max_cell_voltage_deviation_mV) {
+    set_event(EVENT_CELL_DEVIATION_HIGH, (cell_deviation_mV / 20));
+  } else {
+    clear_event(EVENT_CELL_DEVIATION_HIGH);
+  }
+}
+
 #define MAX_SOH_DEVIATION_PPTT 2500
 #define CELL_CRITICAL_MV 100  // If cells go this much outside design voltage, shut battery down!
 #define LOWEST_ALLOWED_CELLVOLTAGE_RECOVERY_CHARGE_MV 2000  //If cells are below this, recovery charge not allowed
@@ -115,24 +143,22 @@ void update_machineryprotection() {
     }
 
     // Cell overvoltage, further charging not possible. Battery might be imbalanced.
-    if (datalayer.battery.status.cell_max_voltage_mV >= datalayer.battery.info.max_cell_voltage_mV) {
+    if (highest_cell_mV(datalayer.battery) >= datalayer.battery.info.max_cell_voltage_mV) {
       set_event(EVENT_CELL_OVER_VOLTAGE, 0);
       datalayer.battery.status.max_charge_power_W = 0;
     }
     // Cell CRITICAL overvoltage, critical latching error without automatic reset. Requires user action to inspect battery.
-    if (datalayer.battery.status.cell_max_voltage_mV >=
-        (datalayer.battery.info.max_cell_voltage_mV + CELL_CRITICAL_MV)) {
+    if (highest_cell_mV(datalayer.battery) >= (datalayer.battery.info.max_cell_voltage_mV + CELL_CRITICAL_MV)) {
       set_event(EVENT_CELL_CRITICAL_OVER_VOLTAGE, 0);
     }
 
     // Cell undervoltage. Further discharge not possible. Battery might be imbalanced.
-    if (datalayer.battery.status.cell_min_voltage_mV <= datalayer.battery.info.min_cell_voltage_mV) {
+    if (lowest_cell_mV(datalayer.battery) <= datalayer.battery.info.min_cell_voltage_mV) {
       set_event(EVENT_CELL_UNDER_VOLTAGE, 0);
       datalayer.battery.status.max_discharge_power_W = 0;
     }
     //Cell CRITICAL undervoltage. critical latching error without automatic reset. Requires user action to inspect battery.
-    if (datalayer.battery.status.cell_min_voltage_mV <=
-        (datalayer.battery.info.min_cell_voltage_mV - CELL_CRITICAL_MV)) {
+    if (lowest_cell_mV(datalayer.battery) <= (datalayer.battery.info.min_cell_voltage_mV - CELL_CRITICAL_MV)) {
       set_event(EVENT_CELL_CRITICAL_UNDER_VOLTAGE, 0);
     }
 
@@ -178,14 +204,7 @@ void update_machineryprotection() {
       set_event(EVENT_SOC_PLAUSIBILITY_ERROR, datalayer.battery.status.real_soc);
     }
 
-    // Check diff between highest and lowest cell
-    cell_deviation_mV =
-        std::abs(datalayer.battery.status.cell_max_voltage_mV - datalayer.battery.status.cell_min_voltage_mV);
-    if (cell_deviation_mV > datalayer.battery.info.max_cell_voltage_deviation_mV) {
-      set_event(EVENT_CELL_DEVIATION_HIGH, (cell_deviation_mV / 20));
-    } else {
-      clear_event(EVENT_CELL_DEVIATION_HIGH);
-    }
+    check_cell_deviation(datalayer.battery);
 
     // Inverter is charging with more power than battery wants!
     if (datalayer.battery.status.active_power_W > 0) {  // Charging
@@ -277,22 +296,15 @@ void update_machineryprotection() {
     }
 
     // Cell overvoltage, critical latching error without automatic reset. Requires user action.
-    if (datalayer.battery2.status.cell_max_voltage_mV >= datalayer.battery2.info.max_cell_voltage_mV) {
+    if (highest_cell_mV(datalayer.battery2) >= datalayer.battery2.info.max_cell_voltage_mV) {
       set_event(EVENT_CELL_OVER_VOLTAGE, 0);
     }
     // Cell undervoltage, critical latching error without automatic reset. Requires user action.
-    if (datalayer.battery2.status.cell_min_voltage_mV <= datalayer.battery2.info.min_cell_voltage_mV) {
+    if (lowest_cell_mV(datalayer.battery2) <= datalayer.battery2.info.min_cell_voltage_mV) {
       set_event(EVENT_CELL_UNDER_VOLTAGE, 0);
     }
 
-    // Check diff between highest and lowest cell
-    cell_deviation_mV =
-        std::abs(datalayer.battery2.status.cell_max_voltage_mV - datalayer.battery2.status.cell_min_voltage_mV);
-    if (cell_deviation_mV > datalayer.battery2.info.max_cell_voltage_deviation_mV) {
-      set_event(EVENT_CELL_DEVIATION_HIGH, (cell_deviation_mV / 20));
-    } else {
-      clear_event(EVENT_CELL_DEVIATION_HIGH);
-    }
+    check_cell_deviation(datalayer.battery2);
 
     // Check if SOH% between the packs is too large
     if ((datalayer.battery.status.soh_pptt != 9900) && (datalayer.battery2.status.soh_pptt != 9900)) {
@@ -337,22 +349,15 @@ void update_machineryprotection() {
     }
 
     // Cell overvoltage, critical latching error without automatic reset. Requires user action.
-    if (datalayer.battery3.status.cell_max_voltage_mV >= datalayer.battery3.info.max_cell_voltage_mV) {
+    if (highest_cell_mV(datalayer.battery3) >= datalayer.battery3.info.max_cell_voltage_mV) {
       set_event(EVENT_CELL_OVER_VOLTAGE, 0);
     }
     // Cell undervoltage, critical latching error without automatic reset. Requires user action.
-    if (datalayer.battery3.status.cell_min_voltage_mV <= datalayer.battery3.info.min_cell_voltage_mV) {
+    if (lowest_cell_mV(datalayer.battery3) <= datalayer.battery3.info.min_cell_voltage_mV) {
       set_event(EVENT_CELL_UNDER_VOLTAGE, 0);
     }
 
-    // Check diff between highest and lowest cell
-    cell_deviation_mV =
-        std::abs(datalayer.battery3.status.cell_max_voltage_mV - datalayer.battery3.status.cell_min_voltage_mV);
-    if (cell_deviation_mV > datalayer.battery3.info.max_cell_voltage_deviation_mV) {
-      set_event(EVENT_CELL_DEVIATION_HIGH, (cell_deviation_mV / 20));
-    } else {
-      clear_event(EVENT_CELL_DEVIATION_HIGH);
-    }
+    check_cell_deviation(datalayer.battery3);
 
     // Check if SOH% between the packs is too large
     if ((datalayer.battery.status.soh_pptt != 9900) && (datalayer.battery3.status.soh_pptt != 9900)) {
@@ -408,7 +413,7 @@ void update_machineryprotection() {
     }
 
     //Check if cellvoltage is too low to safely start recovery. If so, abort!
-    if (datalayer.battery.status.cell_min_voltage_mV < LOWEST_ALLOWED_CELLVOLTAGE_RECOVERY_CHARGE_MV) {
+    if (lowest_cell_mV(datalayer.battery) < LOWEST_ALLOWED_CELLVOLTAGE_RECOVERY_CHARGE_MV) {
       datalayer.battery.settings.user_requests_forced_charging_recovery_mode = false;
       set_event(EVENT_RECOVERY_END, 255);
     }
@@ -0,0 +1,170 @@
+#include "can_log_record.h"
+#include <stdio.h>
+#include <string.h>
+
+void init_can_log_file_header(CanLogFileHeader& header) {
+  memcpy(header.magic, CAN_LOG_MAGIC, CAN_LOG_MAGIC_SIZE);
+  header.version = CAN_LOG_FORMAT_VERSION;
+  header.record_header_size = CAN_LOG_RECORD_HEADER_SIZE;
+  header.reserved = 0;
+}
+
+bool is_valid_can_log_file_header(const CanLogFileHeader& header) {
+  return memcmp(header.magic, CAN_LOG_MAGIC, CAN_LOG_MAGIC_SIZE) == 0 && header.version == CAN_LOG_FORMAT_VERSION &&
+         header.record_header_size == CAN_LOG_RECORD_HEADER_SIZE;
+}
+
+size_t fill_can_log_record(CanLogRecord& record, const CAN_frame& frame, CAN_Interface interface,
+                           frameDirection direction, uint64_t timestamp_us) {
+  record.timestamp_us = timestamp_us;
+  record.id = frame.ID;
+  record.interface = (uint8_t)interface;
+  record.direction = (uint8_t)direction;
+  record.flags = (frame.ext_ID ? CAN_LOG_FLAG_EXT_ID : 0) | (frame.FD ? CAN_LOG_FLAG_FD : 0);
+  record.dlc = frame.DLC > CAN_LOG_MAX_PAYLOAD ? CAN_LOG_MAX_PAYLOAD : frame.DLC;
+  memcpy(record.data, frame.data.u8, record.dlc);
+  return can_log_record_size(record);
+}
+
+size_t format_can_log_record(const CanLogRecord& record, char* buffer, size_t buffer_size) {
+  static const char hex[] = "0123456789ABCDEF";
+
+  // Multiplying the interface by two puts TX and RX on different buses in SavvyCAN
+  int bus = record.interface * 2 + (record.direction == MSG_RX ? 0 : 1);
+  int written = snprintf(buffer, buffer_size, "(%llu.%06llu) %s%d %lX [%u]",
+                         (unsigned long long)(record.timestamp_us / 1000000ULL),
+                         (unsigned long long)(record.timestamp_us % 1000000ULL),
+                         record.direction == MSG_RX ? "RX" : "TX", bus, (unsigned long)record.id, record.dlc);
+  if (written < 0) {
+    return 0;
+  }
+
+  // Three characters per data byte plus the newline and terminator
+  size_t length = (size_t)written;
+  if (length + record.dlc * 3 + 2 > buffer_size) {
+    return 0;
+  }
+
+  for (uint8_t i = 0; i < record.dlc; i++) {
+    buffer[length++] = ' ';
+    buffer[length++] = hex[record.data[i] >> 4];
+    buffer[length++] = hex[record.data[i] & 0x0F];
+  }
+  buffer[length++] = '\n';
+  buffer[length] = '\0';
+  return length;
+}
+
+static const char* skip_spaces(const char* p, const char* end) {
+  while (p < end && (*p == ' ' || *p == '\t')) {
+    p++;
+  }
+  return p;
+}
+
+static int hex_value(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  return -1;
+}
+
+// Parse up to max_digits decimal digits, returns the number of digits read
+static int parse_decimal(const char*& p, const char* end, uint64_t& value, int max_digits) {
+  int digits = 0;
+  value = 0;
+  while (p < end && *p >= '0' && *p <= '9' && digits < max_digits) {
+    value = value * 10 + (*p++ - '0');
+    digits++;
+  }
+  return digits;
+}
+
+bool parse_can_log_line(const char* line, size_t length, CanLogRecord& record) {
+  const char* p = line;
+  const char* end = line + length;
+
+  // Timestamp "(seconds.fraction)", kept exact in microseconds
+  p = skip_spaces(p, end);
+  if (p == end || *p++ != '(') {
+    return false;
+  }
+  uint64_t seconds;
+  if (parse_decimal(p, end, seconds, 13) == 0) {
+    return false;
+  }
+  uint64_t micros = 0;
+  if (p < end && *p == '.') {
+    p++;
+    int digits = parse_decimal(p, end, micros, 6);
+    for (; digits < 6; digits++) {
+      micros *= 10;
+    }
+    while (p < end && *p >= '0' && *p <= '9') {
+      p++;  // Below a microsecond
+    }
+  }
+  if (p == end || *p++ != ')') {
+    return false;
+  }
+  record.timestamp_us = seconds * 1000000ULL + micros;
+
+  // "RX0"/"TX1", the inverse of the bus numbering in format_can_log_record()
+  p = skip_spaces(p, end);
+  const char* token = p;
+  while (p < end && *p != ' ' && *p != '\t') {
+    p++;
+  }
+  if (p == token || p == end) {
+    return false;
+  }
+  record.direction = (*token == 'T') ? MSG_TX : MSG_RX;
+  record.interface = 0;
+  if (p - token > 2) {
+    const char* bus_start = token + 2;
+    uint64_t bus;
+    if (parse_decimal(bus_start, p, bus, 2) > 0) {
+      record.interface = (uint8_t)(bus / 2);
+    }
+  }
+
+  // Identifier in hex
+  p = skip_spaces(p, end);
+  uint32_t id = 0;
+  int id_digits = 0;
+  for (; p < end && hex_value(*p) >= 0; p++, id_digits++) {
+    id = (id << 4) | hex_value(*p);
+  }
+  if (id_digits == 0 || id_digits > 8) {
+    return false;
+  }
+  record.id = id;
+
+  // "[DLC]"
+  p = skip_spaces(p, end);
+  if (p == end || *p++ != '[') {
+    return false;
+  }
+  uint64_t dlc;
+  if (parse_decimal(p, end, dlc, 2) == 0 || dlc > CAN_LOG_MAX_PAYLOAD || p == end || *p++ != ']') {
+    return false;
+  }
+  record.dlc = (uint8_t)dlc;
+  record.flags = (id_digits > 3 || id > 0x7FF ? CAN_LOG_FLAG_EXT_ID : 0) | (dlc > 8 ? CAN_LOG_FLAG_FD : 0);
+
+  for (uint8_t i = 0; i < record.dlc; i++) {
+    p = skip_spaces(p, end);
+    if (end - p < 2 || hex_value(p[0]) < 0 || hex_value(p[1]) < 0) {
+      return false;
+    }
+    record.data[i] = (hex_value(p[0]) << 4) | hex_value(p[1]);
+    p += 2;
+  }
+  return true;
+}
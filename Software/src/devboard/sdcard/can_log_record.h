@@ -0,0 +1,68 @@
+#ifndef _CAN_LOG_RECORD_H_
+#define _CAN_LOG_RECORD_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../utils/types.h"
+
+// Binary CAN log stored on the SD card. The file starts with a CanLogFileHeader,
+// followed by CanLogRecords. Each record is the fixed 16 byte header followed by
+// exactly DLC payload bytes, so a classic frame takes 24 bytes and a full CAN-FD
+// frame 80 bytes. All fields are little endian (native on ESP32 and x86).
+// Use the can_log_convert host tool (test/tools) to turn it into a SavvyCAN log.
+
+#define CAN_LOG_MAGIC "BECANLOG"
+#define CAN_LOG_MAGIC_SIZE 8
+#define CAN_LOG_FORMAT_VERSION 1
+
+#define CAN_LOG_FLAG_EXT_ID 0x01
+#define CAN_LOG_FLAG_FD 0x02
+
+#define CAN_LOG_MAX_PAYLOAD 64
+
+struct __attribute__((packed)) CanLogFileHeader {
+  char magic[CAN_LOG_MAGIC_SIZE];
+  uint16_t version;
+  uint16_t record_header_size;
+  uint32_t reserved;
+};
+
+struct __attribute__((packed)) CanLogRecord {
+  uint64_t timestamp_us;
+  uint32_t id;
+  uint8_t interface;  // CAN_Interface the frame was seen on
+  uint8_t direction;  // frameDirection, MSG_RX or MSG_TX
+  uint8_t flags;      // CAN_LOG_FLAG_*
+  uint8_t dlc;        // Payload length in bytes (0-64)
+  uint8_t data[CAN_LOG_MAX_PAYLOAD];
+};
+
+#define CAN_LOG_RECORD_HEADER_SIZE offsetof(CanLogRecord, data)
+
+static_assert(sizeof(CanLogFileHeader) == 16, "CAN log file header layout changed");
+static_assert(CAN_LOG_RECORD_HEADER_SIZE == 16, "CAN log record layout changed");
+
+// Number of bytes of the record that end up in the log
+inline size_t can_log_record_size(const CanLogRecord& record) {
+  return CAN_LOG_RECORD_HEADER_SIZE + record.dlc;
+}
+
+void init_can_log_file_header(CanLogFileHeader& header);
+bool is_valid_can_log_file_header(const CanLogFileHeader& header);
+
+// Pack a frame into a record, returns the number of bytes to log
+size_t fill_can_log_record(CanLogRecord& record, const CAN_frame& frame, CAN_Interface interface,
+                           frameDirection direction, uint64_t timestamp_us);
+
+// Format a record as one SavvyCAN/candump style line, same as the webserver CAN log:
+// "(1.234567) RX0 7BB [8] 01 02 03 04 05 06 07 08\n". Returns the length written
+// (excluding the terminator), or 0 if the buffer was too small.
+size_t format_can_log_record(const CanLogRecord& record, char* buffer, size_t buffer_size);
+
+// Parse one line in that format back into a record. The timestamp may have any number of
+// decimals (the webserver log has three), the bus token is optional. Frames with a DLC above
+// 8 are flagged as CAN-FD, IDs written with more than three digits as extended. Returns false
+// for lines that are not a frame, such as comments, headers or truncated lines.
+bool parse_can_log_line(const char* line, size_t length, CanLogRecord& record);
+
+#endif
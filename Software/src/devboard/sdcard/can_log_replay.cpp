@@ -0,0 +1,217 @@
+#include "can_log_replay.h"
+#include <string.h>
+
+void CanLogDecoder::reset() {
+  format = Format::Unknown;
+  failed = false;
+  record_count = 0;
+  skipped_count = 0;
+  line_length = 0;
+  line_too_long = false;
+  header_fill = 0;
+  record_fill = 0;
+}
+
+bool CanLogDecoder::feed(const uint8_t* data, size_t length) {
+  if (failed) {
+    return false;
+  }
+  if (format == Format::Unknown && length > 0) {
+    // Text logs start with a timestamp or a comment, never with the binary magic
+    format = (data[0] == CAN_LOG_MAGIC[0]) ? Format::Binary : Format::Text;
+  }
+  bool ok = (format == Format::Binary) ? feed_binary(data, length) : feed_text(data, length);
+  failed = !ok;
+  return ok;
+}
+
+bool CanLogDecoder::finish() {
+  if (failed) {
+    return false;
+  }
+  if (format == Format::Text && (line_length > 0 || line_too_long)) {
+    failed = !end_line();
+  }
+  return !failed;
+}
+
+bool CanLogDecoder::emit(const CanLogRecord& decoded) {
+  record_count++;
+  return on_record(decoded);
+}
+
+bool CanLogDecoder::end_line() {
+  bool ok = true;
+  if (line_too_long) {
+    skipped_count++;
+  } else if (line_length > 0) {
+    CanLogRecord decoded;
+    if (parse_can_log_line(line, line_length, decoded)) {
+      ok = emit(decoded);
+    } else {
+      skipped_count++;
+    }
+  }
+  line_length = 0;
+  line_too_long = false;
+  return ok;
+}
+
+bool CanLogDecoder::feed_text(const uint8_t* data, size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    char c = (char)data[i];
+    if (c == '\n' || c == '\r') {
+      if (!end_line()) {
+        return false;
+      }
+    } else if (line_length < sizeof(line)) {
+      line[line_length++] = c;
+    } else {
+      line_too_long = true;
+    }
+  }
+  return true;
+}
+
+bool CanLogDecoder::feed_binary(const uint8_t* data, size_t length) {
+  while (length > 0) {
+    if (header_fill < sizeof(header)) {
+      size_t n = sizeof(header) - header_fill;
+      n = n < length ? n : length;
+      memcpy((uint8_t*)&header + header_fill, data, n);
+      header_fill += n;
+      data += n;
+      length -= n;
+      if (header_fill == sizeof(header) && !is_valid_can_log_file_header(header)) {
+        return false;
+      }
+      continue;
+    }
+
+    // Record header first, it tells how many payload bytes follow
+    size_t needed =
+        (record_fill < CAN_LOG_RECORD_HEADER_SIZE) ? CAN_LOG_RECORD_HEADER_SIZE : can_log_record_size(record);
+    size_t n = needed - record_fill;
+    n = n < length ? n : length;
+    memcpy((uint8_t*)&record + record_fill, data, n);
+    record_fill += n;
+    data += n;
+    length -= n;
+
+    if (record_fill == CAN_LOG_RECORD_HEADER_SIZE && record.dlc > CAN_LOG_MAX_PAYLOAD) {
+      return false;
+    }
+    if (record_fill >= CAN_LOG_RECORD_HEADER_SIZE && record_fill == can_log_record_size(record)) {
+      record_fill = 0;
+      if (!emit(record)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+CanLogMemoryStore::CanLogMemoryStore(uint8_t* memory, size_t capacity) : memory(memory), capacity(capacity) {
+  clear();
+}
+
+void CanLogMemoryStore::clear() {
+  used = 0;
+  read_offset = 0;
+  if (capacity >= sizeof(CanLogFileHeader)) {
+    CanLogFileHeader header;
+    init_can_log_file_header(header);
+    memcpy(memory, &header, sizeof(header));
+    used = sizeof(header);
+  }
+}
+
+bool CanLogMemoryStore::append(const CanLogRecord& record) {
+  size_t size = can_log_record_size(record);
+  if (used == 0 || capacity - used < size) {
+    return false;
+  }
+  memcpy(memory + used, &record, size);
+  used += size;
+  return true;
+}
+
+bool CanLogMemoryStore::rewind() {
+  read_offset = 0;
+  return true;
+}
+
+size_t CanLogMemoryStore::read(uint8_t* buffer, size_t size) {
+  size_t n = used - read_offset;
+  n = n < size ? n : size;
+  memcpy(buffer, memory + read_offset, n);
+  read_offset += n;
+  return n;
+}
+
+CanLogPlayer::CanLogPlayer(CanLogSource& source)
+    : source(source), decoder([this](const CanLogRecord& record) { return queue.push(record); }) {}
+
+bool CanLogPlayer::start(uint64_t now_us, uint16_t speed) {
+  CanLogRecord discard;
+  while (queue.pop(discard)) {
+  }
+  have_pending = false;
+  decoder.reset();
+  source_done = !source.rewind();
+  speed_percent = speed > 0 ? speed : 1;
+  start_us = now_us;
+  have_origin = false;
+  played = 0;
+  uint64_t due_us;
+  return next_due(due_us);
+}
+
+void CanLogPlayer::refill() {
+  uint8_t chunk[CAN_REPLAY_READ_SIZE];
+  // A read finishes at most the record split by the previous read, plus one record per header it holds
+  while (!source_done && queue.capacity() - queue.size() > CAN_REPLAY_QUEUE_SIZE / 2) {
+    size_t n = source.read(chunk, sizeof(chunk));
+    if (n == 0 || !decoder.feed(chunk, n)) {
+      source_done = true;
+    }
+  }
+}
+
+uint64_t CanLogPlayer::due_time(uint64_t timestamp_us) {
+  if (!have_origin) {
+    origin_timestamp_us = (int64_t)timestamp_us;
+    last_timestamp_us = timestamp_us;
+    have_origin = true;
+  }
+  if (timestamp_us < last_timestamp_us) {
+    origin_timestamp_us -= (int64_t)(last_timestamp_us - timestamp_us);
+  }
+  last_timestamp_us = timestamp_us;
+  uint64_t elapsed = (uint64_t)((int64_t)timestamp_us - origin_timestamp_us);
+  return start_us + elapsed * 100 / speed_percent;
+}
+
+bool CanLogPlayer::next_due(uint64_t& due_us) {
+  if (!have_pending) {
+    refill();
+    if (!queue.pop(pending)) {
+      return false;
+    }
+    pending_due_us = due_time(pending.timestamp_us);
+    have_pending = true;
+  }
+  due_us = pending_due_us;
+  return true;
+}
+
+bool CanLogPlayer::pop_due(uint64_t now_us, CanLogRecord& record) {
+  uint64_t due_us;
+  if (!next_due(due_us) || due_us > now_us) {
+    return false;
+  }
+  record = pending;
+  have_pending = false;
+  played++;
+  return true;
+}
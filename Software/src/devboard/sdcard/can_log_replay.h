@@ -0,0 +1,148 @@
+#ifndef _CAN_LOG_REPLAY_H_
+#define _CAN_LOG_REPLAY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <functional>
+#include "../utils/spsc_queue.h"
+#include "can_log_record.h"
+
+// Longest text line accepted, a full CAN-FD frame takes about 240 characters
+#ifndef CAN_LOG_MAX_LINE_LENGTH
+#define CAN_LOG_MAX_LINE_LENGTH 256
+#endif
+
+// Frames decoded ahead of the one being sent, must be a power of two
+#ifndef CAN_REPLAY_QUEUE_SIZE
+#define CAN_REPLAY_QUEUE_SIZE 64
+#endif
+
+// Bytes read from the stored log at a time. Every record is at least
+// CAN_LOG_RECORD_HEADER_SIZE bytes, so one read never decodes more frames than
+// there is room for in half the queue.
+#define CAN_REPLAY_READ_SIZE (CAN_REPLAY_QUEUE_SIZE / 2 * CAN_LOG_RECORD_HEADER_SIZE)
+
+// Turns a CAN log that arrives in pieces of any size into records, without
+// holding more than one line or record of it. Both the binary SD card log
+// (recognised by its file header) and the SavvyCAN/candump text log of the
+// webserver are accepted.
+class CanLogDecoder {
+ public:
+  // Called for every frame. Returning false stops the decoding, for instance when the storage is full.
+  typedef std::function<bool(const CanLogRecord& record)> RecordCallback;
+
+  explicit CanLogDecoder(RecordCallback on_record) : on_record(on_record) {}
+
+  void reset();
+  // Returns false if the callback refused a record or the binary log is corrupt
+  bool feed(const uint8_t* data, size_t length);
+  // Decode a last line that has no newline at the end
+  bool finish();
+
+  uint32_t records() const { return record_count; }
+  // Lines that were not a frame, or too long to be one
+  uint32_t skipped_lines() const { return skipped_count; }
+
+ private:
+  enum class Format { Unknown, Text, Binary };
+
+  bool feed_text(const uint8_t* data, size_t length);
+  bool feed_binary(const uint8_t* data, size_t length);
+  bool end_line();
+  bool emit(const CanLogRecord& record);
+
+  RecordCallback on_record;
+  Format format = Format::Unknown;
+  bool failed = false;
+  uint32_t record_count = 0;
+  uint32_t skipped_count = 0;
+
+  char line[CAN_LOG_MAX_LINE_LENGTH];
+  size_t line_length = 0;
+  bool line_too_long = false;
+
+  // Binary log: the file header, then one record at a time
+  size_t header_fill = 0;
+  CanLogFileHeader header;
+  size_t record_fill = 0;
+  CanLogRecord record;
+};
+
+// Binary log (file header and packed records) that can be read back from the start
+class CanLogSource {
+ public:
+  virtual ~CanLogSource() = default;
+  virtual bool rewind() = 0;
+  // Returns the number of bytes read, 0 at the end of the log
+  virtual size_t read(uint8_t* buffer, size_t size) = 0;
+};
+
+// Binary log in a fixed block of memory, the upload store when there is no SD card
+class CanLogMemoryStore : public CanLogSource {
+ public:
+  CanLogMemoryStore(uint8_t* memory, size_t capacity);
+
+  // Empty the store, leaving only the file header
+  void clear();
+  // Returns false when the record does not fit
+  bool append(const CanLogRecord& record);
+  size_t size() const { return used; }
+
+  bool rewind() override;
+  size_t read(uint8_t* buffer, size_t size) override;
+
+ private:
+  uint8_t* memory;
+  size_t capacity;
+  size_t used = 0;
+  size_t read_offset = 0;
+};
+
+// Plays a stored log back with the timing it was recorded with.
+//
+// Frames are decoded from the source into a small queue ahead of the one that
+// is due, so only CAN_REPLAY_QUEUE_SIZE frames are held in RAM whatever the size
+// of the log. Due times are exact in microseconds on the caller's clock:
+//
+//   due = start + (timestamp - first timestamp) * 100 / speed_percent
+//
+// A timestamp that goes backwards, where two logs were joined, continues from
+// the frame before it instead of waiting for the clock to catch up.
+class CanLogPlayer {
+ public:
+  explicit CanLogPlayer(CanLogSource& source);
+
+  // Start over from the first frame, due at now_us. speed_percent 100 replays in real time,
+  // 200 twice as fast. Returns false if the log holds no frames.
+  bool start(uint64_t now_us, uint16_t speed_percent = 100);
+
+  // Time the next frame is due. Returns false once the log has been played to its end.
+  bool next_due(uint64_t& due_us);
+  // Take the next frame if it is due at now_us
+  bool pop_due(uint64_t now_us, CanLogRecord& record);
+
+  uint32_t frames_played() const { return played; }
+
+ private:
+  void refill();
+  uint64_t due_time(uint64_t timestamp_us);
+
+  CanLogSource& source;
+  CanLogDecoder decoder;
+  SpscQueue<CanLogRecord, CAN_REPLAY_QUEUE_SIZE> queue;
+  bool source_done = false;
+
+  // Frame taken from the queue whose due time has been worked out
+  bool have_pending = false;
+  CanLogRecord pending;
+  uint64_t pending_due_us = 0;
+
+  uint16_t speed_percent = 100;
+  uint64_t start_us = 0;
+  bool have_origin = false;
+  int64_t origin_timestamp_us = 0;
+  uint64_t last_timestamp_us = 0;
+  uint32_t played = 0;
+};
+
+#endif
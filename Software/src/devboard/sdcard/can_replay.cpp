@@ -0,0 +1,260 @@
+#include "can_replay.h"
+#include <Arduino.h>
+#include <SD_MMC.h>
+#include <algorithm>
+#include <atomic>
+#include "../../communication/can/comm_can.h"
+#include "../../datalayer/datalayer.h"
+#include "../utils/logging.h"
+#include "can_log_replay.h"
+#include "esp_timer.h"
+#include "sdcard.h"
+
+#define CAN_REPLAY_WRITE_BLOCK_SIZE 4096
+
+// Longest a replay sleeps at once, so a stop request is picked up quickly even in a gap of the log
+#define CAN_REPLAY_MAX_SLEEP_US 100000
+
+// Uploaded log on the SD card, written a block at a time
+class CanLogFileStore : public CanLogSource {
+ public:
+  bool create() {
+    SD_MMC.remove(CAN_REPLAY_FILE);
+    file = SD_MMC.open(CAN_REPLAY_FILE, FILE_WRITE);
+    block = (uint8_t*)malloc(CAN_REPLAY_WRITE_BLOCK_SIZE);
+    block_used = 0;
+    write_error = false;
+    if (!file || !block) {
+      finish();
+      return false;
+    }
+    CanLogFileHeader header;
+    init_can_log_file_header(header);
+    memcpy(block, &header, sizeof(header));
+    block_used = sizeof(header);
+    return true;
+  }
+
+  bool append(const CanLogRecord& record) {
+    size_t size = can_log_record_size(record);
+    if (block_used + size > CAN_REPLAY_WRITE_BLOCK_SIZE) {
+      write_block();
+    }
+    memcpy(block + block_used, &record, size);
+    block_used += size;
+    return !write_error;
+  }
+
+  bool finish() {
+    if (block) {
+      write_block();
+      free(block);
+      block = NULL;
+    }
+    file.close();
+    return !write_error;
+  }
+
+  bool rewind() override {
+    if (!file) {
+      file = SD_MMC.open(CAN_REPLAY_FILE, FILE_READ);
+    }
+    return file && file.seek(0);
+  }
+
+  size_t read(uint8_t* buffer, size_t size) override { return file.read(buffer, size); }
+
+  void close() { file.close(); }
+
+ private:
+  void write_block() {
+    if (block_used > 0 && file.write(block, block_used) != block_used) {
+      write_error = true;
+    }
+    block_used = 0;
+  }
+
+  File file;
+  uint8_t* block = NULL;
+  size_t block_used = 0;
+  bool write_error = false;
+};
+
+static CanLogFileStore file_store;
+static uint8_t* memory = NULL;
+static size_t memory_size = 0;
+static CanLogMemoryStore memory_store(NULL, 0);
+
+static bool upload_to_file = false;
+static bool store_full = false;
+static CanReplayUploadResult upload_result = CanReplayUploadResult::Ok;
+static CanLogDecoder upload_decoder([](const CanLogRecord& record) {
+  store_full = !(upload_to_file ? file_store.append(record) : memory_store.append(record));
+  return !store_full;
+});
+
+static CanLogSource* stored_log = NULL;
+static uint32_t stored_frames = 0;
+
+static std::atomic<bool> uploading{false};
+static std::atomic<bool> replay_running{false};
+static std::atomic<bool> stop_requested{false};
+static uint16_t replay_speed_percent = 100;
+
+CanReplayUploadResult can_replay_upload_begin() {
+  if (replay_running || uploading) {
+    return CanReplayUploadResult::Busy;
+  }
+  stored_log = NULL;
+  stored_frames = 0;
+
+  upload_to_file = is_sdcard_active();
+  if (upload_to_file) {
+    if (!file_store.create()) {
+      return CanReplayUploadResult::NoStorage;
+    }
+  } else {
+    if (memory == NULL) {
+      memory_size = psramFound() ? CAN_REPLAY_PSRAM_SIZE : CAN_REPLAY_RAM_SIZE;
+      memory = (uint8_t*)(psramFound() ? ps_malloc(memory_size) : malloc(memory_size));
+    }
+    if (memory == NULL) {
+      return CanReplayUploadResult::NoStorage;
+    }
+    memory_store = CanLogMemoryStore(memory, memory_size);
+  }
+
+  upload_decoder.reset();
+  store_full = false;
+  upload_result = CanReplayUploadResult::Ok;
+  uploading = true;
+  return upload_result;
+}
+
+CanReplayUploadResult can_replay_upload_chunk(const uint8_t* data, size_t length) {
+  if (uploading && upload_result == CanReplayUploadResult::Ok && !upload_decoder.feed(data, length)) {
+    upload_result = store_full ? CanReplayUploadResult::TooLarge : CanReplayUploadResult::Corrupt;
+  }
+  return upload_result;
+}
+
+CanReplayUploadResult can_replay_upload_end() {
+  if (!uploading) {
+    return CanReplayUploadResult::NoStorage;
+  }
+  if (upload_result == CanReplayUploadResult::Ok && !upload_decoder.finish()) {
+    upload_result = CanReplayUploadResult::TooLarge;
+  }
+  if (upload_to_file && !file_store.finish() && upload_result == CanReplayUploadResult::Ok) {
+    upload_result = CanReplayUploadResult::TooLarge;
+  }
+  if (upload_result == CanReplayUploadResult::Ok) {
+    stored_log = upload_to_file ? (CanLogSource*)&file_store : (CanLogSource*)&memory_store;
+    stored_frames = upload_decoder.records();
+  }
+  logging.printf("CAN replay: stored %lu frames (%s), skipped %lu lines\n", (unsigned long)upload_decoder.records(),
+                 upload_to_file ? "SD card" : "RAM", (unsigned long)upload_decoder.skipped_lines());
+  uploading = false;
+  return upload_result;
+}
+
+const char* can_replay_upload_message(CanReplayUploadResult result) {
+  switch (result) {
+    case CanReplayUploadResult::Ok:
+      return "File uploaded successfully";
+    case CanReplayUploadResult::Busy:
+      return "Stop the running replay before uploading a new log";
+    case CanReplayUploadResult::NoStorage:
+      return "No storage available for the log";
+    case CanReplayUploadResult::TooLarge:
+      return "Log does not fit, insert an SD card to replay large logs";
+    case CanReplayUploadResult::Corrupt:
+      return "Binary CAN log is corrupt";
+  }
+  return "";
+}
+
+uint32_t can_replay_stored_frames() {
+  return stored_frames;
+}
+
+// Sleep through most of the wait, then spin for the last tick so the frame goes out on the microsecond
+static void wait_until(uint64_t due_us) {
+  const int64_t tick_us = portTICK_PERIOD_MS * 1000;
+  while (!stop_requested) {
+    int64_t remaining = (int64_t)(due_us - esp_timer_get_time());
+    if (remaining <= 0) {
+      return;
+    }
+    if (remaining > 2 * tick_us) {
+      int64_t sleep_us = std::min<int64_t>(remaining - tick_us, CAN_REPLAY_MAX_SLEEP_US);
+      vTaskDelay(sleep_us / tick_us);
+    }
+  }
+}
+
+static void can_replay_task(void* param) {
+  // Only the queue of decoded frames is held in RAM, and only while replaying
+  CanLogPlayer* player = new CanLogPlayer(*stored_log);
+  uint32_t skipped = 0;
+
+  do {
+    if (!player->start(esp_timer_get_time(), replay_speed_percent)) {
+      break;
+    }
+    uint64_t due_us;
+    while (!stop_requested && player->next_due(due_us)) {
+      wait_until(due_us);
+
+      // Frames that are due by now go out back to back
+      CanLogRecord record;
+      while (!stop_requested && player->pop_due(esp_timer_get_time(), record)) {
+        CAN_Interface interface = (CAN_Interface)datalayer.system.info.can_replay_interface;
+        CAN_frame frame;
+        frame.FD = (interface == CANFD_NATIVE) || (interface == CANFD_ADDON_MCP2518);
+        if (record.dlc > 8 && !frame.FD) {
+          skipped++;  // A CAN-FD payload can not go out on a classic CAN interface
+          continue;
+        }
+        frame.ext_ID = (record.flags & CAN_LOG_FLAG_EXT_ID) != 0;
+        frame.DLC = record.dlc;
+        frame.ID = record.id;
+        memcpy(frame.data.u8, record.data, record.dlc);
+        transmit_can_frame_to_interface(&frame, interface);
+      }
+    }
+  } while (!stop_requested && datalayer.system.info.loop_playback);
+
+  logging.printf("CAN replay: stopped after %lu frames, %lu CAN-FD frames skipped\n",
+                 (unsigned long)player->frames_played(), (unsigned long)skipped);
+  delete player;
+  if (stored_log == &file_store) {
+    file_store.close();
+  }
+  replay_running = false;
+  vTaskDelete(NULL);
+}
+
+bool start_can_replay(bool loop, uint16_t speed_percent) {
+  if (replay_running || uploading || stored_log == NULL) {
+    return false;
+  }
+  datalayer.system.info.loop_playback = loop;
+  replay_speed_percent = speed_percent > 0 ? speed_percent : 100;
+  stop_requested = false;
+  replay_running = true;
+  if (xTaskCreatePinnedToCore(can_replay_task, "CAN_Replay", 8192, NULL, 1, NULL, 1) != pdPASS) {
+    replay_running = false;
+    return false;
+  }
+  return true;
+}
+
+void stop_can_replay() {
+  datalayer.system.info.loop_playback = false;
+  stop_requested = true;
+}
+
+bool can_replay_running() {
+  return replay_running;
+}
@@ -0,0 +1,35 @@
+#ifndef _CAN_REPLAY_H_
+#define _CAN_REPLAY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Uploaded logs are kept here when an SD card is mounted, in the binary CAN log format
+#define CAN_REPLAY_FILE "/canreplay.bin"
+
+// Without an SD card the log is kept in RAM, as packed binary records. In PSRAM
+// when the board has it, otherwise in a much smaller block of the normal heap.
+#ifndef CAN_REPLAY_PSRAM_SIZE
+#define CAN_REPLAY_PSRAM_SIZE (2 * 1024 * 1024)
+#endif
+#ifndef CAN_REPLAY_RAM_SIZE
+#define CAN_REPLAY_RAM_SIZE (32 * 1024)
+#endif
+
+enum class CanReplayUploadResult { Ok, Busy, NoStorage, TooLarge, Corrupt };
+
+// Upload, called with the pieces of the file as they arrive. Text (SavvyCAN/candump)
+// and binary SD card logs are both decoded on the fly and stored as binary records.
+CanReplayUploadResult can_replay_upload_begin();
+CanReplayUploadResult can_replay_upload_chunk(const uint8_t* data, size_t length);
+CanReplayUploadResult can_replay_upload_end();
+const char* can_replay_upload_message(CanReplayUploadResult result);
+uint32_t can_replay_stored_frames();
+
+// Replays the stored log on datalayer.system.info.can_replay_interface from a task of its own.
+// speed_percent 100 is real time. Returns false if a replay is already running or nothing is stored.
+bool start_can_replay(bool loop, uint16_t speed_percent);
+void stop_can_replay();
+bool can_replay_running();
+
+#endif
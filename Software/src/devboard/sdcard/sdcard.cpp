@@ -1,30 +1,142 @@
 #include "sdcard.h"
+#include "can_log_record.h"
+#include "esp_timer.h"
 #include "freertos/ringbuf.h"
 
-File can_log_file;
-File log_file;
+// Log data is gathered from the ring buffers into RAM blocks and written to the card a whole
+// block at a time, aligned to block boundaries in the file. The file is only flushed once
+// per SD_LOG_FLUSH_INTERVAL_MS, so the FAT is not rewritten for every few bytes logged.
+struct SdLogWriter {
+  const char* path;
+  const char* old_path;  // Previous file after rotation
+  size_t block_size;
+  size_t max_file_size;
+  bool can_log;  // Binary CAN log, starts with a CanLogFileHeader
+  File file = File();
+  bool file_open = false;
+  size_t file_size = 0;
+  uint8_t* block = NULL;
+  size_t block_used = 0;
+  unsigned long last_flush_ms = 0;
+};
+
+static SdLogWriter can_writer = {CAN_LOG_FILE, CAN_LOG_FILE_OLD, CAN_LOG_BLOCK_SIZE, CAN_LOG_MAX_FILE_SIZE, true};
+static SdLogWriter log_writer = {LOG_FILE, LOG_FILE_OLD, LOG_BLOCK_SIZE, LOG_MAX_FILE_SIZE, false};
+
 RingbufHandle_t can_bufferHandle;
 RingbufHandle_t log_bufferHandle;
 
 bool can_logging_paused = false;
-bool can_file_open = false;
 bool delete_can_file = false;
 
 bool logging_paused = false;
-bool log_file_open = false;
 bool delete_log_file = false;
 
 bool sd_card_active = false;
 
+static void open_log_file(SdLogWriter& writer) {
+  writer.file = SD_MMC.open(writer.path, FILE_APPEND);
+  writer.file_open = true;
+  writer.file_size = writer.file ? writer.file.size() : 0;
+  writer.last_flush_ms = millis();
+
+  // A new (or deleted) CAN log starts with the header the offline converter checks for
+  if (writer.can_log && writer.file && writer.file_size == 0) {
+    CanLogFileHeader header;
+    init_can_log_file_header(header);
+    writer.file_size += writer.file.write((const uint8_t*)&header, sizeof(header));
+  }
+}
+
+static void rotate_log_file(SdLogWriter& writer) {
+  writer.file.close();
+  writer.file_open = false;
+  SD_MMC.remove(writer.old_path);
+  SD_MMC.rename(writer.path, writer.old_path);
+  open_log_file(writer);
+}
+
+static void write_log_block(SdLogWriter& writer) {
+  if (writer.block_used == 0) {
+    return;
+  }
+  if (!writer.file_open) {
+    open_log_file(writer);
+  }
+  writer.file_size += writer.file.write(writer.block, writer.block_used);
+  writer.block_used = 0;
+
+  if (writer.file_size >= writer.max_file_size) {
+    rotate_log_file(writer);
+  }
+}
+
+static void flush_log_file(SdLogWriter& writer) {
+  write_log_block(writer);
+  if (writer.file_open) {
+    writer.file.flush();
+  }
+  writer.last_flush_ms = millis();
+}
+
+static void close_log_file(SdLogWriter& writer) {
+  write_log_block(writer);
+  if (writer.file_open) {
+    writer.file.close();
+    writer.file_open = false;
+  }
+}
+
+// Move everything waiting in the ring buffer into the block buffer, writing each block
+// once it reaches the next block boundary of the file
+static void drain_ring_buffer(SdLogWriter& writer, RingbufHandle_t ring_buffer) {
+  if (!writer.file_open) {
+    open_log_file(writer);
+  }
+
+  TickType_t wait = pdMS_TO_TICKS(10);
+  while (true) {
+    size_t block_end = writer.block_size - (writer.file_size % writer.block_size);
+    size_t received_size;
+    uint8_t* item =
+        (uint8_t*)xRingbufferReceiveUpTo(ring_buffer, &received_size, wait, block_end - writer.block_used);
+    if (item == NULL) {
+      break;
+    }
+    memcpy(writer.block + writer.block_used, item, received_size);
+    writer.block_used += received_size;
+    vRingbufferReturnItem(ring_buffer, (void*)item);
+
+    if (writer.block_used == block_end) {
+      // One block per pass, so a busy CAN bus does not starve the other log
+      write_log_block(writer);
+      break;
+    }
+    wait = 0;
+  }
+
+  if (millis() - writer.last_flush_ms >= SD_LOG_FLUSH_INTERVAL_MS) {
+    flush_log_file(writer);
+  }
+}
+
+// Throw away what was logged while writing is paused
+static void discard_ring_buffer(RingbufHandle_t ring_buffer) {
+  size_t received_size;
+  uint8_t* item = (uint8_t*)xRingbufferReceive(ring_buffer, &received_size, pdMS_TO_TICKS(10));
+  if (item != NULL) {
+    vRingbufferReturnItem(ring_buffer, (void*)item);
+  }
+}
+
 void delete_can_log() {
   can_logging_paused = true;
   delete_can_file = true;
 }
 
 void resume_can_writing() {
+  // The logging task reopens the file on its next pass
   can_logging_paused = false;
-  can_log_file = SD_MMC.open(CAN_LOG_FILE, FILE_APPEND);
-  can_file_open = true;
 }
 
 void pause_can_writing() {
@@ -33,93 +145,55 @@ void pause_can_writing() {
 
 void delete_log() {
   logging_paused = true;
-  if (log_file_open) {
-    log_file.close();
-    log_file_open = false;
-  }
-  SD_MMC.remove(LOG_FILE);
-  logging_paused = false;
+  delete_log_file = true;
 }
 
 void resume_log_writing() {
   logging_paused = false;
-  log_file = SD_MMC.open(LOG_FILE, FILE_APPEND);
-  log_file_open = true;
 }
 
 void pause_log_writing() {
   logging_paused = true;
 }
 
-void add_can_frame_to_buffer(CAN_frame frame, frameDirection msgDir) {
+void add_can_frame_to_buffer(const CAN_frame& frame, CAN_Interface interface, frameDirection msgDir) {
 
-  if (!sd_card_active)
+  if (!sd_card_active || can_bufferHandle == NULL)
     return;
 
-  unsigned long currentTime = millis();
-  static char messagestr_buffer[32];
-  size_t size = 0;
-  size = snprintf(messagestr_buffer + size, sizeof(messagestr_buffer) - size, "(%lu.%03lu) %s %lX [%u] ",
-                  currentTime / 1000, currentTime % 1000, (msgDir == MSG_RX ? "RX0" : "TX1"), frame.ID, frame.DLC);
+  // One fixed-layout record per frame, handed to the ring buffer in a single send. It is built on the stack
+  // because the core task and the CAN replay task both log frames.
+  CanLogRecord record;
+  size_t size = fill_can_log_record(record, frame, interface, msgDir, esp_timer_get_time());
 
-  if (xRingbufferSend(can_bufferHandle, &messagestr_buffer, size, pdMS_TO_TICKS(2)) != pdTRUE) {
+  if (xRingbufferSend(can_bufferHandle, &record, size, pdMS_TO_TICKS(2)) != pdTRUE) {
     logging.println("Failed to send message to can ring buffer!");
-    return;
-  }
-
-  uint8_t i = 0;
-  for (i = 0; i < frame.DLC; i++) {
-    if (i < frame.DLC - 1)
-      size = snprintf(messagestr_buffer, sizeof(messagestr_buffer), "%02X ", frame.data.u8[i]);
-    else
-      size = snprintf(messagestr_buffer, sizeof(messagestr_buffer), "%02X\n", frame.data.u8[i]);
-
-    if (xRingbufferSend(can_bufferHandle, &messagestr_buffer, size, pdMS_TO_TICKS(2)) != pdTRUE) {
-      logging.println("Failed to send message to can ring buffer!");
-      return;
-    }
   }
 }
 
 void write_can_frame_to_sdcard() {
 
-  if (!sd_card_active)
+  if (!sd_card_active || can_bufferHandle == NULL)
     return;
 
-  size_t receivedMessageSize;
-  uint8_t* buffer = (uint8_t*)xRingbufferReceive(can_bufferHandle, &receivedMessageSize, pdMS_TO_TICKS(10));
-
-  if (buffer != NULL) {
-
-    if (can_logging_paused) {
-      if (can_file_open) {
-        can_log_file.close();
-        can_file_open = false;
-      }
-      if (delete_can_file) {
-        SD_MMC.remove(CAN_LOG_FILE);
-        delete_can_file = false;
-        can_logging_paused = false;
-      }
-      vRingbufferReturnItem(can_bufferHandle, (void*)buffer);
-      return;
+  if (can_logging_paused) {
+    close_log_file(can_writer);
+    if (delete_can_file) {
+      SD_MMC.remove(CAN_LOG_FILE);
+      SD_MMC.remove(CAN_LOG_FILE_OLD);
+      delete_can_file = false;
+      can_logging_paused = false;
     }
-
-    if (can_file_open == false) {
-      can_log_file = SD_MMC.open(CAN_LOG_FILE, FILE_APPEND);
-      can_file_open = true;
-    }
-
-    can_log_file.write(buffer, receivedMessageSize);
-    can_log_file.flush();
-
-    vRingbufferReturnItem(can_bufferHandle, (void*)buffer);
+    discard_ring_buffer(can_bufferHandle);
+    return;
   }
+
+  drain_ring_buffer(can_writer, can_bufferHandle);
 }
 
 void add_log_to_buffer(const uint8_t* buffer, size_t size) {
 
-  if (!sd_card_active)
+  if (!sd_card_active || log_bufferHandle == NULL)
     return;
 
   if (xRingbufferSend(log_bufferHandle, buffer, size, pdMS_TO_TICKS(1)) != pdTRUE) {
@@ -130,58 +204,70 @@ void add_log_to_buffer(const uint8_t* buffer, size_t size) {
 
 void write_log_to_sdcard() {
 
-  if (!sd_card_active)
+  if (!sd_card_active || log_bufferHandle == NULL)
     return;
 
-  size_t receivedMessageSize;
-  uint8_t* buffer = (uint8_t*)xRingbufferReceive(log_bufferHandle, &receivedMessageSize, pdMS_TO_TICKS(10));
-
-  if (buffer != NULL) {
-
-    if (logging_paused) {
-      vRingbufferReturnItem(log_bufferHandle, (void*)buffer);
-      return;
+  if (logging_paused) {
+    close_log_file(log_writer);
+    if (delete_log_file) {
+      SD_MMC.remove(LOG_FILE);
+      SD_MMC.remove(LOG_FILE_OLD);
+      delete_log_file = false;
+      logging_paused = false;
     }
+    discard_ring_buffer(log_bufferHandle);
+    return;
+  }
+
+  drain_ring_buffer(log_writer, log_bufferHandle);
+}
 
-    if (log_file_open == false) {
-      log_file = SD_MMC.open(LOG_FILE, FILE_APPEND);
-      log_file_open = true;
+// Creates the ring buffer and the block buffer of a log. Returns NULL, with neither allocated, if one fails,
+// so a log without a ring buffer is never written.
+static RingbufHandle_t create_log_buffers(SdLogWriter& writer, size_t ring_buffer_size) {
+  RingbufHandle_t ring_buffer = xRingbufferCreate(ring_buffer_size, RINGBUF_TYPE_BYTEBUF);
+  writer.block = (uint8_t*)malloc(writer.block_size);
+  writer.block_used = 0;
+  if (ring_buffer == NULL || writer.block == NULL) {
+    if (ring_buffer != NULL) {
+      vRingbufferDelete(ring_buffer);
     }
+    free(writer.block);
+    writer.block = NULL;
+    return NULL;
+  }
+  return ring_buffer;
+}
 
-    log_file.write(buffer, receivedMessageSize);
-    log_file.flush();
-    vRingbufferReturnItem(log_bufferHandle, (void*)buffer);
+static void delete_log_buffers(SdLogWriter& writer, RingbufHandle_t& ring_buffer) {
+  if (ring_buffer != NULL) {
+    vRingbufferDelete(ring_buffer);
+    ring_buffer = NULL;
   }
+  free(writer.block);
+  writer.block = NULL;
 }
 
 void init_logging_buffers() {
 
   if (datalayer.system.info.CAN_SD_logging_active) {
-    can_bufferHandle = xRingbufferCreate(32 * 1024, RINGBUF_TYPE_BYTEBUF);
+    can_bufferHandle = create_log_buffers(can_writer, 32 * 1024);
     if (can_bufferHandle == NULL) {
       logging.println("Failed to create CAN ring buffer!");
-      return;
     }
   }
 
   if (datalayer.system.info.SD_logging_active) {
-    log_bufferHandle = xRingbufferCreate(1024, RINGBUF_TYPE_BYTEBUF);
+    log_bufferHandle = create_log_buffers(log_writer, 1024);
     if (log_bufferHandle == NULL) {
       logging.println("Failed to create log ring buffer!");
-      return;
     }
   }
 }
 
 void deinit_logging_buffers() {
-  if ((!datalayer.system.info.CAN_SD_logging_active) && (!datalayer.system.info.CAN_SD_logging_active)) {
-    if (can_bufferHandle != NULL) {
-      vRingbufferDelete(can_bufferHandle);
-    }
-    if (log_bufferHandle != NULL) {
-      vRingbufferDelete(log_bufferHandle);
-    }
-  }
+  delete_log_buffers(can_writer, can_bufferHandle);
+  delete_log_buffers(log_writer, log_bufferHandle);
 }
 
 bool init_sdcard() {
@@ -212,6 +298,10 @@ bool init_sdcard() {
   return true;
 }
 
+bool is_sdcard_active() {
+  return sd_card_active;
+}
+
 void log_sdcard_details() {
 
   logging.print("SD Card Type: ");
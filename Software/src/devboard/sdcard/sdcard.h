@@ -6,16 +6,40 @@
 #include "../hal/hal.h"
 #include "../utils/events.h"
 
-#define CAN_LOG_FILE "/canlog.txt"
+#define CAN_LOG_FILE "/canlog.bin"
 #define LOG_FILE "/log.txt"
+#define CAN_LOG_FILE_OLD "/canlog_old.bin"
+#define LOG_FILE_OLD "/log_old.txt"
+
+// Size of the RAM blocks that are written to the card in one go
+#ifndef CAN_LOG_BLOCK_SIZE
+#define CAN_LOG_BLOCK_SIZE (16 * 1024)
+#endif
+#ifndef LOG_BLOCK_SIZE
+#define LOG_BLOCK_SIZE (4 * 1024)
+#endif
+
+// Partially filled blocks are written and the files flushed at least this often
+#ifndef SD_LOG_FLUSH_INTERVAL_MS
+#define SD_LOG_FLUSH_INTERVAL_MS 2000
+#endif
+
+// Once a log reaches this size it is renamed to the _old file and a new one is started
+#ifndef CAN_LOG_MAX_FILE_SIZE
+#define CAN_LOG_MAX_FILE_SIZE (256UL * 1024 * 1024)
+#endif
+#ifndef LOG_MAX_FILE_SIZE
+#define LOG_MAX_FILE_SIZE (16UL * 1024 * 1024)
+#endif
 
 void init_logging_buffers();
 void deinit_logging_buffers();
 
 bool init_sdcard();
+bool is_sdcard_active();
 void log_sdcard_details();
 
-void add_can_frame_to_buffer(CAN_frame frame, frameDirection msgDir);
+void add_can_frame_to_buffer(const CAN_frame& frame, CAN_Interface interface, frameDirection msgDir);
 void write_can_frame_to_sdcard();
 
 void pause_can_writing();
@@ -0,0 +1,125 @@
+#include "cell_statistics.h"
+
+// The cells are visited in lanes that keep their own sums and extremes, so that the
+// loads, compares and multiplies of neighbouring cells do not wait on each other.
+#define CELL_STATISTICS_LANES 4
+
+static uint32_t isqrt64(uint64_t value) {
+  uint64_t root = 0;
+  uint64_t bit = 1ULL << 62;
+  while (bit > value) {
+    bit >>= 2;
+  }
+  while (bit != 0) {
+    if (value >= root + bit) {
+      value -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  return (uint32_t)root;
+}
+
+void compute_cell_statistics(const uint16_t* voltages_mV, const bool* balancing, uint16_t count,
+                             CellStatistics& statistics) {
+  uint32_t sum[CELL_STATISTICS_LANES] = {0};
+  uint64_t squares[CELL_STATISTICS_LANES] = {0};
+  uint16_t measured[CELL_STATISTICS_LANES] = {0};
+  uint16_t balancing_cells[CELL_STATISTICS_LANES] = {0};
+  uint16_t low[CELL_STATISTICS_LANES];
+  uint16_t high[CELL_STATISTICS_LANES];
+  uint16_t low_index[CELL_STATISTICS_LANES];
+  uint16_t high_index[CELL_STATISTICS_LANES];
+  for (int lane = 0; lane < CELL_STATISTICS_LANES; lane++) {
+    low[lane] = UINT16_MAX;
+    high[lane] = 0;
+    low_index[lane] = 0;
+    high_index[lane] = 0;
+  }
+
+  auto visit = [&](int lane, uint16_t cell) {
+    uint16_t voltage_mV = voltages_mV[cell];
+    sum[lane] += voltage_mV;
+    squares[lane] += (uint32_t)voltage_mV * voltage_mV;
+    measured[lane] += (voltage_mV != 0);
+    balancing_cells[lane] += balancing[cell];
+    uint16_t candidate = (voltage_mV != 0) ? voltage_mV : UINT16_MAX;  // Unmeasured cells are never the lowest
+    if (candidate < low[lane]) {
+      low[lane] = candidate;
+      low_index[lane] = cell;
+    }
+    if (voltage_mV > high[lane]) {
+      high[lane] = voltage_mV;
+      high_index[lane] = cell;
+    }
+  };
+
+  uint16_t cell = 0;
+  for (; cell + CELL_STATISTICS_LANES <= count; cell += CELL_STATISTICS_LANES) {
+#pragma GCC unroll 4
+    for (int lane = 0; lane < CELL_STATISTICS_LANES; lane++) {
+      visit(lane, cell + lane);
+    }
+  }
+  for (; cell < count; cell++) {
+    visit(0, cell);
+  }
+
+  CellStatistics result;
+  uint32_t total = 0;
+  uint64_t total_squares = 0;
+  for (int lane = 0; lane < CELL_STATISTICS_LANES; lane++) {
+    total += sum[lane];
+    total_squares += squares[lane];
+    result.cells += measured[lane];
+    result.balancing += balancing_cells[lane];
+    if (measured[lane] == 0) {
+      continue;
+    }
+    // Ties go to the lower cell number, as a plain loop would have it
+    if (result.min_mV == 0 || low[lane] < result.min_mV ||
+        (low[lane] == result.min_mV && low_index[lane] < result.min_index)) {
+      result.min_mV = low[lane];
+      result.min_index = low_index[lane];
+    }
+    if (high[lane] > result.max_mV || (high[lane] == result.max_mV && high_index[lane] < result.max_index)) {
+      result.max_mV = high[lane];
+      result.max_index = high_index[lane];
+    }
+  }
+
+  if (result.cells == 0) {
+    statistics = result;
+    return;
+  }
+
+  uint32_t n = result.cells;
+  result.mean_mV = (total + n / 2) / n;
+  // n² times the variance, exact in integers
+  uint64_t variance_n2 = n * total_squares - (uint64_t)total * total;
+  if (variance_n2 <= UINT64_MAX / 1000000ULL) {
+    result.stddev_uV = isqrt64(variance_n2 * 1000000ULL) / n;
+  } else {
+    result.stddev_uV = (uint64_t)isqrt64(variance_n2) * 1000 / n;  // Only with readings far beyond any cell
+  }
+
+  // Second pass, against the mean
+  uint32_t outlier_limit_uV = CELL_OUTLIER_SIGMAS * result.stddev_uV;
+  if (outlier_limit_uV < CELL_OUTLIER_MIN_DEVIATION_mV * 1000) {
+    outlier_limit_uV = CELL_OUTLIER_MIN_DEVIATION_mV * 1000;
+  }
+  int64_t mean_uV = ((uint64_t)total * 1000) / n;
+  for (cell = 0; cell < count; cell++) {
+    uint16_t voltage_mV = voltages_mV[cell];
+    if (voltage_mV != 0) {
+      int64_t deviation_uV = (int64_t)voltage_mV * 1000 - mean_uV;
+      if (deviation_uV > outlier_limit_uV || -deviation_uV > outlier_limit_uV) {
+        result.outliers++;
+      }
+    }
+  }
+
+  statistics = result;
+}
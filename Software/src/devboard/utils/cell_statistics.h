@@ -0,0 +1,41 @@
+#ifndef _CELL_STATISTICS_H_
+#define _CELL_STATISTICS_H_
+
+#include <stdint.h>
+
+/** A cell is an outlier if it is further from the mean than this many standard deviations... */
+#ifndef CELL_OUTLIER_SIGMAS
+#define CELL_OUTLIER_SIGMAS 3
+#endif
+/** ...and further than this, so a well balanced pack does not report noise as outliers */
+#ifndef CELL_OUTLIER_MIN_DEVIATION_mV
+#define CELL_OUTLIER_MIN_DEVIATION_mV 20
+#endif
+
+/** Summary of the cell voltages of a pack, computed once per second after the battery
+ * updated its values, for the webserver, MQTT and the live data stream.
+ * Cells that read 0 mV have not been measured yet and are left out.
+ */
+struct CellStatistics {
+  /** Standard deviation of the cell voltages, in µV */
+  uint32_t stddev_uV = 0;
+  /** Cells with a voltage reading */
+  uint16_t cells = 0;
+  uint16_t min_mV = 0;
+  uint16_t max_mV = 0;
+  /** Index of the lowest and highest cell, the first one if several share the value */
+  uint16_t min_index = 0;
+  uint16_t max_index = 0;
+  /** Mean cell voltage, rounded to the nearest mV */
+  uint16_t mean_mV = 0;
+  /** Cells further from the mean than CELL_OUTLIER_SIGMAS and CELL_OUTLIER_MIN_DEVIATION_mV */
+  uint16_t outliers = 0;
+  /** Cells with their balancing resistor on */
+  uint16_t balancing = 0;
+};
+
+/** Computes the statistics over the first `count` cells */
+void compute_cell_statistics(const uint16_t* voltages_mV, const bool* balancing, uint16_t count,
+                             CellStatistics& statistics);
+
+#endif
@@ -3,14 +3,35 @@
 #include "../../datalayer/datalayer.h"
 #include "../../devboard/hal/hal.h"
 #include "../../devboard/utils/logging.h"
+#include "freertos/FreeRTOS.h"
+
+#include <atomic>
+
+#define EVENT_NOF_LEVELS (EVENT_LEVEL_UPDATE + 1)
+
+static_assert((EVENT_JOURNAL_SIZE & (EVENT_JOURNAL_SIZE - 1)) == 0, "EVENT_JOURNAL_SIZE must be a power of two");
 
 typedef struct {
   EVENTS_STRUCT_TYPE entries[EVENT_NOF_EVENTS];
   EVENTS_LEVEL_TYPE level;
+  uint8_t active_per_level[EVENT_NOF_LEVELS];  // Active and latched events of each level
 } EVENT_TYPE;
 
+// Events are set from both cores, and the journal is read from the connectivity
+// core. The sequence of a slot is 0 while its entry is written, so a reader can
+// tell a complete entry from one that is being written or was overwritten.
+// A state change, the level counts and the journal entry it adds are made under
+// events_lock, so two cores changing events at once cannot lose a count.
+typedef struct {
+  std::atomic<uint32_t> sequence;
+  EVENT_JOURNAL_ENTRY_TYPE entry;
+} EVENT_JOURNAL_SLOT_TYPE;
+
 /* Local variables */
 static EVENT_TYPE events;
+static EVENT_JOURNAL_SLOT_TYPE journal[EVENT_JOURNAL_SIZE];
+static std::atomic<uint32_t> journal_sequence{0};
+static portMUX_TYPE events_lock = portMUX_INITIALIZER_UNLOCKED;
 static const char* EVENTS_ENUM_TYPE_STRING[] = {EVENTS_ENUM_TYPE(GENERATE_STRING)};
 static const char* EVENTS_LEVEL_TYPE_STRING[] = {EVENTS_LEVEL_TYPE(GENERATE_STRING)};
 static const char* EMULATOR_STATUS_STRING[] = {EMULATOR_STATUS(GENERATE_STRING)};
@@ -19,6 +40,7 @@ static const char* EMULATOR_STATUS_STRING[] = {EMULATOR_STATUS(GENERATE_STRING)}
 static void set_event(EVENTS_ENUM_TYPE event, uint8_t data, bool latched);
 static void update_event_level(void);
 static void update_bms_status(void);
+static void add_to_journal(EVENTS_ENUM_TYPE event, bool active);
 
 /* Initialization function */
 void init_events(void) {
@@ -138,6 +160,17 @@ void init_events(void) {
   events.entries[EVENT_GPIO_CONFLICT].level = EVENT_LEVEL_ERROR;
   events.entries[EVENT_GPIO_NOT_DEFINED].level = EVENT_LEVEL_ERROR;
   events.entries[EVENT_BATTERY_TEMP_DEVIATION_HIGH].level = EVENT_LEVEL_WARNING;
+
+  // Count the events that were set before their level was known
+  for (uint8_t i = 0; i < EVENT_NOF_LEVELS; i++) {
+    events.active_per_level[i] = 0;
+  }
+  for (uint16_t i = 0; i < EVENT_NOF_EVENTS; i++) {
+    if ((events.entries[i].state == EVENT_STATE_ACTIVE) || (events.entries[i].state == EVENT_STATE_ACTIVE_LATCHED)) {
+      events.active_per_level[events.entries[i].level]++;
+    }
+  }
+  update_event_level();
 }
 
 void set_event(EVENTS_ENUM_TYPE event, uint8_t data) {
@@ -149,14 +182,19 @@ void set_event_latched(EVENTS_ENUM_TYPE event, uint8_t data) {
 }
 
 void clear_event(EVENTS_ENUM_TYPE event) {
+  portENTER_CRITICAL(&events_lock);
   if (events.entries[event].state == EVENT_STATE_ACTIVE) {
     events.entries[event].state = EVENT_STATE_INACTIVE;
+    events.active_per_level[events.entries[event].level]--;
+    add_to_journal(event, false);
     update_event_level();
     update_bms_status();
   }
+  portEXIT_CRITICAL(&events_lock);
 }
 
 void reset_all_events() {
+  portENTER_CRITICAL(&events_lock);
   for (uint16_t i = 0; i < EVENT_NOF_EVENTS; i++) {
     events.entries[i].data = 0;
     events.entries[i].state = EVENT_STATE_INACTIVE;
@@ -164,15 +202,21 @@ void reset_all_events() {
     events.entries[i].occurences = 0;
     events.entries[i].MQTTpublished = false;  // Not published by default
   }
+  for (uint8_t i = 0; i < EVENT_NOF_LEVELS; i++) {
+    events.active_per_level[i] = 0;
+  }
   events.level = EVENT_LEVEL_INFO;
   update_bms_status();
+  portEXIT_CRITICAL(&events_lock);
 }
 
 void set_event_MQTTpublished(EVENTS_ENUM_TYPE event) {
+  portENTER_CRITICAL(&events_lock);
   events.entries[event].MQTTpublished = true;
+  portEXIT_CRITICAL(&events_lock);
 }
 
-String get_event_message_string(EVENTS_ENUM_TYPE event) {
+const char* get_event_message(EVENTS_ENUM_TYPE event) {
   switch (event) {
     case EVENT_CANMCP2518FD_INIT_FAILURE:
       return "CAN-FD initialization failed. Check hardware or bitrate settings";
@@ -394,6 +438,20 @@ String get_event_message_string(EVENTS_ENUM_TYPE event) {
       return "BMS reset request completed successfully.";
     case EVENT_BMS_RESET_REQ_FAIL:
       return "BMS reset request failed - check contactors are open.";
+    case EVENT_GPIO_CONFLICT:
+      return "GPIO Pin Conflict: A pin is already allocated. Please check your configuration and assign different "
+             "pins.";
+    case EVENT_GPIO_NOT_DEFINED:
+      return "Missing GPIO Assignment: A component requires a GPIO pin that isn't configured. Please define a valid "
+             "pin number in your settings.";
+    default:
+      return "";
+  }
+}
+
+String get_event_message_string(EVENTS_ENUM_TYPE event) {
+  // Only the GPIO events need text that is not known at compile time
+  switch (event) {
     case EVENT_GPIO_CONFLICT:
       return "GPIO Pin Conflict: The pin used by '" + esp32hal->failed_allocator() + "' is already allocated by '" +
              esp32hal->conflicting_allocator() + "'. Please check your configuration and assign different pins.";
@@ -401,7 +459,7 @@ String get_event_message_string(EVENTS_ENUM_TYPE event) {
       return "Missing GPIO Assignment: The component '" + esp32hal->failed_allocator() +
              "' requires a GPIO pin that isn't configured. Please define a valid pin number in your settings.";
     default:
-      return "";
+      return get_event_message(event);
   }
 }
 
@@ -424,6 +482,38 @@ const EVENTS_STRUCT_TYPE* get_event_pointer(EVENTS_ENUM_TYPE event) {
   return &events.entries[event];
 }
 
+uint32_t get_event_journal_sequence(void) {
+  return journal_sequence.load(std::memory_order_acquire);
+}
+
+size_t read_event_journal(uint32_t since, EVENT_JOURNAL_ENTRY_TYPE* entries, size_t max_entries) {
+  uint32_t latest = journal_sequence.load(std::memory_order_acquire);
+  if (since > latest) {
+    since = 0;  // The reader saw the journal before a restart
+  }
+  if (latest - since > EVENT_JOURNAL_SIZE) {
+    since = latest - EVENT_JOURNAL_SIZE;  // The ones before were overwritten
+  }
+
+  size_t count = 0;
+  for (uint32_t sequence = since + 1; sequence <= latest && count < max_entries; sequence++) {
+    const EVENT_JOURNAL_SLOT_TYPE& slot = journal[sequence & (EVENT_JOURNAL_SIZE - 1)];
+    uint32_t slot_sequence = slot.sequence.load(std::memory_order_acquire);
+    if (slot_sequence == 0 || slot_sequence < sequence) {
+      break;  // Still being written, it is read the next time
+    }
+    if (slot_sequence != sequence) {
+      continue;  // Overwritten by a newer one
+    }
+    entries[count] = slot.entry;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) == sequence) {
+      count++;
+    }
+  }
+  return count;
+}
+
 EVENTS_LEVEL_TYPE get_event_level(void) {
   return events.level;
 }
@@ -457,12 +547,12 @@ static void set_event(EVENTS_ENUM_TYPE event, uint8_t data, bool latched) {
     event = EVENT_UNKNOWN_EVENT_SET;
   }
 
+  portENTER_CRITICAL(&events_lock);
   // If the event is already set, no reason to continue
-  if ((events.entries[event].state != EVENT_STATE_ACTIVE) &&
-      (events.entries[event].state != EVENT_STATE_ACTIVE_LATCHED)) {
+  bool newly_set = (events.entries[event].state != EVENT_STATE_ACTIVE) &&
+                   (events.entries[event].state != EVENT_STATE_ACTIVE_LATCHED);
+  if (newly_set) {
     events.entries[event].MQTTpublished = false;
-
-    DEBUG_PRINTF("Event: %s\n", get_event_message_string(event).c_str());
   }
 
   // We should set the event, update event info
@@ -472,10 +562,21 @@ static void set_event(EVENTS_ENUM_TYPE event, uint8_t data, bool latched) {
   // Check if the event is latching
   events.entries[event].state = latched ? EVENT_STATE_ACTIVE_LATCHED : EVENT_STATE_ACTIVE;
 
+  if (newly_set) {
+    events.active_per_level[events.entries[event].level]++;
+    add_to_journal(event, true);
+  }
+
   // Update event level, only upwards. Downward changes are done in Software.ino:loop()
   events.level = (EVENTS_LEVEL_TYPE)max(events.level, events.entries[event].level);
 
   update_bms_status();
+  portEXIT_CRITICAL(&events_lock);
+
+  // Logged outside the critical section, it may block on the serial port
+  if (newly_set) {
+    DEBUG_PRINTF("Event: %s\n", get_event_message(event));
+  }
 }
 
 static void update_bms_status(void) {
@@ -512,11 +613,22 @@ bool compareEventsByTimestampAsc(const EventData& a, const EventData& b) {
 }
 
 static void update_event_level(void) {
+  // Levels are in order of priority, the highest one with an active event is the system level
   EVENTS_LEVEL_TYPE temporary_level = EVENT_LEVEL_INFO;
-  for (uint8_t i = 0u; i < EVENT_NOF_EVENTS; i++) {
-    if ((events.entries[i].state == EVENT_STATE_ACTIVE) || (events.entries[i].state == EVENT_STATE_ACTIVE_LATCHED)) {
-      temporary_level = (EVENTS_LEVEL_TYPE)max(events.entries[i].level, temporary_level);
+  for (uint8_t i = EVENT_NOF_LEVELS - 1; i > EVENT_LEVEL_INFO; i--) {
+    if (events.active_per_level[i] > 0) {
+      temporary_level = (EVENTS_LEVEL_TYPE)i;
+      break;
     }
   }
   events.level = temporary_level;
 }
+
+static void add_to_journal(EVENTS_ENUM_TYPE event, bool active) {
+  uint32_t sequence = journal_sequence.fetch_add(1, std::memory_order_relaxed) + 1;
+  EVENT_JOURNAL_SLOT_TYPE& slot = journal[sequence & (EVENT_JOURNAL_SIZE - 1)];
+  slot.sequence.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.entry = {millis64(), sequence, event, events.entries[event].data, active};
+  slot.sequence.store(sequence, std::memory_order_release);
+}
@@ -2,6 +2,7 @@
 #define __EVENTS_H__
 
 #include <WString.h>
+#include <stddef.h>
 #include <stdint.h>
 #include "millis64.h"
 #include "types.h"
@@ -159,6 +160,20 @@ typedef struct {
   bool MQTTpublished;
 } EVENTS_STRUCT_TYPE;
 
+// A set or clear of an event, as kept in the event journal
+typedef struct {
+  uint64_t timestamp;      // millis64() of the transition
+  uint32_t sequence;       // Counts the transitions since startup, the first one is 1
+  EVENTS_ENUM_TYPE event;  // Event that was set or cleared
+  uint8_t data;            // Custom data the event was set with
+  bool active;             // Set, or cleared
+} EVENT_JOURNAL_ENTRY_TYPE;
+
+// Transitions the journal holds before the oldest are overwritten, a power of two
+#ifndef EVENT_JOURNAL_SIZE
+#define EVENT_JOURNAL_SIZE 64
+#endif
+
 // Define a struct to hold event data
 struct EventData {
   EVENTS_ENUM_TYPE event_handle;
@@ -166,6 +181,8 @@ struct EventData {
 };
 
 const char* get_event_enum_string(EVENTS_ENUM_TYPE event);
+// The message text, straight from flash. GPIO events leave out the pin owners, see get_event_message_string().
+const char* get_event_message(EVENTS_ENUM_TYPE event);
 String get_event_message_string(EVENTS_ENUM_TYPE event);
 const char* get_event_level_string(EVENTS_ENUM_TYPE event);
 const char* get_event_level_string(EVENTS_LEVEL_TYPE event_level);
@@ -183,6 +200,13 @@ void set_event_MQTTpublished(EVENTS_ENUM_TYPE event);
 
 const EVENTS_STRUCT_TYPE* get_event_pointer(EVENTS_ENUM_TYPE event);
 
+// Sequence number of the latest transition in the event journal, 0 if there was none
+uint32_t get_event_journal_sequence(void);
+// Copies the transitions after sequence `since`, oldest first, up to max_entries of them.
+// Returns how many were copied. Ones that were already overwritten are skipped, which
+// shows as a gap in the sequence numbers. A `since` from before a restart starts over.
+size_t read_event_journal(uint32_t since, EVENT_JOURNAL_ENTRY_TYPE* entries, size_t max_entries);
+
 bool compareEventsByTimestampAsc(const EventData& a, const EventData& b);
 bool compareEventsByTimestampDesc(const EventData& a, const EventData& b);
 
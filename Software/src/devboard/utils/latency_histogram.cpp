@@ -0,0 +1,72 @@
+#include "latency_histogram.h"
+
+int LatencyHistogram::bucket_index(uint32_t duration_us) {
+  if (duration_us < LINEAR_BUCKETS) {
+    return duration_us;
+  }
+  int power = 31 - __builtin_clz(duration_us);  // 3 or more
+  if (power >= MAX_POWER) {
+    return BUCKET_COUNT - 1;
+  }
+  int sub_bucket = (duration_us >> (power - SUB_BUCKET_BITS)) & ((1 << SUB_BUCKET_BITS) - 1);
+  return LINEAR_BUCKETS + ((power - 3) << SUB_BUCKET_BITS) + sub_bucket;
+}
+
+uint32_t LatencyHistogram::bucket_upper_bound(int index) {
+  if (index < LINEAR_BUCKETS) {
+    return index;
+  }
+  int power = 3 + ((index - LINEAR_BUCKETS) >> SUB_BUCKET_BITS);
+  int sub_bucket = (index - LINEAR_BUCKETS) & ((1 << SUB_BUCKET_BITS) - 1);
+  uint32_t width = 1UL << (power - SUB_BUCKET_BITS);
+  uint32_t lower = (uint32_t)((1 << SUB_BUCKET_BITS) + sub_bucket) * width;
+  return lower + width - 1;
+}
+
+void LatencyHistogram::record(int64_t duration_us) {
+  uint32_t value = duration_us < 0 ? 0 : (duration_us > UINT32_MAX ? UINT32_MAX : (uint32_t)duration_us);
+  counts[bucket_index(value)]++;
+  total++;
+  if (value > maximum) {
+    maximum = value;
+  }
+}
+
+void LatencyHistogram::reset() {
+  for (int i = 0; i < BUCKET_COUNT; i++) {
+    counts[i] = 0;
+  }
+  total = 0;
+  maximum = 0;
+}
+
+uint32_t LatencyHistogram::percentile_us(uint8_t percentile) const {
+  if (total == 0) {
+    return 0;
+  }
+  // Rank of the sample we are looking for, rounded up
+  uint64_t rank = ((uint64_t)total * percentile + 99) / 100;
+  if (rank == 0) {
+    rank = 1;
+  }
+
+  uint64_t seen = 0;
+  for (int i = 0; i < BUCKET_COUNT; i++) {
+    seen += counts[i];
+    if (seen >= rank) {
+      uint32_t bound = bucket_upper_bound(i);
+      return bound < maximum ? bound : maximum;
+    }
+  }
+  return maximum;
+}
+
+LatencySummary LatencyHistogram::summary() const {
+  LatencySummary result;
+  result.samples = total;
+  result.p50_us = percentile_us(50);
+  result.p95_us = percentile_us(95);
+  result.p99_us = percentile_us(99);
+  result.max_us = maximum;
+  return result;
+}
@@ -0,0 +1,50 @@
+#ifndef _LATENCY_HISTOGRAM_H_
+#define _LATENCY_HISTOGRAM_H_
+
+#include <stdint.h>
+
+/** Summary of a latency histogram, as shown on the webserver and published over MQTT */
+struct LatencySummary {
+  uint32_t samples = 0;
+  uint32_t p50_us = 0;
+  uint32_t p95_us = 0;
+  uint32_t p99_us = 0;
+  uint32_t max_us = 0;
+};
+
+/** Fixed-size, log-scale histogram of durations in microseconds.
+ *
+ * Values below 8 us get a bucket each, above that every power of two is split
+ * into four buckets, so a percentile is never off by more than 25 %.
+ * Recording is a handful of instructions and never allocates, so it can be
+ * used from the core task every millisecond. Durations of 16 s and more end
+ * up in the last bucket (the exact maximum is still tracked).
+ */
+class LatencyHistogram {
+ public:
+  static const int SUB_BUCKET_BITS = 2;
+  static const int LINEAR_BUCKETS = 8;
+  static const int MAX_POWER = 24;  // 2^24 us = 16.7 s
+  static const int BUCKET_COUNT = LINEAR_BUCKETS + (MAX_POWER - 3) * (1 << SUB_BUCKET_BITS);
+
+  void record(int64_t duration_us);
+  void reset();
+
+  uint32_t samples() const { return total; }
+  uint32_t max_us() const { return maximum; }
+
+  /** Returns the upper bound of the bucket holding the given percentile (0-100) */
+  uint32_t percentile_us(uint8_t percentile) const;
+
+  LatencySummary summary() const;
+
+  static int bucket_index(uint32_t duration_us);
+  static uint32_t bucket_upper_bound(int index);
+
+ private:
+  uint32_t counts[BUCKET_COUNT] = {0};
+  uint32_t total = 0;
+  uint32_t maximum = 0;
+};
+
+#endif
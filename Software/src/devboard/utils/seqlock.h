@@ -0,0 +1,63 @@
+#ifndef _SEQLOCK_H_
+#define _SEQLOCK_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <type_traits>
+
+// Hands a value from one writer task to readers on other tasks or cores without
+// ever making the writer wait. The writer makes the sequence odd while it changes
+// the value and even again when done. A reader copies the value out and tries
+// again if the sequence was odd or moved while it copied, so it never sees half
+// of an update. Readers retry only while the writer is in the middle of a write,
+// which is why the writer must not be preempted by a reader on its own core.
+//
+// The version counts the completed writes, starting at 0.
+template <typename T>
+class Seqlock {
+  static_assert(std::is_trivially_copyable<T>::value, "Seqlock values are copied with memcpy");
+
+ public:
+  // Writer side. The value may only be changed between begin_write() and end_write().
+  T& begin_write() {
+    sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    return value;
+  }
+
+  void end_write() { sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+  // Writer side, the value as last written. Only the writer may look at it without read().
+  const T& written() const { return value; }
+
+  uint32_t version() const { return sequence.load(std::memory_order_acquire) / 2; }
+
+  // Reader side. Copies the value and returns its version.
+  uint32_t read(T& copy) const {
+    return read_part([&copy](const T& value) { memcpy((void*)&copy, (const void*)&value, sizeof(T)); });
+  }
+
+  // Reader side, for readers that need only a part of a large value. copy_part(value)
+  // copies that part out, and is called again when the writer changed the value meanwhile.
+  template <typename F>
+  uint32_t read_part(F copy_part) const {
+    while (true) {
+      uint32_t before = sequence.load(std::memory_order_acquire);
+      if (before & 1) {
+        continue;
+      }
+      copy_part(value);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (sequence.load(std::memory_order_relaxed) == before) {
+        return before / 2;
+      }
+    }
+  }
+
+ private:
+  std::atomic<uint32_t> sequence{0};
+  T value{};
+};
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef _SPSC_QUEUE_H_
+#define _SPSC_QUEUE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+// Lock-free queue for exactly one producer task and one consumer task, which
+// may run on different cores. The producer only writes head and the consumer
+// only writes tail; the release/acquire pair on these indices makes sure an
+// item is completely written before the other side can see it.
+// N must be a power of two. push() never blocks and fails when the queue is full.
+template <typename T, size_t N>
+class SpscQueue {
+  static_assert(N > 0 && (N & (N - 1)) == 0, "SpscQueue size must be a power of two");
+
+ public:
+  // Producer side
+  bool push(const T& item) {
+    uint32_t current_head = head.load(std::memory_order_relaxed);
+    if (current_head - tail.load(std::memory_order_acquire) == N) {
+      dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      return false;
+    }
+    items[current_head & (N - 1)] = item;
+    head.store(current_head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side
+  bool pop(T& item) {
+    uint32_t current_tail = tail.load(std::memory_order_relaxed);
+    if (current_tail == head.load(std::memory_order_acquire)) {
+      return false;
+    }
+    item = items[current_tail & (N - 1)];
+    tail.store(current_tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  size_t size() const { return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire); }
+  bool empty() const { return size() == 0; }
+  static constexpr size_t capacity() { return N; }
+
+  // Items rejected because the queue was full. Only written by the producer.
+  uint32_t dropped_count() const { return dropped.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<uint32_t> head{0};
+  std::atomic<uint32_t> tail{0};
+  std::atomic<uint32_t> dropped{0};
+  T items[N];
+};
+
+#endif
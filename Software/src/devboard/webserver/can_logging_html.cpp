@@ -6,8 +6,7 @@
 
 String can_logger_processor(void) {
   if (!datalayer.system.info.can_logging_active) {
-    datalayer.system.info.logged_can_messages_offset = 0;
-    datalayer.system.info.logged_can_messages[0] = '\0';
+    clear_logged_can_messages();
   }
   datalayer.system.info.can_logging_active =
       true;  // Signal to main loop that we should log messages. Disabled by default for performance reasons
@@ -30,6 +29,7 @@ String can_logger_processor(void) {
   content += "<h3>CAN Logger Configuration</h3>";
   content += "<div class='config-item'><span>CAN ID Cutoff Filter: " + String(user_selected_CAN_ID_cutoff_filter) +
              "</span> <button onclick='editCANIDCutoff()'>Edit</button></div>";
+  content += "<div class='config-item'><span>Frames dropped: " + String(logged_can_frames_dropped()) + "</span></div>";
   content += "<button onclick='refreshPage()'>Refresh data</button> ";
   content += "<button onclick='exportLog()'>Export to .txt</button> ";
 #ifdef LOG_CAN_TO_SD
@@ -42,11 +42,11 @@ String can_logger_processor(void) {
   content += "<div style='background-color: #303E47; padding: 20px; border-radius: 15px'>";
 
   // Check for messages
-  if (datalayer.system.info.logged_can_messages[0] == 0) {
+  String messages = copy_logged_can_messages();
+  if (messages.length() == 0) {
     content += "CAN logger started! Refresh page to display incoming(RX) and outgoing(TX) messages";
   } else {
     // Split the messages using the newline character
-    String messages = String(datalayer.system.info.logged_can_messages);
     int startIndex = 0;
     int endIndex = messages.indexOf('\n');
     while (endIndex != -1) {
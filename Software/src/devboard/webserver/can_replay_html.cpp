@@ -1,16 +1,16 @@
 #include "can_replay_html.h"
 #include <Arduino.h>
+#include "../../communication/can/comm_can.h"
 #include "../../datalayer/datalayer.h"
 #include "index_html.h"
 
-String can_replay_processor(void) {
+void can_replay_processor(HtmlWriter& content) {
   if (!datalayer.system.info.can_logging_active) {
-    datalayer.system.info.logged_can_messages_offset = 0;
-    datalayer.system.info.logged_can_messages[0] = '\0';
+    clear_logged_can_messages();
   }
   datalayer.system.info.can_logging_active =
       true;  // Signal to main loop that we should log messages. Disabled by default for performance reasons
-  String content = index_html_header;
+  content += index_html_header;
   // Page format
   content += "<style>";
   content += "body { background-color: black; color: white; font-family: Arial, sans-serif; }";
@@ -33,16 +33,15 @@ String can_replay_processor(void) {
   // Dropdown with choices
   content += "<label for='canInterface'>CAN Interface:</label>";
   content += "<select id='canInterface' name='canInterface'>";
-  content += "<option value='" + String(CAN_NATIVE) + "' " +
-             (datalayer.system.info.can_replay_interface == CAN_NATIVE ? "selected" : "") + ">CAN Native</option>";
-  content += "<option value='" + String(CANFD_NATIVE) + "' " +
-             (datalayer.system.info.can_replay_interface == CANFD_NATIVE ? "selected" : "") + ">CANFD Native</option>";
-  content += "<option value='" + String(CAN_ADDON_MCP2515) + "' " +
-             (datalayer.system.info.can_replay_interface == CAN_ADDON_MCP2515 ? "selected" : "") +
-             ">CAN Addon MCP2515</option>";
-  content += "<option value='" + String(CANFD_ADDON_MCP2518) + "' " +
-             (datalayer.system.info.can_replay_interface == CANFD_ADDON_MCP2518 ? "selected" : "") +
-             ">CANFD Addon MCP2518</option>";
+  const char* selected[] = {"", "selected"};
+  content.printf("<option value='%d' %s>CAN Native</option>", CAN_NATIVE,
+                 selected[datalayer.system.info.can_replay_interface == CAN_NATIVE]);
+  content.printf("<option value='%d' %s>CANFD Native</option>", CANFD_NATIVE,
+                 selected[datalayer.system.info.can_replay_interface == CANFD_NATIVE]);
+  content.printf("<option value='%d' %s>CAN Addon MCP2515</option>", CAN_ADDON_MCP2515,
+                 selected[datalayer.system.info.can_replay_interface == CAN_ADDON_MCP2515]);
+  content.printf("<option value='%d' %s>CANFD Addon MCP2518</option>", CANFD_ADDON_MCP2518,
+                 selected[datalayer.system.info.can_replay_interface == CANFD_ADDON_MCP2518]);
 
   content += "</select>";
 
@@ -51,8 +50,10 @@ String can_replay_processor(void) {
   content += "<button onclick='sendCANSelection()'>Apply</button>";
 
   content += "<h3>Step 2: Upload CAN Log File</h3>";
-  content += "<p>Click Browse to select a .txt CANdump log file to upload</p>";
-  content += "<input type='file' id='file-input' accept='.txt'>";
+  content +=
+      "<p>Click Browse to select a .txt CANdump log file, or a .bin log from the SD card, to upload. Large logs "
+      "need an SD card in the board.</p>";
+  content += "<input type='file' id='file-input' accept='.txt,.log,.bin'>";
   content += "<button id='upload-btn'>Upload</button>";
 
   content += "<h3>Step 3: Playback control</h3>";
@@ -60,6 +61,17 @@ String can_replay_processor(void) {
   //Checkbox to see if the user wants the log to repeat once it reaches the end
   content += "<input type=\"checkbox\" id=\"loopCheckbox\"> Loop ";
 
+  // Playback speed relative to the timestamps of the log
+  content += "<label for='speedSelect'>Speed:</label> ";
+  content += "<select id='speedSelect'>";
+  content += "<option value='25'>0.25x</option>";
+  content += "<option value='50'>0.5x</option>";
+  content += "<option value='100' selected>1x</option>";
+  content += "<option value='200'>2x</option>";
+  content += "<option value='500'>5x</option>";
+  content += "<option value='1000'>10x</option>";
+  content += "</select> ";
+
   // Add a button to start playing the log
   content += "<button onclick='startReplay()'>Start</button> ";
 
@@ -69,7 +81,7 @@ String can_replay_processor(void) {
   // Status indicator
   content += "<span id='statusIndicator' style='margin-left:10px; font-weight:bold;'>Stopped</span> ";
 
-  content += "<h3>Uploaded Log Preview:</h3>";
+  content += "<h3>Uploaded Log Preview (start of the file):</h3>";
   content += "<pre id='file-content'></pre>";
 
   content += "<script>";
@@ -87,9 +99,10 @@ String can_replay_processor(void) {
   content += "const xhr = new XMLHttpRequest();";
   content += "xhr.open('POST', '/import_can_log', true);";
   content +=
-      "xhr.onload = () => { if (xhr.status === 200) { alert('File uploaded successfully!'); const reader = new "
-      "FileReader(); reader.onload = function (e) { fileContent.textContent = e.target.result; }; "
-      "reader.readAsText(selectedFile); } else { alert('Upload failed! Server error.'); }};";
+      "xhr.onload = () => { if (xhr.status === 200) { alert(xhr.responseText); fileContent.textContent = ''; "
+      "if (!selectedFile.name.endsWith('.bin')) { const reader = new FileReader(); reader.onload = function (e) { "
+      "fileContent.textContent = e.target.result; }; reader.readAsText(selectedFile.slice(0, 65536)); } } else { "
+      "alert('Upload failed! ' + xhr.responseText); }};";
   content += "xhr.send(formData);";
   content += "});";
   content += "</script>";
@@ -100,8 +113,9 @@ String can_replay_processor(void) {
   content += "<script>";
   content += "function startReplay() {";
   content += "  let loop = document.getElementById('loopCheckbox').checked ? 1 : 0;";
-  content += "  fetch('/startReplay?loop=' + loop, { method: 'GET' })";
-  content += "    .then(response => response.text())";
+  content += "  let speed = document.getElementById('speedSelect').value;";
+  content += "  fetch('/startReplay?loop=' + loop + '&speed=' + speed, { method: 'GET' })";
+  content += "    .then(response => response.ok ? response.text() : response.text().then(text => { throw text; }))";
   content += "    .then(data => {";
   content += "      console.log(data);";
   content += "      document.getElementById('statusIndicator').innerText = 'Running...';";
@@ -113,7 +127,7 @@ String can_replay_processor(void) {
   content += "        }, 5000);";  // 5-second timeout before reverting the text
   content += "      }";
   content += "    })";
-  content += "    .catch(error => console.error('Error:', error));";
+  content += "    .catch(error => alert('Error: ' + error));";
   content += "}";
   content += "function stopReplay() {";
   content += "  fetch('/stopReplay', { method: 'GET' })";
@@ -143,5 +157,4 @@ String can_replay_processor(void) {
   content += "function home() { window.location.href = '/'; }";
   content += "</script>";
   content += index_html_footer;
-  return content;
 }
@@ -1,16 +1,13 @@
 #ifndef CANREPLAY_H
 #define CANREPLAY_H
 
-#include <Arduino.h>
-#include <string>
+#include "html_writer.h"
 
 /**
- * @brief Replaces placeholder with content section in web page
+ * @brief Renders the CAN replay web page
  *
- * @param[in] var
- *
- * @return String
+ * @param[in] content
  */
-String can_replay_processor(void);
+void can_replay_processor(HtmlWriter& content);
 
 #endif
@@ -1,15 +1,13 @@
 #ifndef CELLMONITOR_H
 #define CELLMONITOR_H
 
-#include <WString.h>
+#include "html_writer.h"
 
 /**
- * @brief Replaces placeholder with content section in web page
+ * @brief Renders the cell monitor section of the web page
  *
- * @param[in] var
- *
- * @return String
+ * @param[in] content
  */
-String cellmonitor_processor(const String& var);
+void cellmonitor_processor(HtmlWriter& content);
 
 #endif
@@ -94,6 +94,29 @@ String events_processor(const String& var) {
   return String();
 }
 
+String event_journal_json(uint32_t since) {
+  static EVENT_JOURNAL_ENTRY_TYPE entries[EVENT_JOURNAL_SIZE];
+  size_t count = read_event_journal(since, entries, EVENT_JOURNAL_SIZE);
+  // Where the next request carries on, an entry that was still being written comes with it
+  uint32_t sequence = (count > 0) ? entries[count - 1].sequence : std::min(since, get_event_journal_sequence());
+
+  String content = "";
+  content.reserve(64 + count * 112);
+  content.concat("{\"seq\":" + String(sequence) + ",\"now\":" + String(millis64()) + ",\"events\":[");
+  for (size_t i = 0; i < count; i++) {
+    const EVENT_JOURNAL_ENTRY_TYPE& entry = entries[i];
+    content.concat(i > 0 ? ",{" : "{");
+    content.concat("\"seq\":" + String(entry.sequence));
+    content.concat(",\"event\":\"" + String(get_event_enum_string(entry.event)) + "\"");
+    content.concat(",\"level\":\"" + String(get_event_level_string(entry.event)) + "\"");
+    content.concat(",\"active\":" + String(entry.active ? 1 : 0));
+    content.concat(",\"data\":" + String(entry.data));
+    content.concat(",\"millis\":" + String(entry.timestamp) + "}");
+  }
+  content.concat("]}");
+  return content;
+}
+
 /* Script for displaying event log before it gets minified
 <button onclick="askClear()">Clear all events</button>
 <button onclick="home()">Back to main page</button>
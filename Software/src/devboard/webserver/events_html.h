@@ -15,4 +15,13 @@
  */
 String events_processor(const String& var);
 
+/**
+ * @brief Event journal entries after sequence `since` as JSON, for pages and tools that poll for new events
+ *
+ * @param[in] since, the "seq" of the previous answer, 0 for all the journal holds
+ *
+ * @return String
+ */
+String event_journal_json(uint32_t since);
+
 #endif
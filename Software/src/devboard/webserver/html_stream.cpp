@@ -0,0 +1,129 @@
+#include "html_stream.h"
+#include <Arduino.h>
+#include <atomic>
+#include <memory>
+#include "../../system_settings.h"
+#include "../hal/hal.h"
+#include "../utils/logging.h"
+#include "freertos/stream_buffer.h"
+#include "index_html.h"
+
+// A client that takes no data for this long is given up on, the rest of the page is thrown away
+#define HTML_STREAM_SEND_TIMEOUT_MS 5000
+#define HTML_STREAM_SEND_POLL_MS 100
+
+struct HtmlStreamJob {
+  HtmlRenderer render;
+  StreamBufferHandle_t buffer = NULL;
+  uint32_t free_heap_at_request = 0;
+  std::atomic<bool> done{false};
+
+  ~HtmlStreamJob() {
+    if (buffer) {
+      vStreamBufferDelete(buffer);
+    }
+  }
+};
+
+typedef std::shared_ptr<HtmlStreamJob> HtmlStreamJobPtr;
+
+static QueueHandle_t render_queue = NULL;
+static HtmlStreamStats stats;
+
+// Passes the rendered page on to the stream buffer, waiting while the client catches up
+class StreamBufferSink : public HtmlSink {
+ public:
+  explicit StreamBufferSink(const HtmlStreamJobPtr& job) : job(job), min_free_heap(job->free_heap_at_request) {}
+
+  void write(const char* data, size_t length) override {
+    min_free_heap = min(min_free_heap, (uint32_t)ESP.getFreeHeap());
+    uint32_t waited_ms = 0;
+    while (length > 0 && !client_gone) {
+      // The response holds the other reference, it is gone once the connection closes
+      if (job.use_count() == 1 || waited_ms >= HTML_STREAM_SEND_TIMEOUT_MS) {
+        client_gone = true;
+        break;
+      }
+      size_t sent = xStreamBufferSend(job->buffer, data, length, pdMS_TO_TICKS(HTML_STREAM_SEND_POLL_MS));
+      waited_ms = (sent > 0) ? 0 : waited_ms + HTML_STREAM_SEND_POLL_MS;
+      data += sent;
+      length -= sent;
+    }
+  }
+
+  const HtmlStreamJobPtr& job;
+  uint32_t min_free_heap;
+  bool client_gone = false;
+};
+
+static void html_render_task(void* param) {
+  HtmlStreamJobPtr* queued;
+  while (true) {
+    if (xQueueReceive(render_queue, &queued, portMAX_DELAY) != pdTRUE) {
+      continue;
+    }
+    HtmlStreamJobPtr job = std::move(*queued);
+    delete queued;
+
+    StreamBufferSink sink(job);
+    {
+      HtmlWriter content(sink);
+      job->render(content);
+    }
+    job->done = true;
+
+    stats.pages++;
+    if (sink.client_gone) {
+      stats.aborted++;
+    }
+    uint32_t heap_used = job->free_heap_at_request - sink.min_free_heap;
+    uint32_t peak = stats.heap_peak_bytes.load();
+    while (heap_used > peak && !stats.heap_peak_bytes.compare_exchange_weak(peak, heap_used)) {
+    }
+  }
+}
+
+void send_html_stream(AsyncWebServerRequest* request, HtmlRenderer render) {
+  if (render_queue == NULL) {
+    render_queue = xQueueCreate(HTML_STREAM_QUEUE_LENGTH, sizeof(HtmlStreamJobPtr*));
+    xTaskCreatePinnedToCore(html_render_task, "html_render", 8192, NULL, TASK_HTML_RENDER_PRIO, NULL, WIFI_CORE);
+  }
+
+  uint32_t free_heap = ESP.getFreeHeap();
+  HtmlStreamJobPtr job = std::make_shared<HtmlStreamJob>();
+  job->render = render;
+  job->buffer = xStreamBufferCreate(HTML_STREAM_BUFFER_SIZE, 1);
+  job->free_heap_at_request = free_heap;
+
+  HtmlStreamJobPtr* queued = new HtmlStreamJobPtr(job);
+  if (job->buffer == NULL || xQueueSend(render_queue, &queued, 0) != pdTRUE) {
+    delete queued;
+    stats.rejected++;
+    request->send(503, "text/plain", "Busy, try again");
+    return;
+  }
+
+  // Runs on the async_tcp task, which serves every connection, so it must never block. While the
+  // render task has nothing new, the response is retried on the next ack or poll of the connection.
+  request->send(request->beginChunkedResponse("text/html", [job](uint8_t* data, size_t max_length, size_t) {
+    bool done = job->done;  // Read before the buffer, so the end of the page is not missed
+    size_t length = xStreamBufferReceive(job->buffer, data, max_length, 0);
+    if (length > 0 || done) {
+      return length;  // 0 ends the response
+    }
+    return (size_t)RESPONSE_TRY_AGAIN;
+  }));
+}
+
+void send_html_page(AsyncWebServerRequest* request, HtmlRenderer render_body) {
+  send_html_stream(request, [render_body](HtmlWriter& content) {
+    content += index_html_header;
+    content += COMMON_JAVASCRIPT;
+    render_body(content);
+    content += index_html_footer;
+  });
+}
+
+const HtmlStreamStats& html_stream_stats() {
+  return stats;
+}
@@ -0,0 +1,39 @@
+#ifndef _HTML_STREAM_H_
+#define _HTML_STREAM_H_
+
+#include <atomic>
+#include <functional>
+#include "../../lib/ESP32Async-ESPAsyncWebServer/src/ESPAsyncWebServer.h"
+#include "html_writer.h"
+
+// Buffer between the render task and the webserver. The most of a page held in RAM at once.
+#ifndef HTML_STREAM_BUFFER_SIZE
+#define HTML_STREAM_BUFFER_SIZE 2048
+#endif
+
+// Pages waiting for the render task, further requests are answered with 503
+#ifndef HTML_STREAM_QUEUE_LENGTH
+#define HTML_STREAM_QUEUE_LENGTH 4
+#endif
+
+typedef std::function<void(HtmlWriter& content)> HtmlRenderer;
+
+// Send a page as a chunked response. The page is rendered by a task of its own into
+// a stream buffer that the webserver empties as the client takes the data, so the
+// heap a request needs is bounded by HTML_STREAM_BUFFER_SIZE, whatever the page size.
+void send_html_stream(AsyncWebServerRequest* request, HtmlRenderer render);
+
+// Same, with the body wrapped in the header, common script and footer of index_html
+void send_html_page(AsyncWebServerRequest* request, HtmlRenderer render_body);
+
+// Updated from both the render task and the async_tcp task
+struct HtmlStreamStats {
+  std::atomic<uint32_t> pages{0};            // Pages rendered
+  std::atomic<uint32_t> aborted{0};          // Pages the client went away from before the end
+  std::atomic<uint32_t> rejected{0};         // Requests turned away because the render queue was full
+  std::atomic<uint32_t> heap_peak_bytes{0};  // Most heap used from request until the page was rendered
+};
+
+const HtmlStreamStats& html_stream_stats();
+
+#endif
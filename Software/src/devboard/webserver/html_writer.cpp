@@ -0,0 +1,38 @@
+#include "html_writer.h"
+#include <stdarg.h>
+#include <stdio.h>
+
+HtmlWriter& HtmlWriter::printf(const char* format, ...) {
+  char formatted[HTML_FORMAT_BUFFER_SIZE];
+  va_list args;
+  va_start(args, format);
+  int length = vsnprintf(formatted, sizeof(formatted), format, args);
+  va_end(args);
+  if (length > 0) {
+    write(formatted, ((size_t)length < sizeof(formatted)) ? length : sizeof(formatted) - 1);
+  }
+  return *this;
+}
+
+void HtmlWriter::write(const char* data, size_t length) {
+  written += length;
+  if (used + length <= sizeof(buffer)) {
+    memcpy(buffer + used, data, length);
+    used += length;
+    return;
+  }
+  flush();
+  if (length >= sizeof(buffer)) {
+    sink.write(data, length);
+  } else {
+    memcpy(buffer, data, length);
+    used = length;
+  }
+}
+
+void HtmlWriter::flush() {
+  if (used > 0) {
+    sink.write(buffer, used);
+    used = 0;
+  }
+}
@@ -0,0 +1,77 @@
+#ifndef _HTML_WRITER_H_
+#define _HTML_WRITER_H_
+
+#include <WString.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Small writes are gathered into this many bytes before they are handed on
+#ifndef HTML_WRITER_BUFFER_SIZE
+#define HTML_WRITER_BUFFER_SIZE 256
+#endif
+
+// Longest text formatted by HtmlWriter::printf, longer output is cut off
+#ifndef HTML_FORMAT_BUFFER_SIZE
+#define HTML_FORMAT_BUFFER_SIZE 128
+#endif
+
+// Where a rendered page goes, a piece at a time
+class HtmlSink {
+ public:
+  virtual ~HtmlSink() = default;
+  virtual void write(const char* data, size_t length) = 0;
+};
+
+// Renders a page with the same `content += ...` calls that used to build it in a
+// String, but hands it on in pieces as it goes, so the page never has to fit in
+// RAM. Text longer than the buffer, such as style sheets and scripts, goes to the
+// sink straight from flash. Dynamic values are formatted with printf() into a
+// fixed buffer on the stack.
+class HtmlWriter {
+ public:
+  explicit HtmlWriter(HtmlSink& sink) : sink(sink) {}
+  ~HtmlWriter() { flush(); }
+
+  HtmlWriter(const HtmlWriter&) = delete;
+  HtmlWriter& operator=(const HtmlWriter&) = delete;
+
+  HtmlWriter& operator+=(const char* text) {
+    write(text, strlen(text));
+    return *this;
+  }
+  HtmlWriter& operator+=(const String& text) {
+    write(text.c_str(), text.length());
+    return *this;
+  }
+  HtmlWriter& operator+=(char c) {
+    write(&c, 1);
+    return *this;
+  }
+  // String would have turned these into digits, here they have to go through printf()
+  HtmlWriter& operator+=(int) = delete;
+  HtmlWriter& operator+=(unsigned int) = delete;
+  HtmlWriter& operator+=(long) = delete;
+  HtmlWriter& operator+=(unsigned long) = delete;
+  HtmlWriter& operator+=(long long) = delete;
+  HtmlWriter& operator+=(unsigned long long) = delete;
+  HtmlWriter& operator+=(float) = delete;
+  HtmlWriter& operator+=(double) = delete;
+
+  HtmlWriter& printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+  void write(const char* data, size_t length);
+  // Hand on what is buffered, done by the destructor at the end of the page
+  void flush();
+
+  // Bytes written so far
+  size_t length() const { return written; }
+
+ private:
+  HtmlSink& sink;
+  char buffer[HTML_WRITER_BUFFER_SIZE];
+  size_t used = 0;
+  size_t written = 0;
+};
+
+#endif
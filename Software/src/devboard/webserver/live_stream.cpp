@@ -0,0 +1,123 @@
+#include "live_stream.h"
+#include <Arduino.h>
+#include <memory>
+#include <new>
+#include "../../battery/BATTERIES.h"
+#include "../utils/logging.h"
+#include "live_telemetry.h"
+
+// A comment is sent when nothing changed for this long, so the connection is not taken for dead
+#define LIVE_STREAM_HEARTBEAT_MS 15000
+
+// Everything here runs in the webserver task, the fillers of all clients share one sample
+static LiveTelemetry telemetry;
+static DataLayerSnapshot snapshot;
+static uint32_t snapshot_version = 0;
+static unsigned long last_sample_ms = 0;
+static uint8_t clients = 0;
+
+struct LiveStreamClient {
+  LiveStreamClient() { clients++; }
+  ~LiveStreamClient() { clients--; }
+
+  LiveCellEncoding cells = LiveCellEncoding::Json;
+  uint32_t seq = 0;
+  unsigned long last_message_ms = 0;
+  size_t length = 0;
+  size_t offset = 0;
+  char message[LIVE_TELEMETRY_MESSAGE_SIZE];
+};
+
+// Writes one message into the buffer of a client, remembering if it did not fit
+class MessageSink : public HtmlSink {
+ public:
+  explicit MessageSink(LiveStreamClient& client) : client(client) {}
+
+  void write(const char* data, size_t length) override {
+    if (client.length + length > sizeof(client.message)) {
+      overflow = true;
+      return;
+    }
+    memcpy(client.message + client.length, data, length);
+    client.length += length;
+  }
+
+  LiveStreamClient& client;
+  bool overflow = false;
+};
+
+static void sample_when_due() {
+  unsigned long now = millis();
+  if (telemetry.sequence() != 0 && now - last_sample_ms < LIVE_TELEMETRY_INTERVAL_MS) {
+    return;
+  }
+  last_sample_ms = now;
+  if (telemetry.sequence() != 0 && !datalayer_changed_since(snapshot_version)) {
+    return;
+  }
+  snapshot_version = read_datalayer_snapshot(snapshot);
+  telemetry.sample(snapshot, 1 + (battery2 ? 1 : 0) + (battery3 ? 1 : 0));
+}
+
+// Fills the buffer of the client with the next event, or a heartbeat. Returns false if the message does not fit.
+static bool next_message(LiveStreamClient& client) {
+  sample_when_due();
+  client.length = 0;
+  client.offset = 0;
+  unsigned long now = millis();
+
+  if (telemetry.sequence() != client.seq) {
+    MessageSink sink(client);
+    {
+      HtmlWriter out(sink);
+      out += "data: ";
+      telemetry.write_update(client.seq, client.cells, out);
+      out += "\n\n";
+    }
+    if (sink.overflow) {
+      logging.println("Live telemetry message too large, raise LIVE_TELEMETRY_MESSAGE_SIZE");
+      return false;
+    }
+    client.seq = telemetry.sequence();
+    client.last_message_ms = now;
+  } else if (now - client.last_message_ms >= LIVE_STREAM_HEARTBEAT_MS) {
+    static const char heartbeat[] = ":\n\n";
+    memcpy(client.message, heartbeat, sizeof(heartbeat) - 1);
+    client.length = sizeof(heartbeat) - 1;
+    client.last_message_ms = now;
+  }
+  return true;
+}
+
+void send_live_telemetry(AsyncWebServerRequest* request) {
+  if (clients >= LIVE_TELEMETRY_MAX_CLIENTS) {
+    request->send(503, "text/plain", "Too many live data clients");
+    return;
+  }
+  std::shared_ptr<LiveStreamClient> client(new (std::nothrow) LiveStreamClient());
+  if (!client) {
+    request->send(503, "text/plain", "Out of memory");
+    return;
+  }
+  if (request->hasParam("cells") && request->getParam("cells")->value() == "packed") {
+    client->cells = LiveCellEncoding::Packed;
+  }
+
+  AsyncWebServerResponse* response =
+      request->beginChunkedResponse("text/event-stream", [client](uint8_t* data, size_t max_length, size_t) {
+        if (client->offset == client->length) {
+          if (!next_message(*client)) {
+            return (size_t)0;  // Ends the stream
+          }
+          if (client->length == 0) {
+            return (size_t)RESPONSE_TRY_AGAIN;
+          }
+        }
+        size_t length = min(max_length, client->length - client->offset);
+        memcpy(data, client->message + client->offset, length);
+        client->offset += length;
+        return length;
+      });
+  response->addHeader("Cache-Control", "no-cache");
+  request->send(response);
+}
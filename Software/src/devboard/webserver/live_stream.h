@@ -0,0 +1,20 @@
+#ifndef _LIVE_STREAM_H_
+#define _LIVE_STREAM_H_
+
+#include "../../lib/ESP32Async-ESPAsyncWebServer/src/ESPAsyncWebServer.h"
+
+// How often the datalayer is looked at for changes while anyone is listening
+#ifndef LIVE_TELEMETRY_INTERVAL_MS
+#define LIVE_TELEMETRY_INTERVAL_MS 1000
+#endif
+
+// Dashboards that can listen at once, each holds a message buffer, further ones get 503
+#ifndef LIVE_TELEMETRY_MAX_CLIENTS
+#define LIVE_TELEMETRY_MAX_CLIENTS 3
+#endif
+
+// Answer with a server-sent event stream of the live data, see LiveTelemetry for the
+// messages. `?cells=packed` sends the cell voltages base64 encoded instead of as JSON.
+void send_live_telemetry(AsyncWebServerRequest* request);
+
+#endif
@@ -0,0 +1,293 @@
+#include "live_telemetry.h"
+#include <math.h>
+
+struct LiveSystemField {
+  const char* name;
+  int32_t (*read)(const DataLayerSnapshot& snapshot);
+};
+
+struct LiveBatteryField {
+  const char* name;
+  int32_t (*read)(const DATALAYER_BATTERY_TYPE& battery);
+};
+
+#define SYSTEM_FIELD(name, value) {name, [](const DataLayerSnapshot& snapshot) -> int32_t { return value; }}
+#define BATTERY_FIELD(name, value) {name, [](const DATALAYER_BATTERY_TYPE& battery) -> int32_t { return value; }}
+
+// Floats of the charger go out in the tenths the rest of the datalayer uses
+static int32_t deci(float value) {
+  return (int32_t)lroundf(value * 10.0f);
+}
+
+static const LiveSystemField system_fields[] = {
+    SYSTEM_FIELD("system.emulator_status", snapshot.system_info.emulator_status),
+    SYSTEM_FIELD("system.CPU_temperature_dC", deci(snapshot.system_info.CPU_temperature)),
+    SYSTEM_FIELD("system.CPU_free_heap", snapshot.system_info.CPU_free_heap),
+    SYSTEM_FIELD("system.equipment_stop_active", snapshot.system_info.equipment_stop_active),
+    SYSTEM_FIELD("system.inverter_allows_contactor_closing", snapshot.system_status.inverter_allows_contactor_closing),
+    SYSTEM_FIELD("system.contactors_engaged", snapshot.system_status.contactors_engaged),
+    SYSTEM_FIELD("system.precharge_status", snapshot.system_status.precharge_status),
+    SYSTEM_FIELD("shunt.available", snapshot.shunt.available),
+    SYSTEM_FIELD("shunt.contactors_engaged", snapshot.shunt.contactors_engaged),
+    SYSTEM_FIELD("shunt.precharging", snapshot.shunt.precharging),
+    SYSTEM_FIELD("shunt.measured_voltage_mV", snapshot.shunt.measured_voltage_mV),
+    SYSTEM_FIELD("shunt.measured_outvoltage_mV", snapshot.shunt.measured_outvoltage_mV),
+    SYSTEM_FIELD("shunt.measured_amperage_mA", snapshot.shunt.measured_amperage_mA),
+    SYSTEM_FIELD("shunt.measured_avg1S_amperage_mA", snapshot.shunt.measured_avg1S_amperage_mA),
+    SYSTEM_FIELD("charger.HV_enabled", snapshot.charger.charger_HV_enabled),
+    SYSTEM_FIELD("charger.aux12V_enabled", snapshot.charger.charger_aux12V_enabled),
+    SYSTEM_FIELD("charger.setpoint_HV_dV", deci(snapshot.charger.charger_setpoint_HV_VDC)),
+    SYSTEM_FIELD("charger.setpoint_HV_dA", deci(snapshot.charger.charger_setpoint_HV_IDC)),
+    SYSTEM_FIELD("charger.stat_HVvol_dV", deci(snapshot.charger.charger_stat_HVvol)),
+    SYSTEM_FIELD("charger.stat_HVcur_dA", deci(snapshot.charger.charger_stat_HVcur)),
+    SYSTEM_FIELD("charger.stat_ACvol_dV", deci(snapshot.charger.charger_stat_ACvol)),
+    SYSTEM_FIELD("charger.stat_ACcur_dA", deci(snapshot.charger.charger_stat_ACcur)),
+    SYSTEM_FIELD("charger.stat_LVvol_dV", deci(snapshot.charger.charger_stat_LVvol)),
+    SYSTEM_FIELD("charger.stat_LVcur_dA", deci(snapshot.charger.charger_stat_LVcur)),
+};
+
+static const LiveBatteryField battery_fields[] = {
+    BATTERY_FIELD("real_soc", battery.status.real_soc),
+    BATTERY_FIELD("reported_soc", battery.status.reported_soc),
+    BATTERY_FIELD("soh_pptt", battery.status.soh_pptt),
+    BATTERY_FIELD("voltage_dV", battery.status.voltage_dV),
+    BATTERY_FIELD("current_dA", battery.status.current_dA),
+    BATTERY_FIELD("active_power_W", battery.status.active_power_W),
+    BATTERY_FIELD("temperature_min_dC", battery.status.temperature_min_dC),
+    BATTERY_FIELD("temperature_max_dC", battery.status.temperature_max_dC),
+    BATTERY_FIELD("cell_min_voltage_mV", battery.status.cell_min_voltage_mV),
+    BATTERY_FIELD("cell_max_voltage_mV", battery.status.cell_max_voltage_mV),
+    BATTERY_FIELD("cell_mean_voltage_mV", battery.status.cell_statistics.mean_mV),
+    BATTERY_FIELD("cell_stddev_uV", battery.status.cell_statistics.stddev_uV),
+    BATTERY_FIELD("cell_outliers", battery.status.cell_statistics.outliers),
+    BATTERY_FIELD("remaining_capacity_Wh", battery.status.remaining_capacity_Wh),
+    BATTERY_FIELD("total_capacity_Wh", battery.info.total_capacity_Wh),
+    BATTERY_FIELD("max_charge_power_W", battery.status.max_charge_power_W),
+    BATTERY_FIELD("max_discharge_power_W", battery.status.max_discharge_power_W),
+    BATTERY_FIELD("bms_status", battery.status.bms_status),
+    BATTERY_FIELD("real_bms_status", battery.status.real_bms_status),
+    BATTERY_FIELD("balancing_status", battery.status.balancing_status),
+    BATTERY_FIELD("number_of_cells", battery.info.number_of_cells),
+};
+
+static_assert(sizeof(system_fields) / sizeof(system_fields[0]) == LiveTelemetry::SYSTEM_FIELDS);
+static_assert(sizeof(battery_fields) / sizeof(battery_fields[0]) == LiveTelemetry::BATTERY_FIELDS);
+
+static const char* const battery_names[LIVE_TELEMETRY_BATTERIES] = {"battery", "battery2", "battery3"};
+
+static const DATALAYER_BATTERY_TYPE& battery_at(const DataLayerSnapshot& snapshot, uint8_t index) {
+  switch (index) {
+    case 1:
+      return snapshot.battery2;
+    case 2:
+      return snapshot.battery3;
+    default:
+      return snapshot.battery;
+  }
+}
+
+static size_t field_count(uint8_t batteries) {
+  return LiveTelemetry::SYSTEM_FIELDS + batteries * LiveTelemetry::BATTERY_FIELDS;
+}
+
+static int32_t read_field(const DataLayerSnapshot& snapshot, size_t index) {
+  if (index < LiveTelemetry::SYSTEM_FIELDS) {
+    return system_fields[index].read(snapshot);
+  }
+  index -= LiveTelemetry::SYSTEM_FIELDS;
+  return battery_fields[index % LiveTelemetry::BATTERY_FIELDS].read(
+      battery_at(snapshot, index / LiveTelemetry::BATTERY_FIELDS));
+}
+
+static uint16_t cell_count(const DATALAYER_BATTERY_TYPE& battery) {
+  return (battery.info.number_of_cells < MAX_AMOUNT_CELLS) ? battery.info.number_of_cells : MAX_AMOUNT_CELLS;
+}
+
+static bool balancing_bit(const uint32_t* bits, uint16_t cell) {
+  return (bits[cell / 32] >> (cell % 32)) & 1;
+}
+
+bool LiveTelemetry::differs(const DataLayerSnapshot& snapshot, uint8_t batteries) const {
+  for (size_t i = 0; i < field_count(batteries); i++) {
+    if (read_field(snapshot, i) != values[i]) {
+      return true;
+    }
+  }
+  for (uint8_t b = 0; b < batteries; b++) {
+    const DATALAYER_BATTERY_TYPE& battery = battery_at(snapshot, b);
+    if (cell_count(battery) != cells[b]) {
+      return true;
+    }
+    for (uint16_t i = 0; i < cells[b]; i++) {
+      if (battery.status.cell_voltages_mV[i] != cell_voltages_mV[b][i] ||
+          battery.status.cell_balancing_status[i] != balancing_bit(balancing[b], i)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+bool LiveTelemetry::sample(const DataLayerSnapshot& snapshot, uint8_t batteries) {
+  if (batteries > LIVE_TELEMETRY_BATTERIES) {
+    batteries = LIVE_TELEMETRY_BATTERIES;
+  }
+  bool full = (seq == 0 || batteries != present);
+  if (!full && !differs(snapshot, batteries)) {
+    return false;  // Keep the last changes for the clients that are one sample behind
+  }
+  present = batteries;
+
+  for (size_t i = 0; i < field_count(batteries); i++) {
+    int32_t value = read_field(snapshot, i);
+    value_changed[i] = full || value != values[i];
+    values[i] = value;
+  }
+
+  for (uint8_t b = 0; b < batteries; b++) {
+    const DATALAYER_BATTERY_TYPE& battery = battery_at(snapshot, b);
+    uint16_t count = cell_count(battery);
+    bool resized = full || count != cells[b];
+    cells[b] = count;
+    cells_changed[b] = 0;
+    for (uint16_t i = 0; i < count; i++) {
+      uint16_t voltage_mV = battery.status.cell_voltages_mV[i];
+      cell_changed[b][i] = resized || voltage_mV != cell_voltages_mV[b][i];
+      cells_changed[b] += cell_changed[b][i];
+      cell_voltages_mV[b][i] = voltage_mV;
+    }
+
+    uint32_t bits[sizeof(balancing[b]) / sizeof(balancing[b][0])] = {0};
+    for (uint16_t i = 0; i < count; i++) {
+      bits[i / 32] |= (uint32_t)battery.status.cell_balancing_status[i] << (i % 32);
+    }
+    balancing_changed[b] = resized || memcmp(bits, balancing[b], sizeof(bits)) != 0;
+    memcpy(balancing[b], bits, sizeof(bits));
+  }
+
+  seq++;
+  return true;
+}
+
+// Writes `,"name":{` before the first member and the closing brace after the last, if there was one
+class MemberList {
+ public:
+  MemberList(HtmlWriter& out, const char* name) : out(out), name(name) {}
+  ~MemberList() {
+    if (opened) {
+      out += '}';
+    }
+  }
+
+  void next() {
+    if (opened) {
+      out += ',';
+    } else {
+      out.printf(",\"%s\":{", name);
+      opened = true;
+    }
+  }
+
+ private:
+  HtmlWriter& out;
+  const char* name;
+  bool opened = false;
+};
+
+static void write_base64(HtmlWriter& out, const uint16_t* values, uint16_t count) {
+  static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  size_t bytes = count * 2;
+  for (size_t i = 0; i < bytes; i += 3) {
+    uint32_t group = 0;
+    for (size_t j = 0; j < 3; j++) {
+      size_t k = i + j;
+      uint8_t byte = (k < bytes) ? (values[k / 2] >> (8 * (k % 2))) & 0xFF : 0;
+      group = (group << 8) | byte;
+    }
+    char encoded[4];
+    for (size_t j = 0; j < 4; j++) {
+      encoded[j] = (i + j <= bytes) ? alphabet[(group >> (18 - 6 * j)) & 0x3F] : '=';
+    }
+    out.write(encoded, sizeof(encoded));
+  }
+}
+
+bool LiveTelemetry::write_update(uint32_t client_seq, LiveCellEncoding encoding, HtmlWriter& out) const {
+  if (seq == 0 || client_seq == seq) {
+    return false;
+  }
+  bool full = (client_seq == 0 || client_seq + 1 != seq);
+
+  out.printf("{\"v\":%d,\"seq\":%lu", LIVE_TELEMETRY_VERSION, (unsigned long)seq);
+  if (full) {
+    out += ",\"full\":1";
+  }
+
+  {
+    MemberList fields(out, "f");
+    for (size_t i = 0; i < field_count(present); i++) {
+      if (!full && !value_changed[i]) {
+        continue;
+      }
+      fields.next();
+      if (i < SYSTEM_FIELDS) {
+        out.printf("\"%s\":%ld", system_fields[i].name, (long)values[i]);
+      } else {
+        size_t index = i - SYSTEM_FIELDS;
+        out.printf("\"%s.%s\":%ld", battery_names[index / BATTERY_FIELDS], battery_fields[index % BATTERY_FIELDS].name,
+                   (long)values[i]);
+      }
+    }
+  }
+
+  {
+    MemberList batteries(out, "cells");
+    for (uint8_t b = 0; b < present; b++) {
+      if (!full && cells_changed[b] == 0) {
+        continue;
+      }
+      batteries.next();
+      out.printf("\"%s\":", battery_names[b]);
+      if (encoding == LiveCellEncoding::Packed) {
+        out += '"';
+        write_base64(out, cell_voltages_mV[b], cells[b]);
+        out += '"';
+      } else if (!full && cells_changed[b] * 4 < cells[b]) {
+        // Only a few cells moved, send them by index
+        out += '[';
+        const char* separator = "";
+        for (uint16_t i = 0; i < cells[b]; i++) {
+          if (cell_changed[b][i]) {
+            out.printf("%s[%u,%u]", separator, i, cell_voltages_mV[b][i]);
+            separator = ",";
+          }
+        }
+        out += ']';
+      } else {
+        out += '[';
+        for (uint16_t i = 0; i < cells[b]; i++) {
+          out.printf(i ? ",%u" : "%u", cell_voltages_mV[b][i]);
+        }
+        out += ']';
+      }
+    }
+  }
+
+  {
+    MemberList batteries(out, "balancing");
+    for (uint8_t b = 0; b < present; b++) {
+      if (!full && !balancing_changed[b]) {
+        continue;
+      }
+      batteries.next();
+      out.printf("\"%s\":\"", battery_names[b]);
+      for (uint16_t digit = 0; digit < (cells[b] + 3) / 4; digit++) {
+        out += "0123456789abcdef"[(balancing[b][digit / 8] >> ((digit % 8) * 4)) & 0xF];
+      }
+      out += '"';
+    }
+  }
+
+  out += '}';
+  return true;
+}
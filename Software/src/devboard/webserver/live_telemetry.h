@@ -0,0 +1,72 @@
+#ifndef _LIVE_TELEMETRY_H_
+#define _LIVE_TELEMETRY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../../datalayer/datalayer_snapshot.h"
+#include "html_writer.h"
+
+// Bumped whenever a field is renamed or the message layout changes
+#define LIVE_TELEMETRY_VERSION 1
+
+// Batteries covered, battery, battery2 and battery3 of the datalayer
+#define LIVE_TELEMETRY_BATTERIES 3
+
+// Room for the largest message, everything of three full packs with cells sent as JSON
+#ifndef LIVE_TELEMETRY_MESSAGE_SIZE
+#define LIVE_TELEMETRY_MESSAGE_SIZE 8192
+#endif
+
+enum class LiveCellEncoding {
+  Json,    // Cell voltages as a JSON array of mV, or [index,mV] pairs when only a few changed
+  Packed,  // Cell voltages as base64 of little-endian uint16 mV, always the whole pack
+};
+
+// The state of the datalayer as the live data API sends it. sample() reads the
+// battery, shunt, charger and system values of a datalayer snapshot into a cache
+// and starts a new sequence number when anything changed. write_update() then
+// brings a client up to date, with only the changed values if it has the previous
+// sequence number, otherwise with everything. Both are written from the cache, so a full message and the
+// deltas after it always add up, however the datalayer moved in between.
+//
+// Messages are JSON:
+//   {"v":1,"seq":12,"full":1,"f":{"battery.voltage_dV":3700,...},
+//    "cells":{"battery":[3701,3699,...]},"balancing":{"battery":"0000c0..."}}
+// Values keep the integer units of the datalayer, named by their suffix. Balancing
+// is a hex string of one bit per cell, cell 4k+n in bit n of digit k.
+class LiveTelemetry {
+ public:
+  static constexpr size_t SYSTEM_FIELDS = 24;
+  static constexpr size_t BATTERY_FIELDS = 21;
+  static constexpr size_t FIELDS = SYSTEM_FIELDS + LIVE_TELEMETRY_BATTERIES * BATTERY_FIELDS;
+
+  // Reads the snapshot, for the first `batteries` batteries. Returns true and
+  // moves on to the next sequence number if anything changed since the last sample.
+  bool sample(const DataLayerSnapshot& snapshot, uint8_t batteries);
+
+  // Sequence number of the last sample that changed something, 0 before the first one
+  uint32_t sequence() const { return seq; }
+
+  // Writes the message for a client that has seen `client_seq`, 0 for a new client.
+  // Returns false, writing nothing, if the client is already up to date.
+  bool write_update(uint32_t client_seq, LiveCellEncoding cells, HtmlWriter& out) const;
+
+ private:
+  bool differs(const DataLayerSnapshot& snapshot, uint8_t batteries) const;
+
+  uint32_t seq = 0;
+  uint8_t present = 0;
+
+  int32_t values[FIELDS];
+  bool value_changed[FIELDS];
+
+  uint16_t cell_voltages_mV[LIVE_TELEMETRY_BATTERIES][MAX_AMOUNT_CELLS];
+  bool cell_changed[LIVE_TELEMETRY_BATTERIES][MAX_AMOUNT_CELLS];
+  uint16_t cells[LIVE_TELEMETRY_BATTERIES] = {0};
+  uint16_t cells_changed[LIVE_TELEMETRY_BATTERIES] = {0};
+
+  uint32_t balancing[LIVE_TELEMETRY_BATTERIES][(MAX_AMOUNT_CELLS + 31) / 32];
+  bool balancing_changed[LIVE_TELEMETRY_BATTERIES] = {false};
+};
+
+#endif
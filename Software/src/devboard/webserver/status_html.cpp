@@ -0,0 +1,883 @@
+#include "status_html.h"
+#include <Arduino.h>
+#include "../../battery/BATTERIES.h"
+#include "../../battery/Battery.h"
+#include "../../battery/Shunt.h"
+#include "../../charger/CHARGERS.h"
+#include "../../communication/can/comm_can.h"
+#include "../../communication/contactorcontrol/comm_contactorcontrol.h"
+#include "../../datalayer/datalayer.h"
+#include "../../devboard/safety/safety.h"
+#include "../../inverter/INVERTERS.h"
+#include "../utils/events.h"
+#include "../utils/led_handler.h"
+#include "../utils/timer.h"
+#include "../wifi/wifi.h"
+#include "html_escape.h"
+#include "html_stream.h"
+#include "webserver.h"
+
+template <typename T>  // This function makes power values appear as W when under 1000, and kW when over
+static void formatPowerValue(HtmlWriter& content, T value, const char* unit, int precision) {
+  if (std::is_same<T, float>::value || std::is_same<T, uint16_t>::value || std::is_same<T, uint32_t>::value) {
+    float convertedValue = static_cast<float>(value);
+
+    if (convertedValue >= 1000.0f || convertedValue <= -1000.0f) {
+      content.printf("%.*f kW", precision, convertedValue / 1000.0f);
+    } else {
+      content.printf("%.0f W", convertedValue);
+    }
+  }
+
+  content += unit;
+}
+
+template <typename T>  // Same, as a heading with a label
+static void formatPowerValue(HtmlWriter& content, const char* label, T value, const char* unit, int precision,
+                             const char* color = "white") {
+  content.printf("<h4 style='color: %s;'>%s: ", color, label);
+  formatPowerValue(content, value, unit, precision);
+  content += "</h4>";
+}
+
+static String getConnectResultString(wl_status_t status) {
+  switch (status) {
+    case WL_CONNECTED:
+      return "Connected";
+    case WL_NO_SHIELD:
+      return "No shield";
+    case WL_IDLE_STATUS:
+      return "Idle status";
+    case WL_NO_SSID_AVAIL:
+      return "No SSID available";
+    case WL_SCAN_COMPLETED:
+      return "Scan completed";
+    case WL_CONNECT_FAILED:
+      return "Connect failed";
+    case WL_CONNECTION_LOST:
+      return "Connection lost";
+    case WL_DISCONNECTED:
+      return "Disconnected";
+    default:
+      return "Unknown";
+  }
+}
+
+static String get_uptime() {
+  uint64_t milliseconds;
+  uint32_t remaining_seconds_in_day;
+  uint32_t remaining_seconds;
+  uint32_t remaining_minutes;
+  uint32_t remaining_hours;
+  uint16_t total_days;
+
+  milliseconds = millis64();
+
+  //convert passed millis to days, hours, minutes, seconds
+  total_days = milliseconds / (1000 * 60 * 60 * 24);
+  remaining_seconds_in_day = (milliseconds / 1000) % (60 * 60 * 24);
+  remaining_hours = remaining_seconds_in_day / (60 * 60);
+  remaining_minutes = (remaining_seconds_in_day % (60 * 60)) / 60;
+  remaining_seconds = remaining_seconds_in_day % 60;
+
+  return (String)total_days + " days, " + (String)remaining_hours + " hours, " + (String)remaining_minutes +
+         " minutes, " + (String)remaining_seconds + " seconds";
+}
+
+static String latency_summary_html(const char* name, const LatencySummary& summary) {
+  return "<h4>" + String(name) + ": " + String(summary.p50_us) + " / " + String(summary.p95_us) + " / " +
+         String(summary.p99_us) + " / " + String(summary.max_us) + " us</h4>";
+}
+
+// Timing and load of the tasks, only collected while performance measurement is on
+static void render_performance_info(HtmlWriter& content) {
+  content.printf("<h4>Free heap: %lu, max alloc: %lu</h4>", (unsigned long)ESP.getFreeHeap(),
+                 (unsigned long)ESP.getMaxAllocHeap());
+  FlashMode_t mode = ESP.getFlashChipMode();
+  content.printf("<h4>Flash mode: %s, size: %lu MB</h4>",
+                 mode == FM_QIO    ? "QIO"
+                 : mode == FM_QOUT ? "QOUT"
+                 : mode == FM_DIO  ? "DIO"
+                 : mode == FM_DOUT ? "DOUT"
+                                   : /*mode == FM_UNKNOWN*/ "Unknown",
+                 (unsigned long)(ESP.getFlashChipSize() / (1024 * 1024)));
+  // Load information
+  content.printf("<h4>Core task max load: %lld us</h4>", (long long)datalayer.system.status.core_task_max_us);
+  content.printf("<h4>Core task max load last 10 s: %lld us</h4>",
+                 (long long)datalayer.system.status.core_task_10s_max_us);
+  content.printf("<h4>MQTT function (MQTT task) max load last 10 s: %lld us</h4>",
+                 (long long)datalayer.system.status.mqtt_task_10s_max_us);
+  content.printf("<h4>WIFI function (MQTT task) max load last 10 s: %lld us</h4>",
+                 (long long)datalayer.system.status.wifi_task_10s_max_us);
+  content += "<h4>Max load @ worst case execution of core task:</h4>";
+  content.printf("<h4>10ms function timing: %lld us</h4>", (long long)datalayer.system.status.time_snap_10ms_us);
+  content.printf("<h4>Values function timing: %lld us</h4>", (long long)datalayer.system.status.time_snap_values_us);
+  content.printf("<h4>CAN/serial RX function timing: %lld us</h4>",
+                 (long long)datalayer.system.status.time_snap_comm_us);
+  content.printf("<h4>CAN TX function timing: %lld us</h4>", (long long)datalayer.system.status.time_snap_cantx_us);
+  content += "<h4>Timing last 10 s (p50 / p95 / p99 / max):</h4>";
+  content += latency_summary_html("Core task", datalayer.system.status.latency_core_task);
+  content += latency_summary_html("CAN/serial RX function", datalayer.system.status.latency_comm);
+  content += latency_summary_html("10ms function", datalayer.system.status.latency_10ms);
+  content += latency_summary_html("Values function", datalayer.system.status.latency_values);
+  content += latency_summary_html("CAN TX function", datalayer.system.status.latency_cantx);
+  content += latency_summary_html("Core task wakeup jitter", datalayer.system.status.wakeup_jitter);
+  // CAN receive statistics, only for interfaces that are in use
+  for (int i = 0; i < NO_CAN_INTERFACE; i++) {
+    const DATALAYER_CAN_RX_STATS_TYPE& stats = datalayer.system.status.can_rx_stats[i];
+    if (stats.queue_size == 0) {
+      continue;
+    }
+    content.printf("<h4>%s RX frames: %lu, queue peak last 10 s: %u/%u, overflows: %lu</h4>",
+                   getCANInterfaceName((CAN_Interface)i), (unsigned long)stats.frames_received,
+                   stats.queue_high_water, stats.queue_size, (unsigned long)stats.rx_overflows);
+  }
+  const HtmlStreamStats& page_stats = html_stream_stats();
+  content.printf("<h4>Web pages: %lu, aborted: %lu, rejected: %lu, peak heap per page: %lu bytes</h4>",
+                 (unsigned long)page_stats.pages, (unsigned long)page_stats.aborted,
+                 (unsigned long)page_stats.rejected, (unsigned long)page_stats.heap_peak_bytes);
+}
+
+// Name and IP of the WiFi network
+static void render_wifi_info(HtmlWriter& content) {
+  wl_status_t status = WiFi.status();
+  // Display ssid of network connected to and, if connected to the WiFi, its own IP
+  content += "<h4>SSID: ";
+  content += html_escape(ssid.c_str());
+  if (status == WL_CONNECTED) {
+    // Get and display the signal strength (RSSI) and channel
+    content.printf(" RSSI:%d dBm Ch: %d", (int)WiFi.RSSI(), (int)WiFi.channel());
+  }
+  content += "</h4>";
+  if (status == WL_CONNECTED) {
+    content += "<h4>Hostname: ";
+    content += html_escape(WiFi.getHostname());
+    content += "</h4>";
+    content += "<h4>IP: ";
+    content += WiFi.localIP().toString();
+    content += "</h4>";
+  } else {
+    content += "<h4>Wifi state: ";
+    content += getConnectResultString(status);
+    content += "</h4>";
+  }
+}
+
+// Software, hardware and uptime, followed by the performance and WiFi details
+static void render_system_info(HtmlWriter& content) {
+  // Compact header
+  content += "<h2>Battery Emulator</h2>";
+
+  // Start content block
+  content += "<div style='background-color: #303E47; padding: 10px; margin-bottom: 10px; border-radius: 50px'>";
+  content.printf("<h4>Software: %s", version_number);
+
+// Show hardware used:
+#ifdef HW_LILYGO
+  content += " Hardware: LilyGo T-CAN485";
+#endif  // HW_LILYGO
+#ifdef HW_LILYGO2CAN
+  content += " Hardware: LilyGo T_2CAN";
+#endif  // HW_LILYGO2CAN
+#ifdef HW_BECOM
+  content += " Hardware: BECom";
+#endif  // HW_BECOM
+#ifdef HW_STARK
+  content += " Hardware: Stark CMR Module";
+#endif  // HW_STARK
+  content.printf(" @ %.1f &deg;C</h4>", datalayer.system.info.CPU_temperature);
+  content += "<h4>Uptime: ";
+  content += get_uptime();
+  content += "</h4>";
+  if (datalayer.system.info.performance_measurement_active) {
+    render_performance_info(content);
+  }
+
+  render_wifi_info(content);
+  // Close the block
+  content += "</div>";
+}
+
+// Which inverter, battery, shunt and charger protocols are in use
+static void render_component_info(HtmlWriter& content) {
+  if (inverter || battery || charger || user_selected_shunt_type != ShuntType::None) {
+    // Start a new block with a specific background color
+    content += "<div style='background-color: #333; padding: 10px; margin-bottom: 10px; border-radius: 50px'>";
+
+    // Display which components are used
+    if (inverter) {
+      content += "<h4 style='color: white;'>Inverter protocol: ";
+      content += inverter->name();
+      content += " ";
+      content += datalayer.system.info.inverter_brand;
+      content += "</h4>";
+    }
+
+    if (battery) {
+      content += "<h4 style='color: white;'>Battery protocol: ";
+      content += datalayer.system.info.battery_protocol;
+      if (battery3) {
+        content += " (Triple battery)";
+      } else if (battery2) {
+        content += " (Double battery)";
+      }
+      if (datalayer.battery.info.chemistry == battery_chemistry_enum::LFP) {
+        content += " (LFP)";
+      }
+      content += "</h4>";
+    }
+
+    if (user_selected_shunt_type != ShuntType::None) {
+      content += "<h4 style='color: white;'>Shunt protocol: ";
+      content += datalayer.system.info.shunt_protocol;
+      content += "</h4>";
+    }
+
+    if (charger) {
+      content += "<h4 style='color: white;'>Charger protocol: ";
+      content += charger->name();
+      content += "</h4>";
+    }
+
+    // Close the block
+    content += "</div>";
+  }
+}
+
+// Live values of the battery, and of the second and third battery side by side with it
+static void render_battery_info(HtmlWriter& content) {
+  if (battery) {
+    if (battery2) {
+      // Start a new block with a specific background color. Color changes depending on BMS status
+      content += "<div style='display: flex; width: 100%;'>";
+      content += "<div style='flex: 1; background-color: ";
+    } else {
+      // Start a new block with a specific background color. Color changes depending on system status
+      content += "<div style='background-color: ";
+    }
+
+    switch (get_emulator_status()) {
+      case EMULATOR_STATUS::STATUS_OK:
+        content += "#2D3F2F;";
+        break;
+      case EMULATOR_STATUS::STATUS_WARNING:
+        content += "#F5CC00;";
+        break;
+      case EMULATOR_STATUS::STATUS_ERROR:
+        content += "#A70107;";
+        break;
+      case EMULATOR_STATUS::STATUS_UPDATING:
+        content += "#2B35AF;";  // Blue in test mode
+        break;
+    }
+
+    // Add the common style properties
+    content += "padding: 10px; margin-bottom: 10px; border-radius: 50px;'>";
+
+    // Display battery statistics within this block
+    float socRealFloat =
+        static_cast<float>(datalayer.battery.status.real_soc) / 100.0f;  // Convert to float and divide by 100
+    float socScaledFloat =
+        static_cast<float>(datalayer.battery.status.reported_soc) / 100.0f;  // Convert to float and divide by 100
+    float sohFloat =
+        static_cast<float>(datalayer.battery.status.soh_pptt) / 100.0f;  // Convert to float and divide by 100
+    float voltageFloat =
+        static_cast<float>(datalayer.battery.status.voltage_dV) / 10.0f;  // Convert to float and divide by 10
+    float currentFloat =
+        static_cast<float>(datalayer.battery.status.current_dA) / 10.0f;  // Convert to float and divide by 10
+    float powerFloat = static_cast<float>(datalayer.battery.status.active_power_W);                // Convert to float
+    float tempMaxFloat = static_cast<float>(datalayer.battery.status.temperature_max_dC) / 10.0f;  // Convert to float
+    float tempMinFloat = static_cast<float>(datalayer.battery.status.temperature_min_dC) / 10.0f;  // Convert to float
+    float maxCurrentChargeFloat =
+        static_cast<float>(datalayer.battery.status.max_charge_current_dA) / 10.0f;  // Convert to float
+    float maxCurrentDischargeFloat =
+        static_cast<float>(datalayer.battery.status.max_discharge_current_dA) / 10.0f;  // Convert to float
+    uint16_t cell_delta_mv =
+        datalayer.battery.status.cell_max_voltage_mV - datalayer.battery.status.cell_min_voltage_mV;
+
+    if (datalayer.battery.settings.soc_scaling_active)
+      content.printf("<h4 style='color: white;'>Scaled SOC: %.2f&percnt; (real: %.2f&percnt;)</h4>", socScaledFloat,
+                     socRealFloat);
+    else
+      content.printf("<h4 style='color: white;'>SOC: %.2f&percnt;</h4>", socRealFloat);
+
+    content.printf("<h4 style='color: white;'>SOH: %.2f&percnt;</h4>", sohFloat);
+    content.printf("<h4 style='color: white;'>Voltage: %.1f V &nbsp; Current: %.1f A</h4>", voltageFloat, currentFloat);
+    formatPowerValue(content, "Power", powerFloat, "", 1);
+
+    if (datalayer.battery.settings.soc_scaling_active) {
+      content += "<h4 style='color: white;'>Scaled total capacity: ";
+      formatPowerValue(content, datalayer.battery.info.reported_total_capacity_Wh, "h", 1);
+      content += " (real: ";
+      formatPowerValue(content, datalayer.battery.info.total_capacity_Wh, "h", 1);
+      content += ")</h4>";
+    } else {
+      formatPowerValue(content, "Total capacity", datalayer.battery.info.total_capacity_Wh, "h", 1);
+    }
+
+    if (datalayer.battery.settings.soc_scaling_active) {
+      content += "<h4 style='color: white;'>Scaled remaining capacity: ";
+      formatPowerValue(content, datalayer.battery.status.reported_remaining_capacity_Wh, "h", 1);
+      content += " (real: ";
+      formatPowerValue(content, datalayer.battery.status.remaining_capacity_Wh, "h", 1);
+      content += ")</h4>";
+    } else {
+      formatPowerValue(content, "Remaining capacity", datalayer.battery.status.remaining_capacity_Wh, "h", 1);
+    }
+
+    if (datalayer.system.info.equipment_stop_active) {
+      formatPowerValue(content, "Max discharge power", datalayer.battery.status.max_discharge_power_W, "", 1, "red");
+      formatPowerValue(content, "Max charge power", datalayer.battery.status.max_charge_power_W, "", 1, "red");
+      content.printf("<h4 style='color: red;'>Max discharge current: %.1f A</h4>", maxCurrentDischargeFloat);
+      content.printf("<h4 style='color: red;'>Max charge current: %.1f A</h4>", maxCurrentChargeFloat);
+    } else {
+      formatPowerValue(content, "Max discharge power", datalayer.battery.status.max_discharge_power_W, "", 1);
+      formatPowerValue(content, "Max charge power", datalayer.battery.status.max_charge_power_W, "", 1);
+      content.printf("<h4 style='color: white;'>Max discharge current: %.1f A", maxCurrentDischargeFloat);
+      if (datalayer.battery.settings.remote_settings_limit_discharge) {
+        content += " (Remote)</h4>";
+      } else if (datalayer.battery.settings.user_settings_limit_discharge) {
+        content += " (Manual)</h4>";
+      } else {
+        content += " (BMS)</h4>";
+      }
+      content.printf("<h4 style='color: white;'>Max charge current: %.1f A", maxCurrentChargeFloat);
+      if (datalayer.battery.settings.remote_settings_limit_charge) {
+        content += " (Remote)</h4>";
+      } else if (datalayer.battery.settings.user_settings_limit_charge) {
+        content += " (Manual)</h4>";
+      } else {
+        content += " (BMS)</h4>";
+      }
+    }
+
+    content.printf("<h4>Cell min/max: %u mV / %u mV</h4>", datalayer.battery.status.cell_min_voltage_mV,
+                   datalayer.battery.status.cell_max_voltage_mV);
+    if (cell_delta_mv > datalayer.battery.info.max_cell_voltage_deviation_mV) {
+      content.printf("<h4 style='color: red;'>Cell delta: %u mV</h4>", cell_delta_mv);
+    } else {
+      content.printf("<h4>Cell delta: %u mV</h4>", cell_delta_mv);
+    }
+    content.printf("<h4>Temperature min/max: %.1f &deg;C / %.1f &deg;C</h4>", tempMinFloat, tempMaxFloat);
+
+    content += "<h4>System status: ";
+    switch (datalayer.battery.status.bms_status) {
+      case ACTIVE:
+        content += "OK";
+        break;
+      case UPDATING:
+        content += "UPDATING";
+        break;
+      case FAULT:
+        content += "FAULT";
+        break;
+      case INACTIVE:
+        content += "INACTIVE";
+        break;
+      case STANDBY:
+        content += "STANDBY";
+        break;
+      default:
+        content += "??";
+        break;
+    }
+    content += "</h4>";
+
+    if (battery && battery->supports_real_BMS_status()) {
+      content += "<h4>Battery BMS status: ";
+      switch (datalayer.battery.status.real_bms_status) {
+        case BMS_ACTIVE:
+          content += "OK";
+          break;
+        case BMS_FAULT:
+          content += "FAULT";
+          break;
+        case BMS_DISCONNECTED:
+          content += "DISCONNECTED";
+          break;
+        case BMS_STANDBY:
+          content += "STANDBY";
+          break;
+        default:
+          content += "??";
+          break;
+      }
+      content += "</h4>";
+    }
+
+    if (datalayer.battery.status.current_dA == 0) {
+      content += "<h4>Battery idle</h4>";
+    } else if (datalayer.battery.status.current_dA < 0) {
+      content += "<h4>Battery discharging!";
+      if (datalayer.battery.settings.inverter_limits_discharge) {
+        content += " (Inverter limiting)</h4>";
+      } else {
+        if (datalayer.battery.settings.user_settings_limit_discharge) {
+          content += " (Settings limiting)</h4>";
+        } else {
+          content += " (Battery limiting)</h4>";
+        }
+      }
+      content += "</h4>";
+    } else {  // > 0 , positive current
+      content += "<h4>Battery charging!";
+      if (datalayer.battery.settings.inverter_limits_charge) {
+        content += " (Inverter limiting)</h4>";
+      } else {
+        if (datalayer.battery.settings.user_settings_limit_charge) {
+          content += " (Settings limiting)</h4>";
+        } else {
+          content += " (Battery limiting)</h4>";
+        }
+      }
+    }
+
+    // Close the block
+    content += "</div>";
+
+    if (battery2) {
+      content += "<div style='flex: 1; background-color: ";
+      switch (datalayer.battery.status.bms_status) {
+        case ACTIVE:
+          content += "#2D3F2F;";
+          break;
+        case FAULT:
+          content += "#A70107;";
+          break;
+        default:
+          content += "#2D3F2F;";
+          break;
+      }
+      // Add the common style properties
+      content += "padding: 10px; margin-bottom: 10px; border-radius: 50px;'>";
+
+      // Display battery statistics within this block
+      socRealFloat =
+          static_cast<float>(datalayer.battery2.status.real_soc) / 100.0f;  // Convert to float and divide by 100
+      //socScaledFloat; // Same value used for bat2
+      sohFloat =
+          static_cast<float>(datalayer.battery2.status.soh_pptt) / 100.0f;  // Convert to float and divide by 100
+      voltageFloat =
+          static_cast<float>(datalayer.battery2.status.voltage_dV) / 10.0f;  // Convert to float and divide by 10
+      currentFloat =
+          static_cast<float>(datalayer.battery2.status.current_dA) / 10.0f;       // Convert to float and divide by 10
+      powerFloat = static_cast<float>(datalayer.battery2.status.active_power_W);  // Convert to float
+      tempMaxFloat = static_cast<float>(datalayer.battery2.status.temperature_max_dC) / 10.0f;  // Convert to float
+      tempMinFloat = static_cast<float>(datalayer.battery2.status.temperature_min_dC) / 10.0f;  // Convert to float
+      cell_delta_mv = datalayer.battery2.status.cell_max_voltage_mV - datalayer.battery2.status.cell_min_voltage_mV;
+
+      if (datalayer.battery.settings.soc_scaling_active)
+        content.printf("<h4 style='color: white;'>Scaled SOC: %.2f&percnt; (real: %.2f&percnt;)</h4>", socScaledFloat,
+                       socRealFloat);
+      else
+        content.printf("<h4 style='color: white;'>SOC: %.2f&percnt;</h4>", socRealFloat);
+
+      content.printf("<h4 style='color: white;'>SOH: %.2f&percnt;</h4>", sohFloat);
+      content.printf("<h4 style='color: white;'>Voltage: %.1f V &nbsp; Current: %.1f A</h4>", voltageFloat,
+                     currentFloat);
+      formatPowerValue(content, "Power", powerFloat, "", 1);
+
+      if (datalayer.battery.settings.soc_scaling_active) {
+        content += "<h4 style='color: white;'>Scaled total capacity: ";
+        formatPowerValue(content, datalayer.battery2.info.reported_total_capacity_Wh, "h", 1);
+        content += " (real: ";
+        formatPowerValue(content, datalayer.battery2.info.total_capacity_Wh, "h", 1);
+        content += ")</h4>";
+      } else {
+        formatPowerValue(content, "Total capacity", datalayer.battery2.info.total_capacity_Wh, "h", 1);
+      }
+
+      if (datalayer.battery.settings.soc_scaling_active) {
+        content += "<h4 style='color: white;'>Scaled remaining capacity: ";
+        formatPowerValue(content, datalayer.battery2.status.reported_remaining_capacity_Wh, "h", 1);
+        content += " (real: ";
+        formatPowerValue(content, datalayer.battery2.status.remaining_capacity_Wh, "h", 1);
+        content += ")</h4>";
+      } else {
+        formatPowerValue(content, "Remaining capacity", datalayer.battery2.status.remaining_capacity_Wh, "h", 1);
+      }
+
+      if (datalayer.system.info.equipment_stop_active) {
+        formatPowerValue(content, "Max discharge power", datalayer.battery2.status.max_discharge_power_W, "", 1, "red");
+        formatPowerValue(content, "Max charge power", datalayer.battery2.status.max_charge_power_W, "", 1, "red");
+        content.printf("<h4 style='color: red;'>Max discharge current: %.1f A</h4>", maxCurrentDischargeFloat);
+        content.printf("<h4 style='color: red;'>Max charge current: %.1f A</h4>", maxCurrentChargeFloat);
+      } else {
+        formatPowerValue(content, "Max discharge power", datalayer.battery2.status.max_discharge_power_W, "", 1);
+        formatPowerValue(content, "Max charge power", datalayer.battery2.status.max_charge_power_W, "", 1);
+        content.printf("<h4 style='color: white;'>Max discharge current: %.1f A</h4>", maxCurrentDischargeFloat);
+        content.printf("<h4 style='color: white;'>Max charge current: %.1f A</h4>", maxCurrentChargeFloat);
+      }
+
+      content.printf("<h4>Cell min/max: %u mV / %u mV</h4>", datalayer.battery2.status.cell_min_voltage_mV,
+                     datalayer.battery2.status.cell_max_voltage_mV);
+      if (cell_delta_mv > datalayer.battery2.info.max_cell_voltage_deviation_mV) {
+        content.printf("<h4 style='color: red;'>Cell delta: %u mV</h4>", cell_delta_mv);
+      } else {
+        content.printf("<h4>Cell delta: %u mV</h4>", cell_delta_mv);
+      }
+      content.printf("<h4>Temperature min/max: %.1f &deg;C / %.1f &deg;C</h4>", tempMinFloat, tempMaxFloat);
+      if (datalayer.battery.status.bms_status == ACTIVE) {
+        content += "<h4>System status: OK </h4>";
+      } else if (datalayer.battery.status.bms_status == UPDATING) {
+        content += "<h4>System status: UPDATING </h4>";
+      } else {
+        content += "<h4>System status: FAULT </h4>";
+      }
+      if (datalayer.battery2.status.current_dA == 0) {
+        content += "<h4>Battery idle</h4>";
+      } else if (datalayer.battery2.status.current_dA < 0) {
+        content += "<h4>Battery discharging!</h4>";
+      } else {  // > 0
+        content += "<h4>Battery charging!</h4>";
+      }
+      content += "</div>";
+      if (battery3) {
+        content += "<div style='flex: 1; background-color: ";
+        switch (datalayer.battery.status.bms_status) {
+          case ACTIVE:
+            content += "#2D3F2F;";
+            break;
+          case FAULT:
+            content += "#A70107;";
+            break;
+          default:
+            content += "#2D3F2F;";
+            break;
+        }
+        // Add the common style properties
+        content += "padding: 10px; margin-bottom: 10px; border-radius: 50px;'>";
+
+        // Display battery statistics within this block
+        socRealFloat =
+            static_cast<float>(datalayer.battery3.status.real_soc) / 100.0f;  // Convert to float and divide by 100
+        //socScaledFloat; // Same value used for bat2
+        sohFloat =
+            static_cast<float>(datalayer.battery3.status.soh_pptt) / 100.0f;  // Convert to float and divide by 100
+        voltageFloat =
+            static_cast<float>(datalayer.battery3.status.voltage_dV) / 10.0f;  // Convert to float and divide by 10
+        currentFloat =
+            static_cast<float>(datalayer.battery3.status.current_dA) / 10.0f;  // Convert to float and divide by 10
+        powerFloat = static_cast<float>(datalayer.battery3.status.active_power_W);                // Convert to float
+        tempMaxFloat = static_cast<float>(datalayer.battery3.status.temperature_max_dC) / 10.0f;  // Convert to float
+        tempMinFloat = static_cast<float>(datalayer.battery3.status.temperature_min_dC) / 10.0f;  // Convert to float
+        cell_delta_mv = datalayer.battery3.status.cell_max_voltage_mV - datalayer.battery3.status.cell_min_voltage_mV;
+
+        if (datalayer.battery.settings.soc_scaling_active)
+          content.printf("<h4 style='color: white;'>Scaled SOC: %.2f&percnt; (real: %.2f&percnt;)</h4>",
+                         socScaledFloat, socRealFloat);
+        else
+          content.printf("<h4 style='color: white;'>SOC: %.2f&percnt;</h4>", socRealFloat);
+
+        content.printf("<h4 style='color: white;'>SOH: %.2f&percnt;</h4>", sohFloat);
+        content.printf("<h4 style='color: white;'>Voltage: %.1f V &nbsp; Current: %.1f A</h4>", voltageFloat,
+                       currentFloat);
+        formatPowerValue(content, "Power", powerFloat, "", 1);
+
+        if (datalayer.battery.settings.soc_scaling_active) {
+          content += "<h4 style='color: white;'>Scaled total capacity: ";
+          formatPowerValue(content, datalayer.battery3.info.reported_total_capacity_Wh, "h", 1);
+          content += " (real: ";
+          formatPowerValue(content, datalayer.battery3.info.total_capacity_Wh, "h", 1);
+          content += ")</h4>";
+        } else {
+          formatPowerValue(content, "Total capacity", datalayer.battery3.info.total_capacity_Wh, "h", 1);
+        }
+
+        if (datalayer.battery.settings.soc_scaling_active) {
+          content += "<h4 style='color: white;'>Scaled remaining capacity: ";
+          formatPowerValue(content, datalayer.battery3.status.reported_remaining_capacity_Wh, "h", 1);
+          content += " (real: ";
+          formatPowerValue(content, datalayer.battery3.status.remaining_capacity_Wh, "h", 1);
+          content += ")</h4>";
+        } else {
+          formatPowerValue(content, "Remaining capacity", datalayer.battery3.status.remaining_capacity_Wh, "h", 1);
+        }
+
+        if (datalayer.system.info.equipment_stop_active) {
+          formatPowerValue(content, "Max discharge power", datalayer.battery3.status.max_discharge_power_W, "", 1,
+                           "red");
+          formatPowerValue(content, "Max charge power", datalayer.battery3.status.max_charge_power_W, "", 1, "red");
+          content.printf("<h4 style='color: red;'>Max discharge current: %.1f A</h4>", maxCurrentDischargeFloat);
+          content.printf("<h4 style='color: red;'>Max charge current: %.1f A</h4>", maxCurrentChargeFloat);
+        } else {
+          formatPowerValue(content, "Max discharge power", datalayer.battery3.status.max_discharge_power_W, "", 1);
+          formatPowerValue(content, "Max charge power", datalayer.battery3.status.max_charge_power_W, "", 1);
+          content.printf("<h4 style='color: white;'>Max discharge current: %.1f A</h4>", maxCurrentDischargeFloat);
+          content.printf("<h4 style='color: white;'>Max charge current: %.1f A</h4>", maxCurrentChargeFloat);
+        }
+
+        content.printf("<h4>Cell min/max: %u mV / %u mV</h4>", datalayer.battery3.status.cell_min_voltage_mV,
+                       datalayer.battery3.status.cell_max_voltage_mV);
+        if (cell_delta_mv > datalayer.battery3.info.max_cell_voltage_deviation_mV) {
+          content.printf("<h4 style='color: red;'>Cell delta: %u mV</h4>", cell_delta_mv);
+        } else {
+          content.printf("<h4>Cell delta: %u mV</h4>", cell_delta_mv);
+        }
+        content.printf("<h4>Temperature min/max: %.1f &deg;C / %.1f &deg;C</h4>", tempMinFloat, tempMaxFloat);
+        if (datalayer.battery.status.bms_status == ACTIVE) {
+          content += "<h4>System status: OK </h4>";
+        } else if (datalayer.battery.status.bms_status == UPDATING) {
+          content += "<h4>System status: UPDATING </h4>";
+        } else {
+          content += "<h4>System status: FAULT </h4>";
+        }
+        if (datalayer.battery3.status.current_dA == 0) {
+          content += "<h4>Battery idle</h4>";
+        } else if (datalayer.battery3.status.current_dA < 0) {
+          content += "<h4>Battery discharging!</h4>";
+        } else {  // > 0
+          content += "<h4>Battery charging!</h4>";
+        }
+        content += "</div>";
+        content += "</div>";
+      }
+      content += "</div>";
+    }
+  }
+}
+
+// Contactor status and what the emulator and inverter allow
+static void render_contactor_info(HtmlWriter& content) {
+  // Block for Contactor status and component request status
+  // Start a new block with gray background color
+  content += "<div style='background-color: #333; padding: 10px; margin-bottom: 10px;border-radius: 50px'>";
+
+  if (emulator_pause_status == NORMAL) {
+    content.printf("<h4>Power status: %s </h4>", get_emulator_pause_status().c_str());
+  } else {
+    content.printf("<h4 style='color: red;'>Power status: %s </h4>", get_emulator_pause_status().c_str());
+  }
+
+  content += "<h4>Emulator allows contactor closing: ";
+  if (datalayer.battery.status.bms_status == FAULT) {
+    content += "<span style='color: red;'>&#10005;</span>";
+  } else {
+    content += "<span>&#10003;</span>";
+  }
+  content += " Inverter allows contactor closing: ";
+  if (datalayer.system.status.inverter_allows_contactor_closing == true) {
+    content += "<span>&#10003;</span></h4>";
+  } else {
+    content += "<span style='color: red;'>&#10005;</span></h4>";
+  }
+  if (battery2) {
+    content += "<h4>Secondary battery allowed to join ";
+    if (datalayer.system.status.battery2_allowed_contactor_closing == true) {
+      content += "<span>&#10003;</span>";
+    } else {
+      content += "<span style='color: red;'>&#10005; (voltage mismatch)</span>";
+    }
+  }
+
+  if (!contactor_control_enabled) {
+    content += "<div class=\"tooltip\">";
+    content += "<h4>Contactors not fully controlled via emulator <span style=\"color:orange\">[?]</span></h4>";
+    content +=
+        "<span class=\"tooltiptext\">This means you are either running CAN controlled contactors OR manually "
+        "powering the contactors. Battery-Emulator will have limited amount of control over the contactors!</span>";
+    content += "</div>";
+  } else {  //contactor_control_enabled TRUE
+    content += "<div class=\"tooltip\"><h4>Contactors controlled by emulator, state: ";
+    if (datalayer.system.status.contactors_engaged == 0) {
+      content += "<span style='color: red;'>OFF (DISCONNECTED)</span>";
+    } else if (datalayer.system.status.contactors_engaged == 1) {
+      content += "<span style='color: green;'>ON</span>";
+    } else if (datalayer.system.status.contactors_engaged == 2) {
+      content += "<span style='color: red;'>OFF (FAULT)</span>";
+      content += "<span class=\"tooltip-icon\"> [!]</span>";
+      content +=
+          "<span class=\"tooltiptext\">Emulator spent too much time in critical FAULT event. Investigate event "
+          "causing this via Events page. Reboot required to resume operation!</span>";
+    } else if (datalayer.system.status.contactors_engaged == 3) {
+      content += "<span style='color: orange;'>PRECHARGE</span>";
+    }
+    content += "</h4></div>";
+    if (contactor_control_enabled_double_battery && battery2) {
+      content += "<h4>Secondary battery contactor, state: ";
+      if (pwm_contactor_control) {
+        if (datalayer.system.status.contactors_battery2_engaged) {
+          content += "<span style='color: green;'>Economized</span>";
+        } else {
+          content += "<span style='color: red;'>OFF</span>";
+        }
+      } else if (
+          esp32hal->SECOND_BATTERY_CONTACTORS_PIN() !=
+          GPIO_NUM_NC) {  // No PWM_CONTACTOR_CONTROL , we can read the pin and see feedback. Helpful if channel overloaded
+        if (digitalRead(esp32hal->SECOND_BATTERY_CONTACTORS_PIN()) == HIGH) {
+          content += "<span style='color: green;'>ON</span>";
+        } else {
+          content += "<span style='color: red;'>OFF</span>";
+        }
+      }  //no PWM_CONTACTOR_CONTROL
+      content += "</h4>";
+    }
+  }
+
+  // Close the block
+  content += "</div>";
+}
+
+// Output of the charger, if one is configured
+static void render_charger_info(HtmlWriter& content) {
+  if (charger) {
+    // Start a new block with orange background color
+    content += "<div style='background-color: #FF6E00; padding: 10px; margin-bottom: 10px;border-radius: 50px'>";
+
+    content += "<h4>Charger HV Enabled: ";
+    if (datalayer.charger.charger_HV_enabled) {
+      content += "<span>&#10003;</span>";
+    } else {
+      content += "<span style='color: red;'>&#10005;</span>";
+    }
+    content += "</h4>";
+
+    content += "<h4>Charger Aux12v Enabled: ";
+    if (datalayer.charger.charger_aux12V_enabled) {
+      content += "<span>&#10003;</span>";
+    } else {
+      content += "<span style='color: red;'>&#10005;</span>";
+    }
+    content += "</h4>";
+
+    auto chgPwrDC = charger->outputPowerDC();
+    auto chgEff = charger->efficiency();
+
+    formatPowerValue(content, "Charger Output Power", chgPwrDC, "", 1);
+    if (charger->efficiencySupported()) {
+      content.printf("<h4 style='color: white;'>Charger Efficiency: %.2f%%</h4>", chgEff);
+    }
+
+    float HVvol = charger->HVDC_output_voltage();
+    float HVcur = charger->HVDC_output_current();
+    float LVvol = charger->LVDC_output_voltage();
+    float LVcur = charger->LVDC_output_current();
+
+    content.printf("<h4 style='color: white;'>Charger HVDC Output V: %.2f V</h4>", HVvol);
+    content.printf("<h4 style='color: white;'>Charger HVDC Output I: %.2f A</h4>", HVcur);
+    content.printf("<h4 style='color: white;'>Charger LVDC Output I: %.2f</h4>", LVcur);
+    content.printf("<h4 style='color: white;'>Charger LVDC Output V: %.2f</h4>", LVvol);
+
+    float ACcur = charger->AC_input_current();
+    float ACvol = charger->AC_input_voltage();
+
+    content.printf("<h4 style='color: white;'>Charger AC Input V: %.2f VAC</h4>", ACvol);
+    content.printf("<h4 style='color: white;'>Charger AC Input I: %.2f A</h4>", ACcur);
+
+    content += "</div>";
+  }
+}
+
+// Buttons to the other pages and actions, with the scripts behind them
+static void render_status_buttons(HtmlWriter& content) {
+  if (emulator_pause_request_ON)
+    content += "<button onclick='PauseBattery(false)'>Resume charge/discharge</button> ";
+  else
+    content +=
+        "<button onclick=\"if(confirm('Are you sure you want to pause charging and discharging? This will set the "
+        "maximum charge and discharge values to zero, preventing any further power flow.')) { PauseBattery(true); "
+        "}\">Pause charge/discharge</button> ";
+
+  content += "<button onclick='OTA()'>Perform OTA update</button> ";
+  content += "<button onclick='Settings()'>Change Settings</button> ";
+  content += "<button onclick='Advanced()'>More Battery Info</button> ";
+  content += "<button onclick='CANlog()'>CAN logger</button> ";
+  content += "<button onclick='CANreplay()'>CAN replay</button> ";
+  if (datalayer.system.info.web_logging_active || datalayer.system.info.SD_logging_active) {
+    content += "<button onclick='Log()'>Log</button> ";
+  }
+  content += "<button onclick='Cellmon()'>Cellmonitor</button> ";
+  content += "<button onclick='Events()'>Events</button> ";
+  content += "<button onclick='askReboot()'>Reboot Emulator</button>";
+  if (webserver_auth)
+    content += "<button onclick='logout()'>Logout</button>";
+  if (!datalayer.system.info.equipment_stop_active)
+    content +=
+        "<br/><button style=\"background:red;color:white;cursor:pointer;\""
+        " onclick=\""
+        "if(confirm('This action will attempt to open contactors on the battery. Are you "
+        "sure?')) { estop(true); }\""
+        ">Open Contactors</button><br/>";
+  else
+    content +=
+        "<br/><button style=\"background:green;color:white;cursor:pointer;\""
+        "20px;font-size:16px;font-weight:bold;cursor:pointer;border-radius:5px; margin:10px;"
+        " onclick=\""
+        "if(confirm('This action will attempt to close contactors and enable power transfer. Are you sure?')) { "
+        "estop(false); }\""
+        ">Close Contactors</button><br/>";
+  content += "<script>";
+  content += "function OTA() { window.location.href = '/update'; }";
+  content += "function Cellmon() { window.location.href = '/cellmonitor'; }";
+  content += "function Settings() { window.location.href = '/settings'; }";
+  content += "function Advanced() { window.location.href = '/advanced'; }";
+  content += "function CANlog() { window.location.href = '/canlog'; }";
+  content += "function CANreplay() { window.location.href = '/canreplay'; }";
+  content += "function Log() { window.location.href = '/log'; }";
+  content += "function Events() { window.location.href = '/events'; }";
+  if (webserver_auth) {
+    content += "function logout() {";
+    content += "  var xhr = new XMLHttpRequest();";
+    content += "  xhr.open('GET', '/logout', true);";
+    content += "  xhr.send();";
+    content += "  setTimeout(function(){ window.open(\"/\",\"_self\"); }, 1000);";
+    content += "}";
+  }
+  content += "function PauseBattery(pause){";
+  content +=
+      "var xhr=new "
+      "XMLHttpRequest();xhr.onload=function() { "
+      "window.location.reload();};xhr.open('GET','/pause?value='+pause,true);xhr.send();";
+  content += "}";
+  content += "function estop(stop){";
+  content +=
+      "var xhr=new "
+      "XMLHttpRequest();xhr.onload=function() { "
+      "window.location.reload();};xhr.open('GET','/equipmentStop?value='+stop,true);xhr.send();";
+  content += "}";
+  content += "</script>";
+
+  //Script for refreshing page
+  content += "<script>";
+  content += "setTimeout(function(){ location.reload(true); }, 15000);";
+  content += "</script>";
+}
+
+void processor(HtmlWriter& content) {
+  content += "<style>";
+  content += "body { background-color: black; color: white; }";
+  content +=
+      "button { background-color: #505E67; color: white; border: none; padding: 10px 20px; margin-bottom: 20px; "
+      "cursor: pointer; border-radius: 10px; }";
+  content += "button:hover { background-color: #3A4A52; }";
+  content += "h2 { font-size: 1.2em; margin: 0.3em 0 0.5em 0; }";
+  content += "h4 { margin: 0.6em 0; line-height: 1.2; }";
+  //content += ".tooltip { position: relative; display: inline-block; }";
+  content += ".tooltip .tooltiptext {";
+  content += "  visibility: hidden;";
+  content += "  width: 200px;";
+  content += "  background-color: #3A4A52;";  // Matching your button hover color
+  content += "  color: white;";
+  content += "  text-align: center;";
+  content += "  border-radius: 6px;";
+  content += "  padding: 8px;";
+  content += "  position: absolute;";
+  content += "  z-index: 1;";
+  content += "  margin-left: -100px;";
+  content += "  opacity: 0;";
+  content += "  transition: opacity 0.3s;";
+  content += "  font-size: 0.9em;";
+  content += "  font-weight: normal;";
+  content += "  line-height: 1.4;";
+  content += "}";
+  content += ".tooltip:hover .tooltiptext { visibility: visible; opacity: 1; }";
+  content += ".tooltip-icon { color: #505E67; cursor: help; }";  // Matching your button color
+  content += "</style>";
+
+  render_system_info(content);
+  render_component_info(content);
+  render_battery_info(content);
+  render_contactor_info(content);
+  render_charger_info(content);
+  render_status_buttons(content);
+}
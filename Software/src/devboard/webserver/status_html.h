@@ -0,0 +1,13 @@
+#ifndef STATUS_HTML_H
+#define STATUS_HTML_H
+
+#include "html_writer.h"
+
+/**
+ * @brief Renders the status section of the main web page
+ *
+ * @param[in] content
+ */
+void processor(HtmlWriter& content);
+
+#endif
@@ -23,6 +23,9 @@ extern uint16_t OBC_Charge_Power;
 // OTA status
 extern bool ota_active;
 
+// Whether the pages ask for the username and password
+extern bool webserver_auth;
+
 /**
  * @brief Initialization function for the webserver.
  *
@@ -50,14 +53,6 @@ void init_webserver();
  */
 void init_ElegantOTA();
 
-/**
- * @brief Replaces placeholder with content section in web page
- *
- * @param[in] var
- *
- * @return String
- */
-String processor(const String& var);
 String get_firmware_info_processor(const String& var);
 
 /**
@@ -88,19 +83,6 @@ void onOTAProgress(size_t current, size_t final);
  */
 void onOTAEnd(bool success);
 
-/**
- * @brief Formats power values 
- *
- * @param[in] float or uint16_t 
- * 
- * @return string: values
- */
-template <typename T>
-String formatPowerValue(String label, T value, String unit, int precision, String color = "white");
-
-template <typename T>  // This function makes power values appear as W when under 1000, and kW when over
-String formatPowerValue(T value, String unit, int precision);
-
 extern void store_settings();
 
 void ota_monitor();
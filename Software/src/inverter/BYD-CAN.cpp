@@ -95,7 +95,7 @@ void BydCanInverter::
   BYD_250.data.u8[5] = (uint8_t)(datalayer.battery.info.reported_total_capacity_Wh / 100);
 }
 
-void BydCanInverter::map_can_frame_to_variable(CAN_frame rx_frame) {
+void BydCanInverter::map_can_frame_to_variable(const CAN_frame& rx_frame) {
   switch (rx_frame.ID) {
     case 0x151:  //Message originating from BYD HVS compatible inverter. Reply with CAN identifier!
       inverterStartedUp = true;
@@ -144,6 +144,17 @@ void BydCanInverter::map_can_frame_to_variable(CAN_frame rx_frame) {
   }
 }
 
+BydCanInverter::BydCanInverter() {
+  // Cyclic messages only start once the initial data has gone out, see transmit_can
+  auto after_initial_data = [this](CAN_frame*) { return initialDataSent; };
+
+  schedule_can_frame(&BYD_110, INTERVAL_2_S, after_initial_data);   //Send Limits
+  schedule_can_frame(&BYD_150, INTERVAL_10_S, after_initial_data);  //Send States
+  schedule_can_frame(&BYD_1D0, INTERVAL_10_S, after_initial_data);  //Send Battery Info
+  schedule_can_frame(&BYD_210, INTERVAL_10_S, after_initial_data);  //Send Cell Info
+  schedule_can_frame(&BYD_190, INTERVAL_60_S, after_initial_data);  //Send Alarm
+}
+
 void BydCanInverter::transmit_can(unsigned long currentMillis) {
 
   if (!inverterStartedUp) {
@@ -154,29 +165,14 @@ void BydCanInverter::transmit_can(unsigned long currentMillis) {
   // Send initial CAN data once on bootup
   if (!initialDataSent) {
     send_initial_data();
+    // Send the cyclic messages right away as well, the scheduler continues from here
+    transmit_can_frame(&BYD_110);
+    transmit_can_frame(&BYD_150);
+    transmit_can_frame(&BYD_1D0);
+    transmit_can_frame(&BYD_210);
+    transmit_can_frame(&BYD_190);
     initialDataSent = true;
   }
-
-  // Send 2s CAN Message
-  if (currentMillis - previousMillis2s >= INTERVAL_2_S) {
-    previousMillis2s = currentMillis;
-
-    transmit_can_frame(&BYD_110);  //Send Limits
-  }
-  // Send 10s CAN Message
-  if (currentMillis - previousMillis10s >= INTERVAL_10_S) {
-    previousMillis10s = currentMillis;
-
-    transmit_can_frame(&BYD_150);  //Send States
-    transmit_can_frame(&BYD_1D0);  //Send Battery Info
-    transmit_can_frame(&BYD_210);  //Send Cell Info
-  }
-  //Send 60s message
-  if (currentMillis - previousMillis60s >= INTERVAL_60_S) {
-    previousMillis60s = currentMillis;
-
-    transmit_can_frame(&BYD_190);  //Send Alarm
-  }
 }
 
 void BydCanInverter::send_initial_data() {
@@ -6,9 +6,10 @@
 
 class BydCanInverter : public CanInverterProtocol {
  public:
+  BydCanInverter();
   const char* name() override { return Name; }
   void transmit_can(unsigned long currentMillis);
-  void map_can_frame_to_variable(CAN_frame rx_frame);
+  void map_can_frame_to_variable(const CAN_frame& rx_frame);
   void update_values();
   bool provides_shunt() { return true; }
   void enable_shunt();
@@ -16,9 +17,6 @@ class BydCanInverter : public CanInverterProtocol {
 
  private:
   void send_initial_data();
-  unsigned long previousMillis2s = 0;   // will store last time a 2s CAN Message was send
-  unsigned long previousMillis10s = 0;  // will store last time a 10s CAN Message was send
-  unsigned long previousMillis60s = 0;  // will store last time a 60s CAN Message was send
   unsigned long inverter_timestamp = 0;
   uint16_t remaining_capacity_ah = 0;
   uint16_t fully_charged_capacity_ah = 0;
@@ -6,7 +6,7 @@
 
 class BydModbusInverter : public ModbusInverterProtocol {
  public:
-  BydModbusInverter() : ModbusInverterProtocol(21) {}
+  BydModbusInverter();
   const char* name() override { return Name; }
   bool setup() override;
   void update_values();
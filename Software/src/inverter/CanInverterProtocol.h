@@ -3,6 +3,7 @@
 
 #include "../communication/Transmitter.h"
 #include "../communication/can/CanReceiver.h"
+#include "../communication/can/CanTxScheduler.h"
 #include "../communication/can/comm_can.h"
 #include "../devboard/safety/safety.h"
 #include "../devboard/utils/logging.h"
@@ -14,8 +15,9 @@ class CanInverterProtocol : public InverterProtocol, Transmitter, CanReceiver {
   virtual const char* interface_name() { return getCANInterfaceName(can_interface); }
   InverterInterfaceType interface_type() { return InverterInterfaceType::Can; }
 
-  virtual void transmit_can(unsigned long currentMillis) = 0;
-  virtual void map_can_frame_to_variable(CAN_frame rx_frame) = 0;
+  // Protocols that only send scheduled frames (see schedule_can_frame) or replies don't need to override this
+  virtual void transmit_can(unsigned long /*currentMillis*/) {}
+  virtual void map_can_frame_to_variable(const CAN_frame& rx_frame) = 0;
 
   void transmit(unsigned long currentMillis) {
     if (allowed_to_send_CAN) {
@@ -23,7 +25,7 @@ class CanInverterProtocol : public InverterProtocol, Transmitter, CanReceiver {
     }
   }
 
-  void receive_can_frame(CAN_frame* frame) { map_can_frame_to_variable(*frame); }
+  void receive_can_frame(const CAN_frame* frame) { map_can_frame_to_variable(*frame); }
 
  protected:
   CAN_Interface can_interface;
@@ -40,6 +42,11 @@ class CanInverterProtocol : public InverterProtocol, Transmitter, CanReceiver {
   }
 
   void transmit_can_frame(CAN_frame* frame) { transmit_can_frame_to_interface(frame, can_interface); }
+
+  // Let the central CAN TX scheduler send frame every period_ms (see CanTxScheduler.h)
+  void schedule_can_frame(CAN_frame* frame, uint32_t period_ms, CanTxScheduler::RefreshCallback refresh = nullptr) {
+    can_tx_scheduler.add(frame, can_interface, period_ms, refresh);
+  }
 };
 
 #endif
@@ -579,7 +579,7 @@ void GrowattWitInverter::update_values() {
   // Will be sent in transmit_can when triggered
 }
 
-void GrowattWitInverter::map_can_frame_to_variable(CAN_frame rx_frame) {
+void GrowattWitInverter::map_can_frame_to_variable(const CAN_frame& rx_frame) {
   // Validate extended frame (29-bit ID required for Growatt WIT protocol)
   if (!rx_frame.ext_ID) {
     return;  // Ignore standard 11-bit frames
@@ -678,69 +678,34 @@ void GrowattWitInverter::map_can_frame_to_variable(CAN_frame rx_frame) {
   }
 }
 
-void GrowattWitInverter::transmit_can(unsigned long currentMillis) {
-
+GrowattWitInverter::GrowattWitInverter() {
   // Don't send until inverter is alive (has sent heartbeat)
-  if (!inverter_alive) {
-    return;
-  }
-
-  /* ============================================================
-   * 100ms messages (Basic functions - Required)
-   * ============================================================ */
-  if (currentMillis - previousMillis100ms >= INTERVAL_100_MS) {
-    previousMillis100ms = currentMillis;
-
-    // Basic required messages
-    transmit_can_frame(&GROWATT_1AC3);  // Current/Voltage limits
-    transmit_can_frame(&GROWATT_1AC4);  // CV voltage
-    transmit_can_frame(&GROWATT_1AC5);  // Working status
-    transmit_can_frame(&GROWATT_1AC7);  // Voltage/Current
-
-    // Optional monitoring - Cell voltages
-    transmit_can_frame(&GROWATT_1ACE);  // Max cell voltage
-    transmit_can_frame(&GROWATT_1ACF);  // Min cell voltage
-
-    // Optional monitoring - Fault information
-    transmit_can_frame(&GROWATT_1AD8);  // Fault info 3
-    transmit_can_frame(&GROWATT_1AD9);  // Fault info 4
-  }
-
-  /* ============================================================
-   * 500ms messages
-   * ============================================================ */
-  if (currentMillis - previousMillis500ms >= INTERVAL_500_MS) {
-    previousMillis500ms = currentMillis;
-
-    transmit_can_frame(&GROWATT_1AC6);  // SOC/SOH/Capacity
-    transmit_can_frame(&GROWATT_1AC8);  // Software version
-  }
-
-  /* ============================================================
-   * 1000ms messages
-   * ============================================================ */
-  if (currentMillis - previousMillis1000ms >= INTERVAL_1_S) {
-    previousMillis1000ms = currentMillis;
-
-    // Module voltage info
-    transmit_can_frame(&GROWATT_1AC9);  // Max module voltage
-    transmit_can_frame(&GROWATT_1ACA);  // Min module voltage
-
-    // Temperature info
-    transmit_can_frame(&GROWATT_1ACC);  // Max cell temperature
-    transmit_can_frame(&GROWATT_1ACD);  // Min cell temperature
-
-    // Cluster and energy info
-    transmit_can_frame(&GROWATT_1AD0);  // Cluster SOC info
-    transmit_can_frame(&GROWATT_1AD1);  // Cumulative energy
-  }
-
-  /* ============================================================
-   * 2000ms messages
-   * ============================================================ */
-  if (currentMillis - previousMillis2000ms >= INTERVAL_2_S) {
-    previousMillis2000ms = currentMillis;
-
-    transmit_can_frame(&GROWATT_1AC0);  // System composition
-  }
+  auto when_alive = [this](CAN_frame*) { return inverter_alive; };
+
+  // 100ms messages (Basic functions - Required)
+  schedule_can_frame(&GROWATT_1AC3, INTERVAL_100_MS, when_alive);  // Current/Voltage limits
+  schedule_can_frame(&GROWATT_1AC4, INTERVAL_100_MS, when_alive);  // CV voltage
+  schedule_can_frame(&GROWATT_1AC5, INTERVAL_100_MS, when_alive);  // Working status
+  schedule_can_frame(&GROWATT_1AC7, INTERVAL_100_MS, when_alive);  // Voltage/Current
+  // Optional monitoring - Cell voltages
+  schedule_can_frame(&GROWATT_1ACE, INTERVAL_100_MS, when_alive);  // Max cell voltage
+  schedule_can_frame(&GROWATT_1ACF, INTERVAL_100_MS, when_alive);  // Min cell voltage
+  // Optional monitoring - Fault information
+  schedule_can_frame(&GROWATT_1AD8, INTERVAL_100_MS, when_alive);  // Fault info 3
+  schedule_can_frame(&GROWATT_1AD9, INTERVAL_100_MS, when_alive);  // Fault info 4
+
+  // 500ms messages
+  schedule_can_frame(&GROWATT_1AC6, INTERVAL_500_MS, when_alive);  // SOC/SOH/Capacity
+  schedule_can_frame(&GROWATT_1AC8, INTERVAL_500_MS, when_alive);  // Software version
+
+  // 1000ms messages
+  schedule_can_frame(&GROWATT_1AC9, INTERVAL_1_S, when_alive);  // Max module voltage
+  schedule_can_frame(&GROWATT_1ACA, INTERVAL_1_S, when_alive);  // Min module voltage
+  schedule_can_frame(&GROWATT_1ACC, INTERVAL_1_S, when_alive);  // Max cell temperature
+  schedule_can_frame(&GROWATT_1ACD, INTERVAL_1_S, when_alive);  // Min cell temperature
+  schedule_can_frame(&GROWATT_1AD0, INTERVAL_1_S, when_alive);  // Cluster SOC info
+  schedule_can_frame(&GROWATT_1AD1, INTERVAL_1_S, when_alive);  // Cumulative energy
+
+  // 2000ms messages
+  schedule_can_frame(&GROWATT_1AC0, INTERVAL_2_S, when_alive);  // System composition
 }
@@ -35,22 +35,16 @@
 
 class GrowattWitInverter : public CanInverterProtocol {
  public:
+  GrowattWitInverter();
   const char* name() override { return Name; }
   void update_values();
-  void transmit_can(unsigned long currentMillis);
-  void map_can_frame_to_variable(CAN_frame rx_frame);
+  void map_can_frame_to_variable(const CAN_frame& rx_frame);
   static constexpr const char* Name = "Growatt WIT compatible battery via CAN";
 
  private:
   // Helper to extract FSN from 29-bit CAN ID
   uint8_t get_fsn_from_id(uint32_t can_id) { return (can_id >> 16) & 0xFF; }
 
-  // Timing variables
-  unsigned long previousMillis100ms = 0;
-  unsigned long previousMillis500ms = 0;
-  unsigned long previousMillis1000ms = 0;
-  unsigned long previousMillis2000ms = 0;
-
   uint16_t pcs_frame_count = 0;
   uint16_t pcs_bus_voltage_dV = 0;
   uint8_t pcs_working_status = 0;
@@ -80,20 +80,20 @@ static uint8_t calculate_kostal_crc(byte* lfc, int len) {
   return (uint8_t)(-sum & 0xff);
 }
 
-bool KostalInverterProtocol::check_kostal_frame_crc(int len) {
+bool KostalInverterProtocol::check_kostal_frame_crc(uint8_t* frame, int len) {
   unsigned int sum = 0;
-  int zeropointer = RS485_RXFRAME[0];
+  int zeropointer = frame[0];
   int last_zero = 0;
   for (int i = 1; i < len - 2; ++i) {
     if (i == zeropointer + last_zero) {
-      zeropointer = RS485_RXFRAME[i];
+      zeropointer = frame[i];
       last_zero = i;
-      RS485_RXFRAME[i] = 0x00;
+      frame[i] = 0x00;
     }
-    sum += RS485_RXFRAME[i];
+    sum += frame[i];
   }
 
-  if ((-sum & 0xff) == (RS485_RXFRAME[len - 2] & 0xff)) {
+  if ((-sum & 0xff) == (frame[len - 2] & 0xff)) {
     return (true);
   } else {
     return (false);
@@ -218,96 +218,99 @@ void KostalInverterProtocol::receive()  // Runs as fast as possible to handle th
     RX_allow = true;
   }
 
-  if (Serial2.available()) {
-    RS485_RXFRAME[rx_index] = Serial2.read();
-    if (RX_allow) {
-      rx_index++;
-      if (RS485_RXFRAME[rx_index - 1] == 0x00) {
-        if ((rx_index > 9) && register_content_ok) {
-          dbg_frame(RS485_RXFRAME, 10, "RX");
-          if (check_kostal_frame_crc(rx_index)) {
-            incoming_message_counter = RS485_HEALTHY;
-
-            if (RS485_RXFRAME[1] == 'c' && info_sent) {
-              if (RS485_RXFRAME[6] == 0x47) {
-                // Set time function - Do nothing.
-                send_kostal(ACK_FRAME, 8);  // ACK
-              }
-              if (RS485_RXFRAME[6] == 0x5E) {
-                // Set State function
-                if (RS485_RXFRAME[7] == 0x00) {
-                  // Allow contactor closing
-                  setInverterAllowsContactorClosing(true);
-                  dbg_message("inverter_allows_contactor_closing -> true (5E 02)");
-                  send_kostal(ACK_FRAME, 8);  // ACK
-                } else if (RS485_RXFRAME[7] == 0x04) {
-                  // contactor test STATE, ACK sent
-                  setInverterAllowsContactorClosing(false);
-                  dbg_message("inverter_allows_contactor_closing -> false (Contactor test start)");
-                  send_kostal(ACK_FRAME, 8);  // ACK
-                  contactortestTimerStart = currentMillis;
-                  contactortestTimerActive = true;
-                } else if (RS485_RXFRAME[7] == 0xFF) {
-                  // no ACK sent
-                } else {
-                  // Battery deep sleep?
-                  send_kostal(ACK_FRAME, 8);  // ACK
-                }
-              }
-            } else if (RS485_RXFRAME[1] == 'b') {
-              if (RS485_RXFRAME[6] == 0x50) {
-                //Reverse polarity, do nothing
-              } else {
-                int code = RS485_RXFRAME[6] + RS485_RXFRAME[7] * 0x100;
-                if (code == 0x44a && info_sent) {
-                  //Send cyclic data
-                  // TODO: Probably not a good idea to use the battery object here like this.
-                  if (battery) {
-                    battery->update_values();
-                  }
-                  update_values();
-                  if (f2_startup_count < 15) {
-                    f2_startup_count++;
-                  }
-                  uint8_t tmpframe[64];  //copy values to prevent data manipulation during rewrite/crc calculation
-                  memcpy(tmpframe, CYCLIC_DATA, 64);
-                  tmpframe[62] = calculate_kostal_crc(tmpframe, 62);
-                  null_stuffer(tmpframe, 64);
-                  send_kostal(tmpframe, 64);
-                  CYCLIC_DATA[61] = 0x00;
-                }
-                if (code == 0x84a) {
-                  //Send  battery info
-                  uint8_t tmpframe[40];  //copy values to prevent data manipulation during rewrite/crc calculation
-                  memcpy(tmpframe, BATTERY_INFO, 40);
-                  tmpframe[38] = calculate_kostal_crc(tmpframe, 38);
-                  null_stuffer(tmpframe, 40);
-                  send_kostal(tmpframe, 40);
-                  setInverterAllowsContactorClosing(false);
-                  dbg_message("inverter_allows_contactor_closing -> false (battery info sent)");
-                  info_sent = true;
-                  if (!startupMillis) {
-                    startupMillis = currentMillis;
-                  }
-                }
-                if (code == 0x353 && info_sent) {
-                  //Send  battery error/status
-                  uint8_t tmpframe[9];  //copy values to prevent data manipulation during rewrite/crc calculation
-                  memcpy(tmpframe, STATUS_FRAME, 9);
-                  tmpframe[7] = calculate_kostal_crc(tmpframe, 7);
-                  null_stuffer(tmpframe, 9);
-                  send_kostal(tmpframe, 9);
-                }
-              }
-            }
-          }
-          rx_index = 0;
-        }
-        rx_index = 0;
+  if (!RX_allow) {
+    // Nothing the inverter sends before that is answered
+    while (Serial2.available()) {
+      Serial2.read();
+    }
+    return;
+  }
+
+  // All frames that arrived since the last call, so an answer goes out in the same tick
+  while (read_rs485_frame(rx_framer)) {
+    if ((rx_framer.length() > 9) && register_content_ok) {
+      handle_frame(rx_framer.frame(), rx_framer.length());
+    }
+  }
+}
+
+void KostalInverterProtocol::handle_frame(uint8_t* frame, int len) {
+  dbg_frame(frame, 10, "RX");
+  if (!check_kostal_frame_crc(frame, len)) {
+    return;
+  }
+  incoming_message_counter = RS485_HEALTHY;
+
+  if (frame[1] == 'c' && info_sent) {
+    if (frame[6] == 0x47) {
+      // Set time function - Do nothing.
+      send_kostal(ACK_FRAME, 8);  // ACK
+    }
+    if (frame[6] == 0x5E) {
+      // Set State function
+      if (frame[7] == 0x00) {
+        // Allow contactor closing
+        setInverterAllowsContactorClosing(true);
+        dbg_message("inverter_allows_contactor_closing -> true (5E 02)");
+        send_kostal(ACK_FRAME, 8);  // ACK
+      } else if (frame[7] == 0x04) {
+        // contactor test STATE, ACK sent
+        setInverterAllowsContactorClosing(false);
+        dbg_message("inverter_allows_contactor_closing -> false (Contactor test start)");
+        send_kostal(ACK_FRAME, 8);  // ACK
+        contactortestTimerStart = currentMillis;
+        contactortestTimerActive = true;
+      } else if (frame[7] == 0xFF) {
+        // no ACK sent
+      } else {
+        // Battery deep sleep?
+        send_kostal(ACK_FRAME, 8);  // ACK
       }
     }
-    if (rx_index >= 299) {
-      rx_index = 0;
+  } else if (frame[1] == 'b') {
+    if (frame[6] == 0x50) {
+      //Reverse polarity, do nothing
+    } else {
+      int code = frame[6] + frame[7] * 0x100;
+      if (code == 0x44a && info_sent) {
+        //Send cyclic data
+        // TODO: Probably not a good idea to use the battery object here like this.
+        if (battery) {
+          battery->update_values();
+        }
+        update_values();
+        if (f2_startup_count < 15) {
+          f2_startup_count++;
+        }
+        uint8_t tmpframe[64];  //copy values to prevent data manipulation during rewrite/crc calculation
+        memcpy(tmpframe, CYCLIC_DATA, 64);
+        tmpframe[62] = calculate_kostal_crc(tmpframe, 62);
+        null_stuffer(tmpframe, 64);
+        send_kostal(tmpframe, 64);
+        CYCLIC_DATA[61] = 0x00;
+      }
+      if (code == 0x84a) {
+        //Send  battery info
+        uint8_t tmpframe[40];  //copy values to prevent data manipulation during rewrite/crc calculation
+        memcpy(tmpframe, BATTERY_INFO, 40);
+        tmpframe[38] = calculate_kostal_crc(tmpframe, 38);
+        null_stuffer(tmpframe, 40);
+        send_kostal(tmpframe, 40);
+        setInverterAllowsContactorClosing(false);
+        dbg_message("inverter_allows_contactor_closing -> false (battery info sent)");
+        info_sent = true;
+        if (!startupMillis) {
+          startupMillis = currentMillis;
+        }
+      }
+      if (code == 0x353 && info_sent) {
+        //Send  battery error/status
+        uint8_t tmpframe[9];  //copy values to prevent data manipulation during rewrite/crc calculation
+        memcpy(tmpframe, STATUS_FRAME, 9);
+        tmpframe[7] = calculate_kostal_crc(tmpframe, 7);
+        null_stuffer(tmpframe, 9);
+        send_kostal(tmpframe, 9);
+      }
     }
   }
 }
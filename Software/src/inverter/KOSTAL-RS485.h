@@ -14,7 +14,8 @@ class KostalInverterProtocol : public Rs485InverterProtocol {
  private:
   int baud_rate() { return 57600; }
   void float2frame(uint8_t* arr, float value, uint8_t framepointer);
-  bool check_kostal_frame_crc(int len);
+  bool check_kostal_frame_crc(uint8_t* frame, int len);
+  void handle_frame(uint8_t* frame, int len);
   /* How many value updates we can go without inverter gets reported as missing
   e.g. value set to 12, 12*5sec=60seconds without comm before event is raised */
   const int RS485_HEALTHY = 12;
@@ -33,7 +34,6 @@ class KostalInverterProtocol : public Rs485InverterProtocol {
   unsigned long contactortestTimerStart = 0;
   bool contactortestTimerActive = false;
 
-  uint16_t rx_index = 0;
   bool RX_allow = false;
 
   union f32b {
@@ -105,7 +105,7 @@ uint8_t CYCLIC_DATA[64] = {
 
   uint8_t ACK_FRAME[8] = {0x07, 0xE3, 0xFF, 0x02, 0xFF, 0x29, 0xF4, 0x00};
 
-  uint8_t RS485_RXFRAME[300];
+  DelimitedRs485Framer<300> rx_framer{0x00};
 
   bool register_content_ok = false;
 };
@@ -36,6 +36,12 @@ ModbusMessage ModbusInverterProtocol::FC03(ModbusMessage request) {
   request.get(2, addr);    // read address from request
   request.get(4, words);   // read # of words from request
 
+  // # of registers proper?
+  if (words > MAX_READ_WORDS) {
+    response.setError(request.getServerID(), request.getFunctionCode(), ILLEGAL_DATA_VALUE);
+    logging.printf("Modbus FC03 error: bad registers addr=%d words=%d\n", addr, words);
+    return response;
+  }
   // Address overflow?
   if ((addr + words) > MBPV_MAX) {
     // Yes - send respective error response
@@ -44,12 +50,11 @@ ModbusMessage ModbusInverterProtocol::FC03(ModbusMessage request) {
     return response;
   }
 
-  // Set up response
+  // Set up response, the registers are already in Modbus byte order
+  uint8_t values[MAX_READ_WORDS * 2];
+  mbPV.read(addr, words, values);
   response.add(request.getServerID(), request.getFunctionCode(), (uint8_t)(words * 2));
-  for (uint8_t i = 0; i < words; ++i) {
-    // send increasing data values
-    response.add((uint16_t)(mbPV[addr + i]));
-  }
+  response.add(values, words * 2);
 
   return response;
 }
@@ -71,10 +76,10 @@ ModbusMessage ModbusInverterProtocol::FC06(ModbusMessage request) {
   }
 
   // Do the write
-  mbPV[addr] = val;
+  mbPV.set(addr, val);
 
   // Set up response
-  response.add(request.getServerID(), request.getFunctionCode(), mbPV[addr]);
+  response.add(request.getServerID(), request.getFunctionCode(), val);
   return response;
 }
 
@@ -84,7 +89,6 @@ ModbusMessage ModbusInverterProtocol::FC16(ModbusMessage request) {
   uint16_t addr = 0;       // Start address
   uint16_t words = 0;      // total words to write
   uint8_t bytes = 0;       // # of data bytes in request
-  uint16_t val = 0;        // value to be written
   request.get(2, addr);    // read address from request
   request.get(4, words);   // read # of words from request
   request.get(6, bytes);   // read # of data bytes from request (seems redundant with # of words)
@@ -106,10 +110,11 @@ ModbusMessage ModbusInverterProtocol::FC16(ModbusMessage request) {
   }
 
   // Do the writes
+  uint16_t values[123];
   for (uint8_t i = 0; i < words; ++i) {
-    request.get(7 + (i * 2), val);  //data starts at byte 6 in request packet
-    mbPV[addr + i] = val;
+    request.get(7 + (i * 2), values[i]);  //data starts at byte 6 in request packet
   }
+  mbPV.set(addr, values, words);
 
   // Set up response
   response.add(request.getServerID(), request.getFunctionCode(), addr, words);
@@ -124,7 +129,6 @@ ModbusMessage ModbusInverterProtocol::FC23(ModbusMessage request) {
   uint16_t write_addr = 0;       // Start address for write
   uint16_t write_words = 0;      // total words to write
   uint8_t write_bytes = 0;       // # of data bytes in write request
-  uint16_t write_val = 0;        // value to be written
   request.get(2, read_addr);     // read address from request
   request.get(4, read_words);    // read # of words from request
   request.get(6, write_addr);    // read address from request
@@ -135,7 +139,7 @@ ModbusMessage ModbusInverterProtocol::FC23(ModbusMessage request) {
   // # of registers proper?
   if ((write_bytes != (write_words * 2))  // byte count in request must match # of words in request
       || (write_words > 121)              // can't fit more than this in the packet for FC23
-      || (read_words > 125))              // can't fit more than this in the response packet
+      || (read_words > MAX_READ_WORDS))   // can't fit more than this in the response packet
   {                                       // Yes - send respective error response
     response.setError(request.getServerID(), request.getFunctionCode(), ILLEGAL_DATA_VALUE);
     logging.printf("Modbus FC23 error: bad registers write_addr=%d write_words=%d write_bytes=%d read_words=%d\n",
@@ -153,18 +157,18 @@ ModbusMessage ModbusInverterProtocol::FC23(ModbusMessage request) {
 
   //WRITE SECTION  - write is done before read for FC23
   // Do the writes
+  uint16_t write_values[121];
   for (uint8_t i = 0; i < write_words; ++i) {
-    request.get(11 + (i * 2), write_val);  //data starts at byte 6 in request packet
-    mbPV[write_addr + i] = write_val;
+    request.get(11 + (i * 2), write_values[i]);  //data starts at byte 6 in request packet
   }
+  mbPV.set(write_addr, write_values, write_words);
 
   // READ SECTION
   // Set up response
+  uint8_t read_values[MAX_READ_WORDS * 2];
+  mbPV.read(read_addr, read_words, read_values);
   response.add(request.getServerID(), request.getFunctionCode(), (uint8_t)(read_words * 2));
-  for (uint8_t i = 0; i < read_words; ++i) {
-    // send increasing data values
-    response.add((uint16_t)(mbPV[read_addr + i]));
-  }
+  response.add(read_values, read_words * 2);
 
   return response;
 }
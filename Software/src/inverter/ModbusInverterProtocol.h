@@ -4,11 +4,11 @@
 #include "../lib/eModbus-eModbus/ModbusMessage.h"
 #include "../lib/eModbus-eModbus/ModbusServerRTU.h"
 #include "InverterProtocol.h"
+#include "ModbusRegisterFile.h"
 
 #include <HardwareSerial.h>
 
 #include <stdint.h>
-#include <map>
 
 // The abstract base class for all Modbus inverter protocols
 class ModbusInverterProtocol : public InverterProtocol {
@@ -26,10 +26,12 @@ class ModbusInverterProtocol : public InverterProtocol {
 
   // The highest Modbus register we allow reads/writes from
   static const int MBPV_MAX = 30000;
+  // Most registers in one read response
+  static const int MAX_READ_WORDS = 125;
   // The Modbus server ID we respond to
   int _serverId;
-  // The Modbus registers themselves
-  std::map<uint16_t, uint16_t> mbPV;
+  // The Modbus registers themselves, the protocol defines which blocks exist
+  ModbusRegisterFile mbPV;
 
   ModbusServerRTU MBserver;
 };
@@ -0,0 +1,100 @@
+#include "ModbusRegisterFile.h"
+#include <string.h>
+#include <algorithm>
+
+bool ModbusRegisterFile::define_block(uint16_t start, uint16_t count) {
+  if (count == 0 || block_count >= MODBUS_REGISTER_BLOCKS || used + count > MODBUS_REGISTER_FILE_SIZE ||
+      start + count > 0x10000) {
+    return false;
+  }
+  for (int i = 0; i < block_count; i++) {
+    if (start < blocks[i].start + blocks[i].count && blocks[i].start < start + count) {
+      return false;
+    }
+  }
+  blocks[block_count++] = {start, count, used};
+  used += count;
+  return true;
+}
+
+// There are only a handful of blocks, a scan is quicker than any index on top of them
+int ModbusRegisterFile::find_block(uint16_t address) const {
+  for (int i = 0; i < block_count; i++) {
+    if (address >= blocks[i].start && address - blocks[i].start < blocks[i].count) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+void ModbusRegisterFile::begin_write() {
+  uint32_t current = sequence.load(std::memory_order_relaxed);
+  // Wait for a write on the other core to finish, then make the sequence odd
+  while ((current & 1) ||
+         !sequence.compare_exchange_weak(current, current + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+    current = sequence.load(std::memory_order_relaxed);
+  }
+  std::atomic_thread_fence(std::memory_order_release);
+}
+
+void ModbusRegisterFile::end_write() {
+  sequence.fetch_add(1, std::memory_order_release);
+}
+
+bool ModbusRegisterFile::store(uint16_t address, const uint16_t* values, uint16_t count) {
+  bool complete = true;
+  for (uint16_t i = 0; i < count; i++) {
+    int block = find_block(address + i);
+    if (block < 0) {
+      complete = false;
+      continue;
+    }
+    uint8_t* bytes = &data[(blocks[block].offset + (address + i - blocks[block].start)) * 2];
+    bytes[0] = values[i] >> 8;
+    bytes[1] = values[i] & 0xFF;
+  }
+  return complete;
+}
+
+bool ModbusRegisterFile::set(uint16_t address, uint16_t value) {
+  return set(address, &value, 1);
+}
+
+bool ModbusRegisterFile::set(uint16_t address, const uint16_t* values, uint16_t count) {
+  Update update(*this);
+  return update.set(address, values, count);
+}
+
+void ModbusRegisterFile::copy_out(uint16_t address, uint16_t count, uint8_t* bytes) const {
+  memset(bytes, 0, count * 2);
+  uint32_t end = address + count;
+  for (int i = 0; i < block_count; i++) {
+    const Block& block = blocks[i];
+    uint32_t first = std::max<uint32_t>(address, block.start);
+    uint32_t last = std::min<uint32_t>(end, block.start + block.count);
+    if (first < last) {
+      memcpy(&bytes[(first - address) * 2], &data[(block.offset + first - block.start) * 2], (last - first) * 2);
+    }
+  }
+}
+
+void ModbusRegisterFile::read(uint16_t address, uint16_t count, uint8_t* bytes) const {
+  uint32_t before;
+  uint32_t after;
+  do {
+    before = sequence.load(std::memory_order_acquire);
+    if (before & 1) {
+      after = before + 1;  // Write in progress, try again
+      continue;
+    }
+    copy_out(address, count, bytes);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    after = sequence.load(std::memory_order_relaxed);
+  } while (before != after);
+}
+
+uint16_t ModbusRegisterFile::get(uint16_t address) const {
+  uint8_t bytes[2];
+  read(address, 1, bytes);
+  return (bytes[0] << 8) | bytes[1];
+}
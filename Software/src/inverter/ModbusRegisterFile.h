@@ -0,0 +1,76 @@
+#ifndef MODBUS_REGISTER_FILE_H
+#define MODBUS_REGISTER_FILE_H
+
+#include <stdint.h>
+#include <atomic>
+
+// Total number of registers over all blocks
+#ifndef MODBUS_REGISTER_FILE_SIZE
+#define MODBUS_REGISTER_FILE_SIZE 256
+#endif
+
+#ifndef MODBUS_REGISTER_BLOCKS
+#define MODBUS_REGISTER_BLOCKS 8
+#endif
+
+// Holding registers of a Modbus server, stored as a few contiguous blocks.
+//
+// An inverter protocol defines the address ranges it serves once. The registers
+// of a block are kept next to each other in Modbus byte order, so a multi-register
+// read is one memcpy per block it touches and nothing is allocated. Addresses
+// outside the blocks read as 0 and writes to them are dropped.
+//
+// update_values() on the core task writes the registers while the Modbus server
+// task reads them, the two run on different cores. Writers take turns through a
+// sequence counter, readers copy without locking and retry when a write happened
+// in the meantime (a seqlock), so a multi-register read never sees half an update.
+class ModbusRegisterFile {
+ public:
+  // Writes several registers as one update, readers see all of them change at once
+  class Update {
+   public:
+    explicit Update(ModbusRegisterFile& file) : file(file) { file.begin_write(); }
+    ~Update() { file.end_write(); }
+    Update(const Update&) = delete;
+    Update& operator=(const Update&) = delete;
+
+    bool set(uint16_t address, uint16_t value) { return file.store(address, &value, 1); }
+    bool set(uint16_t address, const uint16_t* values, uint16_t count) { return file.store(address, values, count); }
+
+   private:
+    ModbusRegisterFile& file;
+  };
+
+  // Add the registers start..start+count-1. Returns false if they do not fit or overlap a block.
+  bool define_block(uint16_t start, uint16_t count);
+  bool defined(uint16_t address) const { return find_block(address) >= 0; }
+
+  // Returns false if (part of) the range is outside the defined blocks
+  bool set(uint16_t address, uint16_t value);
+  bool set(uint16_t address, const uint16_t* values, uint16_t count);
+
+  uint16_t get(uint16_t address) const;
+  // Copy count registers, two bytes each with the high byte first, as in a Modbus response
+  void read(uint16_t address, uint16_t count, uint8_t* bytes) const;
+
+ private:
+  struct Block {
+    uint16_t start;
+    uint16_t count;
+    uint16_t offset;  // Index of the first register in data
+  };
+
+  int find_block(uint16_t address) const;
+  void begin_write();
+  void end_write();
+  bool store(uint16_t address, const uint16_t* values, uint16_t count);
+  void copy_out(uint16_t address, uint16_t count, uint8_t* bytes) const;
+
+  Block blocks[MODBUS_REGISTER_BLOCKS];
+  uint8_t block_count = 0;
+  uint16_t used = 0;
+  uint8_t data[MODBUS_REGISTER_FILE_SIZE * 2] = {0};
+  std::atomic<uint32_t> sequence{0};  // Odd while a write is in progress
+};
+
+#endif
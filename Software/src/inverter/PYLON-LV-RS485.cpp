@@ -57,42 +57,31 @@ void PylonLV485InverterProtocol::update_values() {
 
 void PylonLV485InverterProtocol::receive() {
   // Read incoming RS485 data
-  while (Serial2.available()) {
-    char byte = Serial2.read();
-
-    if (byte == '~') {
-      rx_buffer.clear();
-      rx_buffer += byte;
-    } else if (!rx_buffer.empty()) {
-      rx_buffer += byte;
-      if (byte == '\r') {
-        incoming_message_counter = RS485_HEALTHY;
-        // logging.printf("RX: Frame received (%u bytes): %s\n", rx_buffer.length(), rx_buffer.c_str());
-        route_frame_request(rx_buffer);
-        rx_buffer.clear();
-      }
-    }
+  while (read_rs485_frame(rx_framer)) {
+    incoming_message_counter = RS485_HEALTHY;
+    // logging.printf("RX: Frame received (%u bytes): %.*s\n", rx_framer.length(), rx_framer.length(), rx_framer.frame());
+    route_frame_request((const char*)rx_framer.frame(), rx_framer.length());
   }
 }
 
-void PylonLV485InverterProtocol::route_frame_request(const std::string& frame_str) {
+void PylonLV485InverterProtocol::route_frame_request(const char* frame, uint16_t length) {
   // Minimal validation
-  if (frame_str.length() < 18) {
-    // logging.printf("RX: Frame too short (%u bytes)\n", frame_str.length());
+  if (length < 18) {
+    // logging.printf("RX: Frame too short (%u bytes)\n", length);
     return;
   }
 
   // Extract command (CID2) from positions 7-8
-  std::string cid2 = frame_str.substr(7, 2);
+  const char* cid2 = frame + 7;
 
-  if (cid2 == "61") {
+  if (strncmp(cid2, "61", 2) == 0) {
     handle_command_61();
-  } else if (cid2 == "62") {
+  } else if (strncmp(cid2, "62", 2) == 0) {
     handle_command_62();
-  } else if (cid2 == "63") {
+  } else if (strncmp(cid2, "63", 2) == 0) {
     handle_command_63();
   } else {
-    logging.printf("RX: Unknown command 0x%s\n", cid2.c_str());
+    logging.printf("RX: Unknown command 0x%.2s\n", cid2);
   }
 }
 
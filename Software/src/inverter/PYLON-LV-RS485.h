@@ -25,7 +25,7 @@ class PylonLV485InverterProtocol : public Rs485InverterProtocol {
   static constexpr const char* RESPONSE_ADDRESS = "02";
 
   // Helper functions
-  void route_frame_request(const std::string& frame_str);
+  void route_frame_request(const char* frame, uint16_t length);
   void handle_command_61();
   void handle_command_62();
   void handle_command_63();
@@ -36,7 +36,7 @@ class PylonLV485InverterProtocol : public Rs485InverterProtocol {
   uint32_t last_update_ms = 0;
   uint32_t last_cmd63_ms = 0;
   uint32_t update_timeout_ms = 60000;
-  std::string rx_buffer;
+  AsciiRs485Framer<128> rx_framer{'~', '\r'};
   bool is_data_valid = false;
 
   // Dynamic data - defaults for safety
@@ -63,7 +63,7 @@ void SmaLvInverter::
   //TODO: Map error/warnings in 0x35A
 }
 
-void SmaLvInverter::map_can_frame_to_variable(CAN_frame rx_frame) {
+void SmaLvInverter::map_can_frame_to_variable(const CAN_frame& rx_frame) {
   switch (rx_frame.ID) {
     case 0x305:
       datalayer.system.status.CAN_inverter_still_alive = CAN_STILL_ALIVE;
@@ -87,7 +87,7 @@ void SolArkLvInverter::update_values() {
   // SOLARK_35E is pre-filled with the manufacturer name (BAT-EMU)
 }
 
-void SolArkLvInverter::map_can_frame_to_variable(CAN_frame rx_frame) {
+void SolArkLvInverter::map_can_frame_to_variable(const CAN_frame& rx_frame) {
   switch (rx_frame.ID) {
     case 0x305:  //Message originating from inverter, signalling that data rec OK
       datalayer.system.status.CAN_inverter_still_alive = CAN_STILL_ALIVE;
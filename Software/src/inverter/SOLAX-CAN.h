@@ -9,7 +9,7 @@ class SolaxInverter : public CanInverterProtocol {
   bool setup();
   void update_values();
   void transmit_can(unsigned long currentMillis);
-  void map_can_frame_to_variable(CAN_frame rx_frame);
+  void map_can_frame_to_variable(const CAN_frame& rx_frame);
   static constexpr const char* Name = "SolaX Triple Power LFP over CAN bus";
 
  private:
@@ -1,7 +1,7 @@
 #include "VCU-CAN.h"
+#include "../communication/can/CanCrc.h"
 #include "../communication/can/comm_can.h"
 #include "../datalayer/datalayer.h"
-#include "../devboard/utils/common_functions.h"  //For CRC table
 #include "../inverter/INVERTERS.h"
 
 /*TODO once testing starts:
@@ -10,11 +10,7 @@
 -*/
 
 static uint8_t calculate_CRC_Nissan(CAN_frame* frame) {
-  uint8_t crc = 0;
-  for (uint8_t j = 0; j < 7; j++) {
-    crc = crctable_nissan_leaf[(crc ^ static_cast<uint8_t>(frame->data.u8[j])) % 256];
-  }
-  return crc;
+  return FrameCrc<Crc8NissanLeaf, 7>::crc(*frame);
 }
 
 void VCUInverter::update_values() {  //Called every 1s
@@ -39,7 +35,7 @@ void VCUInverter::update_values() {  //Called every 1s
   LEAF_5BC.data.u8[4] = (datalayer.battery.status.soh_pptt / 100) << 1;
 }
 
-void VCUInverter::map_can_frame_to_variable(CAN_frame rx_frame) {
+void VCUInverter::map_can_frame_to_variable(const CAN_frame& rx_frame) {
   switch (rx_frame.ID) {
     case 0x1F2:
       datalayer.system.status.CAN_inverter_still_alive = CAN_STILL_ALIVE;
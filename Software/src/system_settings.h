@@ -11,6 +11,10 @@
  * Description:
  * Defines the priority of various wireless functionality (TCP, MQTT, etc)
  * 
+ * Parameter: TASK_HTML_RENDER_PRIO
+ * Description:
+ * Defines the priority of rendering webserver pages
+ *
  * Parameter: TASK_MODBUS_PRIO
  * Description:
  * Defines the priority of MODBUS handling
@@ -26,6 +30,7 @@
 #define TASK_CORE_PRIO 4
 #define TASK_CONNECTIVITY_PRIO 3
 #define TASK_MQTT_PRIO 2
+#define TASK_HTML_RENDER_PRIO 2
 #define TASK_MODBUS_PRIO 8
 #define TASK_ACAN2515_PRIORITY 10
 #define TASK_ACAN2517FD_PRIORITY 10
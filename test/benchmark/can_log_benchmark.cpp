@@ -0,0 +1,369 @@
+// Replays recorded CAN logs through the battery integrations on the host and
+// reports how expensive the decoding is, so that regressions are caught before
+// the firmware runs out of its 1 ms core task budget on real hardware.
+//
+// Usage: can_log_benchmark [options] [log files or directories...]
+//
+// Without logs, all logs in test/can_log_based/can_logs are replayed. Text logs
+// (SavvyCAN format) are replayed through the battery type given by their file
+// name prefix, like the CAN log based tests. Binary SD card logs (canlog.bin)
+// have no battery type, so --battery is needed for them.
+//
+// Options:
+//   --battery <type>             Replay every log through this BatteryType
+//   --all-batteries              Replay every log through every CAN battery type
+//   --min-frames <n>             Repeat each log until at least n frames were replayed (default 1000000)
+//   --update-every <n>           Call update_values() every n frames (default 1000, about once a second)
+//   --max-ns-per-frame <n>       Fail when a battery needs more than n ns per frame
+//   --max-allocs-per-frame <n>   Fail when a battery allocates more than n times per frame
+//   --baseline <file>            Fail when a battery is more than --tolerance slower than in this file
+//   --tolerance <percent>        Allowed slowdown against the baseline (default 25)
+//   --write-baseline <file>      Store the results as a new baseline
+//
+// The exit code is 1 when any of the thresholds is exceeded.
+
+#include "../../Software/src/battery/BATTERIES.h"
+#include "../../Software/src/battery/CanBattery.h"
+#include "../../Software/src/datalayer/datalayer.h"
+#include "../../Software/src/devboard/hal/hal.h"
+#include "../../Software/src/devboard/sdcard/can_log_record.h"
+#include "../../Software/src/devboard/utils/events.h"
+#include "../utils/utils.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <new>
+#include <string>
+
+// Heap allocations are counted while frames are decoded, update_values() is left out.
+// Decoding a frame should never need the heap, an allocation per frame fragments it over time.
+static bool count_allocations = false;
+static uint64_t allocations = 0;
+
+void* operator new(size_t size) {
+  if (count_allocations) {
+    allocations++;
+  }
+  void* p = malloc(size == 0 ? 1 : size);
+  if (p == nullptr) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void* operator new[](size_t size) {
+  return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+  free(p);
+}
+
+void operator delete[](void* p) noexcept {
+  free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+  free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+  free(p);
+}
+
+void store_settings_equipment_stop(void) {}
+
+struct BenchmarkOptions {
+  int battery_type = -1;
+  bool all_batteries = false;
+  uint64_t min_frames = 1000000;
+  uint32_t update_every = 1000;
+  double max_ns_per_frame = 0;
+  double max_allocs_per_frame = -1;
+  std::string baseline;
+  double tolerance_percent = 25;
+  std::string write_baseline;
+};
+
+struct BenchmarkResult {
+  std::string battery;
+  std::string log;
+  uint64_t frames = 0;
+  double decode_ns = 0;
+  double update_ns = 0;
+  uint64_t updates = 0;
+  uint64_t allocations = 0;
+
+  double ns_per_frame() const { return frames ? decode_ns / frames : 0; }
+  double frames_per_second() const { return decode_ns > 0 ? frames * 1e9 / decode_ns : 0; }
+  double allocs_per_frame() const { return frames ? (double)allocations / frames : 0; }
+  double us_per_update() const { return updates ? update_ns / updates / 1000 : 0; }
+};
+
+static std::vector<CAN_frame> load_binary_log(const fs::path& path) {
+  std::vector<CAN_frame> frames;
+  FILE* in = fopen(path.string().c_str(), "rb");
+  if (in == nullptr) {
+    fprintf(stderr, "Could not open %s\n", path.string().c_str());
+    return frames;
+  }
+
+  CanLogFileHeader header;
+  if (fread(&header, sizeof(header), 1, in) != 1 || !is_valid_can_log_file_header(header)) {
+    fprintf(stderr, "%s is not a binary CAN log\n", path.string().c_str());
+    fclose(in);
+    return frames;
+  }
+
+  CanLogRecord record;
+  while (fread(&record, CAN_LOG_RECORD_HEADER_SIZE, 1, in) == 1) {
+    if (record.dlc > CAN_LOG_MAX_PAYLOAD || fread(record.data, 1, record.dlc, in) != record.dlc) {
+      break;
+    }
+    // Frames we sent ourselves are in the log too, the battery never sees those
+    if (record.direction != MSG_RX) {
+      continue;
+    }
+    CAN_frame frame = {};
+    frame.FD = (record.flags & CAN_LOG_FLAG_FD) != 0;
+    frame.ext_ID = (record.flags & CAN_LOG_FLAG_EXT_ID) != 0;
+    frame.DLC = record.dlc;
+    frame.ID = record.id;
+    memcpy(frame.data.u8, record.data, record.dlc);
+    frames.push_back(frame);
+  }
+
+  fclose(in);
+  return frames;
+}
+
+static std::vector<CAN_frame> load_log(const fs::path& path) {
+  if (path.extension() == ".bin") {
+    return load_binary_log(path);
+  }
+  return parse_can_log_file(path);
+}
+
+// The battery type is the number in front of the first '_' in the log name
+static int battery_type_from_log_name(const fs::path& path) {
+  std::string name = path.filename().string();
+  size_t end = name.find('_');
+  if (end == 0 || end == std::string::npos || name.find_first_not_of("0123456789") != end) {
+    return -1;
+  }
+  return std::stoi(name.substr(0, end));
+}
+
+static CanBattery* create_battery(int type) {
+  datalayer = DataLayer();
+  reset_all_events();
+  if (battery) {
+    delete battery;
+    battery = nullptr;
+  }
+
+  // Same custom-BMS limits as the CAN log based tests
+  user_selected_max_pack_voltage_dV = 378 + 10;
+  user_selected_min_pack_voltage_dV = 261 - 10;
+  user_selected_max_cell_voltage_mV = 4200 + 20;
+  user_selected_min_cell_voltage_mV = 2900 - 20;
+
+  user_selected_battery_type = (BatteryType)type;
+  setup_battery();
+  return dynamic_cast<CanBattery*>(battery);
+}
+
+static BenchmarkResult replay(CanBattery* can_battery, const std::vector<CAN_frame>& frames,
+                              const BenchmarkOptions& options) {
+  using clock = std::chrono::steady_clock;
+  BenchmarkResult result;
+  uint32_t since_update = 0;
+
+  allocations = 0;
+
+  while (result.frames < options.min_frames) {
+    size_t index = 0;
+    while (index < frames.size()) {
+      // Frames are timed in batches, a clock read per frame would cost as much as decoding it
+      size_t batch_end = std::min(frames.size(), index + (options.update_every - since_update));
+      count_allocations = true;
+      auto start = clock::now();
+      for (size_t i = index; i < batch_end; i++) {
+        can_battery->handle_incoming_can_frame(frames[i]);
+      }
+      auto decoded = clock::now();
+      count_allocations = false;
+      result.decode_ns += std::chrono::duration<double, std::nano>(decoded - start).count();
+      result.frames += batch_end - index;
+      since_update += batch_end - index;
+      index = batch_end;
+
+      if (since_update >= options.update_every) {
+        since_update = 0;
+        auto update_start = clock::now();
+        can_battery->update_values();
+        result.update_ns += std::chrono::duration<double, std::nano>(clock::now() - update_start).count();
+        result.updates++;
+      }
+    }
+  }
+
+  result.allocations = allocations;
+  return result;
+}
+
+// Baseline files have one "<battery> <log> <ns per frame>" line per result
+static std::string baseline_key(const BenchmarkResult& result) {
+  return snake_case_to_camel_case(result.battery) + " " + result.log;
+}
+
+static std::map<std::string, double> read_baseline(const std::string& path) {
+  std::map<std::string, double> baseline;
+  std::ifstream in(path);
+  std::string battery_name, log_name;
+  double ns_per_frame;
+  while (in >> battery_name >> log_name >> ns_per_frame) {
+    baseline[battery_name + " " + log_name] = ns_per_frame;
+  }
+  return baseline;
+}
+
+static bool parse_options(int argc, char** argv, BenchmarkOptions& options, std::vector<fs::path>& logs) {
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "--all-batteries") {
+      options.all_batteries = true;
+    } else if (arg == "--battery" && has_value) {
+      options.battery_type = atoi(argv[++i]);
+    } else if (arg == "--min-frames" && has_value) {
+      options.min_frames = strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "--update-every" && has_value) {
+      options.update_every = std::max(1, atoi(argv[++i]));
+    } else if (arg == "--max-ns-per-frame" && has_value) {
+      options.max_ns_per_frame = atof(argv[++i]);
+    } else if (arg == "--max-allocs-per-frame" && has_value) {
+      options.max_allocs_per_frame = atof(argv[++i]);
+    } else if (arg == "--baseline" && has_value) {
+      options.baseline = argv[++i];
+    } else if (arg == "--tolerance" && has_value) {
+      options.tolerance_percent = atof(argv[++i]);
+    } else if (arg == "--write-baseline" && has_value) {
+      options.write_baseline = argv[++i];
+    } else if (arg.rfind("--", 0) == 0) {
+      fprintf(stderr, "Unknown or incomplete option %s\n", arg.c_str());
+      return false;
+    } else if (fs::is_directory(arg)) {
+      for (const auto& entry : fs::directory_iterator(arg)) {
+        std::string extension = entry.path().extension().string();
+        if (entry.is_regular_file() && (extension == ".txt" || extension == ".bin")) {
+          logs.push_back(entry.path());
+        }
+      }
+    } else {
+      logs.push_back(arg);
+    }
+  }
+  return true;
+}
+
+int main(int argc, char** argv) {
+  BenchmarkOptions options;
+  std::vector<fs::path> logs;
+  if (!parse_options(argc, argv, options, logs)) {
+    return 2;
+  }
+  if (logs.empty()) {
+    for (const auto& entry : fs::directory_iterator(TEST_CAN_LOG_DIR)) {
+      if (entry.is_regular_file() && entry.path().extension() == ".txt") {
+        logs.push_back(entry.path());
+      }
+    }
+  }
+  std::sort(logs.begin(), logs.end());
+
+  // Some batteries claim wake-up or contactor pins in their setup
+  init_hal();
+
+  std::vector<BenchmarkResult> results;
+  for (const fs::path& log : logs) {
+    std::vector<CAN_frame> frames = load_log(log);
+    if (frames.empty()) {
+      fprintf(stderr, "No frames in %s, skipping\n", log.string().c_str());
+      continue;
+    }
+
+    std::vector<int> types;
+    if (options.all_batteries) {
+      for (BatteryType type : supported_battery_types()) {
+        types.push_back((int)type);
+      }
+    } else if (options.battery_type >= 0) {
+      types.push_back(options.battery_type);
+    } else if (battery_type_from_log_name(log) >= 0) {
+      types.push_back(battery_type_from_log_name(log));
+    } else {
+      fprintf(stderr, "No battery type for %s, use --battery\n", log.string().c_str());
+      continue;
+    }
+
+    for (int type : types) {
+      CanBattery* can_battery = create_battery(type);
+      if (can_battery == nullptr) {
+        continue;  // Not a CAN battery (or no battery at all)
+      }
+      BenchmarkResult result = replay(can_battery, frames, options);
+      result.battery = name_for_battery_type((BatteryType)type);
+      result.log = log.filename().string();
+      results.push_back(result);
+    }
+  }
+
+  if (battery) {
+    delete battery;
+    battery = nullptr;
+  }
+
+  std::map<std::string, double> baseline;
+  if (!options.baseline.empty()) {
+    baseline = read_baseline(options.baseline);
+  }
+
+  bool failed = false;
+  printf("%-36s %-36s %10s %12s %10s %12s %10s\n", "Battery", "Log", "Frames", "Frames/s", "ns/frame",
+         "us/update", "allocs/fr");
+  for (const BenchmarkResult& result : results) {
+    printf("%-36s %-36s %10llu %12.0f %10.1f %12.2f %10.3f\n", result.battery.c_str(), result.log.c_str(),
+           (unsigned long long)result.frames, result.frames_per_second(), result.ns_per_frame(),
+           result.us_per_update(), result.allocs_per_frame());
+
+    if (options.max_ns_per_frame > 0 && result.ns_per_frame() > options.max_ns_per_frame) {
+      printf("  FAIL: %.1f ns/frame is above the limit of %.1f\n", result.ns_per_frame(), options.max_ns_per_frame);
+      failed = true;
+    }
+    if (options.max_allocs_per_frame >= 0 && result.allocs_per_frame() > options.max_allocs_per_frame) {
+      printf("  FAIL: %.3f allocations/frame is above the limit of %.3f\n", result.allocs_per_frame(),
+             options.max_allocs_per_frame);
+      failed = true;
+    }
+    auto reference = baseline.find(baseline_key(result));
+    if (reference != baseline.end() &&
+        result.ns_per_frame() > reference->second * (100 + options.tolerance_percent) / 100) {
+      printf("  FAIL: %.1f ns/frame is more than %.0f %% slower than the baseline of %.1f\n", result.ns_per_frame(),
+             options.tolerance_percent, reference->second);
+      failed = true;
+    }
+  }
+
+  if (!options.write_baseline.empty()) {
+    std::ofstream out(options.write_baseline);
+    for (const BenchmarkResult& result : results) {
+      out << baseline_key(result) << " " << result.ns_per_frame() << "\n";
+    }
+  }
+
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+
+#include "../Software/src/communication/can/CanAcceptanceFilters.h"
+
+static bool accepted(const std::vector<CanFilterGroup>& groups, uint32_t id) {
+  for (const CanFilterGroup& group : groups) {
+    if ((id & group.mask) == group.code) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static const std::vector<uint32_t> tesla_ids = {0x132, 0x20A, 0x212, 0x224, 0x252, 0x292, 0x2A4, 0x2B4,
+                                                0x2C4, 0x2D2, 0x300, 0x310, 0x312, 0x320, 0x332, 0x352,
+                                                0x392, 0x3AA, 0x3C4, 0x3D2, 0x401, 0x612, 0x72A, 0x7AA};
+
+TEST(CanAcceptanceFilterTest, ExactFiltersWhenEnoughSlots) {
+  auto groups = compute_can_filter_groups({0x352, 0x132, 0x132}, CAN_STANDARD_ID_MASK, 32);
+
+  ASSERT_EQ(groups.size(), 2u);
+  EXPECT_TRUE(accepted(groups, 0x132));
+  EXPECT_TRUE(accepted(groups, 0x352));
+  EXPECT_FALSE(accepted(groups, 0x133));
+  EXPECT_EQ(groups[0].mask, CAN_STANDARD_ID_MASK);
+}
+
+TEST(CanAcceptanceFilterTest, MergedFiltersStillAcceptEveryId) {
+  for (size_t max_groups = 1; max_groups <= 6; max_groups++) {
+    auto groups = compute_can_filter_groups(tesla_ids, CAN_STANDARD_ID_MASK, max_groups);
+    EXPECT_LE(groups.size(), max_groups);
+    for (uint32_t id : tesla_ids) {
+      EXPECT_TRUE(accepted(groups, id)) << "ID " << id << " rejected with " << max_groups << " filters";
+    }
+  }
+}
+
+TEST(CanAcceptanceFilterTest, MoreFiltersRejectMoreTraffic) {
+  auto count_accepted = [](const std::vector<CanFilterGroup>& groups) {
+    int count = 0;
+    for (uint32_t id = 0; id <= CAN_STANDARD_ID_MASK; id++) {
+      count += accepted(groups, id);
+    }
+    return count;
+  };
+
+  int one = count_accepted(compute_can_filter_groups(tesla_ids, CAN_STANDARD_ID_MASK, 1));
+  int six = count_accepted(compute_can_filter_groups(tesla_ids, CAN_STANDARD_ID_MASK, 6));
+  EXPECT_LE(six, one);
+  EXPECT_LT(six, (int)CAN_STANDARD_ID_MASK + 1);
+}
+
+TEST(CanAcceptanceFilterTest, ExtendedIdsKeepAllBits) {
+  auto groups = compute_can_filter_groups({0x1C42007B, 0x1C42017B}, CAN_EXTENDED_ID_MASK, 1);
+
+  ASSERT_EQ(groups.size(), 1u);
+  EXPECT_TRUE(accepted(groups, 0x1C42007B));
+  EXPECT_TRUE(accepted(groups, 0x1C42017B));
+  EXPECT_EQ(can_filter_accepted_count(groups[0].mask, CAN_EXTENDED_ID_MASK), 2u);
+}
+
+TEST(CanAcceptanceFilterTest, SplitSharesMaskPerSide) {
+  auto groups = compute_can_filter_groups(tesla_ids, CAN_STANDARD_ID_MASK, 6);
+  std::vector<CanFilterGroup> a;
+  std::vector<CanFilterGroup> b;
+
+  ASSERT_TRUE(split_can_filter_groups(groups, 2, 4, CAN_STANDARD_ID_MASK, a, b));
+  EXPECT_LE(a.size(), 2u);
+  EXPECT_LE(b.size(), 4u);
+  for (const CanFilterGroup& group : a) {
+    EXPECT_EQ(group.mask, a.front().mask);
+  }
+  for (const CanFilterGroup& group : b) {
+    EXPECT_EQ(group.mask, b.front().mask);
+  }
+
+  std::vector<CanFilterGroup> both = a;
+  both.insert(both.end(), b.begin(), b.end());
+  for (uint32_t id : tesla_ids) {
+    EXPECT_TRUE(accepted(both, id));
+  }
+}
+
+TEST(CanAcceptanceFilterTest, SplitFailsWhenGroupsDontFit) {
+  auto groups = compute_can_filter_groups(tesla_ids, CAN_STANDARD_ID_MASK, 8);
+  std::vector<CanFilterGroup> a;
+  std::vector<CanFilterGroup> b;
+
+  EXPECT_FALSE(split_can_filter_groups(groups, 2, 4, CAN_STANDARD_ID_MASK, a, b));
+}
@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+
+#include "../Software/src/battery/MEB-BATTERY.h"
+#include "../Software/src/communication/can/CanCrc.h"
+#include "../Software/src/datalayer/datalayer.h"
+
+#include <random>
+
+uint8_t vw_crc_calc(const uint8_t* inputBytes, uint8_t length, uint32_t address);
+
+static constexpr uint8_t check_input[9] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+
+// Bit by bit reference, MSB first
+static uint8_t reference_crc(uint8_t poly, uint8_t crc, const uint8_t* data, size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    crc ^= data[i];
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x80) ? (crc << 1) ^ poly : crc << 1;
+    }
+  }
+  return crc;
+}
+
+static uint8_t reverse_bits(uint8_t byte) {
+  uint8_t reversed = 0;
+  for (int i = 0; i < 8; i++) {
+    reversed = (reversed << 1) | ((byte >> i) & 1);
+  }
+  return reversed;
+}
+
+TEST(CanCrcTests, MatchesCatalogueCheckValues) {
+  EXPECT_EQ((Crc8<0x1D, 0xFF, 0xFF>::compute(check_input, 9)), 0x4B);  // CRC-8/SAE-J1850
+  EXPECT_EQ(Crc8Autosar::compute(check_input, 9), 0xDF);               // CRC-8/AUTOSAR
+  EXPECT_EQ(Crc8Maxim::compute(check_input, 9), 0xA1);                 // CRC-8/MAXIM-DOW
+  EXPECT_EQ((Crc8<0x07>::compute(check_input, 9)), 0xF4);              // CRC-8/SMBUS
+}
+
+TEST(CanCrcTests, GeneratesTheTablesPreviouslyWrittenOut) {
+  const uint8_t j1850[16] = {0x00, 0x1D, 0x3A, 0x27, 0x74, 0x69, 0x4E, 0x53,
+                             0xE8, 0xF5, 0xD2, 0xCF, 0x9C, 0x81, 0xA6, 0xBB};
+  const uint8_t nissan_leaf[16] = {0, 133, 143, 10, 155, 30, 20, 145, 179, 54, 60, 185, 40, 173, 167, 34};
+  const uint8_t geely[16] = {0x00, 0x2F, 0x5E, 0x71, 0xBC, 0x93, 0xE2, 0xCD,
+                             0x57, 0x78, 0x09, 0x26, 0xEB, 0xC4, 0xB5, 0x9A};
+  for (int i = 0; i < 16; i++) {
+    EXPECT_EQ(Crc8J1850::table[i], j1850[i]);
+    EXPECT_EQ(Crc8NissanLeaf::table[i], nissan_leaf[i]);
+    EXPECT_EQ(Crc8Autosar::table[i], geely[i]);
+  }
+  EXPECT_EQ(Crc8J1850::table[255], 0xC4);
+  EXPECT_EQ(Crc8NissanLeaf::table[255], 141);
+  EXPECT_EQ(Crc8Autosar::table[255], 0x42);
+}
+
+TEST(CanCrcTests, SlicedPathMatchesBytewise) {
+  std::mt19937 random(1);
+  uint8_t data[64];
+  for (int round = 0; round < 100; round++) {
+    for (uint8_t& byte : data) {
+      byte = random();
+    }
+    uint8_t init = random();
+    for (size_t length = 0; length <= sizeof(data); length++) {
+      EXPECT_EQ(Crc8J1850::update(init, data, length), reference_crc(0x1D, init, data, length));
+      EXPECT_EQ(Crc8Autosar::update(init, data, length), reference_crc(0x2F, init, data, length));
+    }
+  }
+}
+
+TEST(CanCrcTests, ReflectedMatchesBitReversedReference) {
+  // How the S-Box code computed it: reverse the bytes, MSB first CRC, reverse the result
+  std::mt19937 random(2);
+  uint8_t data[64];
+  uint8_t reversed[64];
+  for (size_t i = 0; i < sizeof(data); i++) {
+    data[i] = random();
+    reversed[i] = reverse_bits(data[i]);
+  }
+  for (size_t length = 0; length <= sizeof(data); length++) {
+    EXPECT_EQ(Crc8Maxim::compute(data, length), reverse_bits(reference_crc(0x31, 0, reversed, length)));
+  }
+}
+
+TEST(CanCrcTests, FrameCrcCoversTheBytesAroundIt) {
+  CAN_frame frame = {.FD = false, .ext_ID = false, .DLC = 8, .ID = 0x10B,
+                     .data = {0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77}};
+  typedef FrameCrc<Crc8J1850, 0> CrcFirst;
+  typedef FrameCrc<Crc8J1850, 7> CrcLast;
+
+  EXPECT_EQ(CrcFirst::crc(frame, 3, 0x3F), reference_crc(0x1D, 0x3F, &frame.data.u8[1], 2));
+  EXPECT_EQ(CrcLast::crc(frame), reference_crc(0x1D, 0x00, frame.data.u8, 7));
+
+  CrcFirst::write(frame, 8, 0x60);
+  EXPECT_TRUE(CrcFirst::valid(frame, 8, 0x60));
+  frame.data.u8[5] ^= 0x01;
+  EXPECT_FALSE(CrcFirst::valid(frame, 8, 0x60));
+}
+
+TEST(CanCrcTests, FrameWithoutCrcByteIsInvalid) {
+  CAN_frame frame = {.FD = false, .ext_ID = false, .DLC = 0, .ID = 0x2BD, .data = {}};
+  typedef FrameCrc<Crc8J1850, 0> CrcFirst;
+  typedef FrameCrc<Crc8J1850, 7> CrcLast;
+
+  EXPECT_EQ(CrcFirst::crc(frame, frame.DLC, 0x15), 0x15);
+  EXPECT_FALSE(CrcFirst::valid(frame, frame.DLC, 0x15));
+  EXPECT_FALSE(CrcFirst::valid(frame, frame.DLC, 0x00));
+  EXPECT_FALSE(CrcLast::valid(frame, 7));
+}
+
+TEST(CanCrcTests, MebFrameWithoutCrcByteIsInvalid) {
+  CAN_frame frame = {.FD = false, .ext_ID = false, .DLC = 0, .ID = 0x0CF, .data = {}};
+  EXPECT_EQ(vw_crc_calc(frame.data.u8, 0, frame.ID), vw_crc_calc(check_input, 0, frame.ID));
+  EXPECT_EQ(vw_crc_calc(frame.data.u8, 1, frame.ID), vw_crc_calc(check_input, 1, frame.ID));
+
+  datalayer = DataLayer();
+  MebBattery meb;
+  frame.data.u8[0] = vw_crc_calc(frame.data.u8, 0, frame.ID);
+  meb.handle_incoming_can_frame(frame);
+  EXPECT_EQ(datalayer.battery.status.CAN_error_counter, 1);
+}
+
+TEST(CanCrcTests, AliveCounterWrapsAndCrcFollows) {
+  CAN_frame frame = {.FD = false, .ext_ID = false, .DLC = 8, .ID = 0x12F,
+                     .data = {0x00, 0xA0, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77}};
+  typedef AliveCounterCrc<Crc8J1850, 1, 0, 14> Protected;
+
+  uint8_t counter = 13;
+  Protected::advance(frame, counter, 8, 0x60);
+  EXPECT_EQ(frame.data.u8[1], 0xAD);
+  EXPECT_EQ(counter, 14);
+  EXPECT_TRUE(Protected::valid(frame, 8, 0x60));
+
+  Protected::advance(frame, counter, 8, 0x60);
+  EXPECT_EQ(frame.data.u8[1], 0xAE);
+  EXPECT_EQ(counter, 0);
+  EXPECT_EQ(frame.data.u8[0], reference_crc(0x1D, 0x60, &frame.data.u8[1], 7));
+}
+
+TEST(CanCrcTests, AdditiveChecksum) {
+  const uint8_t data[4] = {0xF0, 0x20, 0x01, 0x02};
+  EXPECT_EQ(Checksum8::compute(data, 4), 0x13);
+  EXPECT_EQ(Checksum8::compute(data, 4, 0x29), 0x3C);
+}
+
+TEST(CanCrcTests, WorksAtCompileTime) {
+  static_assert(Crc8Autosar::compute(check_input, 9) == 0xDF, "computed at compile time");
+  static_assert(Crc8J1850::table[1] == 0x1D, "table generated at compile time");
+}
@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+
+#include "../Software/src/communication/can/CanDispatchTable.h"
+
+#include <algorithm>
+
+class RecordingReceiver : public CanReceiver {
+ public:
+  explicit RecordingReceiver(std::vector<uint32_t> ids) : ids(ids) {}
+
+  void receive_can_frame(const CAN_frame* rx_frame) { received.push_back(rx_frame->ID); }
+  std::vector<uint32_t> accepted_can_ids() { return ids; }
+
+  std::vector<uint32_t> ids;
+  std::vector<uint32_t> received;
+};
+
+static CAN_frame frame_with_id(uint32_t id) {
+  CAN_frame frame = {.FD = false, .ext_ID = id > 0x7FF, .DLC = 8, .ID = id, .data = {}};
+  return frame;
+}
+
+TEST(CanDispatchTableTest, DeliversOnlySubscribedIds) {
+  CanDispatchTable table;
+  RecordingReceiver receiver({0x132, 0x20A});
+  table.add(&receiver, CAN_NATIVE);
+
+  CAN_frame wanted = frame_with_id(0x132);
+  CAN_frame unwanted = frame_with_id(0x123);
+
+  EXPECT_TRUE(table.dispatch(&wanted, CAN_NATIVE));
+  EXPECT_FALSE(table.dispatch(&unwanted, CAN_NATIVE));
+  EXPECT_EQ(receiver.received, std::vector<uint32_t>({0x132}));
+}
+
+TEST(CanDispatchTableTest, ReceiverWithoutIdsGetsEveryFrame) {
+  CanDispatchTable table;
+  RecordingReceiver all({});
+  RecordingReceiver some({0x352});
+  table.add(&all, CAN_NATIVE);
+  table.add(&some, CAN_NATIVE);
+
+  CAN_frame first = frame_with_id(0x352);
+  CAN_frame second = frame_with_id(0x18DAF105);
+  table.dispatch(&first, CAN_NATIVE);
+  table.dispatch(&second, CAN_NATIVE);
+
+  EXPECT_EQ(all.received, std::vector<uint32_t>({0x352, 0x18DAF105}));
+  EXPECT_EQ(some.received, std::vector<uint32_t>({0x352}));
+  EXPECT_TRUE(table.wants(0x123, CAN_NATIVE));
+}
+
+TEST(CanDispatchTableTest, InterfacesAreSeparate) {
+  CanDispatchTable table;
+  RecordingReceiver battery({0x100});
+  RecordingReceiver battery2({0x100});
+  table.add(&battery, CAN_NATIVE);
+  table.add(&battery2, CAN_ADDON_MCP2515);
+
+  CAN_frame frame = frame_with_id(0x100);
+  table.dispatch(&frame, CAN_ADDON_MCP2515);
+
+  EXPECT_TRUE(battery.received.empty());
+  EXPECT_EQ(battery2.received.size(), 1u);
+  EXPECT_FALSE(table.wants(0x100, CANFD_ADDON_MCP2518));
+}
+
+TEST(CanDispatchTableTest, DuplicateIdsDeliverOnce) {
+  CanDispatchTable table;
+  RecordingReceiver receiver({0x5A2, 0x5A2});
+  table.add(&receiver, CAN_NATIVE);
+
+  CAN_frame frame = frame_with_id(0x5A2);
+  table.dispatch(&frame, CAN_NATIVE);
+
+  EXPECT_EQ(receiver.received.size(), 1u);
+}
+
+TEST(CanDispatchTableTest, ClearRemovesReceivers) {
+  CanDispatchTable table;
+  RecordingReceiver receiver({});
+  table.add(&receiver, CAN_NATIVE);
+  table.clear();
+
+  CAN_frame frame = frame_with_id(0x100);
+  EXPECT_FALSE(table.dispatch(&frame, CAN_NATIVE));
+  EXPECT_TRUE(receiver.received.empty());
+}
+
+TEST(CanDispatchTableTest, FramesMatchIdsOfTheSameFormat) {
+  CanDispatchTable table;
+  RecordingReceiver standard({0x100});
+  RecordingReceiver extended({0x100 | CAN_EXTENDED_ID_FLAG, 0x18DAF105});
+  table.add(&standard, CAN_NATIVE);
+  table.add(&extended, CAN_NATIVE);
+
+  CAN_frame standard_frame = frame_with_id(0x100);
+  CAN_frame extended_frame = frame_with_id(0x100);
+  extended_frame.ext_ID = true;
+  table.dispatch(&standard_frame, CAN_NATIVE);
+  table.dispatch(&extended_frame, CAN_NATIVE);
+
+  EXPECT_EQ(standard.received.size(), 1u);
+  EXPECT_EQ(extended.received.size(), 1u);
+
+  std::vector<uint32_t> ids = table.subscribed_ids(CAN_NATIVE);
+  std::sort(ids.begin(), ids.end());
+  EXPECT_EQ(ids, std::vector<uint32_t>({0x100, 0x100 | CAN_EXTENDED_ID_FLAG, 0x18DAF105 | CAN_EXTENDED_ID_FLAG}));
+}
@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+
+#include "../Software/src/devboard/sdcard/can_log_record.h"
+
+#include <string>
+
+TEST(CanLogRecordTests, ClassicFrameOnlyStoresItsPayload) {
+  CAN_frame frame = {.FD = false, .ext_ID = false, .DLC = 8, .ID = 0x7BB, .data = {.u8 = {1, 2, 3, 4, 5, 6, 7, 8}}};
+  CanLogRecord record;
+
+  size_t size = fill_can_log_record(record, frame, CAN_ADDON_MCP2515, MSG_RX, 1234567);
+
+  EXPECT_EQ(size, 24u);
+  EXPECT_EQ(record.timestamp_us, 1234567u);
+  EXPECT_EQ(record.id, 0x7BBu);
+  EXPECT_EQ(record.interface, CAN_ADDON_MCP2515);
+  EXPECT_EQ(record.direction, MSG_RX);
+  EXPECT_EQ(record.flags, 0);
+  EXPECT_EQ(record.dlc, 8);
+  EXPECT_EQ(record.data[7], 8);
+}
+
+TEST(CanLogRecordTests, FdFrameKeepsFlagsAndFullPayload) {
+  CAN_frame frame = {.FD = true, .ext_ID = true, .DLC = 64, .ID = 0x18DAF105, .data = {}};
+  for (int i = 0; i < 64; i++) {
+    frame.data.u8[i] = i;
+  }
+  CanLogRecord record;
+
+  size_t size = fill_can_log_record(record, frame, CANFD_ADDON_MCP2518, MSG_TX, 0);
+
+  EXPECT_EQ(size, 80u);
+  EXPECT_EQ(record.flags, CAN_LOG_FLAG_EXT_ID | CAN_LOG_FLAG_FD);
+  EXPECT_EQ(record.data[63], 63);
+}
+
+TEST(CanLogRecordTests, FormatsAsSavvyCanLine) {
+  CAN_frame frame = {.FD = false, .ext_ID = false, .DLC = 3, .ID = 0x1A5, .data = {.u8 = {0x00, 0xAB, 0x0F}}};
+  CanLogRecord record;
+  fill_can_log_record(record, frame, CAN_NATIVE, MSG_TX, 61002003);
+
+  char line[256];
+  size_t length = format_can_log_record(record, line, sizeof(line));
+
+  EXPECT_EQ(std::string(line), "(61.002003) TX1 1A5 [3] 00 AB 0F\n");
+  EXPECT_EQ(length, strlen(line));
+}
+
+TEST(CanLogRecordTests, FormatRejectsTooSmallBuffer) {
+  CAN_frame frame = {.FD = false, .ext_ID = false, .DLC = 8, .ID = 0x100, .data = {}};
+  CanLogRecord record;
+  fill_can_log_record(record, frame, CAN_ADDON_MCP2515, MSG_RX, 0);
+
+  char line[24];
+  EXPECT_EQ(format_can_log_record(record, line, sizeof(line)), 0u);
+}
+
+TEST(CanLogRecordTests, FileHeaderRoundTrips) {
+  CanLogFileHeader header;
+  init_can_log_file_header(header);
+  EXPECT_TRUE(is_valid_can_log_file_header(header));
+
+  header.version++;
+  EXPECT_FALSE(is_valid_can_log_file_header(header));
+}
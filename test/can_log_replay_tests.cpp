@@ -0,0 +1,268 @@
+#include <gtest/gtest.h>
+
+#include "../Software/src/devboard/sdcard/can_log_replay.h"
+
+#include <string>
+#include <vector>
+
+static bool parse(const std::string& line, CanLogRecord& record) {
+  return parse_can_log_line(line.c_str(), line.size(), record);
+}
+
+static std::vector<CanLogRecord> decode_in_pieces(const std::vector<uint8_t>& log, size_t piece) {
+  std::vector<CanLogRecord> records;
+  CanLogDecoder decoder([&records](const CanLogRecord& record) {
+    records.push_back(record);
+    return true;
+  });
+  for (size_t i = 0; i < log.size(); i += piece) {
+    EXPECT_TRUE(decoder.feed(log.data() + i, std::min(piece, log.size() - i)));
+  }
+  EXPECT_TRUE(decoder.finish());
+  return records;
+}
+
+static CanLogRecord make_record(uint64_t timestamp_us, uint32_t id, uint8_t dlc) {
+  CanLogRecord record = {};
+  record.timestamp_us = timestamp_us;
+  record.id = id;
+  record.dlc = dlc;
+  for (int i = 0; i < dlc; i++) {
+    record.data[i] = (uint8_t)(id + i);
+  }
+  return record;
+}
+
+static std::vector<uint8_t> binary_log(const std::vector<CanLogRecord>& records) {
+  std::vector<uint8_t> log(sizeof(CanLogFileHeader));
+  CanLogFileHeader header;
+  init_can_log_file_header(header);
+  memcpy(log.data(), &header, sizeof(header));
+  for (const CanLogRecord& record : records) {
+    const uint8_t* bytes = (const uint8_t*)&record;
+    log.insert(log.end(), bytes, bytes + can_log_record_size(record));
+  }
+  return log;
+}
+
+TEST(CanLogReplayTests, ParsesWebserverLineWithMillisecondTimestamp) {
+  CanLogRecord record;
+  ASSERT_TRUE(parse("(12.345) RX0 7BB [3] 01 A2 ff", record));
+
+  EXPECT_EQ(record.timestamp_us, 12345000u);
+  EXPECT_EQ(record.direction, MSG_RX);
+  EXPECT_EQ(record.id, 0x7BBu);
+  EXPECT_EQ(record.flags, 0);
+  EXPECT_EQ(record.dlc, 3);
+  EXPECT_EQ(record.data[1], 0xA2);
+  EXPECT_EQ(record.data[2], 0xFF);
+}
+
+TEST(CanLogReplayTests, ParsesExtendedAndFdFrames) {
+  CanLogRecord record;
+  ASSERT_TRUE(parse("(0.000001) TX3 18DAF105 [2] 02 3E", record));
+  EXPECT_EQ(record.timestamp_us, 1u);
+  EXPECT_EQ(record.direction, MSG_TX);
+  EXPECT_EQ(record.flags, CAN_LOG_FLAG_EXT_ID);
+
+  std::string fd = "(1.5) RX 12F [12]";
+  for (int i = 0; i < 12; i++) {
+    fd += " 0" + std::to_string(i % 10);
+  }
+  ASSERT_TRUE(parse(fd, record));
+  EXPECT_EQ(record.timestamp_us, 1500000u);
+  EXPECT_EQ(record.flags, CAN_LOG_FLAG_FD);
+  EXPECT_EQ(record.dlc, 12);
+  EXPECT_EQ(record.data[11], 0x01);
+}
+
+TEST(CanLogReplayTests, RejectsLinesThatAreNotFrames) {
+  CanLogRecord record;
+  EXPECT_FALSE(parse("", record));
+  EXPECT_FALSE(parse("# SavvyCAN log", record));
+  EXPECT_FALSE(parse("(1.0) RX0 7BB", record));
+  EXPECT_FALSE(parse("(1.0) RX0 7BB [8] 01 02 03", record));  // Truncated
+  EXPECT_FALSE(parse("(1.0) RX0 7BB [65]", record));
+}
+
+TEST(CanLogReplayTests, ParseIsTheInverseOfFormat) {
+  CAN_frame frame = {.FD = true, .ext_ID = true, .DLC = 16, .ID = 0x1FFFF0AB, .data = {}};
+  for (int i = 0; i < 16; i++) {
+    frame.data.u8[i] = 0xF0 + i;
+  }
+  CanLogRecord original;
+  fill_can_log_record(original, frame, CANFD_NATIVE, MSG_TX, 98765432101ull);
+  char line[256];
+  size_t length = format_can_log_record(original, line, sizeof(line));
+
+  CanLogRecord parsed;
+  ASSERT_TRUE(parse_can_log_line(line, length, parsed));
+
+  EXPECT_EQ(parsed.timestamp_us, original.timestamp_us);
+  EXPECT_EQ(parsed.id, original.id);
+  EXPECT_EQ(parsed.interface, original.interface);
+  EXPECT_EQ(parsed.direction, original.direction);
+  EXPECT_EQ(parsed.flags, original.flags);
+  EXPECT_EQ(parsed.dlc, original.dlc);
+  EXPECT_EQ(memcmp(parsed.data, original.data, 16), 0);
+}
+
+TEST(CanLogReplayTests, DecodesTextSplitAnywhere) {
+  std::string text =
+      "# comment\r\n(0.100) RX0 100 [1] 01\r\n\r\n(0.200) RX0 200 [2] 02 03\ngarbage\n(0.300) RX0 300 [0]";
+  std::vector<uint8_t> log(text.begin(), text.end());
+
+  for (size_t piece = 1; piece <= log.size(); piece++) {
+    std::vector<CanLogRecord> records = decode_in_pieces(log, piece);
+    ASSERT_EQ(records.size(), 3u) << "piece size " << piece;
+    EXPECT_EQ(records[0].id, 0x100u);
+    EXPECT_EQ(records[1].data[1], 0x03);
+    EXPECT_EQ(records[2].timestamp_us, 300000u);
+  }
+}
+
+TEST(CanLogReplayTests, DecodesBinarySplitAnywhere) {
+  std::vector<CanLogRecord> written = {make_record(10, 0x100, 8), make_record(20, 0x200, 0),
+                                       make_record(30, 0x300, 64)};
+  std::vector<uint8_t> log = binary_log(written);
+
+  for (size_t piece = 1; piece <= log.size(); piece++) {
+    std::vector<CanLogRecord> records = decode_in_pieces(log, piece);
+    ASSERT_EQ(records.size(), 3u) << "piece size " << piece;
+    for (size_t i = 0; i < written.size(); i++) {
+      EXPECT_EQ(memcmp(&records[i], &written[i], can_log_record_size(written[i])), 0);
+    }
+  }
+}
+
+TEST(CanLogReplayTests, StopsOnCorruptBinaryLog) {
+  std::vector<uint8_t> log = binary_log({make_record(10, 0x100, 8)});
+  CanLogDecoder decoder([](const CanLogRecord&) { return true; });
+
+  std::vector<uint8_t> bad_version = log;
+  bad_version[CAN_LOG_MAGIC_SIZE] = 99;
+  EXPECT_FALSE(decoder.feed(bad_version.data(), bad_version.size()));
+  EXPECT_FALSE(decoder.finish());
+
+  decoder.reset();
+  std::vector<uint8_t> bad_dlc = log;
+  bad_dlc[sizeof(CanLogFileHeader) + offsetof(CanLogRecord, dlc)] = 65;
+  EXPECT_FALSE(decoder.feed(bad_dlc.data(), bad_dlc.size()));
+  EXPECT_EQ(decoder.records(), 0u);
+}
+
+TEST(CanLogReplayTests, MemoryStoreRefusesRecordsThatDoNotFit) {
+  uint8_t memory[sizeof(CanLogFileHeader) + 2 * 24 + 10];
+  CanLogMemoryStore store(memory, sizeof(memory));
+
+  EXPECT_TRUE(store.append(make_record(1, 0x100, 8)));
+  EXPECT_TRUE(store.append(make_record(2, 0x101, 8)));
+  EXPECT_FALSE(store.append(make_record(3, 0x102, 8)));
+  EXPECT_EQ(store.size(), sizeof(CanLogFileHeader) + 2 * 24);
+
+  // What was stored reads back as a valid binary log
+  std::vector<uint8_t> log(store.size());
+  store.rewind();
+  EXPECT_EQ(store.read(log.data(), log.size()), log.size());
+  EXPECT_EQ(store.read(log.data(), log.size()), 0u);
+  EXPECT_EQ(decode_in_pieces(log, 7).size(), 2u);
+
+  uint8_t tiny[8];
+  CanLogMemoryStore no_room(tiny, sizeof(tiny));
+  EXPECT_FALSE(no_room.append(make_record(1, 0x100, 0)));
+}
+
+class CanLogPlayerTest : public ::testing::Test {
+ protected:
+  CanLogPlayerTest() : store(memory.data(), memory.size()), player(store) {}
+
+  std::vector<uint8_t> memory = std::vector<uint8_t>(64 * 1024);
+  CanLogMemoryStore store;
+  CanLogPlayer player;
+};
+
+TEST_F(CanLogPlayerTest, EmptyLogDoesNotStart) {
+  EXPECT_FALSE(player.start(0));
+}
+
+TEST_F(CanLogPlayerTest, FramesAreDueAtTheirOffsetFromStart) {
+  store.append(make_record(5000000, 0x100, 8));
+  store.append(make_record(5000250, 0x101, 8));
+  store.append(make_record(5010000, 0x102, 8));
+
+  ASSERT_TRUE(player.start(1000));
+  uint64_t due_us;
+  CanLogRecord record;
+
+  ASSERT_TRUE(player.next_due(due_us));
+  EXPECT_EQ(due_us, 1000u);
+  ASSERT_TRUE(player.pop_due(1000, record));
+  EXPECT_EQ(record.id, 0x100u);
+
+  ASSERT_TRUE(player.next_due(due_us));
+  EXPECT_EQ(due_us, 1250u);
+  EXPECT_FALSE(player.pop_due(1249, record));
+  ASSERT_TRUE(player.pop_due(1250, record));
+  EXPECT_EQ(record.id, 0x101u);
+
+  ASSERT_TRUE(player.next_due(due_us));
+  EXPECT_EQ(due_us, 11000u);
+  ASSERT_TRUE(player.pop_due(20000, record));
+  EXPECT_FALSE(player.next_due(due_us));
+  EXPECT_EQ(player.frames_played(), 3u);
+}
+
+TEST_F(CanLogPlayerTest, SpeedScalesTheGaps) {
+  store.append(make_record(0, 0x100, 1));
+  store.append(make_record(1000, 0x101, 1));
+  uint64_t due_us;
+  CanLogRecord record;
+
+  ASSERT_TRUE(player.start(0, 200));
+  player.pop_due(0, record);
+  ASSERT_TRUE(player.next_due(due_us));
+  EXPECT_EQ(due_us, 500u);
+
+  ASSERT_TRUE(player.start(0, 25));
+  player.pop_due(0, record);
+  ASSERT_TRUE(player.next_due(due_us));
+  EXPECT_EQ(due_us, 4000u);
+}
+
+TEST_F(CanLogPlayerTest, TimestampGoingBackwardsContinuesFromThePreviousFrame) {
+  store.append(make_record(9000, 0x100, 1));
+  store.append(make_record(10000, 0x101, 1));
+  store.append(make_record(100, 0x102, 1));  // Second log joined on
+  store.append(make_record(600, 0x103, 1));
+  uint64_t due_us;
+  CanLogRecord record;
+
+  ASSERT_TRUE(player.start(0));
+  std::vector<uint64_t> due;
+  while (player.next_due(due_us)) {
+    due.push_back(due_us);
+    player.pop_due(due_us, record);
+  }
+  EXPECT_EQ(due, (std::vector<uint64_t>{0, 1000, 1000, 1500}));
+}
+
+TEST_F(CanLogPlayerTest, PlaysLogsMuchLargerThanTheQueueInOrder) {
+  const uint32_t frames = CAN_REPLAY_QUEUE_SIZE * 20 + 7;
+  for (uint32_t i = 0; i < frames; i++) {
+    ASSERT_TRUE(store.append(make_record(i * 10, i, (i % 3 == 0) ? 64 : (i % 9))));
+  }
+
+  for (int round = 0; round < 2; round++) {  // A looped replay starts over
+    ASSERT_TRUE(player.start(0));
+    uint64_t due_us;
+    CanLogRecord record;
+    uint32_t expected = 0;
+    while (player.next_due(due_us)) {
+      ASSERT_TRUE(player.pop_due(due_us, record));
+      ASSERT_EQ(record.id, expected);
+      ASSERT_EQ(due_us, expected * 10u);
+      expected++;
+    }
+    EXPECT_EQ(expected, frames);
+  }
+}
@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include "../Software/src/communication/can/CanSignal.h"
+
+#include <random>
+
+// Bit by bit reference, walking the signal the way a DBC file describes it
+static uint64_t reference_decode(const uint8_t* data, int start_bit, int length, ByteOrder order) {
+  uint64_t raw = 0;
+  if (order == ByteOrder::LittleEndian) {
+    for (int i = 0; i < length; i++) {
+      int bit = start_bit + i;
+      raw |= (uint64_t)((data[bit / 8] >> (bit % 8)) & 1) << i;
+    }
+  } else {
+    int bit = start_bit;
+    for (int i = 0; i < length; i++) {
+      raw = (raw << 1) | ((data[bit / 8] >> (bit % 8)) & 1);
+      bit = (bit % 8 == 0) ? bit + 15 : bit - 1;
+    }
+  }
+  return raw;
+}
+
+template <typename Signal>
+static void expect_matches_reference(int start_bit, int length, ByteOrder order) {
+  std::mt19937 random(start_bit * 100 + length);
+  for (int round = 0; round < 200; round++) {
+    uint8_t data[64];
+    for (uint8_t& byte : data) {
+      byte = random();
+    }
+    uint64_t expected = reference_decode(data, start_bit, length, order);
+    EXPECT_EQ((uint64_t)Signal::decode(data), expected) << "start " << start_bit << " length " << length;
+
+    // Writing a new value changes only the bits of the signal
+    uint8_t before[64];
+    memcpy(before, data, sizeof(data));
+    uint64_t value = ((uint64_t)random() << 32 | random()) & Signal::mask;
+    Signal::encode(data, value);
+    EXPECT_EQ(reference_decode(data, start_bit, length, order), value);
+    Signal::encode(data, expected);
+    EXPECT_EQ(memcmp(data, before, sizeof(data)), 0);
+  }
+}
+
+TEST(CanSignalTests, LittleEndianMatchesReference) {
+  expect_matches_reference<CanSignal<0, 8>>(0, 8, ByteOrder::LittleEndian);
+  expect_matches_reference<CanSignal<31, 4>>(31, 4, ByteOrder::LittleEndian);
+  expect_matches_reference<CanSignal<29, 1>>(29, 1, ByteOrder::LittleEndian);
+  expect_matches_reference<CanSignal<16, 10>>(16, 10, ByteOrder::LittleEndian);
+  expect_matches_reference<CanSignal<10, 54>>(10, 54, ByteOrder::LittleEndian);
+  expect_matches_reference<CanSignal<3, 64>>(3, 64, ByteOrder::LittleEndian);
+  expect_matches_reference<CanSignal<500, 12>>(500, 12, ByteOrder::LittleEndian);
+}
+
+TEST(CanSignalTests, BigEndianMatchesReference) {
+  expect_matches_reference<CanSignal<7, 16, ByteOrder::BigEndian>>(7, 16, ByteOrder::BigEndian);
+  expect_matches_reference<CanSignal<12, 8, ByteOrder::BigEndian>>(12, 8, ByteOrder::BigEndian);
+  expect_matches_reference<CanSignal<39, 1, ByteOrder::BigEndian>>(39, 1, ByteOrder::BigEndian);
+  expect_matches_reference<CanSignal<21, 13, ByteOrder::BigEndian>>(21, 13, ByteOrder::BigEndian);
+  expect_matches_reference<CanSignal<4, 64, ByteOrder::BigEndian>>(4, 64, ByteOrder::BigEndian);
+}
+
+TEST(CanSignalTests, DecodesHandWrittenExpressions) {
+  CAN_frame frame = {.FD = false, .ext_ID = false, .DLC = 8, .ID = 0x123,
+                     .data = {0x12, 0x34, 0x56, 0x78, 0x9A, 0xBC, 0xDE, 0xF0}};
+  // (data[3] << 8) | data[2]
+  EXPECT_EQ((CanSignal<16, 16>::decode(frame)), 0x7856u);
+  // (data[2] << 8) | data[3]
+  EXPECT_EQ((CanSignal<23, 16, ByteOrder::BigEndian>::decode(frame)), 0x5678u);
+  // data[4] >> 4
+  EXPECT_EQ((CanSignal<36, 4>::decode(frame)), 0x9u);
+}
+
+TEST(CanSignalTests, SignExtends) {
+  uint8_t data[8] = {0x00, 0xFE, 0x03};
+  EXPECT_EQ((CanSignal<8, 10, ByteOrder::LittleEndian, true>::decode(data)), -2);
+  EXPECT_EQ((CanSignal<8, 10, ByteOrder::LittleEndian, false>::decode(data)), 0x3FEu);
+  EXPECT_EQ((CanSignal<8, 11, ByteOrder::LittleEndian, true>::decode(data)), 0x3FE);
+
+  uint8_t full[8] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+  EXPECT_EQ((CanSignal<0, 64, ByteOrder::LittleEndian, true>::decode(full)), -1);
+}
+
+TEST(CanSignalTests, AppliesScaleAndOffset) {
+  typedef CanSignal<16, 10, ByteOrder::LittleEndian, true, 0.5f, -40.0f> Temperature;
+  uint8_t data[8] = {0};
+
+  Temperature::encode_value(data, 25.5f);
+  EXPECT_EQ(Temperature::decode(data), 131);
+  EXPECT_FLOAT_EQ(Temperature::decode_value(data), 25.5f);
+
+  Temperature::encode_value(data, -100.0f);
+  EXPECT_EQ(Temperature::decode(data), -120);
+  EXPECT_FLOAT_EQ(Temperature::decode_value(data), -100.0f);
+}
+
+TEST(CanSignalTests, ClampsToRange) {
+  uint8_t data[8] = {0};
+  CanSignal<16, 10>::encode(data, 5000);
+  EXPECT_EQ((CanSignal<16, 10>::decode(data)), 1023u);
+
+  typedef CanSignal<0, 8, ByteOrder::LittleEndian, true> Signed8;
+  Signed8::encode(data, -1000);
+  EXPECT_EQ(Signed8::decode(data), -128);
+  Signed8::encode_value(data, 1000.0f);
+  EXPECT_EQ(Signed8::decode(data), 127);
+  // The neighbouring signal is untouched
+  EXPECT_EQ((CanSignal<16, 10>::decode(data)), 1023u);
+}
+
+TEST(CanSignalTests, WorksAtCompileTime) {
+  static constexpr uint8_t data[8] = {0x00, 0x00, 0x00, 0xA0, 0x01};
+  static_assert(CanSignal<28, 8>::decode(data) == 0x1A, "decoded at compile time");
+  static_assert(CanSignal<28, 8>::mask == 0xFF, "mask");
+  static_assert(CanSignal<0, 12, ByteOrder::LittleEndian, true>::min_raw == -2048, "range");
+}
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+
+#include "../Software/src/communication/can/CanTxScheduler.h"
+
+#include <vector>
+
+struct SentFrame {
+  unsigned long time_ms;
+  uint32_t id;
+  CAN_Interface interface;
+};
+
+static std::vector<SentFrame> sent_frames;
+static unsigned long now_ms;
+
+static void record_frame(const CAN_frame* frame, CAN_Interface interface) {
+  sent_frames.push_back({now_ms, frame->ID, interface});
+}
+
+class CanTxSchedulerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    sent_frames.clear();
+    now_ms = 0;
+  }
+
+  void run_until(CanTxScheduler& scheduler, unsigned long end_ms) {
+    for (; now_ms < end_ms; now_ms++) {
+      scheduler.run(now_ms);
+    }
+  }
+
+  CAN_frame make_frame(uint32_t id) { return {.FD = false, .ext_ID = false, .DLC = 8, .ID = id, .data = {}}; }
+};
+
+TEST_F(CanTxSchedulerTest, SendsAtPeriodAndPhase) {
+  CanTxScheduler scheduler(record_frame);
+  CAN_frame frame = make_frame(0x100);
+  scheduler.add(&frame, CAN_NATIVE, 100, nullptr, 7);
+
+  run_until(scheduler, 1000);
+
+  ASSERT_EQ(sent_frames.size(), 10u);
+  for (size_t i = 0; i < sent_frames.size(); i++) {
+    EXPECT_EQ(sent_frames[i].time_ms, i * 100 + 7);
+    EXPECT_EQ(sent_frames[i].interface, CAN_NATIVE);
+  }
+}
+
+TEST_F(CanTxSchedulerTest, SpreadsPhasesOnSameInterface) {
+  CanTxScheduler scheduler(record_frame);
+  CAN_frame frames[4] = {make_frame(1), make_frame(2), make_frame(3), make_frame(4)};
+
+  EXPECT_EQ(scheduler.add(&frames[0], CAN_NATIVE, 100), 0u);
+  EXPECT_EQ(scheduler.add(&frames[1], CAN_NATIVE, 100), 1u);
+  // A 50 ms frame collides with phases 0 and 1 of the 100 ms ones at 50 and 51 too
+  EXPECT_EQ(scheduler.add(&frames[2], CAN_NATIVE, 50), 2u);
+  // Other interfaces have their own bus and start at 0 again
+  EXPECT_EQ(scheduler.add(&frames[3], CAN_ADDON_MCP2515, 100), 0u);
+
+  run_until(scheduler, 200);
+
+  // Never more than one frame per millisecond and interface
+  for (size_t i = 1; i < sent_frames.size(); i++) {
+    if (sent_frames[i].interface == sent_frames[i - 1].interface) {
+      EXPECT_NE(sent_frames[i].time_ms, sent_frames[i - 1].time_ms);
+    }
+  }
+}
+
+TEST_F(CanTxSchedulerTest, RefreshCallbackUpdatesAndGates) {
+  CanTxScheduler scheduler(record_frame);
+  CAN_frame frame = make_frame(0x200);
+  bool enabled = false;
+  int refreshed = 0;
+
+  scheduler.add(&frame, CAN_NATIVE, 10, [&](CAN_frame* f) {
+    refreshed++;
+    f->data.u8[0] = refreshed;
+    return enabled;
+  });
+
+  run_until(scheduler, 50);
+  EXPECT_EQ(refreshed, 5);
+  EXPECT_TRUE(sent_frames.empty());
+
+  enabled = true;
+  run_until(scheduler, 100);
+  EXPECT_EQ(sent_frames.size(), 5u);
+  EXPECT_EQ(frame.data.u8[0], 10);
+}
+
+TEST_F(CanTxSchedulerTest, SkipsMissedDeadlinesInsteadOfBursting) {
+  CanTxScheduler scheduler(record_frame);
+  CAN_frame frame = make_frame(0x300);
+  scheduler.add(&frame, CAN_NATIVE, 10, nullptr, 0);
+
+  scheduler.run(0);
+  // Core task stalled for 95 ms
+  now_ms = 95;
+  scheduler.run(now_ms);
+  now_ms = 100;
+  scheduler.run(now_ms);
+
+  ASSERT_EQ(sent_frames.size(), 3u);
+  EXPECT_EQ(sent_frames[1].time_ms, 95u);
+  EXPECT_EQ(sent_frames[2].time_ms, 100u);
+}
+
+TEST_F(CanTxSchedulerTest, FramesAddedLaterKeepTheirPhase) {
+  CanTxScheduler scheduler(record_frame);
+  CAN_frame frame = make_frame(0x400);
+
+  run_until(scheduler, 1234);
+  scheduler.add(&frame, CAN_NATIVE, 100, nullptr, 20);
+  run_until(scheduler, 1500);
+
+  ASSERT_EQ(sent_frames.size(), 2u);
+  EXPECT_EQ(sent_frames[0].time_ms, 1320u);
+  EXPECT_EQ(sent_frames[1].time_ms, 1420u);
+}
@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+
+#include "../Software/src/devboard/utils/cell_statistics.h"
+#include "../Software/src/system_settings.h"
+
+#include <math.h>
+#include <vector>
+
+TEST(CellStatisticsTests, FindsExtremesMeanAndDeviation) {
+  uint16_t voltages_mV[] = {3700, 3710, 3690, 3705, 3695, 3720, 3680};
+  bool balancing[7] = {false, true, false, false, false, true, false};
+  CellStatistics statistics;
+  compute_cell_statistics(voltages_mV, balancing, 7, statistics);
+
+  EXPECT_EQ(statistics.cells, 7u);
+  EXPECT_EQ(statistics.min_mV, 3680u);
+  EXPECT_EQ(statistics.min_index, 6u);
+  EXPECT_EQ(statistics.max_mV, 3720u);
+  EXPECT_EQ(statistics.max_index, 5u);
+  EXPECT_EQ(statistics.mean_mV, 3700u);
+  EXPECT_EQ(statistics.balancing, 2u);
+  EXPECT_EQ(statistics.outliers, 0u);
+
+  // sqrt((0 + 100 + 100 + 25 + 25 + 400 + 400) / 7) mV
+  EXPECT_NEAR(statistics.stddev_uV, 12247u, 1u);
+}
+
+TEST(CellStatisticsTests, MatchesAPlainLoopOverAFullPack) {
+  std::vector<uint16_t> voltages_mV(MAX_AMOUNT_CELLS);
+  bool balancing[MAX_AMOUNT_CELLS] = {false};
+  for (int i = 0; i < MAX_AMOUNT_CELLS; i++) {
+    voltages_mV[i] = 3600 + (i * 37) % 41;
+  }
+  voltages_mV[150] = 3500;  // An outlier, and two cells that tie for the highest
+  voltages_mV[11] = 3700;
+  voltages_mV[131] = 3700;
+
+  CellStatistics statistics;
+  compute_cell_statistics(voltages_mV.data(), balancing, MAX_AMOUNT_CELLS, statistics);
+
+  double sum = 0;
+  for (uint16_t voltage_mV : voltages_mV) {
+    sum += voltage_mV;
+  }
+  double mean = sum / MAX_AMOUNT_CELLS;
+  double squares = 0;
+  for (uint16_t voltage_mV : voltages_mV) {
+    squares += (voltage_mV - mean) * (voltage_mV - mean);
+  }
+
+  EXPECT_EQ(statistics.cells, MAX_AMOUNT_CELLS);
+  EXPECT_EQ(statistics.min_mV, 3500u);
+  EXPECT_EQ(statistics.min_index, 150u);
+  EXPECT_EQ(statistics.max_mV, 3700u);
+  EXPECT_EQ(statistics.max_index, 11u);
+  EXPECT_EQ(statistics.mean_mV, (uint16_t)lround(mean));
+  EXPECT_NEAR(statistics.stddev_uV, sqrt(squares / MAX_AMOUNT_CELLS) * 1000, 1);
+  EXPECT_EQ(statistics.outliers, 3u);  // The low cell and the two high ones
+}
+
+TEST(CellStatisticsTests, UnmeasuredCellsAreLeftOut) {
+  uint16_t voltages_mV[] = {0, 3650, 3630, 3640, 3660};
+  bool balancing[5] = {false};
+  CellStatistics statistics;
+  compute_cell_statistics(voltages_mV, balancing, 5, statistics);
+
+  EXPECT_EQ(statistics.cells, 4u);
+  EXPECT_EQ(statistics.min_mV, 3630u);
+  EXPECT_EQ(statistics.min_index, 2u);
+  EXPECT_EQ(statistics.mean_mV, 3645u);
+
+  uint16_t none_mV[4] = {0};
+  compute_cell_statistics(none_mV, balancing, 4, statistics);
+  EXPECT_EQ(statistics.cells, 0u);
+  EXPECT_EQ(statistics.min_mV, 0u);
+  EXPECT_EQ(statistics.stddev_uV, 0u);
+}
@@ -140,6 +140,11 @@ int max(int a, int b);
 
 bool ledcAttachChannel(uint8_t pin, uint32_t freq, uint8_t resolution, int8_t channel);
 bool ledcWrite(uint8_t pin, uint32_t duty);
+bool ledcWriteTone(uint8_t pin, uint32_t freq);
+
+inline float temperatureRead() {
+  return 20.0f;  // Room temperature, the host has no chip sensor to read
+}
 
 class ESPClass {
  public:
@@ -148,6 +153,7 @@ class ESPClass {
     // that retrieves the flash chip size.
     return 4 * 1024 * 1024;  // Example: returning 4MB
   }
+  uint32_t getFreeHeap() { return 200 * 1024; }
 };
 
 extern ESPClass ESP;
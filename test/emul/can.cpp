@@ -19,4 +19,4 @@ char const* getCANInterfaceName(CAN_Interface) {
 
 void register_transmitter(Transmitter* transmitter) {}
 
-void dump_can_frame(CAN_frame& frame, CAN_Interface interface, frameDirection msgDir) {}
+void dump_can_frame(const CAN_frame& frame, CAN_Interface interface, frameDirection msgDir) {}
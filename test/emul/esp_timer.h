@@ -0,0 +1,9 @@
+#ifndef ESP_TIMER_H
+#define ESP_TIMER_H
+
+#include <stdint.h>
+
+// Microseconds since boot, on the same emulated clock as millis()
+int64_t esp_timer_get_time();
+
+#endif
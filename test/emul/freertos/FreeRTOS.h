@@ -10,6 +10,23 @@ typedef unsigned int UBaseType_t;
 
 const BaseType_t tskNO_AFFINITY = -1;
 
+// Critical sections are a spinlock shared by both cores on the ESP32
+typedef struct {
+  volatile bool locked;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED \
+  { false }
+
+inline void portENTER_CRITICAL(portMUX_TYPE* mux) {
+  while (__atomic_exchange_n(&mux->locked, true, __ATOMIC_ACQUIRE)) {
+  }
+}
+
+inline void portEXIT_CRITICAL(portMUX_TYPE* mux) {
+  __atomic_store_n(&mux->locked, false, __ATOMIC_RELEASE);
+}
+
 extern "C" {
 BaseType_t xTaskCreatePinnedToCore(TaskFunction_t pxTaskCode, const char* const pcName, const uint32_t ulStackDepth,
                                    void* const pvParameters, UBaseType_t uxPriority, TaskHandle_t* const pxCreatedTask,
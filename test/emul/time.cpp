@@ -1,4 +1,5 @@
 #include <stdint.h>
+#include "esp_timer.h"
 
 uint64_t current_time = 0;
 
@@ -17,3 +18,7 @@ uint64_t millis64(void) {
 void set_millis64(uint64_t time) {
   current_time = time;
 }
+
+int64_t esp_timer_get_time() {
+  return static_cast<int64_t>(current_time * 1000);
+}
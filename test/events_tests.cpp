@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+
+#include "../Software/src/devboard/utils/events.h"
+
+#include "Arduino.h"
+
+#include <atomic>
+#include <thread>
+
+class EventsTests : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    reset_all_events();
+    init_events();
+  }
+};
+
+TEST_F(EventsTests, LevelFollowsTheHighestActiveEvent) {
+  EXPECT_EQ(get_event_level(), EVENT_LEVEL_INFO);
+
+  // A warning, an error set twice and an info
+  set_event(EVENT_CONTACTOR_WELDED, 0);
+  set_event(EVENT_CAN_BATTERY_MISSING, 0);
+  set_event(EVENT_CAN_BATTERY_MISSING, 0);
+  set_event(EVENT_TASK_OVERRUN, 0);
+  EXPECT_EQ(get_event_level(), EVENT_LEVEL_ERROR);
+
+  clear_event(EVENT_CAN_BATTERY_MISSING);
+  EXPECT_EQ(get_event_level(), EVENT_LEVEL_WARNING);
+  clear_event(EVENT_CAN_BATTERY_MISSING);  // Already cleared, not counted twice
+  EXPECT_EQ(get_event_level(), EVENT_LEVEL_WARNING);
+
+  clear_event(EVENT_CONTACTOR_WELDED);
+  EXPECT_EQ(get_event_level(), EVENT_LEVEL_INFO);
+}
+
+TEST_F(EventsTests, LatchedEventsKeepTheLevel) {
+  set_event_latched(EVENT_CAN_BATTERY_MISSING, 0);
+  clear_event(EVENT_CAN_BATTERY_MISSING);
+  EXPECT_EQ(get_event_level(), EVENT_LEVEL_ERROR);
+
+  reset_all_events();
+  EXPECT_EQ(get_event_level(), EVENT_LEVEL_INFO);
+  set_event(EVENT_CONTACTOR_WELDED, 0);
+  clear_event(EVENT_CONTACTOR_WELDED);
+  EXPECT_EQ(get_event_level(), EVENT_LEVEL_INFO);
+}
+
+TEST_F(EventsTests, MessagesComeFromFlash) {
+  EXPECT_STREQ(get_event_message(EVENT_BALANCING_START), "Balancing has started");
+  EXPECT_EQ(get_event_message_string(EVENT_BALANCING_START), String("Balancing has started"));
+  EXPECT_STREQ(get_event_message(EVENT_NOF_EVENTS), "");
+}
+
+TEST_F(EventsTests, JournalHoldsTheTransitionsInOrder) {
+  uint32_t start = get_event_journal_sequence();
+  set_millis64(1000);
+  set_event(EVENT_CONTACTOR_WELDED, 7);
+  set_event(EVENT_CONTACTOR_WELDED, 8);  // Still active, not a transition
+  set_millis64(2000);
+  clear_event(EVENT_CONTACTOR_WELDED);
+
+  EVENT_JOURNAL_ENTRY_TYPE entries[4];
+  ASSERT_EQ(read_event_journal(start, entries, 4), 2u);
+  EXPECT_EQ(entries[0].sequence, start + 1);
+  EXPECT_EQ(entries[0].event, EVENT_CONTACTOR_WELDED);
+  EXPECT_TRUE(entries[0].active);
+  EXPECT_EQ(entries[0].data, 7);
+  EXPECT_EQ(entries[0].timestamp, 1000u);
+  EXPECT_EQ(entries[1].sequence, start + 2);
+  EXPECT_FALSE(entries[1].active);
+  EXPECT_EQ(entries[1].timestamp, 2000u);
+
+  // Incremental reads only get what is new
+  EXPECT_EQ(read_event_journal(start + 1, entries, 4), 1u);
+  EXPECT_EQ(entries[0].sequence, start + 2);
+  EXPECT_EQ(read_event_journal(start + 2, entries, 4), 0u);
+}
+
+TEST_F(EventsTests, JournalSkipsOverwrittenEntries) {
+  uint32_t start = get_event_journal_sequence();
+  for (int i = 0; i < EVENT_JOURNAL_SIZE; i++) {
+    set_event(EVENT_TASK_OVERRUN, i);
+    clear_event(EVENT_TASK_OVERRUN);
+  }
+  uint32_t latest = get_event_journal_sequence();
+  EXPECT_EQ(latest, start + 2 * EVENT_JOURNAL_SIZE);
+
+  EVENT_JOURNAL_ENTRY_TYPE entries[EVENT_JOURNAL_SIZE];
+  ASSERT_EQ(read_event_journal(start, entries, EVENT_JOURNAL_SIZE), (size_t)EVENT_JOURNAL_SIZE);
+  EXPECT_EQ(entries[0].sequence, latest - EVENT_JOURNAL_SIZE + 1);
+  EXPECT_EQ(entries[EVENT_JOURNAL_SIZE - 1].sequence, latest);
+
+  // A reader from before a restart starts over with what is there
+  ASSERT_EQ(read_event_journal(latest + 100, entries, 2), 2u);
+  EXPECT_EQ(entries[0].sequence, latest - EVENT_JOURNAL_SIZE + 1);
+}
+
+TEST_F(EventsTests, EventsChangedFromTwoCoresKeepTheLevelCounts) {
+  uint32_t start = get_event_journal_sequence();
+  const int rounds = 200000;
+  std::atomic<int> ready{0};
+  // Two warnings, so both threads change the count of the same level
+  auto toggle = [&](EVENTS_ENUM_TYPE event) {
+    ready++;
+    while (ready < 2) {
+    }
+    for (int i = 0; i < rounds; i++) {
+      set_event(event, 0);
+      clear_event(event);
+    }
+  };
+  std::thread other_core(toggle, EVENT_CONTACTOR_WELDED);
+  toggle(EVENT_CAN_CORRUPTED_WARNING);
+  other_core.join();
+
+  EXPECT_EQ(get_event_level(), EVENT_LEVEL_INFO);
+  EXPECT_EQ(get_event_journal_sequence(), start + 4u * rounds);
+}
@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+
+#include "../Software/src/devboard/webserver/html_writer.h"
+
+#include <string>
+#include <vector>
+
+class RecordingSink : public HtmlSink {
+ public:
+  void write(const char* data, size_t length) override {
+    text.append(data, length);
+    writes.push_back(length);
+  }
+
+  std::string text;
+  std::vector<size_t> writes;
+};
+
+TEST(HtmlWriterTests, SmallWritesAreMergedUntilFlushed) {
+  RecordingSink sink;
+  {
+    HtmlWriter content(sink);
+    content += "<h4>";
+    content += String("Battery");
+    content += '!';
+    content += "</h4>";
+    EXPECT_TRUE(sink.writes.empty());
+    EXPECT_EQ(content.length(), 17u);
+  }
+  EXPECT_EQ(sink.text, "<h4>Battery!</h4>");
+  EXPECT_EQ(sink.writes.size(), 1u);
+}
+
+TEST(HtmlWriterTests, NoWriteIsLargerThanTheBufferUnlessItComesInOnePiece) {
+  RecordingSink sink;
+  std::string expected;
+  std::string style(HTML_WRITER_BUFFER_SIZE * 3, 's');
+  {
+    HtmlWriter content(sink);
+    for (int i = 0; i < 100; i++) {
+      content += "<td>cell</td>";
+      expected += "<td>cell</td>";
+    }
+    content += style.c_str();  // Passed on as it is, not copied through the buffer
+    expected += style;
+    content += "</table>";
+    expected += "</table>";
+  }
+  EXPECT_EQ(sink.text, expected);
+  for (size_t length : sink.writes) {
+    EXPECT_TRUE(length <= HTML_WRITER_BUFFER_SIZE || length == style.size());
+  }
+}
+
+TEST(HtmlWriterTests, PrintfFormatsValues) {
+  RecordingSink sink;
+  {
+    HtmlWriter content(sink);
+    content.printf("<h4>SOC: %.2f&percnt;</h4>", 51.256f);
+    content.printf("<h4>Cell delta: %u mV</h4>", 12u);
+    content.printf("%lld us", (long long)-5);
+  }
+  EXPECT_EQ(sink.text, "<h4>SOC: 51.26&percnt;</h4><h4>Cell delta: 12 mV</h4>-5 us");
+}
+
+TEST(HtmlWriterTests, PrintfCutsOffAtTheFormatBuffer) {
+  RecordingSink sink;
+  std::string long_name(HTML_FORMAT_BUFFER_SIZE * 2, 'x');
+  size_t length;
+  {
+    HtmlWriter content(sink);
+    content.printf("%s", long_name.c_str());
+    length = content.length();
+  }
+  EXPECT_EQ(length, HTML_FORMAT_BUFFER_SIZE - 1u);
+  EXPECT_EQ(sink.text, long_name.substr(0, HTML_FORMAT_BUFFER_SIZE - 1));
+}
@@ -0,0 +1,408 @@
+#include <gtest/gtest.h>
+
+#include "../Software/src/battery/BMW-IX-BATTERY.h"
+#include "../Software/src/battery/ECMP-BATTERY.h"
+#include "../Software/src/battery/KIA-E-GMP-BATTERY.h"
+#include "../Software/src/battery/MEB-BATTERY.h"
+#include "../Software/src/battery/RENAULT-ZOE-GEN1-BATTERY.h"
+#include "../Software/src/battery/RENAULT-ZOE-GEN2-BATTERY.h"
+#include "../Software/src/communication/can/IsoTp.h"
+#include "../Software/src/communication/can/UdsClient.h"
+#include "../Software/src/datalayer/datalayer.h"
+#include "../Software/src/datalayer/datalayer_extended.h"
+
+#include <vector>
+
+static std::vector<CAN_frame> sent_frames;
+
+static void record_frame(const CAN_frame* frame, CAN_Interface /*interface*/) {
+  sent_frames.push_back(*frame);
+}
+
+static CAN_frame make_frame(uint32_t id, std::vector<uint8_t> data) {
+  CAN_frame frame = {.FD = false, .ext_ID = false, .DLC = (uint8_t)data.size(), .ID = id, .data = {}};
+  for (size_t i = 0; i < data.size(); i++) {
+    frame.data.u8[i] = data[i];
+  }
+  return frame;
+}
+
+class IsoTpTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    sent_frames.clear();
+    link.on_receive([this](const uint8_t* data, uint16_t length) { received.assign(data, data + length); });
+  }
+
+  IsoTpLink link{CAN_NATIVE, 0x7E0, 0x7E8, record_frame};
+  std::vector<uint8_t> received;
+};
+
+TEST_F(IsoTpTest, DeliversSingleFrame) {
+  EXPECT_TRUE(link.handle_frame(make_frame(0x7E8, {0x03, 0x62, 0xB0, 0x41, 0xAA, 0xAA, 0xAA, 0xAA}), 0));
+  EXPECT_EQ(received, (std::vector<uint8_t>{0x62, 0xB0, 0x41}));
+  EXPECT_TRUE(sent_frames.empty());
+}
+
+TEST_F(IsoTpTest, IgnoresOtherIds) {
+  EXPECT_FALSE(link.handle_frame(make_frame(0x7E9, {0x02, 0x50, 0x03}), 0));
+  EXPECT_TRUE(received.empty());
+}
+
+TEST_F(IsoTpTest, ReassemblesMultiFrameAndSendsFlowControl) {
+  link.set_flow_control(2, 5);
+  uint8_t pool_before = isotp_buffer_pool.available();
+
+  link.handle_frame(make_frame(0x7E8, {0x10, 0x1A, 1, 2, 3, 4, 5, 6}), 0);
+  ASSERT_EQ(sent_frames.size(), 1u);
+  EXPECT_EQ(sent_frames[0].ID, 0x7E0u);
+  EXPECT_EQ(sent_frames[0].data.u8[0], 0x30);
+  EXPECT_EQ(sent_frames[0].data.u8[1], 2);
+  EXPECT_EQ(sent_frames[0].data.u8[2], 5);
+  EXPECT_EQ(isotp_buffer_pool.available(), pool_before - 1);
+
+  link.handle_frame(make_frame(0x7E8, {0x21, 7, 8, 9, 10, 11, 12, 13}), 5);
+  link.handle_frame(make_frame(0x7E8, {0x22, 14, 15, 16, 17, 18, 19, 20}), 10);
+  // Block of two consecutive frames done, next flow control
+  EXPECT_EQ(sent_frames.size(), 2u);
+  EXPECT_TRUE(received.empty());
+
+  link.handle_frame(make_frame(0x7E8, {0x23, 21, 22, 23, 24, 25, 26, 0xAA}), 15);
+  ASSERT_EQ(received.size(), 26u);
+  for (int i = 0; i < 26; i++) {
+    EXPECT_EQ(received[i], i + 1);
+  }
+  EXPECT_EQ(isotp_buffer_pool.available(), pool_before);
+}
+
+TEST_F(IsoTpTest, DropsMessageOnSequenceError) {
+  uint8_t pool_before = isotp_buffer_pool.available();
+  link.handle_frame(make_frame(0x7E8, {0x10, 0x0A, 1, 2, 3, 4, 5, 6}), 0);
+  link.handle_frame(make_frame(0x7E8, {0x22, 7, 8, 9, 10}), 1);
+  link.handle_frame(make_frame(0x7E8, {0x21, 7, 8, 9, 10}), 2);
+
+  EXPECT_TRUE(received.empty());
+  EXPECT_EQ(link.errors(), 1);
+  EXPECT_EQ(isotp_buffer_pool.available(), pool_before);
+}
+
+TEST_F(IsoTpTest, ReleasesBufferOnTimeout) {
+  uint8_t pool_before = isotp_buffer_pool.available();
+  link.set_timeout(100);
+  link.handle_frame(make_frame(0x7E8, {0x10, 0x0A, 1, 2, 3, 4, 5, 6}), 0);
+  link.poll(100);
+  EXPECT_TRUE(link.receiving());
+  link.poll(101);
+  EXPECT_FALSE(link.receiving());
+  EXPECT_EQ(isotp_buffer_pool.available(), pool_before);
+}
+
+TEST_F(IsoTpTest, AnswersOverflowWhenPoolIsEmpty) {
+  std::vector<uint8_t*> taken;
+  while (uint8_t* buffer = isotp_buffer_pool.acquire()) {
+    taken.push_back(buffer);
+  }
+
+  link.handle_frame(make_frame(0x7E8, {0x10, 0x0A, 1, 2, 3, 4, 5, 6}), 0);
+  ASSERT_EQ(sent_frames.size(), 1u);
+  EXPECT_EQ(sent_frames[0].data.u8[0], 0x32);
+  EXPECT_FALSE(link.receiving());
+
+  for (uint8_t* buffer : taken) {
+    isotp_buffer_pool.release(buffer);
+  }
+}
+
+TEST_F(IsoTpTest, SendsSingleFramePadded) {
+  link.set_padding(0xAA);
+  uint8_t request[] = {0x22, 0xB0, 0x41};
+  EXPECT_TRUE(link.send(request, sizeof(request), 0));
+
+  ASSERT_EQ(sent_frames.size(), 1u);
+  EXPECT_EQ(sent_frames[0].DLC, 8);
+  EXPECT_EQ(sent_frames[0].data.u8[0], 0x03);
+  EXPECT_EQ(sent_frames[0].data.u8[1], 0x22);
+  EXPECT_EQ(sent_frames[0].data.u8[4], 0xAA);
+  EXPECT_FALSE(link.sending());
+}
+
+TEST_F(IsoTpTest, SendsMultiFrameWithBlockSizeAndSeparationTime) {
+  uint8_t request[20];
+  for (int i = 0; i < 20; i++) {
+    request[i] = i;
+  }
+  EXPECT_TRUE(link.send(request, sizeof(request), 0));
+  ASSERT_EQ(sent_frames.size(), 1u);
+  EXPECT_EQ(sent_frames[0].data.u8[0], 0x10);
+  EXPECT_EQ(sent_frames[0].data.u8[1], 20);
+  EXPECT_FALSE(link.send(request, sizeof(request), 0));  // Busy
+
+  // Nothing before the flow control
+  link.poll(10);
+  EXPECT_EQ(sent_frames.size(), 1u);
+
+  // Block size 1, 20 ms apart
+  link.handle_frame(make_frame(0x7E8, {0x30, 0x01, 0x14}), 10);
+  ASSERT_EQ(sent_frames.size(), 2u);
+  EXPECT_EQ(sent_frames[1].data.u8[0], 0x21);
+  EXPECT_EQ(sent_frames[1].data.u8[1], 6);
+
+  // Waits for the next flow control
+  link.poll(100);
+  EXPECT_EQ(sent_frames.size(), 2u);
+
+  // Unlimited block, 20 ms apart
+  link.handle_frame(make_frame(0x7E8, {0x30, 0x00, 0x14}), 100);
+  EXPECT_EQ(sent_frames.size(), 3u);
+  link.poll(119);
+  EXPECT_EQ(sent_frames.size(), 3u);
+  link.poll(120);
+  ASSERT_EQ(sent_frames.size(), 3u);
+  EXPECT_EQ(sent_frames[2].data.u8[0], 0x22);
+  EXPECT_EQ(sent_frames[2].data.u8[1], 13);
+  EXPECT_FALSE(link.sending());
+}
+
+TEST_F(IsoTpTest, ExtendedAddressing) {
+  link.set_addresses(0x40, 0xF1);
+  EXPECT_FALSE(link.handle_frame(make_frame(0x7E8, {0x12, 0x02, 0x50, 0x03}), 0));
+  EXPECT_TRUE(link.handle_frame(make_frame(0x7E8, {0xF1, 0x02, 0x50, 0x03}), 0));
+  EXPECT_EQ(received, (std::vector<uint8_t>{0x50, 0x03}));
+
+  uint8_t request[] = {0x10, 0x03};
+  link.send(request, sizeof(request), 0);
+  ASSERT_EQ(sent_frames.size(), 1u);
+  EXPECT_EQ(sent_frames[0].data.u8[0], 0x40);
+  EXPECT_EQ(sent_frames[0].data.u8[1], 0x02);
+  EXPECT_EQ(sent_frames[0].data.u8[2], 0x10);
+}
+
+class UdsClientTest : public ::testing::Test {
+ protected:
+  void SetUp() override { sent_frames.clear(); }
+
+  UdsClient uds{CAN_NATIVE, 0x781, 0x789, record_frame};
+  std::vector<UdsClient::Result> results;
+  std::vector<uint16_t> values;
+
+  UdsClient::ResponseCallback record_result() {
+    return [this](const UdsClient::Response& response) {
+      results.push_back(response.result);
+      if (response.result == UdsClient::Result::Positive && response.length >= 5) {
+        values.push_back((response.data[3] << 8) | response.data[4]);
+      }
+    };
+  }
+};
+
+TEST_F(UdsClientTest, SendsQueuedRequestsBackToBack) {
+  uds.read_data_by_identifier(0xB041, record_result());
+  uds.read_data_by_identifier(0xB042, record_result());
+  EXPECT_EQ(uds.queued(), 2);
+
+  uds.poll(0);
+  ASSERT_EQ(sent_frames.size(), 1u);
+  EXPECT_EQ(sent_frames[0].data.u8[1], 0x22);
+  EXPECT_EQ(sent_frames[0].data.u8[3], 0x41);
+
+  uds.handle_frame(make_frame(0x789, {0x05, 0x62, 0xB0, 0x41, 0x01, 0x02}), 3);
+  uds.poll(4);
+  ASSERT_EQ(sent_frames.size(), 2u);
+  EXPECT_EQ(sent_frames[1].data.u8[3], 0x42);
+
+  uds.handle_frame(make_frame(0x789, {0x05, 0x62, 0xB0, 0x42, 0x03, 0x04}), 6);
+  EXPECT_EQ(results, (std::vector<UdsClient::Result>{UdsClient::Result::Positive, UdsClient::Result::Positive}));
+  EXPECT_EQ(values, (std::vector<uint16_t>{0x0102, 0x0304}));
+  EXPECT_TRUE(uds.idle());
+}
+
+TEST_F(UdsClientTest, TimedOutRequestDoesNotStallQueue) {
+  uds.set_timeouts(100, 1000);
+  uds.read_data_by_identifier(0xB041, record_result());
+  uds.read_data_by_identifier(0xB042, record_result());
+
+  uds.poll(0);
+  uds.poll(100);
+  EXPECT_EQ(sent_frames.size(), 1u);
+  uds.poll(101);
+  ASSERT_EQ(results.size(), 1u);
+  EXPECT_EQ(results[0], UdsClient::Result::Timeout);
+  EXPECT_EQ(uds.timeouts(), 1);
+  ASSERT_EQ(sent_frames.size(), 2u);
+  EXPECT_EQ(sent_frames[1].data.u8[3], 0x42);
+
+  // The late answer to the first request is not taken for the second one
+  uds.handle_frame(make_frame(0x789, {0x05, 0x62, 0xB0, 0x41, 0x01, 0x02}), 102);
+  EXPECT_EQ(results.size(), 1u);
+  uds.handle_frame(make_frame(0x789, {0x05, 0x62, 0xB0, 0x42, 0x03, 0x04}), 103);
+  ASSERT_EQ(results.size(), 2u);
+  EXPECT_EQ(values, (std::vector<uint16_t>{0x0304}));
+}
+
+TEST_F(UdsClientTest, ResponsePendingExtendsTimeout) {
+  uds.set_timeouts(100, 1000);
+  uint8_t clear_dtcs[] = {0x14, 0xFF, 0xFF, 0xFF};
+  uds.request(clear_dtcs, sizeof(clear_dtcs), record_result());
+
+  uds.poll(0);
+  uds.handle_frame(make_frame(0x789, {0x03, 0x7F, 0x14, 0x78}), 50);
+  uds.poll(500);
+  EXPECT_TRUE(results.empty());
+
+  uds.handle_frame(make_frame(0x789, {0x01, 0x54}), 600);
+  ASSERT_EQ(results.size(), 1u);
+  EXPECT_EQ(results[0], UdsClient::Result::Positive);
+}
+
+TEST_F(UdsClientTest, ReportsNegativeResponse) {
+  UdsClient::Response last = {};
+  uint8_t session[] = {0x10, 0x03};
+  uds.request(session, sizeof(session), [&last](const UdsClient::Response& response) { last = response; });
+
+  uds.poll(0);
+  uds.handle_frame(make_frame(0x789, {0x03, 0x7F, 0x10, 0x22}), 5);
+  EXPECT_EQ(last.result, UdsClient::Result::Negative);
+  EXPECT_EQ(last.service, 0x10);
+  EXPECT_EQ(last.nrc, 0x22);
+}
+
+TEST_F(UdsClientTest, ReceivesMultiFrameResponse) {
+  uint16_t length = 0;
+  uint8_t read_dtcs[] = {0x19, 0x02, 0xFF};
+  uds.request(read_dtcs, sizeof(read_dtcs),
+              [&length](const UdsClient::Response& response) { length = response.length; });
+
+  uds.poll(0);
+  uds.handle_frame(make_frame(0x789, {0x10, 0x0B, 0x59, 0x02, 0xFF, 0x01, 0x02, 0x03}), 10);
+  EXPECT_EQ(sent_frames.back().data.u8[0], 0x30);  // Flow control
+  uds.handle_frame(make_frame(0x789, {0x21, 0x08, 0x04, 0x05, 0x06, 0x09, 0x00, 0x00}), 11);
+  EXPECT_EQ(length, 11);
+}
+
+// Feeds a classic CAN multi-frame response into a battery, first frame followed by consecutive frames
+static void receive_multi_frame(CanBattery& battery, uint32_t id, const std::vector<uint8_t>& message) {
+  battery.handle_incoming_can_frame(make_frame(id, {(uint8_t)(0x10 | (message.size() >> 8)), (uint8_t)message.size(),
+                                                    message[0], message[1], message[2], message[3], message[4],
+                                                    message[5]}));
+  for (size_t offset = 6, sequence = 1; offset < message.size(); offset += 7, sequence++) {
+    std::vector<uint8_t> frame = {(uint8_t)(0x20 | (sequence & 0x0F))};
+    for (size_t i = offset; i < offset + 7; i++) {
+      frame.push_back(i < message.size() ? message[i] : 0xAA);
+    }
+    battery.handle_incoming_can_frame(make_frame(id, frame));
+  }
+}
+
+TEST(UdsBatteryTest, KiaEGmpDecodesCellVoltagesFromReassembledPid) {
+  KiaEGmpBattery battery;
+  battery.setup();
+  battery.handle_incoming_can_frame(make_frame(0x055, {0, 0, 0, 0, 0, 0, 0, 0}));
+  battery.transmit_can(10000);  // Polling starts after 10 s
+  battery.transmit_can(10200);  // Polls PID 0x0102, cells 1-32
+
+  // 0x62 0x01 0x02, three unused bytes, 32 cell voltages in 20 mV steps
+  std::vector<uint8_t> message = {0x62, 0x01, 0x02, 0x00, 0x00, 0x00, 0x00};
+  for (int cell = 0; cell < 32; cell++) {
+    message.push_back(180 + cell % 8);
+  }
+  receive_multi_frame(battery, 0x7EC, message);
+
+  for (int cell = 0; cell < 32; cell++) {
+    EXPECT_EQ(datalayer.battery.status.cell_voltages_mV[cell], (180 + cell % 8) * 20);
+  }
+}
+
+TEST(UdsBatteryTest, ZoeGen2DecodesBalanceSwitchesAndIgnoresNegativeResponses) {
+  RenaultZoeGen2Battery battery;
+  battery.setup();
+
+  battery.handle_incoming_can_frame(make_frame(0x18DAF1DB, {0x03, 0x7F, 0x22, 0x31, 0xAA, 0xAA, 0xAA, 0xAA}));
+
+  // 0x62 0x91 0x2B, 20 unused bytes, then one bit per cell: only cells 0, 40 and 95 balance
+  std::vector<uint8_t> message(35, 0x00);
+  message[0] = 0x62;
+  message[1] = 0x91;
+  message[2] = 0x2B;
+  message[23] = 0x80;
+  message[28] = 0x80;
+  message[34] = 0x01;
+  receive_multi_frame(battery, 0x18DAF1DB, message);
+
+  for (int cell = 0; cell < 96; cell++) {
+    EXPECT_EQ(datalayer.battery.status.cell_balancing_status[cell], cell == 0 || cell == 40 || cell == 95) << cell;
+  }
+}
+
+TEST(UdsBatteryTest, MebDecodesClassicAndEscapedSingleFrames) {
+  MebBattery battery;
+  battery.setup();
+
+  // Cell 1 in a classic single frame, 3123 mV - 1000
+  battery.handle_incoming_can_frame(make_frame(0x1C42007B, {0x05, 0x62, 0x1E, 0x40, 0x08, 0x4B, 0x55, 0x55}));
+
+  // Energy counters in a CAN-FD single frame with the length in the second byte
+  CAN_frame energy = make_frame(0x1C42007B, {0x00, 0x13, 0x62, 0x1E, 0x32});
+  energy.FD = true;
+  energy.DLC = 24;
+  energy.data.u8[15] = 0x27;  // kWh charged, 10000 * 0.1165 Wh
+  energy.data.u8[16] = 0x10;
+  energy.data.u8[19] = 0x4E;  // kWh discharged, 20000 * 0.1165 Wh
+  energy.data.u8[20] = 0x20;
+  battery.handle_incoming_can_frame(energy);
+  battery.update_values();
+
+  EXPECT_EQ(datalayer.battery.status.cell_voltages_mV[0], 3123);
+  EXPECT_EQ(datalayer.battery.status.total_charged_battery_Wh, 1165);
+  EXPECT_EQ(datalayer.battery.status.total_discharged_battery_Wh, 2330);
+}
+
+TEST(UdsBatteryTest, ZoeGen1DecodesCellVoltageGroupsAcrossSequenceWrap) {
+  RenaultZoeGen1Battery battery;
+  battery.setup();
+
+  // 0x61 0x41, cells 1-62, long enough for the sequence number to wrap from 0x2F to 0x20
+  std::vector<uint8_t> group1 = {0x61, 0x41};
+  for (int cell = 0; cell < 62; cell++) {
+    group1.push_back((3500 + cell) >> 8);
+    group1.push_back((3500 + cell) & 0xFF);
+  }
+  receive_multi_frame(battery, 0x7BB, group1);
+
+  // 0x61 0x42, cells 63-96, publishes all cells
+  std::vector<uint8_t> group2 = {0x61, 0x42};
+  for (int cell = 62; cell < 96; cell++) {
+    group2.push_back((3500 + cell) >> 8);
+    group2.push_back((3500 + cell) & 0xFF);
+  }
+  receive_multi_frame(battery, 0x7BB, group2);
+
+  for (int cell = 0; cell < 96; cell++) {
+    EXPECT_EQ(datalayer.battery.status.cell_voltages_mV[cell], 3500 + cell) << cell;
+  }
+}
+
+TEST(UdsBatteryTest, BmwIxReassemblesExtendedAddressedCellVoltages) {
+  BmwIXBattery battery;
+  battery.setup();
+
+  // 0x62 0xE5 0x54 and three cell voltages, F4 is our address on every frame
+  battery.handle_incoming_can_frame(make_frame(0x607, {0xF4, 0x10, 0x09, 0x62, 0xE5, 0x54, 0x0E, 0x10}));
+  battery.handle_incoming_can_frame(make_frame(0x607, {0xF4, 0x21, 0x0E, 0x11, 0x0E, 0x12, 0xAA, 0xAA}));
+
+  EXPECT_EQ(datalayer.battery.status.cell_voltages_mV[0], 3600);
+  EXPECT_EQ(datalayer.battery.status.cell_voltages_mV[1], 3601);
+  EXPECT_EQ(datalayer.battery.status.cell_voltages_mV[2], 3602);
+}
+
+TEST(UdsBatteryTest, EcmpDecodesSingleFramePidsAndReassembledSerial) {
+  EcmpBattery battery;
+  battery.setup();
+
+  battery.handle_incoming_can_frame(make_frame(0x694, {0x04, 0x62, 0xD8, 0x14, 0x02}));  // Weld check
+  receive_multi_frame(battery, 0x694, {0x62, 0xD9, 0x01, '3', '4', 'A', 'A', 'A', 'F', '0', '0', '0', '2', '2', '3',
+                                       '1', 0x00});
+  battery.update_values();
+
+  EXPECT_EQ(datalayer_extended.stellantisECMP.pid_welding_detection, 2);
+  EXPECT_EQ(memcmp(datalayer_extended.stellantisECMP.pid_battery_serial, "34AAAF000223", 12), 0);
+}
@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+
+#include "../Software/src/devboard/utils/latency_histogram.h"
+
+TEST(LatencyHistogramTests, BucketsCoverTheirOwnUpperBound) {
+  for (int i = 0; i < LatencyHistogram::BUCKET_COUNT; i++) {
+    uint32_t bound = LatencyHistogram::bucket_upper_bound(i);
+    EXPECT_EQ(LatencyHistogram::bucket_index(bound), i) << "bucket " << i;
+    if (i + 1 < LatencyHistogram::BUCKET_COUNT) {
+      EXPECT_EQ(LatencyHistogram::bucket_index(bound + 1), i + 1) << "bucket " << i;
+    }
+  }
+}
+
+TEST(LatencyHistogramTests, HugeValuesGoToLastBucket) {
+  EXPECT_EQ(LatencyHistogram::bucket_index(UINT32_MAX), LatencyHistogram::BUCKET_COUNT - 1);
+}
+
+TEST(LatencyHistogramTests, EmptyHistogramReportsZero) {
+  LatencyHistogram histogram;
+  LatencySummary summary = histogram.summary();
+  EXPECT_EQ(summary.samples, 0u);
+  EXPECT_EQ(summary.p99_us, 0u);
+  EXPECT_EQ(summary.max_us, 0u);
+}
+
+TEST(LatencyHistogramTests, PercentilesWithinBucketPrecision) {
+  LatencyHistogram histogram;
+  // 1000 samples of 1..1000 us
+  for (int i = 1; i <= 1000; i++) {
+    histogram.record(i);
+  }
+
+  EXPECT_EQ(histogram.samples(), 1000u);
+  EXPECT_EQ(histogram.max_us(), 1000u);
+  EXPECT_GE(histogram.percentile_us(50), 500u);
+  EXPECT_LE(histogram.percentile_us(50), 625u);
+  EXPECT_GE(histogram.percentile_us(99), 990u);
+  EXPECT_LE(histogram.percentile_us(99), 1000u);
+  EXPECT_EQ(histogram.percentile_us(100), 1000u);
+}
+
+TEST(LatencyHistogramTests, SingleSpikeOnlyShowsInMax) {
+  LatencyHistogram histogram;
+  for (int i = 0; i < 999; i++) {
+    histogram.record(40);
+  }
+  histogram.record(900);
+
+  LatencySummary summary = histogram.summary();
+  EXPECT_LE(summary.p99_us, 47u);
+  EXPECT_EQ(summary.max_us, 900u);
+}
+
+TEST(LatencyHistogramTests, ResetAndNegativeValues) {
+  LatencyHistogram histogram;
+  histogram.record(-5);
+  EXPECT_EQ(histogram.samples(), 1u);
+  EXPECT_EQ(histogram.max_us(), 0u);
+
+  histogram.reset();
+  EXPECT_EQ(histogram.samples(), 0u);
+}
@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+
+#include "../Software/src/devboard/webserver/live_telemetry.h"
+
+#include <string>
+
+class StringSink : public HtmlSink {
+ public:
+  void write(const char* data, size_t length) override { text.append(data, length); }
+
+  std::string text;
+};
+
+static std::string update(const LiveTelemetry& telemetry, uint32_t client_seq,
+                          LiveCellEncoding cells = LiveCellEncoding::Json) {
+  StringSink sink;
+  {
+    HtmlWriter out(sink);
+    if (!telemetry.write_update(client_seq, cells, out)) {
+      return "";
+    }
+  }
+  return sink.text;
+}
+
+static void set_cells(DATALAYER_BATTERY_TYPE& battery, uint8_t count, uint16_t first_mV) {
+  battery.info.number_of_cells = count;
+  for (uint8_t i = 0; i < count; i++) {
+    battery.status.cell_voltages_mV[i] = first_mV + i;
+    battery.status.cell_balancing_status[i] = false;
+  }
+}
+
+class LiveTelemetryTests : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    datalayer.battery.status.voltage_dV = 3700;
+    datalayer.battery.status.current_dA = -25;
+    set_cells(datalayer.battery, 8, 3600);
+  }
+
+  // The core task publishes the snapshot after each value update
+  bool sample(uint8_t batteries) {
+    publish_datalayer_snapshot();
+    read_datalayer_snapshot(snapshot);
+    return telemetry.sample(snapshot, batteries);
+  }
+
+  LiveTelemetry telemetry;
+  DataLayerSnapshot snapshot;
+};
+
+TEST_F(LiveTelemetryTests, NewClientGetsEverything) {
+  EXPECT_EQ(telemetry.sequence(), 0u);
+  EXPECT_EQ(update(telemetry, 0), "");
+
+  EXPECT_TRUE(sample(1));
+  std::string message = update(telemetry, 0);
+  EXPECT_EQ(message.rfind("{\"v\":1,\"seq\":1,\"full\":1,\"f\":{", 0), 0u);
+  EXPECT_NE(message.find("\"battery.voltage_dV\":3700,"), std::string::npos);
+  EXPECT_NE(message.find("\"battery.current_dA\":-25,"), std::string::npos);
+  EXPECT_NE(message.find("\"shunt.measured_voltage_mV\":"), std::string::npos);
+  EXPECT_NE(message.find("\"cells\":{\"battery\":[3600,3601,3602,3603,3604,3605,3606,3607]}"), std::string::npos);
+  EXPECT_NE(message.find("\"balancing\":{\"battery\":\"00\"}}"), std::string::npos);
+  EXPECT_EQ(message.find("battery2"), std::string::npos);
+}
+
+TEST_F(LiveTelemetryTests, NothingIsSentWhenNothingChanged) {
+  sample(1);
+  EXPECT_FALSE(sample(1));
+  EXPECT_EQ(telemetry.sequence(), 1u);
+  EXPECT_EQ(update(telemetry, 1), "");
+}
+
+TEST_F(LiveTelemetryTests, DeltaHoldsOnlyTheChanges) {
+  sample(1);
+  datalayer.battery.status.voltage_dV = 3710;
+  datalayer.battery.status.cell_voltages_mV[2] = 3650;
+  EXPECT_TRUE(sample(1));
+  EXPECT_EQ(update(telemetry, 1),
+            "{\"v\":1,\"seq\":2,\"f\":{\"battery.voltage_dV\":3710},\"cells\":{\"battery\":[[2,3650]]}}");
+
+  // A client that missed a sample cannot apply the delta, it gets everything
+  datalayer.battery.status.cell_balancing_status[0] = true;
+  datalayer.battery.status.cell_balancing_status[5] = true;
+  EXPECT_TRUE(sample(1));
+  EXPECT_EQ(update(telemetry, 2), "{\"v\":1,\"seq\":3,\"balancing\":{\"battery\":\"12\"}}");
+  EXPECT_NE(update(telemetry, 1).find("\"full\":1"), std::string::npos);
+}
+
+TEST_F(LiveTelemetryTests, ManyChangedCellsAreSentAsAWholeArray) {
+  sample(1);
+  for (int i = 0; i < 4; i++) {
+    datalayer.battery.status.cell_voltages_mV[i] += 10;
+  }
+  sample(1);
+  EXPECT_EQ(update(telemetry, 1),
+            "{\"v\":1,\"seq\":2,\"cells\":{\"battery\":[3610,3611,3612,3613,3604,3605,3606,3607]}}");
+}
+
+TEST_F(LiveTelemetryTests, PackedCellsAreBase64OfLittleEndianWords) {
+  set_cells(datalayer.battery, 2, 0x0E10);
+  sample(1);
+  EXPECT_NE(update(telemetry, 0, LiveCellEncoding::Packed).find("\"cells\":{\"battery\":\"EA4RDg==\"}"),
+            std::string::npos);
+}
+
+TEST_F(LiveTelemetryTests, LargestMessageFitsTheBuffer) {
+  set_cells(datalayer.battery, MAX_AMOUNT_CELLS, 4000);
+  set_cells(datalayer.battery2, MAX_AMOUNT_CELLS, 4000);
+  set_cells(datalayer.battery3, MAX_AMOUNT_CELLS, 4000);
+  sample(3);
+  std::string message = update(telemetry, 0);
+  EXPECT_NE(message.find("\"battery3.voltage_dV\":"), std::string::npos);
+  EXPECT_LT(message.size() + sizeof("data: \n\n"), (size_t)LIVE_TELEMETRY_MESSAGE_SIZE);
+
+  set_cells(datalayer.battery2, 0, 0);
+  set_cells(datalayer.battery3, 0, 0);
+}
@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+
+#include "../Software/src/inverter/ModbusRegisterFile.h"
+
+#include <thread>
+
+TEST(ModbusRegisterFileTests, RejectsOverlappingBlocks) {
+  ModbusRegisterFile file;
+  EXPECT_TRUE(file.define_block(100, 10));
+  EXPECT_FALSE(file.define_block(105, 10));
+  EXPECT_FALSE(file.define_block(95, 6));
+  EXPECT_TRUE(file.define_block(110, 5));
+  EXPECT_FALSE(file.define_block(200, MODBUS_REGISTER_FILE_SIZE));
+  EXPECT_TRUE(file.defined(114));
+  EXPECT_FALSE(file.defined(115));
+}
+
+TEST(ModbusRegisterFileTests, StoresRegistersInBlocks) {
+  ModbusRegisterFile file;
+  file.define_block(200, 13);
+  file.define_block(300, 24);
+
+  EXPECT_TRUE(file.set(202, 57960));
+  EXPECT_TRUE(file.set(323, 9900));
+  EXPECT_EQ(file.get(202), 57960);
+  EXPECT_EQ(file.get(323), 9900);
+  EXPECT_EQ(file.get(300), 0);
+
+  // Outside the blocks, writes are dropped and reads give 0
+  EXPECT_FALSE(file.set(250, 1));
+  EXPECT_EQ(file.get(250), 0);
+  uint16_t values[3] = {1, 2, 3};
+  EXPECT_FALSE(file.set(211, values, 3));
+  EXPECT_EQ(file.get(211), 1);
+  EXPECT_EQ(file.get(212), 2);
+}
+
+TEST(ModbusRegisterFileTests, ReadsInModbusByteOrderAcrossBlocks) {
+  ModbusRegisterFile file;
+  file.define_block(10, 2);
+  file.define_block(13, 2);
+  uint16_t values[2] = {0x1234, 0xABCD};
+  file.set(10, values, 2);
+  file.set(14, 0x0102);
+
+  uint8_t bytes[12];
+  memset(bytes, 0xEE, sizeof(bytes));
+  file.read(9, 6, bytes);
+  const uint8_t expected[12] = {0x00, 0x00, 0x12, 0x34, 0xAB, 0xCD, 0x00, 0x00, 0x00, 0x00, 0x01, 0x02};
+  EXPECT_EQ(memcmp(bytes, expected, sizeof(expected)), 0);
+}
+
+TEST(ModbusRegisterFileTests, ReaderNeverSeesHalfAnUpdate) {
+  ModbusRegisterFile file;
+  file.define_block(300, 24);
+  std::atomic<bool> done{false};
+
+  std::thread writer([&]() {
+    for (uint16_t round = 1; round <= 20000; round++) {
+      ModbusRegisterFile::Update update(file);
+      for (uint16_t i = 0; i < 24; i++) {
+        update.set(300 + i, round);
+      }
+    }
+    done = true;
+  });
+
+  int torn = 0;
+  uint8_t bytes[48];
+  while (!done) {
+    file.read(300, 24, bytes);
+    for (int i = 2; i < 48; i += 2) {
+      if (bytes[i] != bytes[0] || bytes[i + 1] != bytes[1]) {
+        torn++;
+        break;
+      }
+    }
+  }
+  writer.join();
+  EXPECT_EQ(torn, 0);
+  EXPECT_EQ(file.get(323), 20000);
+}
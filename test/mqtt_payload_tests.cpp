@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+
+#include "../Software/src/devboard/mqtt/mqtt_payload.h"
+
+#include <string>
+
+class MqttPayloadTests : public ::testing::Test {
+ protected:
+  // Writes a payload like publish_common_info() does, returns if it would be published
+  bool write(int32_t voltage_dV, int32_t power_W, int32_t uptime_s, const char* status = "Active") {
+    MqttPayload payload(buffer, sizeof(buffer), state);
+    payload.add("bms_status", "", status);
+    payload.add("battery_voltage", "_2", voltage_dV, 1);
+    payload.add("stat_batt_power", "_2", power_W, 0, 20);
+    payload.add("emulator_uptime", "", uptime_s, 0, MQTT_UNTRACKED);
+    bool publish = payload.finish();
+    if (publish) {
+      payload.published();
+    }
+    return publish;
+  }
+
+  char buffer[128];
+  MqttPublishedState state;
+};
+
+TEST_F(MqttPayloadTests, WritesJsonWithFixedDecimals) {
+  EXPECT_TRUE(write(3705, -1500, 12));
+  EXPECT_STREQ(buffer,
+               "{\"bms_status\":\"Active\",\"battery_voltage_2\":370.5,\"stat_batt_power_2\":-1500,"
+               "\"emulator_uptime\":12}");
+
+  MqttPayload payload(buffer, sizeof(buffer), state);
+  payload.begin_array("cell_voltages");
+  payload.add_to_array(3700, 3);
+  payload.add_to_array(3701, 3);
+  payload.add_to_array(-5, 1);
+  payload.add_to_array(40, 3);
+  payload.end_array();
+  payload.begin_array("cell_balancing");
+  payload.add_to_array(true);
+  payload.add_to_array(false);
+  payload.end_array();
+  payload.finish();
+  EXPECT_STREQ(buffer, "{\"cell_voltages\":[3.7,3.701,-0.5,0.04],\"cell_balancing\":[true,false]}");
+}
+
+TEST_F(MqttPayloadTests, OnlyChangesBeyondTheDeadbandArePublished) {
+  EXPECT_TRUE(write(3700, 1000, 1));
+  EXPECT_FALSE(write(3700, 1000, 2));  // The uptime alone is no reason
+  EXPECT_FALSE(write(3700, 1020, 3));  // Within the deadband
+  EXPECT_TRUE(write(3700, 1021, 4));
+  EXPECT_TRUE(write(3701, 1021, 5));
+  EXPECT_TRUE(write(3701, 1021, 6, "Fault"));
+
+  // Small steps add up against the value last published
+  EXPECT_FALSE(write(3701, 1031, 7, "Fault"));
+  EXPECT_TRUE(write(3701, 1042, 8, "Fault"));
+}
+
+TEST_F(MqttPayloadTests, EverythingIsRepublishedAfterTheFullCycle) {
+  EXPECT_TRUE(write(3700, 1000, 0));
+  for (int cycle = 1; cycle < MQTT_FULL_PUBLISH_CYCLES; cycle++) {
+    EXPECT_FALSE(write(3700, 1000, cycle));
+  }
+  EXPECT_TRUE(write(3700, 1000, MQTT_FULL_PUBLISH_CYCLES));
+  EXPECT_FALSE(write(3700, 1000, MQTT_FULL_PUBLISH_CYCLES + 1));
+}
+
+TEST_F(MqttPayloadTests, ValuesThatComeOrGoArePublished) {
+  write(3700, 1000, 0);
+  MqttPayload payload(buffer, sizeof(buffer), state);
+  payload.add("bms_status", "", "Active");
+  EXPECT_TRUE(payload.finish());
+}
+
+TEST_F(MqttPayloadTests, TooSmallBufferIsNotPublished) {
+  char small[16];
+  MqttPayload payload(small, sizeof(small), state);
+  payload.add("battery_voltage", "", 3700, 1);
+  EXPECT_FALSE(payload.finish());
+  EXPECT_TRUE(payload.overflow());
+}
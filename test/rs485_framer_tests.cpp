@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+
+#include "../Software/src/communication/rs485/Rs485Framer.h"
+
+#include <string.h>
+#include <string>
+#include <vector>
+
+// Pushes the bytes and returns the frames that completed, in order
+static std::vector<std::string> feed(Rs485Framer& framer, const std::string& bytes) {
+  std::vector<std::string> frames;
+  for (char byte : bytes) {
+    if (framer.push((uint8_t)byte)) {
+      frames.emplace_back((const char*)framer.frame(), framer.length());
+    }
+  }
+  return frames;
+}
+
+TEST(Rs485FramerTests, DelimitedFramesEndWithTheDelimiter) {
+  DelimitedRs485Framer<16> framer(0x00);
+  auto frames = feed(framer, std::string("\x07\xE3\xFF\x02\x00\x05\x62\x00", 8));
+
+  ASSERT_EQ(frames.size(), 2u);
+  EXPECT_EQ(frames[0], std::string("\x07\xE3\xFF\x02\x00", 5));
+  EXPECT_EQ(frames[1], std::string("\x05\x62\x00", 3));
+  EXPECT_EQ(framer.dropped(), 0u);
+}
+
+TEST(Rs485FramerTests, DelimitedFrameThatDoesNotFitIsDropped) {
+  DelimitedRs485Framer<4> framer(0x00);
+  auto frames = feed(framer, std::string("\x01\x02\x03\x04\x05\x00\x09\x00", 8));
+
+  // The first four bytes are dropped on the fifth, which then starts a frame that ends at the zero
+  ASSERT_EQ(frames.size(), 2u);
+  EXPECT_EQ(frames[0], std::string("\x05\x00", 2));
+  EXPECT_EQ(frames[1], std::string("\x09\x00", 2));
+  EXPECT_EQ(framer.dropped(), 4u);
+}
+
+TEST(Rs485FramerTests, AsciiFramesResyncOnTheStartCharacter) {
+  AsciiRs485Framer<64> framer('~', '\r');
+  auto frames = feed(framer, "noise~2002464F~20024661E00202FD33\r\r~200246620000FDAC\r");
+
+  ASSERT_EQ(frames.size(), 2u);
+  EXPECT_EQ(frames[0], "~20024661E00202FD33\r");
+  EXPECT_EQ(frames[1], "~200246620000FDAC\r");
+  // "noise", the cut off frame before the second '~' and the stray '\r'
+  EXPECT_EQ(framer.dropped(), 5u + 9u + 1u);
+}
+
+TEST(Rs485FramerTests, FrameStaysAvailableUntilTheNextByte) {
+  AsciiRs485Framer<64> framer('~', '\r');
+  feed(framer, "~20024663E00202FD30\r");
+  EXPECT_EQ(framer.length(), 20u);
+
+  framer.push('~');
+  EXPECT_EQ(framer.length(), 0u);
+}
+
+static uint8_t checksum(const uint8_t* frame) {
+  uint8_t sum = 0;
+  for (int i = 0; i < 12; i++) {
+    sum += frame[i];
+  }
+  return sum;
+}
+
+static bool check_daly(const uint8_t* frame, uint16_t length) {
+  return !(((length > 0) && (frame[0] != 0xA5)) || ((length > 1) && (frame[1] != 0x01)) ||
+           ((length > 12) && (frame[12] != checksum(frame))));
+}
+
+TEST(Rs485FramerTests, FixedLengthFramesAreChecked) {
+  FixedLengthRs485Framer<13> framer(check_daly);
+  uint8_t packet[13] = {0xA5, 0x01, 0x90, 0x08, 0x02, 0x0A, 0x00, 0x00, 0x75, 0x30, 0x02, 0x58};
+  packet[12] = checksum(packet);
+
+  std::string bytes = "\x12";  // Not a frame start
+  bytes.append((const char*)packet, 13);
+  std::string corrupted((const char*)packet, 13);
+  corrupted[12] ^= 0xFF;
+  bytes += corrupted;
+  bytes.append((const char*)packet, 13);
+
+  auto frames = feed(framer, bytes);
+  ASSERT_EQ(frames.size(), 2u);
+  EXPECT_EQ(memcmp(frames[0].data(), packet, 13), 0);
+  EXPECT_EQ(memcmp(frames[1].data(), packet, 13), 0);
+  EXPECT_EQ(framer.dropped(), 1u + 13u);
+}
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 
+#include "../Software/src/battery/BATTERIES.h"
 #include "../Software/src/datalayer/datalayer.h"
 #include "../Software/src/devboard/safety/safety.h"
 #include "../Software/src/devboard/utils/events.h"
@@ -21,3 +22,24 @@ TEST(SafetyTests, ShouldSetEventWhenTemperatureWayTooHigh) {
   auto event_pointer = get_event_pointer(EVENT_CPU_OVERHEATED);
   EXPECT_EQ(event_pointer->occurences, 1);
 }
+
+TEST(SafetyTests, ShouldSetEventWhenCellStatisticsSeeACellTheBmsDoesNotReport) {
+  init_events();
+  datalayer = DataLayer();
+  user_selected_battery_type = BatteryType::TestFake;
+  setup_battery();
+
+  // The BMS reports 3700 mV for both the highest and the lowest cell
+  CellStatistics& cells = datalayer.battery.status.cell_statistics;
+  cells.cells = 96;
+  cells.min_mV = 3100;
+  cells.max_mV = datalayer.battery.info.max_cell_voltage_mV + 10;
+  update_machineryprotection();
+
+  EXPECT_EQ(get_event_pointer(EVENT_CELL_OVER_VOLTAGE)->occurences, 1);
+  EXPECT_EQ(get_event_pointer(EVENT_CELL_DEVIATION_HIGH)->occurences, 1);
+  EXPECT_EQ(datalayer.battery.status.max_charge_power_W, 0);
+
+  delete battery;
+  battery = nullptr;
+}
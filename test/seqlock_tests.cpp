@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+
+#include "../Software/src/datalayer/datalayer_snapshot.h"
+#include "../Software/src/devboard/utils/seqlock.h"
+
+#include <atomic>
+#include <thread>
+
+TEST(SeqlockTests, VersionCountsTheWrites) {
+  Seqlock<int> seqlock;
+  int value = -1;
+  EXPECT_EQ(seqlock.version(), 0u);
+  EXPECT_EQ(seqlock.read(value), 0u);
+  EXPECT_EQ(value, 0);
+
+  seqlock.begin_write() = 42;
+  seqlock.end_write();
+  EXPECT_EQ(seqlock.version(), 1u);
+  EXPECT_EQ(seqlock.read(value), 1u);
+  EXPECT_EQ(value, 42);
+  EXPECT_EQ(seqlock.written(), 42);
+}
+
+TEST(SeqlockTests, ReaderNeverSeesAHalfWrite) {
+  // Every element holds the same number, like cell voltages from one update
+  struct Pack {
+    uint32_t values[192];
+  };
+  static Seqlock<Pack> seqlock;
+  const uint32_t writes = 20000;
+  std::atomic<bool> done{false};
+
+  std::thread writer([&]() {
+    for (uint32_t i = 1; i <= writes; i++) {
+      Pack& pack = seqlock.begin_write();
+      for (uint32_t& value : pack.values) {
+        value = i;
+      }
+      seqlock.end_write();
+    }
+    done = true;
+  });
+
+  static Pack copy;
+  uint32_t last_version = 0;
+  while (!done) {
+    uint32_t version = seqlock.read(copy);
+    ASSERT_GE(version, last_version);
+    for (uint32_t value : copy.values) {
+      ASSERT_EQ(value, copy.values[0]);
+    }
+    ASSERT_EQ(copy.values[0], version);
+    last_version = version;
+  }
+  writer.join();
+  EXPECT_EQ(seqlock.version(), writes);
+}
+
+TEST(DataLayerSnapshotTests, NewVersionOnlyWhenSomethingChanged) {
+  static DataLayerSnapshot snapshot;
+  publish_datalayer_snapshot();
+  uint32_t version = read_datalayer_snapshot(snapshot);
+  EXPECT_NE(version, 0u);
+
+  publish_datalayer_snapshot();
+  EXPECT_FALSE(datalayer_changed_since(version));
+
+  datalayer.battery.status.cell_voltages_mV[100] ^= 0x55;
+  datalayer.shunt.measured_amperage_mA += 1000;
+  EXPECT_FALSE(datalayer_changed_since(version));  // Not before the core task publishes
+
+  publish_datalayer_snapshot();
+  EXPECT_TRUE(datalayer_changed_since(version));
+  EXPECT_EQ(read_datalayer_snapshot(snapshot), version + 1);
+  EXPECT_EQ(snapshot.battery.status.cell_voltages_mV[100], datalayer.battery.status.cell_voltages_mV[100]);
+  EXPECT_EQ(snapshot.shunt.measured_amperage_mA, datalayer.shunt.measured_amperage_mA);
+}
+
+TEST(DataLayerSnapshotTests, TimingsAndCountersAloneAreNoChange) {
+  static DataLayerSnapshot snapshot;
+  publish_datalayer_snapshot();
+  uint32_t version = read_datalayer_snapshot(snapshot);
+
+  datalayer.system.status.time_values_us += 17;
+  datalayer.system.status.latency_core_task.max_us += 1;
+  datalayer.system.status.can_rx_stats[0].frames_received += 100;
+  datalayer.system.status.CAN_inverter_still_alive--;
+  datalayer.battery.status.CAN_battery_still_alive--;
+  datalayer.charger.CAN_charger_still_alive--;
+  publish_datalayer_snapshot();
+  EXPECT_FALSE(datalayer_changed_since(version));
+
+  datalayer.system.status.contactors_engaged ^= 1;
+  publish_datalayer_snapshot();
+  EXPECT_TRUE(datalayer_changed_since(version));
+}
+
+TEST(DataLayerSnapshotTests, CarriesTheSystemInfoReadersNeed) {
+  static DataLayerSnapshot snapshot;
+  publish_datalayer_snapshot();
+  uint32_t version = read_datalayer_snapshot(snapshot);
+
+  datalayer.system.info.CPU_temperature += 0.5f;
+  datalayer.system.info.CPU_free_heap -= 64;
+  publish_datalayer_snapshot();
+  EXPECT_FALSE(datalayer_changed_since(version));
+
+  datalayer.system.info.equipment_stop_active = !datalayer.system.info.equipment_stop_active;
+  publish_datalayer_snapshot();
+  EXPECT_EQ(read_datalayer_snapshot(snapshot), version + 1);
+  EXPECT_EQ(snapshot.system_info.equipment_stop_active, datalayer.system.info.equipment_stop_active);
+  EXPECT_EQ(snapshot.system_info.CPU_temperature, datalayer.system.info.CPU_temperature);
+  EXPECT_EQ(snapshot.system_info.CPU_free_heap, datalayer.system.info.CPU_free_heap);
+  EXPECT_EQ(snapshot.system_info.emulator_status, get_emulator_status());
+}
+
+TEST(DataLayerSnapshotTests, ReadsOneBattery) {
+  static DATALAYER_BATTERY_TYPE pack;
+  datalayer.battery2.status.voltage_dV += 3;
+  datalayer.battery3.status.voltage_dV += 5;
+  publish_datalayer_snapshot();
+
+  uint32_t version = read_datalayer_snapshot_battery(2, pack);
+  EXPECT_FALSE(datalayer_changed_since(version));
+  EXPECT_EQ(pack.status.voltage_dV, datalayer.battery2.status.voltage_dV);
+  read_datalayer_snapshot_battery(3, pack);
+  EXPECT_EQ(pack.status.voltage_dV, datalayer.battery3.status.voltage_dV);
+  read_datalayer_snapshot_battery(1, pack);
+  EXPECT_EQ(pack.status.voltage_dV, datalayer.battery.status.voltage_dV);
+}
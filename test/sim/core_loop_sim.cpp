@@ -0,0 +1,445 @@
+// Runs the firmware core task on the host: the same setup_core() and
+// core_loop_tick() as on the ESP32, with the battery and the inverter
+// integrations on virtual CAN buses. Use it to profile the whole receive, update
+// and transmit path with perf or valgrind, to measure how long it takes for a
+// battery frame to reach the inverter, and to soak test a release for days of
+// emulated time.
+//
+// By default a tick runs every millisecond of wall clock time. With
+// --virtual-time, millis(), millis64() and esp_timer_get_time() follow a clock
+// that only advances between ticks, and the ticks run back to back. A day then
+// takes minutes instead of a day, and every run of the same scenario produces
+// the same frames: the digest printed at the end is the same on every run, and
+// on every host.
+//
+// Usage: core_loop_sim [options]
+//
+// Options:
+//   --battery <type>          BatteryType to emulate (default: the number in front of the battery log name)
+//   --inverter <type>         InverterProtocolType to talk (default 10, Pylon CAN)
+//   --battery-log <file>      Frames sent by the battery, a SavvyCAN text log or a binary SD card log
+//   --inverter-log <file>     Frames sent by the inverter, for protocols that only answer requests
+//   --loop                    Start the logs over when they end
+//   --seconds <n>             Stop after n seconds (default: 2 s after the logs ended, 10 s without logs)
+//   --virtual-time            Run on emulated time, as fast as the host allows
+//   --tick-ms <n>             Emulated milliseconds between ticks with --virtual-time (default 1)
+//   --periodic-bms-reset      Power cycle the BMS every 24 hours, as the setting of the same name
+//   --expect-digest <hex>     Exit with 1 unless the frames digest is this, to catch changes in behaviour
+//   --battery-bus <name>      "loopback" (default) or a SocketCAN interface such as vcan0
+//   --inverter-bus <name>     Same for the inverter side
+//
+// The battery is connected to CAN_NATIVE and the inverter to CAN_ADDON_MCP2515.
+// Frames the emulator sends on a SocketCAN bus can be watched with candump, and
+// other tools can play the battery or the inverter on it.
+//
+// Latency is measured from the moment a battery frame is put on the bus until the
+// first inverter frame that went out after the emulator received the frame and
+// ran update_values(). That is the age of the data the inverter acts on.
+//
+// A day with a periodic BMS reset, on the fake battery that needs no traffic:
+//
+//   core_loop_sim --battery 34 --inverter 15 --virtual-time --seconds 86400 --periodic-bms-reset
+
+#include "../../Software/src/battery/BATTERIES.h"
+#include "../../Software/src/communication/can/comm_can.h"
+#include "../../Software/src/communication/contactorcontrol/comm_contactorcontrol.h"
+#include "../../Software/src/core/core_loop.h"
+#include "../../Software/src/datalayer/datalayer.h"
+#include "../../Software/src/devboard/hal/hal.h"
+#include "../../Software/src/devboard/sdcard/can_log_replay.h"
+#include "../../Software/src/devboard/utils/events.h"
+#include "../../Software/src/devboard/utils/latency_histogram.h"
+#include "../../Software/src/inverter/INVERTERS.h"
+#include "sim_can.h"
+
+#include <signal.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+// The devboard LED and the settings store are not emulated
+bool led_init(void) {
+  return true;
+}
+void led_exe(void) {}
+void store_settings_equipment_stop(void) {}
+
+struct SimOptions {
+  int battery_type = -1;
+  int inverter_type = (int)InverterProtocolType::Pylon;
+  std::string battery_log;
+  std::string inverter_log;
+  bool loop = false;
+  double seconds = 0;
+  std::string battery_bus = "loopback";
+  std::string inverter_bus = "loopback";
+  bool virtual_time = false;
+  uint32_t tick_ms = 1;
+  bool periodic_bms_reset = false;
+  std::string expect_digest;
+};
+
+// FNV-1a over everything the emulator sent, with the emulated time it was sent at
+class FrameDigest {
+ public:
+  void add(uint64_t now_ms, CAN_Interface interface, const CAN_frame& frame) {
+    add_value(now_ms, sizeof(now_ms));
+    add_value(interface, 1);
+    add_value(frame.ID | (frame.ext_ID ? 0x80000000u : 0), 4);
+    add_value(frame.DLC, 1);
+    for (uint8_t i = 0; i < frame.DLC; i++) {
+      add_value(frame.data.u8[i], 1);
+    }
+  }
+
+  uint64_t value() const { return hash; }
+
+ private:
+  void add_value(uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+      hash = (hash ^ ((value >> (8 * i)) & 0xFF)) * 0x100000001b3ULL;
+    }
+  }
+
+  uint64_t hash = 0xcbf29ce484222325ULL;
+};
+
+// Log on disk, read a block at a time by the player
+class FileCanLogSource : public CanLogSource {
+ public:
+  explicit FileCanLogSource(const std::string& path) : path(path) {}
+  ~FileCanLogSource() override {
+    if (file != nullptr) {
+      fclose(file);
+    }
+  }
+
+  bool rewind() override {
+    if (file != nullptr) {
+      fclose(file);
+    }
+    file = fopen(path.c_str(), "rb");
+    return file != nullptr;
+  }
+
+  size_t read(uint8_t* buffer, size_t size) override { return file ? fread(buffer, 1, size, file) : 0; }
+
+ private:
+  std::string path;
+  FILE* file = nullptr;
+};
+
+// One side of the cable: a log played onto a bus with its recorded timing
+class LogPeer {
+ public:
+  LogPeer(const std::string& path, SimCanBus& bus) : source(path), player(source), bus(bus) {}
+
+  bool start(uint64_t now_us) { return running = player.start(now_us); }
+
+  // Put the frames that are due on the bus, returns how many went out
+  uint32_t play(uint64_t now_us, bool loop) {
+    uint32_t sent = 0;
+    CanLogRecord record;
+    while (running) {
+      if (!player.pop_due(now_us, record)) {
+        uint64_t due_us;
+        if (!player.next_due(due_us)) {
+          running = loop && player.start(now_us);
+        }
+        break;
+      }
+      if (record.direction == MSG_TX) {
+        continue;  // Sent by the emulator that recorded the log, not by the equipment
+      }
+      CAN_frame frame = {};
+      frame.FD = (record.flags & CAN_LOG_FLAG_FD) != 0;
+      frame.ext_ID = (record.flags & CAN_LOG_FLAG_EXT_ID) != 0;
+      frame.ID = record.id;
+      frame.DLC = record.dlc;
+      memcpy(frame.data.u8, record.data, record.dlc);
+      if (bus.peer_transmit(frame)) {
+        sent++;
+      }
+    }
+    return sent;
+  }
+
+  bool finished() const { return !running; }
+
+ private:
+  FileCanLogSource source;
+  CanLogPlayer player;
+  SimCanBus& bus;
+  bool running = false;
+};
+
+static volatile sig_atomic_t stop_requested = 0;
+
+static void on_signal(int) {
+  stop_requested = 1;
+}
+
+static std::unique_ptr<SimCanBus> open_bus(const std::string& name) {
+  if (name == "loopback") {
+    return std::make_unique<LoopbackCanBus>("loopback");
+  }
+#ifdef __linux__
+  auto bus = std::make_unique<SocketCanBus>(name.c_str());
+  if (bus->open()) {
+    return bus;
+  }
+  fprintf(stderr, "Could not open SocketCAN interface %s, is it up?\n", name.c_str());
+#else
+  fprintf(stderr, "SocketCAN is only available on Linux\n");
+#endif
+  return nullptr;
+}
+
+// The battery type is the number in front of the first '_' in the log name
+static int battery_type_from_log_name(const std::string& path) {
+  std::string name = fs::path(path).filename().string();
+  size_t end = name.find('_');
+  if (end == 0 || end == std::string::npos || name.find_first_not_of("0123456789") != end) {
+    return -1;
+  }
+  return std::stoi(name.substr(0, end));
+}
+
+static bool parse_options(int argc, char** argv, SimOptions& options) {
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "--loop") {
+      options.loop = true;
+    } else if (arg == "--battery" && has_value) {
+      options.battery_type = atoi(argv[++i]);
+    } else if (arg == "--inverter" && has_value) {
+      options.inverter_type = atoi(argv[++i]);
+    } else if (arg == "--battery-log" && has_value) {
+      options.battery_log = argv[++i];
+    } else if (arg == "--inverter-log" && has_value) {
+      options.inverter_log = argv[++i];
+    } else if (arg == "--seconds" && has_value) {
+      options.seconds = atof(argv[++i]);
+    } else if (arg == "--battery-bus" && has_value) {
+      options.battery_bus = argv[++i];
+    } else if (arg == "--inverter-bus" && has_value) {
+      options.inverter_bus = argv[++i];
+    } else if (arg == "--virtual-time") {
+      options.virtual_time = true;
+    } else if (arg == "--tick-ms" && has_value) {
+      options.tick_ms = std::max(1, atoi(argv[++i]));
+    } else if (arg == "--periodic-bms-reset") {
+      options.periodic_bms_reset = true;
+    } else if (arg == "--expect-digest" && has_value) {
+      options.expect_digest = argv[++i];
+    } else {
+      fprintf(stderr, "Unknown or incomplete option %s\n", arg.c_str());
+      return false;
+    }
+  }
+  if (options.battery_type < 0 && !options.battery_log.empty()) {
+    options.battery_type = battery_type_from_log_name(options.battery_log);
+  }
+  if (options.battery_type < 0) {
+    fprintf(stderr, "No battery type, use --battery <type>\n");
+    return false;
+  }
+  if (options.tick_ms != 1 && !options.virtual_time) {
+    fprintf(stderr, "--tick-ms needs --virtual-time\n");
+    return false;
+  }
+  return true;
+}
+
+static void print_histogram(const char* name, const LatencyHistogram& histogram) {
+  LatencySummary summary = histogram.summary();
+  printf("%-28s %10lu samples  p50 %8lu us  p95 %8lu us  p99 %8lu us  max %8lu us\n", name,
+         (unsigned long)summary.samples, (unsigned long)summary.p50_us, (unsigned long)summary.p95_us,
+         (unsigned long)summary.p99_us, (unsigned long)summary.max_us);
+}
+
+static void print_bus(const char* side, CAN_Interface interface, const SimCanBus& bus) {
+  const SimCanStats& stats = sim_can_stats(interface);
+  printf("%-9s bus %-10s %10llu frames received, %10llu sent, %llu not sent\n", side, bus.name(),
+         (unsigned long long)stats.received, (unsigned long long)stats.transmitted,
+         (unsigned long long)stats.transmit_failed);
+}
+
+static void print_events() {
+  for (int event = 0; event < EVENT_NOF_EVENTS; event++) {
+    const EVENTS_STRUCT_TYPE* entry = get_event_pointer((EVENTS_ENUM_TYPE)event);
+    if (entry->occurences > 0) {
+      printf("Event %-40s %4u times, last at %10.3f s, %s\n", get_event_enum_string((EVENTS_ENUM_TYPE)event),
+             entry->occurences, entry->timestamp / 1000.0, get_event_level_string(entry->level));
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  SimOptions options;
+  if (!parse_options(argc, argv, options)) {
+    return 2;
+  }
+
+  std::unique_ptr<SimCanBus> battery_bus = open_bus(options.battery_bus);
+  std::unique_ptr<SimCanBus> inverter_bus = open_bus(options.inverter_bus);
+  if (!battery_bus || !inverter_bus) {
+    return 2;
+  }
+
+  // What setup() does, without the tasks and peripherals that have no host counterpart
+  init_hal();
+  init_events();
+  user_selected_battery_type = (BatteryType)options.battery_type;
+  user_selected_inverter_protocol = (InverterProtocolType)options.inverter_type;
+  periodic_bms_reset = options.periodic_bms_reset;
+  can_config.battery = CAN_NATIVE;
+  can_config.inverter = CAN_ADDON_MCP2515;
+  attach_sim_can_bus(CAN_NATIVE, battery_bus.get());
+  attach_sim_can_bus(CAN_ADDON_MCP2515, inverter_bus.get());
+  setup_core();
+
+  printf("Emulating %s towards %s%s\n", name_for_battery_type(user_selected_battery_type),
+         name_for_inverter_type(user_selected_inverter_protocol), options.virtual_time ? ", on virtual time" : "");
+
+  using clock = std::chrono::steady_clock;
+  const clock::time_point start = clock::now();
+  auto elapsed_us = [&]() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - start).count();
+  };
+  // Emulated time, the wall clock unless it is virtual. Virtual time stands still during a tick.
+  uint64_t virtual_us = 0;
+  auto now_us = [&]() { return options.virtual_time ? virtual_us : elapsed_us(); };
+
+  std::unique_ptr<LogPeer> battery_peer;
+  std::unique_ptr<LogPeer> inverter_peer;
+  if (!options.battery_log.empty()) {
+    battery_peer = std::make_unique<LogPeer>(options.battery_log, *battery_bus);
+    if (!battery_peer->start(0)) {
+      fprintf(stderr, "No frames in %s\n", options.battery_log.c_str());
+      return 2;
+    }
+  }
+  if (!options.inverter_log.empty()) {
+    inverter_peer = std::make_unique<LogPeer>(options.inverter_log, *inverter_bus);
+    if (!inverter_peer->start(0)) {
+      fprintf(stderr, "No frames in %s\n", options.inverter_log.c_str());
+      return 2;
+    }
+  }
+
+  signal(SIGINT, on_signal);
+  signal(SIGTERM, on_signal);
+
+  // Battery frames by the time they were put on the bus: not read by the emulator yet,
+  // read but not decoded by an update yet, and waiting for the next inverter frame
+  std::deque<uint64_t> on_bus;
+  std::deque<uint64_t> received;
+  std::deque<uint64_t> decoded;
+  uint64_t battery_frames_read = 0;
+
+  LatencyHistogram tick_histogram;
+  LatencyHistogram latency_histogram;
+  FrameDigest digest;
+  uint64_t ticks = 0;
+  uint64_t tick_ns = 0;
+  uint64_t logs_ended_us = 0;
+
+  while (!stop_requested) {
+    uint64_t tick_us = now_us();
+    if (options.seconds > 0 && tick_us >= options.seconds * 1e6) {
+      break;
+    }
+    bool logs_running = (battery_peer && !battery_peer->finished()) || (inverter_peer && !inverter_peer->finished());
+    if (options.seconds <= 0 && !logs_running) {
+      uint64_t linger_us = (battery_peer || inverter_peer) ? 2000000 : 10000000;
+      if (logs_ended_us == 0) {
+        logs_ended_us = tick_us;
+      } else if (tick_us - logs_ended_us >= linger_us) {
+        break;
+      }
+    }
+
+    if (battery_peer) {
+      uint32_t sent = battery_peer->play(tick_us, options.loop);
+      on_bus.insert(on_bus.end(), sent, tick_us);
+    }
+    if (inverter_peer) {
+      inverter_peer->play(tick_us, options.loop);
+    }
+
+    set_millis64(tick_us / 1000);
+    unsigned long last_update = previousMillisUpdateVal;
+    clock::time_point tick_start = clock::now();
+    core_loop_tick();
+    int64_t duration_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - tick_start).count();
+    tick_histogram.record(duration_ns / 1000);
+    tick_ns += duration_ns;
+    ticks++;
+
+    // The bus is first in first out, so what the emulator read are the oldest frames on it
+    uint64_t read = sim_can_stats(CAN_NATIVE).received - battery_frames_read;
+    battery_frames_read += read;
+    for (; read > 0 && !on_bus.empty(); read--) {
+      received.push_back(on_bus.front());
+      on_bus.pop_front();
+    }
+    if (previousMillisUpdateVal != last_update) {
+      decoded.insert(decoded.end(), received.begin(), received.end());
+      received.clear();
+    }
+
+    CAN_frame frame;
+    while (battery_bus->peer_receive(frame)) {
+      digest.add(tick_us / 1000, CAN_NATIVE, frame);
+    }
+    bool inverter_frame_sent = false;
+    while (inverter_bus->peer_receive(frame)) {
+      digest.add(tick_us / 1000, CAN_ADDON_MCP2515, frame);
+      inverter_frame_sent = true;
+    }
+    if (inverter_frame_sent) {
+      uint64_t sent_us = now_us();
+      for (uint64_t put_on_bus_us : decoded) {
+        latency_histogram.record(sent_us - put_on_bus_us);
+      }
+      decoded.clear();
+    }
+
+    if (options.virtual_time) {
+      virtual_us += options.tick_ms * 1000ULL;
+    } else {
+      // Same 1 ms period as vTaskDelayUntil() in core_loop(), late ticks catch up
+      std::this_thread::sleep_until(start + std::chrono::milliseconds(ticks));
+    }
+  }
+
+  double emulated_s = now_us() / 1e6;
+  double wall_s = elapsed_us() / 1e6;
+  printf("%llu ticks, %.1f s emulated in %.1f s\n", (unsigned long long)ticks, emulated_s, wall_s);
+  print_bus("Battery", CAN_NATIVE, *battery_bus);
+  print_bus("Inverter", CAN_ADDON_MCP2515, *inverter_bus);
+  print_histogram("core_loop_tick()", tick_histogram);
+  print_histogram("Battery to inverter frame", latency_histogram);
+  if (emulated_s > 0) {
+    printf("core_loop_tick() CPU time per emulated hour: %.1f ms\n", tick_ns / 1e6 / (emulated_s / 3600));
+  }
+  print_events();
+
+  char digest_text[17];
+  snprintf(digest_text, sizeof(digest_text), "%016llx", (unsigned long long)digest.value());
+  printf("Frames digest: %s\n", digest_text);
+  if (!options.expect_digest.empty() && options.expect_digest != digest_text) {
+    fprintf(stderr, "Frames digest differs from the expected %s\n", options.expect_digest.c_str());
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,157 @@
+// comm_can.h for the host build: the same receiver registration and dispatch as
+// the firmware, with SimCanBus objects in place of the CAN controllers.
+
+#include "sim_can.h"
+
+#include "../../Software/src/communication/can/CanDispatchTable.h"
+#include "../../Software/src/communication/can/comm_can.h"
+#include "../../Software/src/devboard/safety/safety.h"
+
+#include <map>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#include <net/if.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+static std::multimap<CAN_Interface, CanReceiver*> can_receivers;
+static CanDispatchTable can_dispatch;
+static SimCanBus* buses[NO_CAN_INTERFACE] = {nullptr};
+static SimCanStats stats[NO_CAN_INTERFACE];
+
+void attach_sim_can_bus(CAN_Interface interface, SimCanBus* bus) {
+  buses[interface] = bus;
+}
+
+const SimCanStats& sim_can_stats(CAN_Interface interface) {
+  return stats[interface];
+}
+
+void register_can_receiver(CanReceiver* receiver, CAN_Interface interface, CAN_Speed /*speed*/) {
+  can_receivers.insert({interface, receiver});
+}
+
+bool init_CAN() {
+  can_dispatch.clear();
+  for (auto& [interface, receiver] : can_receivers) {
+    can_dispatch.add(receiver, interface);
+  }
+  return true;
+}
+
+void receive_can() {
+  for (int interface = 0; interface < NO_CAN_INTERFACE; interface++) {
+    SimCanBus* bus = buses[interface];
+    if (bus == nullptr) {
+      continue;
+    }
+    CAN_frame frame;
+    uint16_t count = 0;
+    while (count < CAN_RX_BUDGET_PER_TICK && bus->receive(frame)) {
+      count++;
+      stats[interface].received++;
+      can_dispatch.dispatch(&frame, (CAN_Interface)interface);
+    }
+  }
+}
+
+void transmit_can_frame_to_interface(const CAN_frame* tx_frame, CAN_Interface interface) {
+  if (!allowed_to_send_CAN) {
+    return;
+  }
+  SimCanBus* bus = buses[interface];
+  if (bus != nullptr && bus->transmit(*tx_frame)) {
+    stats[interface].transmitted++;
+  } else {
+    stats[interface].transmit_failed++;
+  }
+}
+
+bool change_can_speed(CAN_Interface /*interface*/, CAN_Speed /*speed*/) {
+  return true;
+}
+
+void stop_can() {}
+
+void restart_can() {}
+
+const char* getCANInterfaceName(CAN_Interface interface) {
+  return buses[interface] ? buses[interface]->name() : "Not connected";
+}
+
+void dump_can_frame(const CAN_frame& /*frame*/, CAN_Interface /*interface*/, frameDirection /*msgDir*/) {}
+
+void format_logged_can_frames() {}
+
+void print_can_frame(const CAN_frame& /*frame*/, CAN_Interface /*interface*/, frameDirection /*msgDir*/) {}
+
+#ifdef __linux__
+SocketCanBus::~SocketCanBus() {
+  if (emulator_socket >= 0) {
+    close(emulator_socket);
+  }
+  if (peer_socket >= 0) {
+    close(peer_socket);
+  }
+}
+
+int SocketCanBus::open_socket() {
+  int s = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+  if (s < 0) {
+    return -1;
+  }
+  int enable = 1;
+  setsockopt(s, SOL_CAN_RAW, CAN_RAW_FD_FRAMES, &enable, sizeof(enable));
+
+  struct ifreq ifr = {};
+  strncpy(ifr.ifr_name, interface, IFNAMSIZ - 1);
+  if (ioctl(s, SIOCGIFINDEX, &ifr) < 0) {
+    close(s);
+    return -1;
+  }
+  struct sockaddr_can address = {};
+  address.can_family = AF_CAN;
+  address.can_ifindex = ifr.ifr_ifindex;
+  if (bind(s, (struct sockaddr*)&address, sizeof(address)) < 0) {
+    close(s);
+    return -1;
+  }
+  fcntl(s, F_SETFL, O_NONBLOCK);
+  return s;
+}
+
+bool SocketCanBus::open() {
+  emulator_socket = open_socket();
+  peer_socket = open_socket();
+  return emulator_socket >= 0 && peer_socket >= 0;
+}
+
+bool SocketCanBus::read_frame(int socket, CAN_frame& frame) {
+  struct canfd_frame raw;
+  ssize_t length = read(socket, &raw, sizeof(raw));
+  if (length != CAN_MTU && length != CANFD_MTU) {
+    return false;
+  }
+  frame.FD = (length == CANFD_MTU);
+  frame.ext_ID = (raw.can_id & CAN_EFF_FLAG) != 0;
+  frame.ID = raw.can_id & (frame.ext_ID ? CAN_EFF_MASK : CAN_SFF_MASK);
+  frame.DLC = raw.len;
+  memcpy(frame.data.u8, raw.data, raw.len);
+  return true;
+}
+
+bool SocketCanBus::write_frame(int socket, const CAN_frame& frame) {
+  struct canfd_frame raw = {};
+  raw.can_id = frame.ID | (frame.ext_ID ? CAN_EFF_FLAG : 0);
+  raw.len = frame.DLC;
+  memcpy(raw.data, frame.data.u8, frame.DLC);
+  size_t length = frame.FD ? CANFD_MTU : CAN_MTU;
+  return write(socket, &raw, length) == (ssize_t)length;
+}
+#endif
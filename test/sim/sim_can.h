@@ -0,0 +1,97 @@
+#ifndef _SIM_CAN_H_
+#define _SIM_CAN_H_
+
+#include "../../Software/src/devboard/utils/spsc_queue.h"
+#include "../../Software/src/devboard/utils/types.h"
+
+// Frames a loopback bus holds in each direction, like the receive queue of a CAN
+// controller. Must be a power of two.
+#ifndef SIM_CAN_QUEUE_SIZE
+#define SIM_CAN_QUEUE_SIZE 256
+#endif
+
+// A CAN bus the emulator is connected to in the host build. The emulator side is
+// used by receive_can() and transmit_can_frame_to_interface(). The peer side is the
+// equipment at the other end of the cable: a replayed log, a test, or another
+// process on a vcan interface.
+class SimCanBus {
+ public:
+  virtual ~SimCanBus() = default;
+
+  virtual const char* name() const = 0;
+
+  // Emulator side
+  virtual bool receive(CAN_frame& frame) = 0;
+  virtual bool transmit(const CAN_frame& frame) = 0;
+
+  // Peer side
+  virtual bool peer_transmit(const CAN_frame& frame) = 0;
+  virtual bool peer_receive(CAN_frame& frame) = 0;
+};
+
+// In-process bus, two bounded queues. A full queue drops the frame like a CAN
+// controller that is not read in time.
+class LoopbackCanBus : public SimCanBus {
+ public:
+  explicit LoopbackCanBus(const char* name) : bus_name(name) {}
+
+  const char* name() const override { return bus_name; }
+
+  bool receive(CAN_frame& frame) override { return to_emulator.pop(frame); }
+  bool transmit(const CAN_frame& frame) override { return from_emulator.push(frame); }
+  bool peer_transmit(const CAN_frame& frame) override { return to_emulator.push(frame); }
+  bool peer_receive(CAN_frame& frame) override { return from_emulator.pop(frame); }
+
+ private:
+  const char* bus_name;
+  SpscQueue<CAN_frame, SIM_CAN_QUEUE_SIZE> to_emulator;
+  SpscQueue<CAN_frame, SIM_CAN_QUEUE_SIZE> from_emulator;
+};
+
+#ifdef __linux__
+// Linux SocketCAN interface, normally a vcan one:
+//
+//   sudo ip link add dev vcan0 type vcan && sudo ip link set up vcan0
+//
+// The emulator and the peer side each have their own socket on it, so frames
+// one writes are read by the other, and by candump, cangen or a real inverter
+// or BMS simulator on the same interface.
+class SocketCanBus : public SimCanBus {
+ public:
+  explicit SocketCanBus(const char* interface) : interface(interface) {}
+  ~SocketCanBus() override;
+
+  // Returns false if the interface does not exist or is down
+  bool open();
+
+  const char* name() const override { return interface; }
+
+  bool receive(CAN_frame& frame) override { return read_frame(emulator_socket, frame); }
+  bool transmit(const CAN_frame& frame) override { return write_frame(emulator_socket, frame); }
+  bool peer_transmit(const CAN_frame& frame) override { return write_frame(peer_socket, frame); }
+  bool peer_receive(CAN_frame& frame) override { return read_frame(peer_socket, frame); }
+
+ private:
+  int open_socket();
+  static bool read_frame(int socket, CAN_frame& frame);
+  static bool write_frame(int socket, const CAN_frame& frame);
+
+  const char* interface;
+  int emulator_socket = -1;
+  int peer_socket = -1;
+};
+#endif
+
+struct SimCanStats {
+  uint64_t received = 0;
+  uint64_t transmitted = 0;
+  uint64_t transmit_failed = 0;  // Bus queue full, or the frame was refused by the socket
+};
+
+// Connect a CAN interface of the emulator to a bus. Frames sent on an interface
+// without a bus are counted and dropped, as if nothing was connected.
+void attach_sim_can_bus(CAN_Interface interface, SimCanBus* bus);
+
+const SimCanStats& sim_can_stats(CAN_Interface interface);
+
+#endif
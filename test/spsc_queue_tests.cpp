@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+
+#include "../Software/src/devboard/utils/spsc_queue.h"
+
+#include <thread>
+
+TEST(SpscQueueTests, KeepsOrder) {
+  SpscQueue<int, 4> queue;
+  int value;
+
+  EXPECT_FALSE(queue.pop(value));
+  EXPECT_TRUE(queue.push(1));
+  EXPECT_TRUE(queue.push(2));
+  EXPECT_EQ(queue.size(), 2u);
+
+  EXPECT_TRUE(queue.pop(value));
+  EXPECT_EQ(value, 1);
+  EXPECT_TRUE(queue.pop(value));
+  EXPECT_EQ(value, 2);
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(SpscQueueTests, RejectsAndCountsWhenFull) {
+  SpscQueue<int, 4> queue;
+  for (int i = 0; i < 4; i++) {
+    EXPECT_TRUE(queue.push(i));
+  }
+  EXPECT_FALSE(queue.push(4));
+  EXPECT_EQ(queue.dropped_count(), 1u);
+
+  int value;
+  EXPECT_TRUE(queue.pop(value));
+  EXPECT_EQ(value, 0);
+  EXPECT_TRUE(queue.push(5));
+}
+
+TEST(SpscQueueTests, WrapsAround) {
+  SpscQueue<int, 4> queue;
+  int value;
+  for (int i = 0; i < 100; i++) {
+    EXPECT_TRUE(queue.push(i));
+    EXPECT_TRUE(queue.pop(value));
+    EXPECT_EQ(value, i);
+  }
+}
+
+TEST(SpscQueueTests, ProducerAndConsumerThreads) {
+  struct Item {
+    uint32_t sequence;
+    uint32_t check;
+  };
+  static SpscQueue<Item, 64> queue;
+  const uint32_t count = 20000;
+
+  std::thread producer([&]() {
+    for (uint32_t i = 0; i < count; i++) {
+      while (!queue.push({i, ~i})) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  uint32_t expected = 0;
+  Item item;
+  while (expected < count) {
+    if (queue.pop(item)) {
+      ASSERT_EQ(item.sequence, expected);
+      ASSERT_EQ(item.check, ~expected);
+      expected++;
+    }
+  }
+  producer.join();
+  EXPECT_TRUE(queue.empty());
+}
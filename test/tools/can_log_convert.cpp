@@ -0,0 +1,66 @@
+// Converts a binary CAN log from the SD card (/canlog.bin) into the SavvyCAN
+// text format used by the webserver CAN log export.
+//
+// Usage: can_log_convert <canlog.bin> [output.txt]
+// Without an output file the converted log is written to stdout.
+
+#include "../../Software/src/devboard/sdcard/can_log_record.h"
+
+#include <cstdio>
+
+int main(int argc, char** argv) {
+  if (argc < 2 || argc > 3) {
+    fprintf(stderr, "Usage: %s <canlog.bin> [output.txt]\n", argv[0]);
+    return 2;
+  }
+
+  FILE* in = fopen(argv[1], "rb");
+  if (in == nullptr) {
+    fprintf(stderr, "Could not open %s\n", argv[1]);
+    return 1;
+  }
+
+  FILE* out = stdout;
+  if (argc == 3) {
+    out = fopen(argv[2], "w");
+    if (out == nullptr) {
+      fprintf(stderr, "Could not create %s\n", argv[2]);
+      fclose(in);
+      return 1;
+    }
+  }
+
+  CanLogFileHeader header;
+  if (fread(&header, sizeof(header), 1, in) != 1 || !is_valid_can_log_file_header(header)) {
+    fprintf(stderr, "%s is not a binary CAN log (version %d)\n", argv[1], CAN_LOG_FORMAT_VERSION);
+    fclose(in);
+    if (out != stdout) {
+      fclose(out);
+    }
+    return 1;
+  }
+
+  CanLogRecord record;
+  char line[CAN_LOG_MAX_PAYLOAD * 3 + 64];
+  unsigned long frames = 0;
+  int result = 0;
+
+  while (fread(&record, CAN_LOG_RECORD_HEADER_SIZE, 1, in) == 1) {
+    if (record.dlc > CAN_LOG_MAX_PAYLOAD || fread(record.data, 1, record.dlc, in) != record.dlc) {
+      // The last record is cut short when the log was exported while frames were being written
+      fprintf(stderr, "Truncated or corrupt record after %lu frames, stopping\n", frames);
+      result = 1;
+      break;
+    }
+    size_t length = format_can_log_record(record, line, sizeof(line));
+    fwrite(line, 1, length, out);
+    frames++;
+  }
+
+  fclose(in);
+  if (out != stdout) {
+    fclose(out);
+    fprintf(stderr, "Converted %lu frames\n", frames);
+  }
+  return result;
+}
@@ -0,0 +1,179 @@
+#include <gtest/gtest.h>
+
+#include "../Software/src/communication/can/UdsPollScheduler.h"
+#include "../Software/src/datalayer/datalayer.h"
+
+#include <map>
+#include <vector>
+
+void set_millis64(uint64_t time);
+
+static std::vector<CAN_frame> sent_frames;
+
+static void record_frame(const CAN_frame* frame, CAN_Interface /*interface*/) {
+  sent_frames.push_back(*frame);
+}
+
+class UdsPollSchedulerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    sent_frames.clear();
+    datalayer.system.status.can_rx_stats[CAN_NATIVE].frames_received = 0;
+    polls.on_failure([this](uint16_t did, const UdsClient::Response& /*response*/) { failures.push_back(did); });
+  }
+
+  uint8_t add(uint16_t did, UdsPollScheduler::Priority priority, uint16_t period_ms, uint16_t timeout_ms = 0,
+              uint8_t retries = 1) {
+    return polls.add(
+        did, priority, period_ms, [this](const UdsClient::Response& /*response*/) { answers++; }, timeout_ms, retries);
+  }
+
+  // Run the core loop for a while. The ECU answers every request after latency_ms,
+  // or never when latency_ms is 0.
+  void simulate(unsigned long until_ms, unsigned long latency_ms) {
+    for (; now <= until_ms; now++) {
+      set_millis64(now);
+      if (pending_answer && now >= answer_ms) {
+        pending_answer = false;
+        CAN_frame frame = {.FD = false, .ext_ID = false, .DLC = 8, .ID = 0x789, .data = {}};
+        uint8_t data[8] = {0x05, 0x62, (uint8_t)(answer_did >> 8), (uint8_t)answer_did, 0x00, 0x01, 0xAA, 0xAA};
+        memcpy(frame.data.u8, data, sizeof(data));
+        uds.handle_frame(frame, now);
+      }
+      uds.poll(now);
+      polls.run(now);
+      while (handled < sent_frames.size()) {
+        const CAN_frame& request = sent_frames[handled++];
+        uint16_t did = (request.data.u8[2] << 8) | request.data.u8[3];
+        requests[did]++;
+        request_times.push_back(now);
+        if (latency_ms > 0) {
+          pending_answer = true;
+          answer_did = did;
+          answer_ms = now + latency_ms;
+        }
+      }
+    }
+  }
+
+  UdsClient uds{CAN_NATIVE, 0x781, 0x789, record_frame};
+  UdsPollScheduler polls{uds, CAN_NATIVE};
+
+  unsigned long now = 0;
+  size_t handled = 0;
+  bool pending_answer = false;
+  uint16_t answer_did = 0;
+  unsigned long answer_ms = 0;
+
+  std::map<uint16_t, int> requests;
+  std::vector<unsigned long> request_times;
+  std::vector<uint16_t> failures;
+  int answers = 0;
+};
+
+TEST_F(UdsPollSchedulerTest, PollsHighPriorityFirstAndAtItsOwnRate) {
+  add(0xB061, UdsPollScheduler::Priority::Low, 1000);
+  add(0xB043, UdsPollScheduler::Priority::High, 200);
+
+  // Queued on the first tick, sent on the next UdsClient::poll()
+  simulate(1, 10);
+  ASSERT_EQ(sent_frames.size(), 1u);
+  EXPECT_EQ(sent_frames[0].data.u8[3], 0x43);
+
+  simulate(1999, 10);
+  EXPECT_EQ(requests[0xB043], 10);
+  EXPECT_EQ(requests[0xB061], 2);
+  EXPECT_EQ(answers, 12);
+}
+
+TEST_F(UdsPollSchedulerTest, ReportsEffectiveRefreshRateAndLatency) {
+  uint8_t fast = add(0xB043, UdsPollScheduler::Priority::High, 200);
+  uint8_t slow = add(0xB061, UdsPollScheduler::Priority::Low, 1000);
+
+  simulate(5000, 10);
+  EXPECT_NEAR(polls.stats(fast).effective_period_ms, 200, 10);
+  EXPECT_NEAR(polls.stats(slow).effective_period_ms, 1000, 50);
+  EXPECT_NEAR(polls.stats(fast).latency_ms, 10, 2);
+  EXPECT_EQ(polls.stats(fast).identifier, 0xB043);
+  EXPECT_EQ(polls.stats(fast).target_period_ms, 200);
+  EXPECT_EQ(polls.stats(fast).timeouts, 0);
+}
+
+TEST_F(UdsPollSchedulerTest, LimitsRequestRate) {
+  polls.set_request_rate(10);
+  for (uint16_t did = 0xB041; did < 0xB046; did++) {
+    add(did, UdsPollScheduler::Priority::High, 10);
+  }
+
+  simulate(999, 1);
+  EXPECT_EQ(sent_frames.size(), 10u);
+  for (size_t i = 1; i < request_times.size(); i++) {
+    EXPECT_GE(request_times[i] - request_times[i - 1], 100u);
+  }
+}
+
+TEST_F(UdsPollSchedulerTest, LeavesSlowEcuTimeToRest) {
+  polls.set_request_rate(100);
+  add(0xB043, UdsPollScheduler::Priority::High, 10);
+
+  simulate(2000, 50);
+  // Every request takes 50 ms to answer, after which the ECU gets another 50 ms
+  EXPECT_NEAR(requests[0xB043], 20, 2);
+  EXPECT_NEAR(polls.average_latency_ms(), 50, 2);
+}
+
+TEST_F(UdsPollSchedulerTest, LowPriorityIsNotStarved) {
+  polls.set_request_rate(10);
+  add(0xB041, UdsPollScheduler::Priority::High, 100);
+  add(0xB042, UdsPollScheduler::Priority::High, 100);
+  add(0xB043, UdsPollScheduler::Priority::High, 100);
+  add(0xB061, UdsPollScheduler::Priority::Low, 500);
+
+  // Three times more requests wanted than the rate allows
+  simulate(10000, 5);
+  EXPECT_GE(requests[0xB061], 2);
+  EXPECT_GT(requests[0xB041], 5 * requests[0xB061]);
+}
+
+TEST_F(UdsPollSchedulerTest, RetriesThenBacksOff) {
+  add(0xB043, UdsPollScheduler::Priority::High, 1000, 50, 1);
+
+  simulate(200, 0);
+  // Request sent at 1, timeout at 52, retry in the next free slot at 101, second timeout at 152
+  EXPECT_EQ(request_times, (std::vector<unsigned long>{1, 101}));
+  EXPECT_EQ(failures, (std::vector<uint16_t>{0xB043}));
+  EXPECT_EQ(polls.stats(0).timeouts, 2);
+
+  // Next try after twice the period
+  simulate(2152, 0);
+  EXPECT_EQ(request_times.size(), 2u);
+  simulate(2153, 0);
+  EXPECT_EQ(request_times.size(), 3u);
+}
+
+TEST_F(UdsPollSchedulerTest, SlowsDownOnBusyBus) {
+  add(0xB043, UdsPollScheduler::Priority::High, 200);
+  add(0xB061, UdsPollScheduler::Priority::Low, 1000);
+
+  simulate(0, 10);
+  datalayer.system.status.can_rx_stats[CAN_NATIVE].frames_received += 3000;
+  simulate(1000, 10);
+  EXPECT_TRUE(polls.bus_busy());
+  requests.clear();
+
+  // Low priority waits while the bus is busy, until it is overdue by a whole period
+  for (unsigned long second = 2; second <= 3; second++) {
+    datalayer.system.status.can_rx_stats[CAN_NATIVE].frames_received += 3000;
+    simulate(second * 1000, 10);
+  }
+  EXPECT_EQ(requests[0xB061], 0);
+  EXPECT_EQ(requests[0xB043], 10);
+  for (unsigned long second = 4; second <= 5; second++) {
+    datalayer.system.status.can_rx_stats[CAN_NATIVE].frames_received += 3000;
+    simulate(second * 1000, 10);
+  }
+  EXPECT_GE(requests[0xB061], 1);
+
+  simulate(7000, 10);
+  EXPECT_FALSE(polls.bus_busy());
+}